@@ -13,34 +13,40 @@
 #include "src/DisplayManager.h"
 #include "src/PowerManager.h"
 #include "src/CSCParser.h"
-#include <Preferences.h>
+#include "src/PowerParser.h"
+#include "src/HeartRateParser.h"
+#include "src/MeasurementDispatcher.h"
+#include "src/CSCRelay.h"
+#if CSC_RELAY_ENABLED
+#include "src/RelayPeripheral.h"
+#endif
+#include "src/SensorData.h"
+#include "src/Telemetry.h"
+#include "src/HeapMonitor.h"
+#include "src/LatencyTracker.h"
+#include "src/LinkMonitor.h"
+#include "src/Settings.h"
+#include "src/StallMonitor.h"
+#include "src/ButtonInput.h"
+#include "src/RideHistory.h"
+#include "src/SyntheticSensor.h"
 
 // 全局对象
 BLEManager bleManager;
 DisplayManager displayManager;
 PowerManager powerManager;
 CSCParser cscParser;
+PowerParser powerParser;
+HeartRateParser heartRateParser;
+MeasurementDispatcher dispatcher;  // 按测量类型把数据包交给对应的解析器
+CSCRelay cscRelay;                 // 把CSC数据转发给连接本机的中心设备
+#if CSC_RELAY_ENABLED
+RelayPeripheral relayPeripheral;
+#endif
+Telemetry telemetry;
 
 // 传感器数据
-struct SensorData {
-  float speed = 0.0;        // 速度 (km/h)
-  float cadence = 0.0;      // 踏频 (rpm)
-  uint32_t wheelRevolutions = 0;
-  uint16_t lastWheelEventTime = 0;
-  uint16_t crankRevolutions = 0;
-  uint16_t lastCrankEventTime = 0;
-  bool connected = false;
-  int8_t batteryLevel = -1;  // 电池电量 (0-100, -1表示未获取)
-  String deviceName = "";   // 设备名称
-  int8_t rssi = 0;          // 信号强度 (dBm)
-  float distance = 0.0;     // 此次连接以来的总路程 (km)
-  float totalDistance = 0.0; // 总路程（累积所有连接的路程，km）
-  float averageSpeed = 0.0; // 平均速度 (km/h)
-  unsigned long rideDuration = 0;  // 本次骑行时长（秒）
-  uint32_t initialWheelRevolutions = 0;  // 连接时的初始轮转数
-  unsigned long connectionStartTime = 0;  // 连接开始时间（用于计算平均速度和骑行时长）
-  unsigned long lastUpdateTime = 0;
-} sensorData;
+SensorData sensorData;
 
 // 状态变量
 unsigned long lastDisplayUpdate = 0;
@@ -48,25 +54,50 @@ unsigned long lastMotionTime = 0;
 
 // 按键状态
 bool pairingMode = false;
-unsigned long buttonPressStartTime = 0;
-bool buttonPressed = false;
+bool pairingCancelRequested = false;  // 匹配扫描期间长按（取消匹配）
+int64_t pairingEndedUs = 0;           // 最近一次退出匹配模式的时间（esp_timer），此前按下的长按针对的是匹配模式
 
-// 显示主题（运行时变量，0=数字表盘，1=模拟表盘，2=统计表盘）
+// 当前骑行的数据来自合成数据源（不计入总路程和骑行历史）
+bool syntheticRide = false;
+
+// 显示主题（运行时变量，0=数字表盘，1=模拟表盘，2=统计表盘，3=骑行历史）
 uint8_t currentDisplayTheme = DISPLAY_THEME;
-Preferences themePreferences;  // 用于保存主题设置
-Preferences distancePreferences;  // 用于保存总路程
+uint8_t historyPage = 0;  // 骑行历史主题显示的记录（1 = 最近一次骑行）
 
 // 函数声明
 void checkPairButton();
+bool pairingCancelPressed();
+void endPairingMode();
+void cancelPairing();
+void checkSerialCommand();
+bool resumeRideSession(const RetainedSession& session);
+void onSensorConnected();
+void showHistoryPage(uint8_t page);
+void startSyntheticSensor(uint16_t rateHz);
+bool finishSensorRide();
 
 void setup() {
+  // 检查RTC内存中是否保留了睡眠前的骑行会话（仅从深度睡眠唤醒时有效）
+  RetainedSession session;
+  bool warmResume = powerManager.restoreSession(session);
+  
+  HeapMonitor::begin();
+  
+  dispatcher.attach(MEASUREMENT_CSC, cscParser);
+  dispatcher.attach(MEASUREMENT_POWER, powerParser);
+  dispatcher.attach(MEASUREMENT_HEART_RATE, heartRateParser);
+  
   // 初始化串口
   Serial.begin(SERIAL_BAUD);
-  delay(1000);
+  if (!warmResume) {
+    delay(1000);  // 冷启动时等待串口就绪，热恢复时跳过以尽快重连
+  }
   
   // 检查是否从深度睡眠唤醒
   esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
-  if (wakeup_reason == ESP_SLEEP_WAKEUP_TIMER) {
+  if (warmResume) {
+    Serial.println("\n=== 从深度睡眠唤醒，热恢复骑行会话 ===");
+  } else if (wakeup_reason == ESP_SLEEP_WAKEUP_TIMER) {
     // 定时唤醒时不输出提示，避免干扰串口日志
   } else if (wakeup_reason == ESP_SLEEP_WAKEUP_UNDEFINED) {
     Serial.println("\n\n=== 从RST按钮唤醒（硬件复位）===");
@@ -74,18 +105,33 @@ void setup() {
     Serial.println("\n\n=== 自行车BLE传感器显示屏 ===");
   }
   Serial.println("初始化中...");
+  
+  // 主题、轮周长、已知设备和总路程：一次读取到内存
+  Settings::load();
+  cscParser.setWheelCircumference(Settings::get().wheelCircumferenceMm);
+  RideHistory::begin();
 
   // 配置CPU频率
   setCpuFrequencyMhz(CPU_FREQ_MHZ);
   Serial.printf("CPU频率: %d MHz\n", getCpuFrequencyMhz());
 
+  #if TELEMETRY_MODE == 1
+  telemetry.begin();
+  #endif
+
   // 初始化显示
   if (!displayManager.begin()) {
     Serial.println("显示初始化失败！");
     while(1) delay(1000);
   }
-  displayManager.showSplash("BLE Meter");
-  delay(2000);
+  if (!warmResume) {
+    displayManager.showSplash("BLE Meter");
+    delay(2000);
+  }
+  
+  #if DISPLAY_BENCHMARK
+  displayManager.runBenchmark();
+  #endif
 
   // ========== 显示调试模式 ==========
   // Splash 显示完后，如果启用调试模式，直接显示主界面并跳过所有后续代码
@@ -103,6 +149,11 @@ void setup() {
   #endif
   // ========== 正常模式 ==========
 
+  // 启动渲染任务（之后连接、扫描等阻塞操作期间屏幕仍按固定帧间隔刷新）
+  #if DISPLAY_RENDER_TASK
+  displayManager.startRenderTask(DISPLAY_REFRESH_INTERVAL);
+  #endif
+
   // 初始化BLE
   if (!bleManager.begin()) {
     Serial.println("BLE初始化失败！");
@@ -110,59 +161,66 @@ void setup() {
     delay(3000);
   }
 
+  #if CSC_RELAY_ENABLED
+  // 中继外设与传感器连接共用同一个BLE协议栈
+  if (relayPeripheral.begin()) {
+    cscRelay.begin(RelayPeripheral::send, &relayPeripheral);
+  }
+  #endif
+
   // 初始化功耗管理
   powerManager.begin();
 
-  // 加载保存的主题设置
-  themePreferences.begin("display", false);
-  uint8_t savedTheme = themePreferences.getUChar("theme", DISPLAY_THEME);
-  Serial.printf("从Preferences读取的主题值: %d (默认值: %d)\n", savedTheme, DISPLAY_THEME);
-  if (savedTheme <= 2) {  // 验证主题值有效（0=数字表盘，1=模拟表盘，2=统计表盘）
-    currentDisplayTheme = savedTheme;
-    Serial.printf("✓ 加载保存的主题: %d (0=数字表盘, 1=模拟表盘, 2=统计表盘)\n", currentDisplayTheme);
+  if (warmResume) {
+    // 热恢复：主题和总路程取自RTC会话（睡眠前的最新值）
+    currentDisplayTheme = (session.theme < DISPLAY_THEME_COUNT) ? session.theme : DISPLAY_THEME;
+    sensorData.totalDistance = session.totalDistance;
   } else {
-    currentDisplayTheme = DISPLAY_THEME;
-    Serial.printf("✗ 主题值无效，使用默认主题: %d\n", currentDisplayTheme);
+    uint8_t savedTheme = Settings::get().theme;
+    if (savedTheme < DISPLAY_THEME_COUNT) {  // 验证主题值有效（0=数字表盘，1=模拟表盘，2=统计表盘，3=骑行历史）
+      currentDisplayTheme = savedTheme;
+    } else {
+      currentDisplayTheme = DISPLAY_THEME;
+      Serial.printf("✗ 主题值无效，使用默认主题: %d\n", currentDisplayTheme);
+    }
+    sensorData.totalDistance = Settings::get().odometerKm;
+  }
+  if (currentDisplayTheme == DISPLAY_THEME_HISTORY) {
+    showHistoryPage(1);
   }
-  
-  // 加载保存的总路程
-  distancePreferences.begin("distance", false);
-  sensorData.totalDistance = distancePreferences.getFloat("total", 0.0);
-  Serial.printf("加载总路程: %.3f km\n", sensorData.totalDistance);
 
   // 初始化匹配按键（如果配置了）
   #if PAIR_BUTTON_GPIO >= 0
-  // ESP32 C3 Super Mini的BOOT按钮（GPIO9）需要配置为输入模式，启用内部上拉
-  pinMode(PAIR_BUTTON_GPIO, INPUT_PULLUP);
-  // 等待GPIO稳定
-  delay(10);
-  Serial.printf("匹配按键已初始化: GPIO%d\n", PAIR_BUTTON_GPIO);
+  // ESP32 C3 Super Mini的BOOT按钮（GPIO9）配置为上拉输入，按下/释放由边沿中断和定时器识别
+  if (ButtonInput::begin(PAIR_BUTTON_GPIO)) {
+    Serial.printf("匹配按键已初始化: GPIO%d\n", PAIR_BUTTON_GPIO);
+  }
   Serial.printf("长按时间: %d ms\n", BUTTON_PRESS_TIME);
   Serial.println("提示: 长按BOOT按钮进入匹配模式");
   #endif
 
   Serial.println("初始化完成");
   displayManager.showStatus("连接中...");
+  Serial.printf("启动耗时: 首帧 %lu ms, 设置读取 %lu us, 初始化 %lu ms\n",
+                (unsigned long)(displayManager.getFirstFrameUs() / 1000), (unsigned long)Settings::getLoadUs(),
+                (unsigned long)(esp_timer_get_time() / 1000));
+  
+  if (warmResume) {
+    // 热恢复：跳过扫描，直接连接睡眠前的设备并继续本次骑行
+    if (!resumeRideSession(session)) {
+      displayManager.showStatus("等待连接");
+    }
+    return;
+  }
   
-  // 尝试快速连接上次的设备
-  if (bleManager.scanAndConnect()) {
-    sensorData.connected = true;
+  // 直接连接上次的设备（与掉线后的重连是同一个流程，失败时在主循环中退避重试）
+  bleManager.beginReconnect();
+  if (bleManager.reconnect()) {
+    onSensorConnected();
     Serial.println("✓ 快速连接到上次的设备成功！");
-    // 保存设备名称和信号强度
-    sensorData.deviceName = bleManager.getDeviceName();
-    sensorData.rssi = bleManager.getRSSI();
-    // 立即读取一次电量
-    sensorData.batteryLevel = bleManager.readBatteryLevel();
-    // 重置路程统计、平均速度和骑行时长
-    sensorData.distance = 0.0;
-    sensorData.averageSpeed = 0.0;
-    sensorData.rideDuration = 0;
-    sensorData.initialWheelRevolutions = 0;
-    sensorData.connectionStartTime = millis();
     displayManager.showStatus("已连接");
   } else {
     displayManager.showStatus("等待连接");
-    Serial.println("提示: 长按BOOT按钮进入匹配模式");
   }
 }
 
@@ -179,13 +237,16 @@ void loop() {
     return;  // 跳过后续所有逻辑
   #endif
   // ========== 正常模式 ==========
+  StallMonitor::loopStart();  // 结束上一次迭代的计时（耗时统计和卡顿归类）
 
-  // 检测匹配按键（如果配置了）
-  // 注意：按键检测应该在循环中频繁调用，确保能及时响应
+  // 处理匹配按键事件（如果配置了）
   #if PAIR_BUTTON_GPIO >= 0
   checkPairButton();
   #endif
   
+  // 串口命令（输出统计信息）
+  checkSerialCommand();
+  
   // 检查BLE连接状态
   if (!sensorData.connected) {
     if (pairingMode) {
@@ -196,23 +257,20 @@ void loop() {
         lastPairingUpdate = millis();
       }
       
-      if (bleManager.scanAndConnectForced()) {
-        sensorData.connected = true;
-        pairingMode = false;
+      // 扫描期间长按取消匹配：扫描立即停止，不连接
+      pairingCancelRequested = false;
+      if (bleManager.scanAndConnectForced(pairingCancelPressed)) {
+        endPairingMode();
+        onSensorConnected();
         Serial.println("✓ 匹配成功，传感器连接成功！");
-        // 保存设备名称和信号强度
-        sensorData.deviceName = bleManager.getDeviceName();
-        sensorData.rssi = bleManager.getRSSI();
-        // 立即读取一次电量
-        sensorData.batteryLevel = bleManager.readBatteryLevel();
-        // 重置路程统计和平均速度
-        sensorData.distance = 0.0;
-        sensorData.averageSpeed = 0.0;
-        sensorData.initialWheelRevolutions = 0;
-        sensorData.connectionStartTime = millis();
         displayManager.showStatus("已连接");
-        delay(1000);
+        {
+          StallScope scope(STALL_REGION_UI_DELAY);
+          delay(1000);
+        }
         lastMotionTime = millis();
+      } else if (pairingCancelRequested) {
+        cancelPairing();
       } else {
         // 匹配失败时显示状态，但不要立即退出匹配模式
         static unsigned long lastMatchTime = 0;
@@ -222,80 +280,87 @@ void loop() {
         }
       }
     } else {
-      // 正常模式：尝试快速连接上次的设备
-      // 减少连接尝试频率，避免频繁调用
-      static unsigned long lastConnectAttempt = 0;
-      static bool connectionAttempted = false;
+      // 正常模式：重连流程（掉线后立即直接连接上次的设备，失败后指数退避，等待期间不阻塞）
       static unsigned long lastStatusUpdate = 0;
-      
-      // 定期更新显示状态（即使不在连接尝试时）
       if (millis() - lastStatusUpdate > 1000) {  // 每秒更新一次显示
-        if (connectionAttempted && (millis() - lastConnectAttempt < 5000)) {
-          // 正在尝试连接
-          displayManager.showStatus("连接中...");
-        } else {
-          // 等待连接
-          displayManager.showStatus("等待连接");
-        }
+        displayManager.showStatus(bleManager.hasReconnectTarget() ? "连接中..." : "等待连接");
         lastStatusUpdate = millis();
       }
       
-      // 每5秒尝试连接一次
-      if (!connectionAttempted || (millis() - lastConnectAttempt > 5000)) {
-        connectionAttempted = true;
-        lastConnectAttempt = millis();
-        
-        if (bleManager.scanAndConnect()) {
-          sensorData.connected = true;
-          Serial.println("✓ 传感器连接成功，开始接收数据...");
-          // 保存设备名称和信号强度
-          sensorData.deviceName = bleManager.getDeviceName();
-          sensorData.rssi = bleManager.getRSSI();
-          // 立即读取一次电量
-          sensorData.batteryLevel = bleManager.readBatteryLevel();
-          // 重置路程统计和平均速度
-          sensorData.distance = 0.0;
-          sensorData.averageSpeed = 0.0;
-          sensorData.initialWheelRevolutions = 0;
-          sensorData.connectionStartTime = millis();
-          displayManager.showStatus("已连接");
-          delay(1000);
-          lastMotionTime = millis();
-          connectionAttempted = false;  // 连接成功后重置
-        } else {
-          // 连接失败，显示状态会在上面的定期更新中处理
-          // 状态信息已在BLEManager中输出，这里不再重复输出
-        }
+      if (bleManager.reconnect()) {
+        onSensorConnected();
+        Serial.println("✓ 传感器连接成功，开始接收数据...");
+        displayManager.showStatus("已连接");
+      } else if (bleManager.getDisconnectedMs() > BLE_RECONNECT_GIVE_UP_MS) {
+        // 长时间未连接，进入深度睡眠节省电量
+        Serial.println("进入深度睡眠...");
+        Serial.println("提示: 使用RST按钮唤醒，唤醒后长按BOOT按钮进入匹配模式");
+        displayManager.powerOff();  // 直接关闭显示，避免睡眠字样缺字
+        powerManager.saveSession(sensorData, bleManager.getDeviceAddress(), currentDisplayTheme);
+        Settings::flush();
+        delay(1000);
+        powerManager.enterDeepSleep(DEEP_SLEEP_DURATION);
       }
-      
-        // 如果长时间未连接，进入深度睡眠节省电量
-        if (millis() > 30000) {  // 30秒后
-          Serial.println("进入深度睡眠...");
-          Serial.println("提示: 使用RST按钮唤醒，唤醒后长按BOOT按钮进入匹配模式");
-          displayManager.powerOff();  // 直接关闭显示，避免睡眠字样缺字
-          delay(1000);
-          powerManager.enterDeepSleep();
-        }
     }
   } else {
-    // 已连接，读取数据
-    if (bleManager.isConnected()) {
-      // 读取CSC数据
-      uint8_t* data = bleManager.readCSCData();
-      size_t dataLength = bleManager.getLastDataLength();
-      if (data != nullptr) {
-        // 解析数据
-        cscParser.parseData(data, dataLength, sensorData);
+    // 已连接（或合成数据源运行中），读取数据
+    if (bleManager.isConnected() || SyntheticSensor::isRunning()) {
+      // 读取测量数据（CSC、功率、心率共用一个缓冲区，复制到栈上，不分配堆内存）
+      uint8_t data[MEASUREMENT_PACKET_MAX];
+      size_t dataLength;
+      MeasurementKind kind = MEASUREMENT_CSC;
+      uint32_t arrivalUs = 0;
+      {
+        HeapScope scope(HEAP_TAG_BLE);
+        bleManager.requestRSSI();  // 定期异步读取RSSI（结果在BLE任务中送给 LinkMonitor）
+        dataLength = bleManager.readMeasurement(data, sizeof(data), &kind, &arrivalUs);
+      }
+      sensorData.rssi = bleManager.getRSSI();
+      sensorData.rssiTrend = LinkMonitor::getRssiTrend();
+      if (dataLength > 0) {
+        uint32_t dequeuedUs = LatencyTracker::now();
+        LatencyTracker::record(LATENCY_QUEUE, arrivalUs, dequeuedUs);
+        
+        // 原始CSC数据包（二进制遥测模式下用于离线回放）
+        #if TELEMETRY_MODE == 1 && TELEMETRY_RAW_PACKETS
+        if (kind == MEASUREMENT_CSC) {
+          telemetry.sendRawPacket(data, dataLength);
+        }
+        #endif
+        
+        // 按测量类型交给对应的解析器
+        {
+          HeapScope scope(HEAP_TAG_PARSER);
+          dispatcher.dispatch(kind, data, dataLength, sensorData, arrivalUs);
+        }
+        // 尽早转发给中继的中心设备（在显示、日志等处理之前）
+        #if CSC_RELAY_ENABLED
+        if (kind == MEASUREMENT_CSC) {
+          cscRelay.forward(sensorData, arrivalUs);
+        }
+        #endif
+        // 到达时间随数据一起传给显示，帧发送完成时统计端到端延迟
+        sensorData.packetArrivalUs = arrivalUs;
+        sensorData.packetParsedUs = LatencyTracker::now();
+        LatencyTracker::record(LATENCY_PARSE, dequeuedUs, sensorData.packetParsedUs);
+        // 按到达间隔和计数器跳变推断丢失的通知（只有CSC数据包带计数器）
+        if (kind == MEASUREMENT_CSC) {
+          LinkMonitor::onPacket(arrivalUs, sensorData.wheelRevolutions, sensorData.crankRevolutions);
+          sensorData.linkLossPermille = LinkMonitor::getLossPermille();
+        }
+        powerManager.reportFirstData();
         
         // 计算路程（此次连接以来的总路程）
         if (sensorData.initialWheelRevolutions == 0) {
           // 第一次收到数据，记录初始轮转数
           sensorData.initialWheelRevolutions = sensorData.wheelRevolutions;
+          // 连接建立完成，之后的堆分配都算作骑行中的分配
+          HeapMonitor::markSteadyState();
         } else {
           // 计算轮转数差
           uint32_t revDiff = sensorData.wheelRevolutions - sensorData.initialWheelRevolutions;
-          // 计算路程（km）= 轮转数差 × 轮周长(mm) / 1000000.0
-          float distanceKm = (revDiff * WHEEL_CIRCUMFERENCE_MM) / 1000000.0;
+          // 计算路程（km）= 睡眠前路程 + 轮转数差 × 轮周长(mm) / 1000000.0
+          float distanceKm = sensorData.distanceOffset + (revDiff * Settings::get().wheelCircumferenceMm) / 1000000.0;
           sensorData.distance = distanceKm;
           
           // 计算平均速度（路程 / 连接时长）
@@ -309,24 +374,37 @@ void loop() {
             sensorData.rideDuration = connectionDuration / 1000;
           }
         }
+        // 骑行摘要（移动时间、最高速度、平均踏频）只在内存中累计，骑行结束时写入一次
+        RideHistory::update(sensorData, millis());
         
         // 读取电池电量（定期读取，避免频繁调用）
         static unsigned long lastBatteryRead = 0;
         if (millis() - lastBatteryRead > 5000) {  // 每5秒读取一次电量
+          HeapScope scope(HEAP_TAG_BLE);
           sensorData.batteryLevel = bleManager.readBatteryLevel();
           lastBatteryRead = millis();
         }
         
         // 串口输出解析后的数据
+        #if TELEMETRY_MODE == 1
+        // 二进制遥测：每个数据包一条固定布局记录
+        telemetry.sendSensorRecord(sensorData);
+        #else
         Serial.println("=== CSC数据 ===");
-        if (sensorData.deviceName.length() > 0) {
-          Serial.printf("设备名称: %s\n", sensorData.deviceName.c_str());
+        if (sensorData.deviceName[0] != '\0') {
+          Serial.printf("设备名称: %s\n", sensorData.deviceName);
         }
         if (sensorData.rssi != 0) {
           Serial.printf("信号强度: %d dBm\n", sensorData.rssi);
         }
         Serial.printf("速度: %.2f km/h\n", sensorData.speed);
         Serial.printf("踏频: %.1f rpm\n", sensorData.cadence);
+        if (dispatcher.getPackets(MEASUREMENT_POWER) > 0) {
+          Serial.printf("功率: %u W\n", sensorData.power);
+        }
+        if (sensorData.heartRate > 0) {
+          Serial.printf("心率: %u bpm\n", sensorData.heartRate);
+        }
         Serial.printf("本次路程: %.3f km\n", sensorData.distance);
         Serial.printf("总路程: %.3f km\n", sensorData.totalDistance);
         Serial.printf("平均速度: %.2f km/h\n", sensorData.averageSpeed);
@@ -334,14 +412,14 @@ void loop() {
         unsigned long minutes = (sensorData.rideDuration % 3600) / 60;
         unsigned long seconds = sensorData.rideDuration % 60;
         Serial.printf("骑行时长: %lu:%02lu:%02lu\n", hours, minutes, seconds);
-        Serial.printf("轮转数: %lu\n", sensorData.wheelRevolutions);
+        Serial.printf("轮转数: %lu\n", (unsigned long)sensorData.wheelRevolutions);
         Serial.printf("曲柄转数: %u\n", sensorData.crankRevolutions);
         if (sensorData.batteryLevel >= 0) {
           Serial.printf("电池电量: %d%%\n", sensorData.batteryLevel);
         }
         Serial.println("===============");
+        #endif
         
-        free(data);  // 释放内存
         sensorData.lastUpdateTime = millis();
         
         // 更新运动时间
@@ -356,141 +434,373 @@ void loop() {
           lastStatusTime = millis();
         }
       }
+      
+      // 二进制遥测：定期发送链路质量统计（没有数据包时也发送，便于观察中断前后的信号变化）
+      #if TELEMETRY_MODE == 1 && LINK_MONITOR_ENABLED
+      static unsigned long lastLinkReport = 0;
+      if (millis() - lastLinkReport > LINK_REPORT_INTERVAL_MS) {
+        LinkStats linkStats;
+        LinkMonitor::snapshot(linkStats);
+        telemetry.sendLinkRecord(linkStats, bleManager.getPacketsDropped());
+        lastLinkReport = millis();
+      }
+      #endif
     } else {
-      // 连接断开
-      // 计算最终骑行时长
-      if (sensorData.connectionStartTime > 0) {
-        unsigned long connectionDuration = millis() - sensorData.connectionStartTime;
-        sensorData.rideDuration = connectionDuration / 1000;
+      // 连接断开：本次骑行结束
+      if (finishSensorRide() && currentDisplayTheme == DISPLAY_THEME_HISTORY) {
+        showHistoryPage(1);
       }
-      
-      // 累积此次连接的路程到总路程
-      if (sensorData.distance > 0.0) {
-        sensorData.totalDistance += sensorData.distance;
-        distancePreferences.putFloat("total", sensorData.totalDistance);
-        unsigned long hours = sensorData.rideDuration / 3600;
-        unsigned long minutes = (sensorData.rideDuration % 3600) / 60;
-        unsigned long seconds = sensorData.rideDuration % 60;
-        Serial.printf("连接断开，累积路程: %.3f km，总路程: %.3f km，平均速度: %.2f km/h，骑行时长: %lu:%02lu:%02lu\n", 
-                     sensorData.distance, sensorData.totalDistance, sensorData.averageSpeed, hours, minutes, seconds);
+      if (syntheticRide) {
+        Serial.println("合成数据源已停止");
+        syntheticRide = false;
       }
+      #if LINK_MONITOR_ENABLED
+      LinkMonitor::report();  // 断开前的信号和丢包情况
+      #endif
       
       sensorData.connected = false;
-      sensorData.deviceName = "";
+      sensorData.deviceName[0] = '\0';
       sensorData.rssi = 0;
+      sensorData.rssiTrend = 0;
+      sensorData.linkLossPermille = 0;
+      sensorData.power = 0;
+      sensorData.heartRate = 0;
       sensorData.batteryLevel = -1;
       sensorData.distance = 0.0;
+      sensorData.distanceOffset = 0.0;
       sensorData.averageSpeed = 0.0;
       sensorData.rideDuration = 0;
       sensorData.initialWheelRevolutions = 0;
       sensorData.connectionStartTime = 0;
       Serial.println("连接断开！");
       displayManager.showStatus("连接断开");
-      delay(2000);
+      // 下一次循环立即开始直接连接
+      bleManager.beginReconnect();
     }
   }
 
   // 更新显示
-  if (millis() - lastDisplayUpdate >= DISPLAY_REFRESH_INTERVAL) {
+  // 渲染任务运行时每次循环都发布最新数据（只复制到邮箱，不绘制），由渲染任务按固定帧间隔刷新
+  if (displayManager.isRenderTaskRunning() || millis() - lastDisplayUpdate >= DISPLAY_REFRESH_INTERVAL) {
     static uint8_t lastTheme = 255;
     if (currentDisplayTheme != lastTheme) {
       Serial.printf("切换显示主题: %d\n", currentDisplayTheme);
       lastTheme = currentDisplayTheme;
     }
-    displayManager.updateDisplay(sensorData, currentDisplayTheme);
+    {
+      HeapScope scope(HEAP_TAG_DISPLAY);
+      StallScope stallScope(STALL_REGION_RENDER);
+      displayManager.updateDisplay(sensorData, currentDisplayTheme);
+    }
     lastDisplayUpdate = millis();
+    
+    // 定期输出显示传输耗时（每30秒一次）
+    static unsigned long lastDisplayStats = 0;
+    if (DEBUG_MODE && PACKET_LOG_ENABLED && millis() - lastDisplayStats > 30000) {
+      Serial.printf("[显示] 每帧阻塞: %lu us (最大 %lu us), I2C传输: %lu us\n",
+                    (unsigned long)displayManager.getFrameBlockingUs(),
+                    (unsigned long)displayManager.getMaxFrameBlockingUs(),
+                    (unsigned long)displayManager.getFrameTransferUs());
+      if (displayManager.isRenderTaskRunning()) {
+        Serial.printf("[显示] 渲染任务: 绘制 %lu 帧, 内容未变跳过 %lu 次, 节拍抖动: %lu us (最大 %lu us)\n",
+                      (unsigned long)displayManager.getFramesRendered(),
+                      (unsigned long)displayManager.getFramesSkipped(),
+                      (unsigned long)displayManager.getFrameJitterUs(),
+                      (unsigned long)displayManager.getMaxFrameJitterUs());
+      }
+      lastDisplayStats = millis();
+    }
+  }
+
+  // 合成数据源：输出速率扫描已完成的档位
+  SyntheticSensor::service();
+
+  // 合并写入设置的修改
+  {
+    HeapScope scope(HEAP_TAG_STORAGE);
+    Settings::service(millis());
   }
 
-  // 检查是否需要进入睡眠
-  if (STATIONARY_TIME > 0 && 
+  // 定期输出堆内存统计
+  #if HEAP_MONITOR_ENABLED
+  static unsigned long lastHeapReport = 0;
+  if (millis() - lastHeapReport > HEAP_REPORT_INTERVAL) {
+    HeapMonitor::report();
+    if (bleManager.getPacketsDropped() > 0) {
+      Serial.printf("[BLE] 通知缓冲区溢出丢弃: %lu 个数据包\n", (unsigned long)bleManager.getPacketsDropped());
+    }
+    lastHeapReport = millis();
+  }
+  #endif
+
+  // 检查是否需要进入睡眠（合成数据源运行时不睡眠）
+  if (STATIONARY_TIME > 0 && !syntheticRide &&
       (millis() - lastMotionTime) > (STATIONARY_TIME * 1000) &&
       sensorData.speed < MOTION_THRESHOLD) {
     Serial.println("检测到静止，进入深度睡眠...");
     displayManager.showStatus("睡眠中...");
+    // 保存骑行会话到RTC内存，唤醒后直接重连并继续本次骑行（骑行摘要先写入，热恢复后继续同一条记录）
+    RideHistory::suspendRide(sensorData);
+    powerManager.saveSession(sensorData, bleManager.getDeviceAddress(), currentDisplayTheme);
+    Settings::flush();
     delay(1000);
-    powerManager.enterDeepSleep();
+    powerManager.enterDeepSleep(DEEP_SLEEP_DURATION);
   }
 
-  // 短暂延迟，避免CPU占用过高
-  delay(10);
+  // 短暂延迟，避免CPU占用过高。每次循环只处理一个数据包：缓冲区中还有数据包时只让出1 ms（让空闲任务运行）
+  // 就进入下一次循环，主循环能持续处理的速率由处理耗时决定，而不是固定的10 ms延迟（约100 Hz）
+  delay(bleManager.hasQueuedMeasurement() ? 1 : 10);
 }
 
-// 检测匹配按键
-// 正常运行时，长按BOOT按钮进入匹配模式
-// ESP32 C3 Super Mini的BOOT按钮连接到GPIO9
+// 处理匹配按键事件
+// 短按切换显示主题，长按（按住 BUTTON_PRESS_TIME）进入匹配模式，匹配模式下再次长按取消
+// ESP32 C3 Super Mini的BOOT按钮连接到GPIO9；事件由中断和定时器产生，主循环阻塞期间的按键在之后处理。
+// 匹配扫描期间的长按由扫描循环取出（pairingCancelPressed）；连接期间按下、匹配结束后才处理的长按按发生时间忽略，
+// 不会被当作"进入匹配模式"而清除刚匹配的设备
 // 注意：深度睡眠时使用RST按钮唤醒（硬件复位）
 void checkPairButton() {
-  static bool lastRawState = HIGH;
-  static bool lastStableState = HIGH;
-  static unsigned long lastDebounceTime = 0;
-  static bool longPressNotified = false;
-  
-  // 读取按键状态（BOOT按钮按下时为LOW，释放时为HIGH，使用内部上拉）
-  bool currentButtonState = digitalRead(PAIR_BUTTON_GPIO);
-  
-  // 检测原始状态变化（用于防抖）
-  if (currentButtonState != lastRawState) {
-    lastDebounceTime = millis();
-    lastRawState = currentButtonState;
-  }
-  
-  // 状态稳定后处理（防抖时间后）
-  if ((millis() - lastDebounceTime) > BUTTON_DEBOUNCE_TIME) {
-    // 按键按下（从HIGH变为LOW）
-    if (currentButtonState == LOW && lastStableState == HIGH) {
-      buttonPressStartTime = millis();
-      buttonPressed = true;
-      longPressNotified = false;
-    } 
-    // 按键释放（从LOW变为HIGH）
-    else if (currentButtonState == HIGH && lastStableState == LOW) {
-      if (buttonPressed) {
-        unsigned long pressDuration = millis() - buttonPressStartTime;
-        buttonPressed = false;
-        
-        if (pressDuration >= BUTTON_PRESS_TIME) {
-          // 长按：进入匹配模式
-          Serial.println("=== 进入匹配模式 ===");
-          if (!pairingMode) {
-            pairingMode = true;
-            Serial.println("开始扫描并连接新的CSC传感器...");
-            displayManager.showStatus("匹配模式");
-            // 清除上次保存的设备地址
-            bleManager.clearLastDevice();
-            // 如果已连接，先断开
-            if (sensorData.connected) {
-              bleManager.disconnect();
-              sensorData.connected = false;
-            }
-          } else {
-            // 匹配模式下再次长按：取消匹配
-            pairingMode = false;
-            Serial.println("取消匹配模式");
-            displayManager.showStatus("已取消");
-          }
-        } else if (pressDuration > BUTTON_DEBOUNCE_TIME && pressDuration < BUTTON_PRESS_TIME) {
-          // 短按：切换显示主题（0->1->2->0循环）
-          currentDisplayTheme = (currentDisplayTheme + 1) % 3;
-          themePreferences.putUChar("theme", currentDisplayTheme);
-          const char* themeNames[] = {"数字表盘", "模拟表盘", "统计表盘"};
-          Serial.printf("切换显示主题: %d (%s)\n", currentDisplayTheme, themeNames[currentDisplayTheme]);
-          displayManager.showStatus(themeNames[currentDisplayTheme]);
-          delay(1000);
+  ButtonEvent event;
+  int64_t eventUs = 0;
+  while ((event = ButtonInput::poll(&eventUs)) != BUTTON_EVENT_NONE) {
+    if (event == BUTTON_EVENT_LONG_PRESS) {
+      if (!pairingMode && eventUs <= pairingEndedUs) {
+        Serial.println("忽略匹配模式结束前按下的长按");
+      } else if (!pairingMode) {
+        Serial.println("=== 进入匹配模式 ===");
+        pairingMode = true;
+        Serial.println("开始扫描并连接新的CSC传感器...");
+        displayManager.showStatus("匹配模式");
+        // 清除上次保存的设备地址
+        bleManager.clearLastDevice();
+        // 如果已连接，先断开（保存本次骑行的摘要）
+        if (sensorData.connected) {
+          finishSensorRide();
+          SyntheticSensor::stop();
+          syntheticRide = false;
+          bleManager.disconnect();
+          sensorData.connected = false;
         }
+      } else {
+        // 匹配模式下再次长按：取消匹配
+        cancelPairing();
+      }
+    } else if (event == BUTTON_EVENT_SHORT_PRESS &&
+               currentDisplayTheme == DISPLAY_THEME_HISTORY && historyPage < RideHistory::getCount()) {
+      // 骑行历史主题：短按翻到更早的一次骑行，最早一次之后切换到下一个主题
+      showHistoryPage(historyPage + 1);
+      Serial.printf("骑行历史: %u/%u\n", historyPage, sensorData.historyCount);
+    } else if (event == BUTTON_EVENT_SHORT_PRESS) {
+      // 短按：切换显示主题（0->1->2->3->0循环）
+      currentDisplayTheme = (currentDisplayTheme + 1) % DISPLAY_THEME_COUNT;
+      if (currentDisplayTheme == DISPLAY_THEME_HISTORY) {
+        showHistoryPage(1);
       }
+      Settings::setTheme(currentDisplayTheme);  // 连续切换时只写入最后的主题
+      const char* themeNames[] = {UI_TEXT("数字表盘"), UI_TEXT("模拟表盘"), UI_TEXT("统计表盘"), UI_TEXT("骑行历史")};
+      Serial.printf("切换显示主题: %d (%s)\n", currentDisplayTheme, themeNames[currentDisplayTheme]);
+      displayManager.showStatus(themeNames[currentDisplayTheme]);
+      StallScope scope(STALL_REGION_UI_DELAY);
+      delay(1000);
     }
-    // 按键持续按下时的反馈（仅在长按时间达到时输出一次）
-    else if (buttonPressed && currentButtonState == LOW) {
-      unsigned long pressDuration = millis() - buttonPressStartTime;
-      if (pressDuration >= BUTTON_PRESS_TIME && !longPressNotified) {
-        longPressNotified = true;
+  }
+}
+
+// 匹配扫描期间检查取消：只取出长按，短按留在队列中由 checkPairButton 处理
+bool pairingCancelPressed() {
+  if (ButtonInput::take(BUTTON_EVENT_LONG_PRESS)) {
+    pairingCancelRequested = true;
+  }
+  return pairingCancelRequested;
+}
+
+void endPairingMode() {
+  if (pairingMode) {
+    pairingEndedUs = esp_timer_get_time();
+  }
+  pairingMode = false;
+}
+
+void cancelPairing() {
+  endPairingMode();
+  Serial.println("取消匹配模式");
+  displayManager.showStatus("已取消");
+  bleManager.beginReconnect();  // 重新开始计时，不立即进入深度睡眠
+}
+
+// 串口命令（按行读取，不分配堆内存）
+//   latency        输出各阶段延迟统计
+//   latency reset  清零延迟统计
+//   link           输出链路质量统计（RSSI、丢包、到达间隔分布）
+//   relay          输出中继转发统计
+//   stall          输出主循环卡顿统计
+//   stall reset    清零卡顿统计
+//   history        输出保存的骑行记录
+//   synth <Hz>     以固定速率运行合成CSC数据源（断开传感器）
+//   synth sweep    合成数据源速率扫描，输出不溢出的最高速率
+//   synth off      停止合成数据源（之后重连传感器）
+//   synth          输出合成数据源统计
+//   settings       输出保存的设置
+//   wheel <毫米>   设置轮子周长
+void checkSerialCommand() {
+  static char line[32];
+  static uint8_t length = 0;
+  while (Serial.available() > 0) {
+    char c = (char)Serial.read();
+    if (c != '\n' && c != '\r') {
+      if (length < sizeof(line) - 1) {
+        line[length++] = c;
       }
+      continue;
     }
+    if (length == 0) continue;
+    line[length] = '\0';
+    length = 0;
     
-    // 更新稳定状态
-    lastStableState = currentButtonState;
+    if (strcmp(line, "latency") == 0) {
+      LatencyTracker::report();
+    } else if (strcmp(line, "latency reset") == 0) {
+      LatencyTracker::reset();
+      Serial.println("延迟统计已清零");
+    } else if (strcmp(line, "link") == 0) {
+      LinkMonitor::report();
+    } else if (strcmp(line, "relay") == 0) {
+      #if CSC_RELAY_ENABLED
+      Serial.printf("[中继] 已连接的中心设备: %u\n", relayPeripheral.getCentralCount());
+      cscRelay.report();
+      #else
+      Serial.println("中继未启用（config.h 中的 CSC_RELAY_ENABLED）");
+      #endif
+    } else if (strcmp(line, "stall") == 0) {
+      StallMonitor::report();
+    } else if (strcmp(line, "stall reset") == 0) {
+      StallMonitor::reset();
+      Serial.println("卡顿统计已清零");
+    } else if (strcmp(line, "history") == 0) {
+      RideHistory::report();
+    } else if (strcmp(line, "synth") == 0) {
+      SyntheticSensor::report();
+    } else if (strcmp(line, "synth sweep") == 0) {
+      startSyntheticSensor(0);
+    } else if (strcmp(line, "synth off") == 0) {
+      SyntheticSensor::stop();  // 主循环按断开处理，之后开始重连
+    } else if (strncmp(line, "synth ", 6) == 0) {
+      startSyntheticSensor((uint16_t)atoi(line + 6));
+    } else if (strcmp(line, "settings") == 0) {
+      Settings::report();
+    } else if (strncmp(line, "wheel ", 6) == 0) {
+      int mm = atoi(line + 6);
+      if (mm >= 1000 && mm <= 3000) {
+        Settings::setWheelCircumference((uint16_t)mm);
+        cscParser.setWheelCircumference((uint16_t)mm);
+        Serial.printf("轮周长: %d mm\n", mm);
+      } else {
+        Serial.println("轮周长应在 1000-3000 mm 之间");
+      }
+    } else {
+      Serial.printf("未知命令: %s（可用: latency, latency reset, link, relay, stall, stall reset, history, synth, synth <Hz>, synth sweep, synth off, settings, wheel <毫米>）\n", line);
+    }
+  }
+}
+
+// 从深度睡眠热恢复：直接连接睡眠前的设备，恢复本次骑行的路程和时长
+bool resumeRideSession(const RetainedSession& session) {
+  Serial.printf("热恢复: 直接连接 %s\n", session.deviceAddress);
+  bleManager.beginReconnect(session.deviceAddress);  // 失败时主循环按同一流程退避重试
+  if (!bleManager.reconnect()) {
+    Serial.println("热恢复连接失败，主循环中继续重连");
+    // 睡眠前的路程还未累积到总路程，此处补上，避免丢失
+    if (session.rideActive && session.distance > 0.0) {
+      sensorData.totalDistance += session.distance;
+      Settings::checkpointOdometer(sensorData.totalDistance);
+    }
+    return false;
+  }
+  
+  onSensorConnected();  // 第一个数据包重新确定基准（传感器计数可能已重置）
+  if (session.rideActive) {
+    // 继续睡眠前的骑行：路程作为偏移量，骑行时长扣除睡眠时间
+    sensorData.distanceOffset = session.distance;
+    sensorData.distance = session.distance;
+    sensorData.connectionStartTime = millis() - session.rideElapsedMs;
+    sensorData.rideDuration = session.rideElapsedMs / 1000;
+    RideHistory::resumeRide();
+  }
+  displayManager.showStatus("已连接");
+  Serial.printf("✓ 热恢复成功，继续骑行: 路程 %.3f km，时长 %lu 秒\n",
+                sensorData.distance, sensorData.rideDuration);
+  return true;
+}
+
+// 传感器连接建立（启动、匹配、重连、热恢复共用）：配置解析器，开始新的一段骑行统计
+void onSensorConnected() {
+  sensorData.connected = true;
+  cscParser.configure(bleManager.getCSCFeature());  // 按传感器的CSC Feature选择数据包解码方式
+  cscRelay.reset();  // 新的传感器：中继重新建立计数器基准
+  // 保存设备名称和信号强度
+  snprintf(sensorData.deviceName, sizeof(sensorData.deviceName), "%s", bleManager.getDeviceName());
+  sensorData.rssi = bleManager.getRSSI();
+  // 立即读取一次电量（已订阅电量通知时不读取）
+  sensorData.batteryLevel = bleManager.readBatteryLevel();
+  // 重置路程统计、平均速度和骑行时长
+  sensorData.distance = 0.0;
+  sensorData.distanceOffset = 0.0;
+  sensorData.averageSpeed = 0.0;
+  sensorData.rideDuration = 0;
+  sensorData.initialWheelRevolutions = 0;
+  sensorData.connectionStartTime = millis();
+  lastMotionTime = millis();
+  RideHistory::startRide();
+}
+
+// 合成数据源（rateHz 为0时速率扫描）：断开真实传感器，数据从合成数据源开始一段新的骑行统计
+void startSyntheticSensor(uint16_t rateHz) {
+  if (sensorData.connected && !syntheticRide) {
+    finishSensorRide();  // 真实传感器的这段骑行计入总路程和骑行历史
+    bleManager.disconnect();
+  }
+  bool started = rateHz == 0 ? SyntheticSensor::startSweep() : SyntheticSensor::start(rateHz);
+  if (!started) {
+    return;
+  }
+  endPairingMode();
+  syntheticRide = true;
+  onSensorConnected();
+  cscParser.configure(-1);  // 与BT003-2一样不提供CSC Feature，自动识别5字节数据包
+  snprintf(sensorData.deviceName, sizeof(sensorData.deviceName), "Synthetic");
+  displayManager.showStatus("已连接");
+}
+
+// 结束一次骑行（断开、进入匹配模式或切换到合成数据源时调用）：路程累积到总路程，保存骑行摘要。
+// 合成数据源的骑行不计入。返回是否保存了骑行摘要
+bool finishSensorRide() {
+  if (syntheticRide) {
+    return false;
+  }
+  // 计算最终骑行时长
+  if (sensorData.connectionStartTime > 0) {
+    unsigned long connectionDuration = millis() - sensorData.connectionStartTime;
+    sensorData.rideDuration = connectionDuration / 1000;
   }
   
-  lastRawState = currentButtonState;
+  // 累积此次连接的路程到总路程
+  if (sensorData.distance > 0.0) {
+    sensorData.totalDistance += sensorData.distance;
+    Settings::checkpointOdometer(sensorData.totalDistance);  // 延迟合并写入（重连期间不写闪存）
+    unsigned long hours = sensorData.rideDuration / 3600;
+    unsigned long minutes = (sensorData.rideDuration % 3600) / 60;
+    unsigned long seconds = sensorData.rideDuration % 60;
+    Serial.printf("骑行结束，累积路程: %.3f km，总路程: %.3f km，平均速度: %.2f km/h，骑行时长: %lu:%02lu:%02lu\n", 
+                 sensorData.distance, sensorData.totalDistance, sensorData.averageSpeed, hours, minutes, seconds);
+  }
+  return RideHistory::finishRide(sensorData);
 }
 
+// 骑行历史主题：显示第 page 次骑行（1 = 最近一次），按编号直接读取一条记录
+void showHistoryPage(uint8_t page) {
+  sensorData.historyCount = RideHistory::getCount();
+  historyPage = page < sensorData.historyCount ? page : sensorData.historyCount;
+  sensorData.historyIndex = 0;
+  if (historyPage > 0 && RideHistory::get(historyPage - 1, sensorData.historyRide)) {
+    sensorData.historyIndex = historyPage;
+  }
+}
@@ -18,6 +18,33 @@
 #define OLED_SDA_PIN 6   // 默认SDA
 #define OLED_SCL_PIN 7   // 默认SCL
 
+// I2C总线时钟（Hz）
+// 100000 = 标准模式, 400000 = 快速模式（SSD1306标称值，也是已测试的上限）
+// ESP32-C3 的硬件I2C不能稳定支持快速模式+（1MHz），超过400kHz时编译报错
+// 128x64全屏刷新约1KB数据：100kHz约100ms，400kHz约25ms
+#define OLED_I2C_CLOCK 400000
+#if OLED_I2C_CLOCK > 400000
+#error "OLED_I2C_CLOCK 不能超过 400000（SSD1306 标称 400kHz，ESP32-C3 硬件I2C不支持快速模式+）"
+#endif
+
+// 异步传输帧缓冲区
+// true = 由独立任务发送帧缓冲区，主循环只复制1KB缓冲区后立即返回（额外占用2倍帧缓冲区RAM）
+// false = 主循环同步等待整个I2C传输完成
+#define OLED_ASYNC_TRANSFER true
+
+// 帧缓冲区模式（RAM与帧延迟的取舍）
+// 0 = 完整帧缓冲区（U8g2 _F构造类，128x64占用1KB RAM，绘制一次整帧发送，支持异步传输）
+// 1 = 单页缓冲（_1，128字节RAM，每帧按页重复绘制8次，主循环同步等待传输）
+// 2 = 双页缓冲（_2，256字节RAM，每帧重复绘制4次）
+// 需要为数据包缓冲和日志腾出RAM时使用分页模式，可用 DISPLAY_BENCHMARK 对比各模式
+#define OLED_BUFFER_MODE 0
+
+// 界面中文字体使用子集字体
+// false = 使用完整的 u8g2_font_unifont_t_chinese3（数千个汉字，占用大量Flash）
+// true = 使用 tools/gen_ui_font.py 生成的子集字体 src/fonts/ui_font.c（只含界面用到的字形）
+//        修改界面文字后需重新生成，编译前运行 python3 tools/gen_ui_font.py --check 检查缺字（host/ 下的 make test 会运行）
+#define USE_UI_FONT_SUBSET false
+
 // ========== BLE配置 ==========
 // CSC Service UUID（标准UUID为0x1816，但某些设备可能使用完整UUID或其他格式）
 // 支持多种格式：
@@ -26,6 +53,8 @@
 // - 自定义UUID（根据实际设备修改）
 #define CSC_SERVICE_UUID "1816"
 #define CSC_SERVICE_UUID_FULL "00001816-0000-1000-8000-00805f9b34fb"
+// 扫描时匹配广播数据用的16位UUID（同时匹配基础UUID形式的128位UUID）
+#define CSC_SERVICE_UUID16 0x1816
 
 // CSC Measurement Characteristic UUID
 #define CSC_MEASUREMENT_UUID "2A5B"
@@ -35,6 +64,24 @@
 #define CSC_CONTROL_POINT_UUID "2A55"
 #define CSC_CONTROL_POINT_UUID_FULL "00002A55-0000-1000-8000-00805f9b34fb"
 
+// CSC Feature Characteristic UUID（可选，连接时读取，用于选择数据包解码方式）
+#define CSC_FEATURE_UUID "2A5C"
+
+// 同一设备上的其他测量服务（连接CSC传感器后，设备同时提供时一并订阅，例如骑行台、功率计）
+// 所有测量通知共用同一个环形缓冲区，按特征值句柄分发给对应的解析器
+#define CYCLING_POWER_ENABLED true
+#define CYCLING_POWER_SERVICE_UUID "1818"
+#define CYCLING_POWER_MEASUREMENT_UUID "2A63"
+#define HEART_RATE_ENABLED true
+#define HEART_RATE_SERVICE_UUID "180D"
+#define HEART_RATE_MEASUREMENT_UUID "2A37"
+
+// CSC中继：同时以BLE外设身份广播CSC服务，把收到的数据重新编码为标准CSC Measurement转发给手机等中心设备
+// 传感器只接受一个连接时（如BT003-2），手机可以通过本机获取同一个传感器的数据；转发延迟见串口命令 latency
+#define CSC_RELAY_ENABLED false
+#define CSC_RELAY_DEVICE_NAME "BLE Meter"
+#define CSC_RELAY_MAX_CENTRALS 2   // 同时连接的中心设备数量
+
 // 是否自动检测CSC设备（通过特征值识别，即使UUID不匹配）
 // 注意：当前仅通过Service UUID识别，不通过设备名称
 #define AUTO_DETECT_CSC_DEVICE false
@@ -42,14 +89,36 @@
 // BLE扫描超时时间（毫秒）
 #define BLE_SCAN_TIMEOUT 10000
 
+// 扫描提前停止条件：某个CSC候选设备收到至少 BLE_SCAN_STABLE_SAMPLES 次广播，
+// 平滑后RSSI不低于 BLE_SCAN_STRONG_RSSI，且比其他候选强 BLE_SCAN_RSSI_MARGIN 以上时立即停止扫描并连接
+// 扫描到上次连接的设备时也立即停止；否则扫描超时后连接信号最强的候选
+#define BLE_SCAN_STRONG_RSSI -75     // dBm
+#define BLE_SCAN_STABLE_SAMPLES 2
+#define BLE_SCAN_RSSI_MARGIN 6       // dB
+#define BLE_SCAN_RSSI_SMOOTHING 0.3  // RSSI指数平滑系数（越大越跟随最新值）
+
 // BLE连接超时时间（毫秒）
 #define BLE_CONNECT_TIMEOUT 5000
 
 // 快速连接超时时间（毫秒，用于连接上次保存的设备）
 #define BLE_QUICK_CONNECT_TIMEOUT 3000
 
+// 重连流程：掉线（或启动）后立即直接连接上次的设备，失败后等待
+// BLE_RECONNECT_BACKOFF_MIN_MS × 2^(失败次数-1)（不超过 BLE_RECONNECT_BACKOFF_MAX_MS）再试，
+// 等待时间随机浮动 ±BLE_RECONNECT_JITTER_PERCENT%
+#define BLE_RECONNECT_BACKOFF_MIN_MS 250
+#define BLE_RECONNECT_BACKOFF_MAX_MS 8000
+#define BLE_RECONNECT_JITTER_PERCENT 25
+
+// 重连流程开始后超过此时间仍未连接，进入深度睡眠（毫秒）
+#define BLE_RECONNECT_GIVE_UP_MS 30000
+
+// 电量读取间隔（毫秒，仅用于不支持电量通知的传感器，支持通知时只在连接时读取一次）
+#define BLE_BATTERY_POLL_INTERVAL 60000
+
 // ========== 功耗管理配置 ==========
 // 深度睡眠唤醒时间（秒，0表示不自动唤醒）
+// 设置为非0时定时唤醒，唤醒后从RTC内存热恢复：跳过启动画面和扫描，直接重连睡眠前的设备并继续本次骑行
 #define DEEP_SLEEP_DURATION 0  // 0 = 通过外部唤醒（如运动检测）
 
 // 运动检测阈值（速度变化，km/h）
@@ -60,6 +129,9 @@
 #define MIN_TIME_DIFF 1              // 最小时间差 (1/1024秒)
 #define MAX_TIME_DIFF_SEC 10.0       // 最大时间差 (秒)
 #define MAX_REV_DIFF 10              // 最大转数差（单次）
+// 事件时间与上一个数据包相同（没有新的轮转/曲柄事件，数据包比转动快时很常见）时保持上次的速度/踏频，
+// 超过此时间仍没有新的事件视为停止，速度/踏频为0
+#define CSC_EVENT_HOLD_MS 4000
 
 // 静止检测时间（秒，超过此时间无运动则进入睡眠）
 #define STATIONARY_TIME 120
@@ -88,11 +160,31 @@
 // 显示刷新间隔（毫秒）
 #define DISPLAY_REFRESH_INTERVAL 500
 
+// 独立渲染任务
+// true = 显示由独立的FreeRTOS任务按固定帧间隔刷新，主循环只发布最新数据（连接、处理数据包时屏幕不冻结）
+// false = 在主循环中按 DISPLAY_REFRESH_INTERVAL 刷新
+#define DISPLAY_RENDER_TASK true
+#define DISPLAY_RENDER_TASK_STACK 4096  // 渲染任务栈大小（字节）
+
+// 状态文字（"已连接"、主题名称等）的最短显示时间（毫秒），之后恢复显示传感器数据
+#define DISPLAY_STATUS_HOLD_MS 1000
+
+// 变化驱动刷新（仅渲染任务）：显示内容（按显示精度）变化后立即重绘，内容不变时不重绘
+// 两帧最小间隔（毫秒），限制数据包密集时的刷新频率
+#define DISPLAY_MIN_FRAME_INTERVAL 50
+// 踏频轮子动画刷新间隔（毫秒，只在数字表盘且踏频大于0时）
+#define DISPLAY_ANIMATION_INTERVAL 100
+// 内容不变时的最长刷新间隔（毫秒），空闲刷新间隔从 DISPLAY_REFRESH_INTERVAL 开始逐步加倍到此值
+#define DISPLAY_IDLE_REFRESH_MAX 8000
+
 // 显示主题选择
 // 0 = 数字显示仪表盘（默认）
 // 1 = 模拟仪表盘（指针式）
 // 2 = 数据统计表盘（列出所有数据）
+// 3 = 骑行历史（短按翻到更早的骑行，最早一次之后回到主题0）
 #define DISPLAY_THEME 0
+#define DISPLAY_THEME_COUNT 4
+#define DISPLAY_THEME_HISTORY 3
 
 // 是否显示调试信息
 #define DEBUG_MODE true
@@ -102,9 +194,71 @@
 // 设置为 false 时，正常运行程序逻辑
 #define DISPLAY_DEBUG_MODE false
 
+// 显示基准测试（启动画面后运行，输出帧缓冲区RAM占用和各主题平均/最大帧延迟到串口）
+#define DISPLAY_BENCHMARK false
+
+// 堆内存监控（按子系统统计 new/delete 次数，定期输出空闲堆、最低空闲和最大可分配块）
+// 连接并收到首个数据后记录基准，之后输出"骑行中"的分配次数，正常应为0
+#define HEAP_MONITOR_ENABLED true
+#define HEAP_REPORT_INTERVAL 30000  // 输出间隔（毫秒）
+
+// 延迟统计：数据包从通知到达、解析、显示刷新到帧发送完成的各阶段耗时分布
+// 串口发送 latency 输出统计，latency reset 清零
+#define LATENCY_TRACKER_ENABLED true
+
+// 链路质量监控：连接期间定期读取RSSI（异步，不阻塞主循环），统计通知间隔，
+// 按轮转数/曲柄转数的跳变推断丢失的通知；串口发送 link 输出统计
+#define LINK_MONITOR_ENABLED true
+#define LINK_RSSI_INTERVAL_MS 2000     // RSSI采样间隔（毫秒）
+#define LINK_RSSI_SMOOTHING 0.3        // RSSI指数平滑系数（显示用）
+#define LINK_RSSI_TREND_SMOOTHING 0.05 // 长期平均的平滑系数，趋势 = 平滑值 - 长期平均（负值表示信号在变弱）
+#define LINK_RSSI_TREND_WARN_DB 4      // 信号下降超过此值（dB）时界面显示趋势
+#define LINK_MAX_INFERRED_LOSS 30      // 单个间隔最多推断的丢包数（更长的中断按30个计）
+#define LINK_REPORT_INTERVAL_MS 5000   // 二进制遥测模式下链路记录的发送间隔（毫秒）
+
+// 主循环卡顿监控：统计每次 loop() 迭代的耗时，超过阈值的迭代按当时耗时最多的区域
+// （扫描、连接、GATT读取、显示、存储、界面等待）归类；串口发送 stall 输出统计，stall reset 清零
+#define STALL_MONITOR_ENABLED true
+#define STALL_THRESHOLD_MS 100         // 卡顿阈值（毫秒，正常迭代约10毫秒）
+#define STALL_LOG_ENABLED true         // 每次卡顿时输出一行日志
+
+// 设置（主题、轮周长、已知设备、总路程）修改后，此时间内没有新的修改时合并写入NVS（毫秒）
+// 进入深度睡眠前立即写入
+#define SETTINGS_WRITE_DELAY_MS 5000
+
+// 骑行历史：每次骑行结束时保存一条摘要（路程、时长、移动时间、平均/最高速度、平均踏频），
+// 最多保存的条数（超过时覆盖最早的记录），以及保存的最短路程（km，更短的连接不记录）
+#define RIDE_HISTORY_SLOTS 20
+#define RIDE_HISTORY_MIN_KM 0.1
+
+// 合成CSC数据源（压力测试，不需要传感器）：按速度/踏频曲线生成BT003-2格式的数据包
+// （11字节完整数据包中穿插5字节数据包，计数器和事件时间从接近回绕的值开始），
+// 直接写入通知缓冲区，之后的解析、统计和显示与真实传感器相同。不计入总路程和骑行历史
+// 串口发送 synth <Hz> 以固定速率运行，synth sweep 从1 Hz逐档提高到几百Hz，输出不溢出的最高速率，synth off 停止
+#define SYNTHETIC_PROFILE 0             // 0 = 匀速，1 = 间歇（骑30秒、停10秒），2 = 速度在0到2倍之间往复（60秒一个周期）
+#define SYNTHETIC_SPEED_KMH 25.0
+#define SYNTHETIC_CADENCE_RPM 85.0
+#define SYNTHETIC_SHORT_PACKET_EVERY 2  // 每N个数据包中有一个5字节数据包（0 = 只发送11字节数据包）
+#define SYNTHETIC_JITTER_PERCENT 20     // 数据包间隔的随机波动（±%）
+#define SYNTHETIC_LOSS_PERCENT 0        // 模拟丢失的数据包（%，不写入缓冲区，计数器照常增加）
+#define SYNTHETIC_MAX_RATE_HZ 1000      // synth <Hz> 允许的最高速率
+#define SYNTHETIC_SWEEP_STEP_MS 5000    // 速率扫描每一档的持续时间（毫秒）
+
 // 串口波特率
 #define SERIAL_BAUD 115200
 
+// ========== 串口遥测配置 ==========
+// 串口数据输出格式
+// 0 = 文本日志（每个数据包输出"=== CSC数据 ==="文本，便于人工查看）
+// 1 = 二进制遥测帧（COBS分帧 + CRC16，使用 tools/telemetry_decode.py 解码，详见 docs/telemetry_protocol.md）
+#define TELEMETRY_MODE 0
+
+// 二进制遥测模式下是否同时输出原始CSC通知数据（用于离线回放和解析器调试）
+#define TELEMETRY_RAW_PACKETS true
+
+// 逐包文本日志（通知原始数据、解析过程），二进制遥测模式下自动关闭以节省串口带宽
+#define PACKET_LOG_ENABLED (TELEMETRY_MODE == 0)
+
 // ========== 传感器配置 ==========
 // 轮子周长（毫米，用于计算速度）
 // 常见值：
@@ -112,9 +266,26 @@
 // 700x25C: 2105mm
 // 700x28C: 2114mm
 // 26寸山地车: 2050mm
-// 根据实际轮胎调整
+// 根据实际轮胎调整（默认值；串口命令 wheel <毫米> 修改后保存在设置记录中）
 #define WHEEL_CIRCUMFERENCE_MM 2100
 
+// CSC数据包解码方式
+// 0 = 自动：标准格式的数据包按标准解码；标志0x02的5字节数据包在标准格式（曲柄转数+曲柄时间）
+//     和BT003-2格式（轮转时间+曲柄转数）之间有歧义，连接后与完整数据包中的曲柄转数比较来判断
+// 1 = 标准格式（Bluetooth SIG CSC规范）
+// 2 = BT003-2格式（见 docs/ble_csc_protocol.md）
+#define CSC_DECODE_PROFILE 0
+#define CSC_PROFILE_MATCH_REVS 16     // 自动判断：5字节数据包的曲柄转数比上次完整数据包多不超过此值即认为匹配
+#define CSC_PROFILE_LEARN_PACKETS 8   // 自动判断：收到此数量的5字节数据包仍无法判断时，使用BT003-2格式
+
+// 只有曲柄转数、没有曲柄时间的数据包（BT003-2的5字节数据包）用通知到达时间估算踏频
+// 对窗口内的 (到达时间, 累计转数) 做直线拟合，抵消连接间隔造成的到达时间抖动
+#define CADENCE_ESTIMATE_ENABLED true
+#define CADENCE_WINDOW_SAMPLES 8    // 拟合窗口最多样本数（曲柄事件）
+#define CADENCE_WINDOW_MS 4000      // 拟合窗口时长（毫秒），超过此时间没有曲柄事件则踏频归零、重新开始
+#define CADENCE_MIN_SAMPLES 3       // 至少需要的样本数
+#define CADENCE_MAX_RPM 200         // 最高踏频（到达间隔短于此周期的通知视为批量到达）
+
 // ========== 电池监控配置（可选） ==========
 // 是否启用电池监控
 #define ENABLE_BATTERY_MONITOR false
@@ -0,0 +1,134 @@
+/**
+ * 广播匹配基准测试
+ *
+ * 用典型的广播负载（按常见设备的广播包 + 扫描响应拼接后的AD结构构造，包括截断和边界情况）比较两种CSC设备识别方法：
+ *   AdvParser   直接遍历AD结构，整数比较16位UUID、memcmp比较128位UUID
+ *   旧方法      按原 BLEManager::isCSCDevice：第一个服务UUID转为字符串、转小写后与 "1816" 比较并查找子串
+ *               （BLEAdvertisedDevice / BLEUUID / String 用 std::string 代替）
+ * 先检查每个负载的识别结果，再分别计时。旧方法的结果只输出，不检查
+ *
+ * 用法: make bench（或 build/bench_adv [轮数]）
+ */
+
+#include <chrono>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include "config.h"
+#include "src/AdvParser.h"
+
+struct CapturedAdv {
+  const char* name;
+  uint8_t payload[62];
+  uint8_t length;
+  AdvUUIDMatch expected;
+};
+
+static const CapturedAdv CAPTURES[] = {
+  // BT003-2：flags + 完整16位UUID列表 + 完整名称
+  {"BT003-2", {0x02, 0x01, 0x06, 0x03, 0x03, 0x16, 0x18, 0x08, 0x09, 'B', 'T', '0', '0', '3', '-', '2'},
+   16, ADV_MATCH_UUID16},
+  // 不完整16位UUID列表，CSC不是第一个（电池服务在前）
+  {"16位列表第二个", {0x02, 0x01, 0x06, 0x05, 0x02, 0x0F, 0x18, 0x16, 0x18, 0x06, 0x09, 'C', 'S', 'C', '-', '1'},
+   16, ADV_MATCH_UUID16},
+  // 基础UUID形式的128位CSC UUID 00001816-0000-1000-8000-00805F9B34FB
+  {"128位基础UUID", {0x02, 0x01, 0x06, 0x11, 0x07,
+                     0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x16, 0x18, 0x00, 0x00},
+   21, ADV_MATCH_UUID128},
+  // 只在服务数据中出现
+  {"服务数据", {0x02, 0x01, 0x06, 0x05, 0x16, 0x16, 0x18, 0x01, 0x02}, 9, ADV_MATCH_SERVICE_DATA},
+  // 厂商128位UUID 6e400001-b5a3-f393-e0a9-e50e24dc1816：字符串中含有 "1816"，不是CSC
+  {"厂商UUID含1816", {0x02, 0x01, 0x06, 0x11, 0x07,
+                      0x16, 0x18, 0xDC, 0x24, 0x0E, 0xE5, 0xA9, 0xE0, 0x93, 0xF3, 0xA3, 0xB5, 0x01, 0x00, 0x40, 0x6E},
+   21, ADV_MATCH_NONE},
+  // 心率带
+  {"心率带", {0x02, 0x01, 0x06, 0x03, 0x03, 0x0D, 0x18, 0x07, 0x09, 'H', 'R', 'M', '-', '4', '2'}, 15, ADV_MATCH_NONE},
+  // 耳机：厂商数据 + 名称，没有服务UUID
+  {"厂商数据", {0x02, 0x01, 0x1A, 0x1A, 0xFF, 0x4C, 0x00, 0x07, 0x19, 0x01, 0x0E, 0x20, 0x2B, 0x77, 0x8F, 0x01,
+                0x00, 0x00, 0x45, 0x3A, 0x9C, 0x52, 0x11, 0x8D, 0x3E, 0xA0, 0x6B, 0x27, 0x31, 0x05, 0x09, 'B', 'u', 'd', 's'},
+   35, ADV_MATCH_NONE},
+  // AD结构被截断：长度字节超出负载，其中的UUID不可信
+  {"截断的UUID列表", {0x02, 0x01, 0x06, 0x05, 0x03, 0x16, 0x18}, 7, ADV_MATCH_NONE},
+  // 完整的CSC UUID之后跟着被截断的名称
+  {"截断的名称", {0x03, 0x03, 0x16, 0x18, 0x09, 0x09, 'B', 'T', '0'}, 9, ADV_MATCH_UUID16},
+  // 长度为0的AD结构表示负载结束，之后的内容不解析
+  {"结束标记之后", {0x02, 0x01, 0x06, 0x00, 0x03, 0x03, 0x16, 0x18}, 8, ADV_MATCH_NONE},
+  // 奇数长度的16位UUID列表：最后一个字节不构成UUID
+  {"奇数长度列表", {0x04, 0x03, 0x0F, 0x18, 0x16}, 5, ADV_MATCH_NONE},
+};
+static const int CAPTURE_COUNT = sizeof(CAPTURES) / sizeof(CAPTURES[0]);
+
+// 旧方法：第一个服务UUID按 BLEUUID::toString() 的格式转为字符串
+static bool oldIsCSCDevice(const uint8_t* payload, size_t length) {
+  std::string serviceUUIDStr;
+  size_t index = 0;
+  while (index < length && serviceUUIDStr.empty()) {
+    uint8_t fieldLength = payload[index];
+    if (fieldLength == 0 || index + 1 + fieldLength > length) break;
+    uint8_t type = payload[index + 1];
+    const uint8_t* data = payload + index + 2;
+    char text[40];
+    if ((type == AD_TYPE_UUID16_INCOMPLETE || type == AD_TYPE_UUID16_COMPLETE) && fieldLength >= 3) {
+      snprintf(text, sizeof(text), "0000%02x%02x-0000-1000-8000-00805f9b34fb", data[1], data[0]);
+      serviceUUIDStr = text;
+    } else if ((type == AD_TYPE_UUID128_INCOMPLETE || type == AD_TYPE_UUID128_COMPLETE) && fieldLength >= 17) {
+      snprintf(text, sizeof(text), "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+               data[15], data[14], data[13], data[12], data[11], data[10], data[9], data[8],
+               data[7], data[6], data[5], data[4], data[3], data[2], data[1], data[0]);
+      serviceUUIDStr = text;
+    }
+    index += 1 + fieldLength;
+  }
+  if (serviceUUIDStr.empty()) return false;
+
+  for (char& c : serviceUUIDStr) c = (char)tolower((unsigned char)c);
+  std::string targetUUID = CSC_SERVICE_UUID;
+  std::string targetUUIDFull = CSC_SERVICE_UUID_FULL;
+  for (char& c : targetUUIDFull) c = (char)tolower((unsigned char)c);
+  return serviceUUIDStr == targetUUID || serviceUUIDStr == targetUUIDFull ||
+         serviceUUIDStr.find("1816") != std::string::npos;
+}
+
+int main(int argc, char** argv) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 200000;
+  if (rounds <= 0) rounds = 200000;
+
+  int failures = 0;
+  for (int i = 0; i < CAPTURE_COUNT; i++) {
+    const CapturedAdv& capture = CAPTURES[i];
+    AdvUUIDMatch match = AdvParser::findService16(capture.payload, capture.length, CSC_SERVICE_UUID16);
+    bool oldMatch = oldIsCSCDevice(capture.payload, capture.length);
+    bool correct = match == capture.expected;
+    if (!correct) failures++;
+    printf("%s: %s（期望 %s）%s，旧方法%s\n", capture.name, AdvParser::matchName(match),
+           AdvParser::matchName(capture.expected), correct ? "" : " 错误", oldMatch ? "识别为CSC" : "不是CSC");
+  }
+
+  // 计时：每轮依次识别所有负载
+  volatile uint32_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; round++) {
+    for (int i = 0; i < CAPTURE_COUNT; i++) {
+      sink += AdvParser::findService16(CAPTURES[i].payload, CAPTURES[i].length, CSC_SERVICE_UUID16);
+    }
+  }
+  double parserNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; round++) {
+    for (int i = 0; i < CAPTURE_COUNT; i++) {
+      sink += oldIsCSCDevice(CAPTURES[i].payload, CAPTURES[i].length);
+    }
+  }
+  double oldNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  double advertisements = (double)rounds * CAPTURE_COUNT;
+  printf("AdvParser: %.1f ns/广播\n", parserNs / advertisements);
+  printf("旧方法:    %.1f ns/广播 (%.1f 倍)\n", oldNs / advertisements, oldNs / parserNs);
+  if (failures > 0) {
+    printf("识别错误: %d\n", failures);
+    return 1;
+  }
+  return 0;
+}
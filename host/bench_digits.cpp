@@ -0,0 +1,136 @@
+/**
+ * 数字图集基准测试
+ *
+ * 用真实的 U8g2 C 库（不经过 fake/）在 128x64 完整帧缓冲区上比较数字表盘的速度和踏频两种画法：
+ *   字体绘制  snprintf + u8g2_GetUTF8Width + u8g2_DrawUTF8（当前没有图集时的路径）
+ *   数字图集  DigitAtlas::formatFixed + getWidth + draw
+ * 先逐个数值验证两种画法的文本、宽度和帧缓冲区内容完全相同，再分别计时。
+ * 控件的位置、字体和清除区域与 ThemeLayouts.cpp 中 128x64 数字表盘的速度、踏频控件相同
+ *
+ * 用法（需要U8g2 Arduino库的 src 目录，其中有 clib/）:
+ *   make bench U8G2_DIR=~/Arduino/libraries/U8g2/src
+ *   build/bench_digits [帧数]
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <clib/u8g2.h>
+#include "src/DigitAtlas.h"
+
+struct BenchWidget {
+  const char* name;
+  const uint8_t* font;
+  const char* format;
+  uint8_t decimals;
+  int16_t x, y;
+  int16_t bx, by, bw, bh;  // 每帧清除的区域
+  float step;
+  uint16_t values;         // 验证的数值个数：0, step, 2*step, ...
+};
+
+static const BenchWidget WIDGETS[] = {
+  {"速度", u8g2_font_logisoso32_tn, "%.1f", 1, 0, 32, 0, 0,  84, 33, 0.1f, 1000},
+  {"踏频", u8g2_font_logisoso24_tn, "%.0f", 0, 0, 64, 0, 40, 56, 24, 1.0f, 200},
+};
+static const int WIDGET_COUNT = sizeof(WIDGETS) / sizeof(WIDGETS[0]);
+
+// 不连接显示器：字节、GPIO和延时消息全部忽略
+static uint8_t noDisplay(u8x8_t*, uint8_t, uint8_t, void*) {
+  return 1;
+}
+
+static void clearBox(u8g2_t* u8g2, const BenchWidget& w) {
+  u8g2_SetDrawColor(u8g2, 0);
+  u8g2_DrawBox(u8g2, w.bx, w.by, w.bw, w.bh);
+  u8g2_SetDrawColor(u8g2, 1);
+}
+
+static int16_t drawFont(u8g2_t* u8g2, const BenchWidget& w, float value) {
+  char text[16];
+  snprintf(text, sizeof(text), w.format, value);
+  clearBox(u8g2, w);
+  u8g2_SetFont(u8g2, w.font);
+  int16_t width = u8g2_GetUTF8Width(u8g2, text);
+  u8g2_DrawUTF8(u8g2, w.x, w.y, text);
+  return width;
+}
+
+static int16_t drawAtlas(u8g2_t* u8g2, const BenchWidget& w, const DigitAtlas& atlas, float value) {
+  char text[16];
+  DigitAtlas::formatFixed(value, w.decimals, text, sizeof(text));
+  clearBox(u8g2, w);
+  int16_t width = atlas.getWidth(text);
+  atlas.draw(u8g2_GetBufferPtr(u8g2), u8g2_GetBufferTileWidth(u8g2), u8g2_GetBufferTileHeight(u8g2), w.x, text);
+  return width;
+}
+
+int main(int argc, char** argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 20000;
+  if (frames <= 0) frames = 20000;
+
+  u8g2_t u8g2;
+  u8g2_Setup_ssd1306_128x64_noname_f(&u8g2, U8G2_R0, noDisplay, noDisplay);
+  u8g2_InitDisplay(&u8g2);
+  const size_t bufferBytes = (size_t)u8g2_GetBufferTileWidth(&u8g2) * 8 * u8g2_GetBufferTileHeight(&u8g2);
+  uint8_t* expected = (uint8_t*)malloc(bufferBytes);
+
+  DigitAtlas atlases[WIDGET_COUNT];
+  for (int i = 0; i < WIDGET_COUNT; i++) {
+    if (!atlases[i].build(&u8g2, WIDGETS[i].font, WIDGETS[i].y)) {
+      printf("%s: 建立数字图集失败\n", WIDGETS[i].name);
+      return 1;
+    }
+  }
+
+  // 验证：每个数值分别用两种画法画在清空的帧缓冲区上，文本宽度和全部字节都必须相同
+  int failures = 0;
+  for (int i = 0; i < WIDGET_COUNT; i++) {
+    const BenchWidget& w = WIDGETS[i];
+    for (uint16_t n = 0; n < w.values; n++) {
+      float value = n * w.step;
+      u8g2_ClearBuffer(&u8g2);
+      int16_t fontWidth = drawFont(&u8g2, w, value);
+      memcpy(expected, u8g2_GetBufferPtr(&u8g2), bufferBytes);
+      u8g2_ClearBuffer(&u8g2);
+      int16_t atlasWidth = drawAtlas(&u8g2, w, atlases[i], value);
+      if (fontWidth != atlasWidth || memcmp(expected, u8g2_GetBufferPtr(&u8g2), bufferBytes) != 0) {
+        char fontText[16], atlasText[16];
+        snprintf(fontText, sizeof(fontText), w.format, value);
+        DigitAtlas::formatFixed(value, w.decimals, atlasText, sizeof(atlasText));
+        if (failures < 10) {
+          printf("%s %s / %s: 宽度 %d / %d, 帧缓冲区%s\n", w.name, fontText, atlasText, fontWidth, atlasWidth,
+                 memcmp(expected, u8g2_GetBufferPtr(&u8g2), bufferBytes) != 0 ? "不同" : "相同");
+        }
+        failures++;
+      }
+    }
+    printf("%s: 验证 %u 个数值\n", w.name, (unsigned)w.values);
+  }
+  free(expected);
+  if (failures > 0) {
+    printf("不一致: %d\n", failures);
+    return 1;
+  }
+
+  // 计时：每帧速度和踏频各画一次（数值每帧不同），不包括发送到显示器
+  volatile int16_t sink = 0;
+  double frameUs[2];
+  for (int path = 0; path < 2; path++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+      for (int i = 0; i < WIDGET_COUNT; i++) {
+        const BenchWidget& w = WIDGETS[i];
+        float value = (frame % w.values) * w.step;
+        sink += path == 0 ? drawFont(&u8g2, w, value) : drawAtlas(&u8g2, w, atlases[i], value);
+      }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    frameUs[path] = std::chrono::duration<double, std::micro>(elapsed).count() / frames;
+  }
+  printf("字体绘制: %.3f us/帧\n", frameUs[0]);
+  printf("数字图集: %.3f us/帧 (%.1f 倍)\n", frameUs[1], frameUs[0] / frameUs[1]);
+  printf("图集RAM: %u 字节\n", (unsigned)(sizeof(DigitAtlas) * WIDGET_COUNT));
+  return 0;
+}
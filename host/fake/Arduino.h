@@ -0,0 +1,110 @@
+/**
+ * 主机仿真：Arduino核心的替代实现
+ * 只提供固件用到的接口；时间来自 SimClock 虚拟时钟，delay() 推进时钟并触发到期的仿真事件
+ */
+
+#ifndef FAKE_ARDUINO_H
+#define FAKE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "WString.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define HEX 16
+#define DEC 10
+
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_ptr(p) (*(void* const*)(p))
+#define digitalPinToInterrupt(p) (p)
+
+typedef bool boolean;
+
+class Print {
+public:
+  virtual ~Print() {}
+  size_t print(const char* text);
+  size_t print(const String& text) { return print(text.c_str()); }
+  size_t print(char c);
+  size_t print(int value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(double value, int digits = 2);
+  size_t println();
+  template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+  template <typename T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+  virtual size_t write(uint8_t c) { return write(&c, 1); }
+  virtual size_t write(const uint8_t* data, size_t length) = 0;
+};
+
+// 串口：输出交给仿真（默认丢弃，-v 时带虚拟时间戳打印），输入来自仿真脚本
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long /*baud*/) {}
+  void end() {}
+  void flush() {}
+  int available();
+  int read();
+  int availableForWrite() { return 128; }
+  operator bool() { return true; }
+  using Print::write;
+  size_t write(const uint8_t* data, size_t length) override;
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+  uint32_t getFreeHeap() { return 200000; }
+  uint32_t getMinFreeHeap() { return 180000; }
+  uint32_t getMaxAllocHeap() { return 100000; }
+  uint32_t getHeapSize() { return 320000; }
+  void restart();
+};
+
+extern EspClass ESP;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+int analogRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+bool setCpuFrequencyMhz(uint32_t mhz);
+uint32_t getCpuFrequencyMhz();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+#endif // FAKE_ARDUINO_H
@@ -0,0 +1,16 @@
+/**
+ * 主机仿真：CCCD描述符（见 BLEServer.h）
+ */
+
+#ifndef FAKE_BLE2902_H
+#define FAKE_BLE2902_H
+
+#include "BLEServer.h"
+
+class BLE2902 : public BLEDescriptor {
+public:
+  bool getNotifications() { return false; }
+  bool getIndications() { return false; }
+};
+
+#endif // FAKE_BLE2902_H
@@ -0,0 +1,10 @@
+/**
+ * 主机仿真：见 BLEDevice.h
+ */
+
+#ifndef FAKE_BLE_ADVERTISED_DEVICE_H
+#define FAKE_BLE_ADVERTISED_DEVICE_H
+
+#include "BLEDevice.h"
+
+#endif // FAKE_BLE_ADVERTISED_DEVICE_H
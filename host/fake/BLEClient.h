@@ -0,0 +1,10 @@
+/**
+ * 主机仿真：见 BLEDevice.h
+ */
+
+#ifndef FAKE_BLE_CLIENT_H
+#define FAKE_BLE_CLIENT_H
+
+#include "BLEDevice.h"
+
+#endif // FAKE_BLE_CLIENT_H
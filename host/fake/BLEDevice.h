@@ -0,0 +1,198 @@
+/**
+ * 主机仿真：Arduino BLE 库（Bluedroid）的客户端部分
+ *
+ * 接口与 arduino-esp32 的 BLEDevice/BLEScan/BLEClient 保持一致，行为由 FakeBLE 中脚本化的传感器决定：
+ *   - 扫描期间按广播间隔回调 onResult()（只有在范围内且未被连接的传感器广播）
+ *   - connect() 阻塞到连接建立，传感器不在广播时等待，直到超时
+ *   - 首次 getService() 阻塞一次服务发现时间，读特征值、写CCCD各阻塞一次GATT往返
+ *   - 订阅后按传感器的通知间隔（带抖动和丢包）调用通知回调
+ * 阻塞和回调都发生在虚拟时钟上（见 SimClock.h）
+ */
+
+#ifndef FAKE_BLE_DEVICE_H
+#define FAKE_BLE_DEVICE_H
+
+#include "Arduino.h"
+#include "esp_gap_ble_api.h"
+#include "esp_gatts_api.h"
+
+struct SimSensor;
+class BLEClient;
+class BLERemoteCharacteristic;
+
+class BLEAddress {
+public:
+  BLEAddress(const char* text);
+  BLEAddress(const String& text) : BLEAddress(text.c_str()) {}
+  BLEAddress(const esp_bd_addr_t native);
+
+  esp_bd_addr_t* getNative() { return &native; }
+  bool equals(const BLEAddress& other) const { return memcmp(native, other.native, sizeof(native)) == 0; }
+  String toString() const;
+
+private:
+  esp_bd_addr_t native;
+};
+
+// UUID统一保存为128位小写文本，16位UUID按蓝牙基础UUID展开
+class BLEUUID {
+public:
+  BLEUUID() { text[0] = '\0'; }
+  BLEUUID(const char* uuid);
+  BLEUUID(uint16_t uuid);
+
+  bool equals(const BLEUUID& other) const { return strcmp(text, other.text) == 0; }
+  String toString() const { return String(text); }
+
+private:
+  char text[37];
+};
+
+typedef void (*notify_callback)(BLERemoteCharacteristic* characteristic, uint8_t* data, size_t length, bool isNotify);
+
+class BLERemoteCharacteristic {
+public:
+  bool canNotify() { return (properties & PROPERTY_NOTIFY) != 0; }
+  bool canRead() { return (properties & PROPERTY_READ) != 0; }
+  bool canIndicate() { return false; }
+  uint16_t getHandle() { return handle; }
+  BLEUUID getUUID() { return uuid; }
+
+  void registerForNotify(notify_callback callback, bool notifications = true, bool descriptorRequiresRegistration = true);
+  String readValue();
+  uint8_t readUInt8();
+  uint16_t readUInt16();
+  uint32_t readUInt32();
+
+private:
+  friend struct SimSensor;
+  friend class BLERemoteService;
+  static const uint8_t PROPERTY_READ = 0x02;
+  static const uint8_t PROPERTY_NOTIFY = 0x10;
+
+  SimSensor* sensor = nullptr;
+  BLEUUID uuid;
+  uint16_t handle = 0;
+  uint8_t properties = 0;
+  notify_callback callback = nullptr;
+};
+
+class BLERemoteService {
+public:
+  BLERemoteCharacteristic* getCharacteristic(BLEUUID uuid);
+  BLEUUID getUUID() { return uuid; }
+
+private:
+  friend struct SimSensor;
+  friend class BLEClient;
+  static const uint8_t MAX_CHARACTERISTICS = 4;
+
+  SimSensor* sensor = nullptr;
+  BLEUUID uuid;
+  BLERemoteCharacteristic characteristics[MAX_CHARACTERISTICS];
+  uint8_t characteristicCount = 0;
+  uint32_t discoveredConnection = 0;  // 已在第几次连接中发现过特征值（0表示未发现）
+};
+
+class BLEClientCallbacks {
+public:
+  virtual ~BLEClientCallbacks() {}
+  virtual void onConnect(BLEClient* client) = 0;
+  virtual void onDisconnect(BLEClient* client) = 0;
+};
+
+class BLEClient {
+public:
+  bool connect(BLEAddress address, uint8_t type = BLE_ADDR_TYPE_PUBLIC, uint32_t timeoutMs = portMAX_DELAY);
+  void disconnect();
+  bool isConnected();
+  BLERemoteService* getService(BLEUUID uuid);
+  BLEAddress getPeerAddress();
+  int getRssi();
+  uint16_t getConnId() { return connection; }
+  void setClientCallbacks(BLEClientCallbacks* callbacks) { this->callbacks = callbacks; }
+
+private:
+  friend struct SimSensor;
+  SimSensor* peer = nullptr;
+  uint32_t connection = 0;   // 连接编号（与 peer 当前连接编号一致时表示连接有效）
+  bool discovered = false;   // 本次连接已完成服务发现
+  BLEClientCallbacks* callbacks = nullptr;
+};
+
+class BLEAdvertisedDevice {
+public:
+  BLEAddress getAddress() { return address; }
+  esp_ble_addr_type_t getAddressType() { return addressType; }
+  bool haveName() { return name[0] != '\0'; }
+  String getName() { return String(name); }
+  bool haveRSSI() { return true; }
+  int getRSSI() { return rssi; }
+  uint8_t* getPayload() { return payload; }
+  size_t getPayloadLength() { return payloadLength; }
+
+private:
+  friend struct SimSensor;
+  BLEAdvertisedDevice() : address("00:00:00:00:00:00") {}
+
+  BLEAddress address;
+  esp_ble_addr_type_t addressType = BLE_ADDR_TYPE_PUBLIC;
+  char name[24] = "";
+  int rssi = 0;
+  uint8_t payload[31];
+  size_t payloadLength = 0;
+};
+
+class BLEAdvertisedDeviceCallbacks {
+public:
+  virtual ~BLEAdvertisedDeviceCallbacks() {}
+  virtual void onResult(BLEAdvertisedDevice advertisedDevice) = 0;
+};
+
+class BLEScanResults {
+public:
+  int getCount() { return 0; }
+};
+
+class BLEScan {
+public:
+  void setActiveScan(bool /*active*/) {}
+  void setInterval(uint16_t /*intervalMs*/) {}
+  void setWindow(uint16_t /*windowMs*/) {}
+  void setAdvertisedDeviceCallbacks(BLEAdvertisedDeviceCallbacks* callbacks, bool wantDuplicates = false, bool shouldParse = true);
+  // 非阻塞扫描：duration 秒后调用 completeCallback
+  bool start(uint32_t duration, void (*completeCallback)(BLEScanResults), bool isContinue = false);
+  void stop();
+  void clearResults() {}
+  bool isScanning() { return scanning; }
+
+private:
+  friend struct SimSensor;
+  friend class FakeBLE;
+  BLEAdvertisedDeviceCallbacks* callbacks = nullptr;
+  void (*completeCallback)(BLEScanResults) = nullptr;
+  bool scanning = false;
+  uint32_t generation = 0;  // 每次开始/停止扫描加一，之前安排的广播事件作废
+
+  static void endEvent(void* context, uint32_t generation);
+};
+
+class BLEServer;
+class BLEAdvertising;
+
+class BLEDevice {
+public:
+  static void init(const char* /*name*/) {}
+  static void init(const String& /*name*/) {}
+  static void deinit(bool /*releaseMemory*/ = false) {}
+  static BLEScan* getScan();
+  static BLEClient* createClient();
+  static void setCustomGapHandler(esp_gap_ble_cb_t handler);
+  static void setCustomGattsHandler(void (*/*handler*/)(esp_gatts_cb_event_t, esp_gatt_if_t, esp_ble_gatts_cb_param_t*)) {}
+  static BLEServer* createServer();
+  static BLEAdvertising* getAdvertising();
+  static void startAdvertising() {}
+  static void stopAdvertising() {}
+};
+
+#endif // FAKE_BLE_DEVICE_H
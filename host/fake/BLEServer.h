@@ -0,0 +1,72 @@
+/**
+ * 主机仿真：Arduino BLE 库的服务器部分
+ * 只保证中继外设可以编译和启动；仿真中没有中心设备连接本机，通知不会发出
+ */
+
+#ifndef FAKE_BLE_SERVER_H
+#define FAKE_BLE_SERVER_H
+
+#include "BLEDevice.h"
+
+class BLEDescriptor {
+public:
+  virtual ~BLEDescriptor() {}
+};
+
+class BLECharacteristic {
+public:
+  static const uint32_t PROPERTY_READ = 1 << 0;
+  static const uint32_t PROPERTY_WRITE = 1 << 1;
+  static const uint32_t PROPERTY_NOTIFY = 1 << 2;
+  static const uint32_t PROPERTY_INDICATE = 1 << 4;
+
+  explicit BLECharacteristic(uint16_t handle) : handle(handle) {}
+  void addDescriptor(BLEDescriptor* /*descriptor*/) {}
+  void setValue(uint8_t* /*data*/, size_t /*length*/) {}
+  void setValue(uint16_t& /*value*/) {}
+  void notify(bool /*isNotification*/ = true) {}
+  uint16_t getHandle() { return handle; }
+
+private:
+  uint16_t handle;
+};
+
+class BLEService {
+public:
+  BLECharacteristic* createCharacteristic(BLEUUID /*uuid*/, uint32_t /*properties*/) {
+    return new BLECharacteristic(nextHandle++);
+  }
+  void start() {}
+
+private:
+  uint16_t nextHandle = 0x0030;
+};
+
+class BLEServer;
+
+class BLEServerCallbacks {
+public:
+  virtual ~BLEServerCallbacks() {}
+  virtual void onConnect(BLEServer* /*server*/) {}
+  virtual void onConnect(BLEServer* /*server*/, esp_ble_gatts_cb_param_t* /*param*/) {}
+  virtual void onDisconnect(BLEServer* /*server*/) {}
+  virtual void onDisconnect(BLEServer* /*server*/, esp_ble_gatts_cb_param_t* /*param*/) {}
+};
+
+class BLEServer {
+public:
+  BLEService* createService(BLEUUID /*uuid*/) { return new BLEService(); }
+  void setCallbacks(BLEServerCallbacks* /*callbacks*/) {}
+  esp_gatt_if_t getGattsIf() { return 3; }
+  uint32_t getConnectedCount() { return 0; }
+};
+
+class BLEAdvertising {
+public:
+  void addServiceUUID(BLEUUID /*uuid*/) {}
+  void setScanResponse(bool /*enabled*/) {}
+  void start() {}
+  void stop() {}
+};
+
+#endif // FAKE_BLE_SERVER_H
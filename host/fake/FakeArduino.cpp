@@ -0,0 +1,466 @@
+/**
+ * 主机仿真：Arduino核心、FreeRTOS、ESP-IDF 和 Preferences 的替代实现
+ */
+
+#include "Arduino.h"
+#include "Preferences.h"
+#include "U8g2lib.h"
+#include "Wire.h"
+#include "esp_heap_caps.h"
+#include "SimBoard.h"
+#include "SimClock.h"
+#include <stdarg.h>
+#include <map>
+#include <string>
+
+HardwareSerial Serial;
+EspClass ESP;
+TwoWire Wire;
+
+// ========== 串口 ==========
+
+namespace {
+
+bool verbose = false;
+bool lineStart = true;
+std::string serialInput;
+
+const int PIN_COUNT = 32;
+uint8_t pinLevels[PIN_COUNT];
+void (*pinHandlers[PIN_COUNT])(void);  // attachInterrupt 的处理函数（任意边沿触发）
+
+}  // namespace
+
+void SimBoard::reset() {
+  verbose = false;
+  lineStart = true;
+  serialInput.clear();
+  for (int i = 0; i < PIN_COUNT; i++) {
+    pinLevels[i] = HIGH;
+    pinHandlers[i] = nullptr;
+  }
+}
+
+void SimBoard::setVerbose(bool enabled) {
+  verbose = enabled;
+}
+
+static void serialLineEvent(void* context, uint32_t /*tag*/) {
+  std::string* line = static_cast<std::string*>(context);
+  serialInput += *line;
+  serialInput += '\n';
+  delete line;
+}
+
+void SimBoard::sendSerial(uint32_t atMs, const char* line) {
+  SimClock::schedule((uint64_t)atMs * 1000, serialLineEvent, new std::string(line));
+}
+
+static void pinEvent(void* context, uint32_t tag) {
+  uint8_t pin = (uint8_t)(uintptr_t)context;
+  bool changed = pinLevels[pin] != (uint8_t)tag;
+  pinLevels[pin] = (uint8_t)tag;
+  if (changed && pinHandlers[pin] != nullptr) {
+    pinHandlers[pin]();
+  }
+}
+
+void SimBoard::pressPin(uint8_t pin, uint32_t atMs, uint32_t durationMs) {
+  if (pin >= PIN_COUNT) {
+    return;
+  }
+  SimClock::schedule((uint64_t)atMs * 1000, pinEvent, (void*)(uintptr_t)pin, LOW);
+  SimClock::schedule((uint64_t)(atMs + durationMs) * 1000, pinEvent, (void*)(uintptr_t)pin, HIGH);
+}
+
+int HardwareSerial::available() {
+  return (int)serialInput.size();
+}
+
+int HardwareSerial::read() {
+  if (serialInput.empty()) {
+    return -1;
+  }
+  int c = (uint8_t)serialInput[0];
+  serialInput.erase(0, 1);
+  return c;
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t length) {
+  if (!verbose) {
+    return length;
+  }
+  for (size_t i = 0; i < length; i++) {
+    if (lineStart) {
+      ::printf("[%9.3f] ", SimClock::now() / 1000000.0);
+      lineStart = false;
+    }
+    ::putchar(data[i]);
+    if (data[i] == '\n') {
+      lineStart = true;
+    }
+  }
+  return length;
+}
+
+size_t Print::print(const char* text) {
+  return write((const uint8_t*)text, strlen(text));
+}
+
+size_t Print::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t Print::print(long value, int base) {
+  char text[24];
+  snprintf(text, sizeof(text), base == HEX ? "%lX" : "%ld", value);
+  return print(text);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  char text[24];
+  snprintf(text, sizeof(text), base == HEX ? "%lX" : "%lu", value);
+  return print(text);
+}
+
+size_t Print::print(double value, int digits) {
+  char text[32];
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return print(text);
+}
+
+size_t Print::println() {
+  return print("\r\n");
+}
+
+size_t Print::printf(const char* format, ...) {
+  char text[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  if (length < 0) {
+    return 0;
+  }
+  return write((const uint8_t*)text, (size_t)length < sizeof(text) ? (size_t)length : sizeof(text) - 1);
+}
+
+void EspClass::restart() {
+  esp_deep_sleep_start();
+}
+
+// ========== 时间和GPIO ==========
+
+unsigned long millis() {
+  SimClock::nudge();
+  return (unsigned long)(SimClock::now() / 1000);
+}
+
+unsigned long micros() {
+  SimClock::nudge();
+  return (unsigned long)SimClock::now();
+}
+
+void delay(uint32_t ms) {
+  SimClock::sleep((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+  SimClock::sleep(us);
+}
+
+void yield() {
+  SimClock::sleep(1);
+}
+
+void pinMode(uint8_t /*pin*/, uint8_t /*mode*/) {}
+
+int digitalRead(uint8_t pin) {
+  return pin < PIN_COUNT ? pinLevels[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin < PIN_COUNT) {
+    pinLevels[pin] = value ? HIGH : LOW;
+  }
+}
+
+int analogRead(uint8_t /*pin*/) {
+  return 0;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int /*mode*/) {
+  if (pin < PIN_COUNT) {
+    pinHandlers[pin] = handler;
+  }
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin < PIN_COUNT) {
+    pinHandlers[pin] = nullptr;
+  }
+}
+
+static uint32_t cpuFrequencyMhz = 160;
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+  cpuFrequencyMhz = mhz;
+  return true;
+}
+
+uint32_t getCpuFrequencyMhz() {
+  return cpuFrequencyMhz;
+}
+
+long random(long max) {
+  return max > 0 ? (long)SimClock::random((uint32_t)max) : 0;
+}
+
+long random(long min, long max) {
+  return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long /*seed*/) {}
+
+uint32_t esp_random() {
+  return SimClock::random();
+}
+
+// ========== FreeRTOS ==========
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)millis();
+}
+
+BaseType_t xTaskCreate(TaskFunction_t /*entry*/, const char* /*name*/, uint32_t /*stackDepth*/,
+                       void* /*parameter*/, UBaseType_t /*priority*/, TaskHandle_t* /*handle*/) {
+  return pdFAIL;
+}
+
+void vTaskDelete(TaskHandle_t /*task*/) {}
+
+void vTaskDelay(TickType_t ticks) {
+  delay(ticks);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  static int loopTask;
+  return (TaskHandle_t)&loopTask;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t /*clearOnExit*/, TickType_t /*ticksToWait*/) {
+  return 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t /*task*/) {
+  return pdPASS;
+}
+
+// ========== esp_timer / esp_sleep / 堆 ==========
+
+struct esp_timer {
+  esp_timer_cb_t callback;
+  void* arg;
+  uint64_t periodUs;
+  uint32_t generation;  // 每次启动/停止加一，之前安排的事件作废
+  bool active;
+};
+
+int64_t esp_timer_get_time() {
+  SimClock::nudge();
+  return (int64_t)SimClock::now();
+}
+
+static void timerEvent(void* context, uint32_t generation) {
+  esp_timer* timer = static_cast<esp_timer*>(context);
+  if (!timer->active || timer->generation != generation) {
+    return;
+  }
+  if (timer->periodUs > 0) {
+    SimClock::scheduleIn(timer->periodUs, timerEvent, timer, generation);
+  } else {
+    timer->active = false;
+  }
+  timer->callback(timer->arg);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+  if (args == nullptr || args->callback == nullptr || handle == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  *handle = new esp_timer{args->callback, args->arg, 0, 0, false};
+  return ESP_OK;
+}
+
+static esp_err_t startTimer(esp_timer_handle_t timer, uint64_t timeoutUs, uint64_t periodUs) {
+  if (timer == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (timer->active) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer->active = true;
+  timer->periodUs = periodUs;
+  SimClock::scheduleIn(timeoutUs, timerEvent, timer, ++timer->generation);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+  return startTimer(timer, timeoutUs, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+  return startTimer(timer, periodUs, periodUs);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  if (timer == nullptr || !timer->active) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer->active = false;
+  timer->generation++;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  if (timer == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  delete timer;
+  return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+  return timer != nullptr && timer->active;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+  return ESP_SLEEP_WAKEUP_UNDEFINED;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t /*timeUs*/) {
+  return ESP_OK;
+}
+
+void esp_deep_sleep_start() {
+  throw SimDeepSleep{SimClock::now()};
+}
+
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t /*caps*/) {
+  memset(info, 0, sizeof(*info));
+  info->total_free_bytes = ESP.getFreeHeap();
+  info->minimum_free_bytes = ESP.getMinFreeHeap();
+  info->largest_free_block = ESP.getMaxAllocHeap();
+}
+
+// ========== 显示 ==========
+
+extern "C" uint8_t u8x8_DrawTile(u8x8_t* /*u8x8*/, uint8_t /*x*/, uint8_t /*y*/, uint8_t /*count*/, uint8_t* /*tiles*/) {
+  return 1;
+}
+
+extern "C" void u8x8_RefreshDisplay(u8x8_t* /*u8x8*/) {}
+
+void u8g2_ClearBuffer(u8g2_t* u8g2) { u8g2->owner->clearBuffer(); }
+void u8g2_SetFont(u8g2_t* u8g2, const uint8_t* font) { u8g2->owner->setFont(font); }
+void u8g2_SetDrawColor(u8g2_t* u8g2, uint8_t color) { u8g2->owner->setDrawColor(color); }
+u8g2_uint_t u8g2_DrawUTF8(u8g2_t* u8g2, u8g2_uint_t x, u8g2_uint_t y, const char* text) { return u8g2->owner->drawUTF8(x, y, text); }
+u8g2_uint_t u8g2_GetUTF8Width(u8g2_t* u8g2, const char* text) { return u8g2->owner->getUTF8Width(text); }
+uint8_t* u8g2_GetBufferPtr(u8g2_t* u8g2) { return u8g2->owner->getBufferPtr(); }
+uint8_t u8g2_GetBufferTileWidth(u8g2_t* u8g2) { return u8g2->owner->getBufferTileWidth(); }
+uint8_t u8g2_GetBufferTileHeight(u8g2_t* u8g2) { return u8g2->owner->getBufferTileHeight(); }
+u8g2_uint_t u8g2_GetDisplayHeight(u8g2_t* u8g2) { return u8g2->owner->getDisplayHeight(); }
+
+const uint8_t u8g2_font_6x10_tf[] = {0};
+const uint8_t u8g2_font_logisoso16_tn[] = {0};
+const uint8_t u8g2_font_logisoso24_tn[] = {0};
+const uint8_t u8g2_font_logisoso24_tr[] = {0};
+const uint8_t u8g2_font_logisoso32_tn[] = {0};
+const uint8_t u8g2_font_unifont_t_chinese3[] = {0};
+
+// ========== Preferences ==========
+
+namespace {
+
+std::map<std::string, std::string>& store() {
+  static std::map<std::string, std::string> entries;
+  return entries;
+}
+
+uint32_t writeCount = 0;
+
+}  // namespace
+
+bool Preferences::begin(const char* name, bool /*readOnly*/) {
+  space = name;
+  opened = true;
+  return true;
+}
+
+void Preferences::end() {
+  opened = false;
+}
+
+bool Preferences::clear() {
+  if (!opened) return false;
+  std::string prefix = space + "/";
+  for (auto it = store().begin(); it != store().end();) {
+    it = it->first.compare(0, prefix.size(), prefix) == 0 ? store().erase(it) : std::next(it);
+  }
+  writeCount++;
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!opened) return false;
+  writeCount++;
+  return store().erase(fullKey(key)) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  return opened && store().count(fullKey(key)) > 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+  if (!opened) return 0;
+  store()[fullKey(key)] = std::string((const char*)value, length);
+  writeCount++;
+  return length;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+  if (!isKey(key)) {
+    return defaultValue;
+  }
+  const std::string& value = store()[fullKey(key)];
+  return String(value.data(), value.size());
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  return isKey(key) ? store()[fullKey(key)].size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t length) {
+  if (!isKey(key)) return 0;
+  const std::string& value = store()[fullKey(key)];
+  if (value.size() > length) return 0;
+  memcpy(buffer, value.data(), value.size());
+  return value.size();
+}
+
+void Preferences::preset(const char* name, const char* key, const void* value, size_t length) {
+  store()[std::string(name) + "/" + key] = std::string((const char*)value, length);
+}
+
+void Preferences::presetString(const char* name, const char* key, const char* value) {
+  preset(name, key, value, strlen(value));
+}
+
+void Preferences::wipe() {
+  store().clear();
+  writeCount = 0;
+}
+
+uint32_t Preferences::getWriteCount() {
+  return writeCount;
+}
@@ -0,0 +1,609 @@
+/**
+ * 主机仿真：脚本化BLE传感器和 Arduino BLE 客户端接口的实现
+ *
+ * 每个传感器提供:
+ *   - CSC服务 (0x1816): Measurement (0x2A5B, 通知), Feature (0x2A5C, 读取, 可选), Control Point (0x2A55)
+ *   - 电池服务 (0x180F): Battery Level (0x2A19, 读取, 可选通知)
+ * 传感器只支持一个连接，连接期间不广播
+ */
+
+#include "FakeBLE.h"
+#include "BLEDevice.h"
+#include "BLEServer.h"
+#include "SimClock.h"
+#include <ctype.h>
+
+// 传感器所在车轮的周长（计数器按此换算速度）
+#define SIM_WHEEL_CIRCUMFERENCE_MM 2100
+
+#define SIM_HANDLE_CSC_MEASUREMENT 0x000E
+#define SIM_HANDLE_CSC_FEATURE 0x0011
+#define SIM_HANDLE_CSC_CONTROL_POINT 0x0013
+#define SIM_HANDLE_BATTERY_LEVEL 0x0017
+
+struct SimSensor {
+  SimSensorConfig config;
+  uint8_t index;
+  BLEAddress address = BLEAddress("00:00:00:00:00:00");
+  uint64_t clockOffsetUs;     // 传感器时钟领先仿真时钟的时间（计数器不从0开始）
+  bool inRange;
+  BLEClient* client;          // 当前连接的客户端（nullptr 表示未连接，正在广播）
+  uint32_t connection;        // 连接编号，每次连接和断开都加一，之前安排的通知事件作废
+  SimConnectionRecord* record;
+  BLERemoteService cscService;
+  BLERemoteService batteryService;
+
+  bool advertising() const { return inRange && client == nullptr; }
+  BLERemoteCharacteristic* measurement() { return &cscService.characteristics[0]; }
+
+  void setup(uint8_t index, const SimSensorConfig& config);
+  void addCharacteristic(BLERemoteService& service, uint16_t uuid, uint16_t handle, uint8_t properties);
+  void buildAdvertisement(BLEAdvertisedDevice& device);
+  size_t buildMeasurement(uint8_t* out);
+  size_t readCharacteristic(const BLERemoteCharacteristic* characteristic, uint8_t* out);
+  int8_t sampleRssi();
+  void establish(BLEClient* client, SimConnectionRecord* record);
+  void end(bool dropped);
+
+  static void advertisementEvent(void* context, uint32_t scanGeneration);
+  static void notifyEvent(void* context, uint32_t connection);
+  static void awayEvent(void* context, uint32_t away);
+  static void rssiEvent(void* context, uint32_t connection);
+};
+
+namespace {
+
+SimSensor sensors[SIM_MAX_SENSORS];
+uint8_t sensorCount = 0;
+SimConnectionRecord connections[SIM_MAX_CONNECTIONS];
+size_t connectionCount = 0;
+uint32_t connectTimeoutMs = 3000;
+BLEScan scan;
+esp_gap_ble_cb_t gapHandler = nullptr;
+
+SimSensor* findSensor(const BLEAddress& address) {
+  for (uint8_t i = 0; i < sensorCount; i++) {
+    if (sensors[i].address.equals(address)) {
+      return &sensors[i];
+    }
+  }
+  return nullptr;
+}
+
+SimConnectionRecord* newRecord(uint8_t sensor) {
+  // 记录表满时复用最后一条，统计只看前面的连接
+  SimConnectionRecord* record = &connections[connectionCount < SIM_MAX_CONNECTIONS ? connectionCount++ : SIM_MAX_CONNECTIONS - 1];
+  memset(record, 0, sizeof(*record));
+  record->sensor = sensor;
+  record->attemptUs = SimClock::now();
+  return record;
+}
+
+}  // namespace
+
+// ========== 脚本接口 ==========
+
+void FakeBLE::reset() {
+  sensorCount = 0;
+  connectionCount = 0;
+  connectTimeoutMs = 3000;
+  scan = BLEScan();
+  gapHandler = nullptr;
+}
+
+SimSensorConfig FakeBLE::defaultSensor(const char* address, const char* name) {
+  SimSensorConfig config;
+  config.address = address;
+  config.name = name;
+  config.rssi = -65;
+  config.rssiJitter = 4;
+  config.advIntervalMs = 100;
+  config.connectLatencyMs = 120;
+  config.discoveryMs = 450;
+  config.gattRoundTripMs = 45;
+  config.notifyIntervalMs = 1000;
+  config.notifyJitterMs = 15;
+  config.lossPercent = 0;
+  config.speedKmh = 25.0f;
+  config.cadenceRpm = 85.0f;
+  config.cscFeature = 0x0003;
+  config.batteryLevel = 80;
+  config.batteryNotify = true;
+  return config;
+}
+
+int FakeBLE::addSensor(const SimSensorConfig& config) {
+  if (sensorCount >= SIM_MAX_SENSORS) {
+    return -1;
+  }
+  sensors[sensorCount].setup(sensorCount, config);
+  return sensorCount++;
+}
+
+void FakeBLE::setConnectTimeoutMs(uint32_t timeoutMs) {
+  connectTimeoutMs = timeoutMs;
+}
+
+void FakeBLE::setAway(int sensor, uint32_t fromMs, uint32_t toMs) {
+  if (sensor < 0 || sensor >= sensorCount || toMs <= fromMs) {
+    return;
+  }
+  SimClock::schedule((uint64_t)fromMs * 1000, SimSensor::awayEvent, &sensors[sensor], 1);
+  SimClock::schedule((uint64_t)toMs * 1000, SimSensor::awayEvent, &sensors[sensor], 0);
+}
+
+size_t FakeBLE::getConnectionCount() {
+  return connectionCount;
+}
+
+const SimConnectionRecord& FakeBLE::getConnection(size_t index) {
+  return connections[index];
+}
+
+// ========== 传感器 ==========
+
+void SimSensor::setup(uint8_t index, const SimSensorConfig& config) {
+  this->config = config;
+  this->index = index;
+  address = BLEAddress(config.address);
+  clockOffsetUs = (uint64_t)SimClock::random(3600) * 1000000 + SimClock::random(1000000);
+  inRange = true;
+  client = nullptr;
+  connection = 0;
+  record = nullptr;
+
+  cscService = BLERemoteService();
+  cscService.sensor = this;
+  cscService.uuid = BLEUUID((uint16_t)0x1816);
+  addCharacteristic(cscService, 0x2A5B, SIM_HANDLE_CSC_MEASUREMENT, BLERemoteCharacteristic::PROPERTY_NOTIFY);
+  if (config.cscFeature >= 0) {
+    addCharacteristic(cscService, 0x2A5C, SIM_HANDLE_CSC_FEATURE, BLERemoteCharacteristic::PROPERTY_READ);
+  }
+  addCharacteristic(cscService, 0x2A55, SIM_HANDLE_CSC_CONTROL_POINT, 0);
+
+  batteryService = BLERemoteService();
+  batteryService.sensor = this;
+  batteryService.uuid = BLEUUID((uint16_t)0x180F);
+  if (config.batteryLevel >= 0) {
+    addCharacteristic(batteryService, 0x2A19, SIM_HANDLE_BATTERY_LEVEL,
+                      BLERemoteCharacteristic::PROPERTY_READ | (config.batteryNotify ? BLERemoteCharacteristic::PROPERTY_NOTIFY : 0));
+  }
+}
+
+void SimSensor::addCharacteristic(BLERemoteService& service, uint16_t uuid, uint16_t handle, uint8_t properties) {
+  BLERemoteCharacteristic& characteristic = service.characteristics[service.characteristicCount++];
+  characteristic.sensor = this;
+  characteristic.uuid = BLEUUID(uuid);
+  characteristic.handle = handle;
+  characteristic.properties = properties;
+}
+
+int8_t SimSensor::sampleRssi() {
+  int jitter = config.rssiJitter;
+  return (int8_t)(config.rssi + (int)SimClock::random(2 * jitter + 1) - jitter);
+}
+
+void SimSensor::buildAdvertisement(BLEAdvertisedDevice& device) {
+  device.address = address;
+  device.rssi = sampleRssi();
+  uint8_t* p = device.payload;
+  // Flags
+  *p++ = 0x02; *p++ = 0x01; *p++ = 0x06;
+  // 完整的16位服务UUID列表：CSC
+  *p++ = 0x03; *p++ = 0x03; *p++ = 0x16; *p++ = 0x18;
+  if (config.name != nullptr) {
+    size_t length = strlen(config.name);
+    if (length > sizeof(device.payload) - 9) length = sizeof(device.payload) - 9;
+    *p++ = (uint8_t)(length + 1);
+    *p++ = 0x09;
+    memcpy(p, config.name, length);
+    p += length;
+    snprintf(device.name, sizeof(device.name), "%s", config.name);
+  }
+  device.payloadLength = (size_t)(p - device.payload);
+}
+
+// 标准CSC Measurement：计数器和事件时间按传感器时钟从速度、踏频推算
+size_t SimSensor::buildMeasurement(uint8_t* out) {
+  double seconds = (SimClock::now() + clockOffsetUs) / 1000000.0;
+  bool wheel = config.cscFeature < 0 || (config.cscFeature & 0x0001);
+  bool crank = config.cscFeature < 0 || (config.cscFeature & 0x0002);
+  size_t length = 1;
+  out[0] = (wheel ? 0x01 : 0x00) | (crank ? 0x02 : 0x00);
+  if (wheel) {
+    double metersPerSecond = config.speedKmh / 3.6;
+    uint32_t revolutions = 0;
+    uint16_t eventTime = 0;
+    if (metersPerSecond > 0) {
+      double period = SIM_WHEEL_CIRCUMFERENCE_MM / 1000.0 / metersPerSecond;
+      revolutions = (uint32_t)(seconds / period);
+      eventTime = (uint16_t)((uint64_t)(revolutions * period * 1024) & 0xFFFF);
+    }
+    memcpy(out + length, &revolutions, 4);
+    memcpy(out + length + 4, &eventTime, 2);
+    length += 6;
+  }
+  if (crank) {
+    uint16_t revolutions = 0;
+    uint16_t eventTime = 0;
+    if (config.cadenceRpm > 0) {
+      double period = 60.0 / config.cadenceRpm;
+      uint64_t total = (uint64_t)(seconds / period);
+      revolutions = (uint16_t)(total & 0xFFFF);
+      eventTime = (uint16_t)((uint64_t)(total * period * 1024) & 0xFFFF);
+    }
+    memcpy(out + length, &revolutions, 2);
+    memcpy(out + length + 2, &eventTime, 2);
+    length += 4;
+  }
+  return length;
+}
+
+size_t SimSensor::readCharacteristic(const BLERemoteCharacteristic* characteristic, uint8_t* out) {
+  switch (characteristic->handle) {
+    case SIM_HANDLE_CSC_MEASUREMENT:
+      return buildMeasurement(out);
+    case SIM_HANDLE_CSC_FEATURE:
+      out[0] = (uint8_t)(config.cscFeature & 0xFF);
+      out[1] = (uint8_t)((config.cscFeature >> 8) & 0xFF);
+      return 2;
+    case SIM_HANDLE_BATTERY_LEVEL:
+      out[0] = (uint8_t)config.batteryLevel;
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+void SimSensor::establish(BLEClient* newClient, SimConnectionRecord* newRecord) {
+  client = newClient;
+  connection++;
+  record = newRecord;
+  record->established = true;
+  record->connectedUs = SimClock::now();
+  newClient->peer = this;
+  newClient->connection = connection;
+  newClient->discovered = false;
+  if (newClient->callbacks) {
+    newClient->callbacks->onConnect(newClient);
+  }
+}
+
+void SimSensor::end(bool dropped) {
+  if (client == nullptr) {
+    return;
+  }
+  BLEClient* oldClient = client;
+  client = nullptr;
+  connection++;
+  record->endUs = SimClock::now();
+  record->dropped = dropped;
+  record = nullptr;
+  // 订阅随连接结束
+  for (uint8_t i = 0; i < cscService.characteristicCount; i++) {
+    cscService.characteristics[i].callback = nullptr;
+  }
+  for (uint8_t i = 0; i < batteryService.characteristicCount; i++) {
+    batteryService.characteristics[i].callback = nullptr;
+  }
+  if (oldClient->callbacks) {
+    oldClient->callbacks->onDisconnect(oldClient);
+  }
+}
+
+void SimSensor::advertisementEvent(void* context, uint32_t scanGeneration) {
+  SimSensor* sensor = static_cast<SimSensor*>(context);
+  if (!scan.scanning || scan.generation != scanGeneration) {
+    return;
+  }
+  if (sensor->advertising() && scan.callbacks) {
+    BLEAdvertisedDevice device;
+    sensor->buildAdvertisement(device);
+    scan.callbacks->onResult(device);
+  }
+  // 广播间隔另加0-10ms随机延迟（与蓝牙规范中的 advDelay 相同）
+  SimClock::scheduleIn((uint64_t)(sensor->config.advIntervalMs + SimClock::random(11)) * 1000,
+                       advertisementEvent, sensor, scanGeneration);
+}
+
+void SimSensor::notifyEvent(void* context, uint32_t connection) {
+  SimSensor* sensor = static_cast<SimSensor*>(context);
+  if (sensor->connection != connection || sensor->client == nullptr) {
+    return;
+  }
+  int jitter = sensor->config.notifyJitterMs;
+  uint32_t nextMs = sensor->config.notifyIntervalMs + (int)SimClock::random(2 * jitter + 1) - jitter;
+  SimClock::scheduleIn((uint64_t)nextMs * 1000, notifyEvent, sensor, connection);
+
+  BLERemoteCharacteristic* measurement = sensor->measurement();
+  if (measurement->callback == nullptr || SimClock::random(100) < sensor->config.lossPercent) {
+    return;
+  }
+  uint8_t data[11];
+  size_t length = sensor->buildMeasurement(data);
+  if (sensor->record->firstNotifyUs == 0) {
+    sensor->record->firstNotifyUs = SimClock::now();
+  }
+  sensor->record->notifications++;
+  measurement->callback(measurement, data, length, true);
+}
+
+void SimSensor::awayEvent(void* context, uint32_t away) {
+  SimSensor* sensor = static_cast<SimSensor*>(context);
+  sensor->inRange = !away;
+  if (away) {
+    sensor->end(true);
+  }
+}
+
+void SimSensor::rssiEvent(void* context, uint32_t connection) {
+  SimSensor* sensor = static_cast<SimSensor*>(context);
+  if (gapHandler == nullptr) {
+    return;
+  }
+  esp_ble_gap_cb_param_t param;
+  memset(&param, 0, sizeof(param));
+  bool connected = sensor->connection == connection && sensor->client != nullptr;
+  param.read_rssi_cmpl.status = connected ? ESP_BT_STATUS_SUCCESS : ESP_BT_STATUS_FAIL;
+  param.read_rssi_cmpl.rssi = connected ? sensor->sampleRssi() : 0;
+  memcpy(param.read_rssi_cmpl.remote_addr, *sensor->address.getNative(), sizeof(esp_bd_addr_t));
+  gapHandler(ESP_GAP_BLE_READ_RSSI_COMPLETE_EVT, &param);
+}
+
+// ========== BLEAddress / BLEUUID ==========
+
+BLEAddress::BLEAddress(const char* text) {
+  unsigned int bytes[6] = {0};
+  if (text == nullptr || sscanf(text, "%x:%x:%x:%x:%x:%x", &bytes[0], &bytes[1], &bytes[2], &bytes[3], &bytes[4], &bytes[5]) != 6) {
+    memset(bytes, 0, sizeof(bytes));
+  }
+  for (int i = 0; i < 6; i++) {
+    native[i] = (uint8_t)bytes[i];
+  }
+}
+
+BLEAddress::BLEAddress(const esp_bd_addr_t address) {
+  memcpy(native, address, sizeof(native));
+}
+
+String BLEAddress::toString() const {
+  char text[18];
+  snprintf(text, sizeof(text), "%02x:%02x:%02x:%02x:%02x:%02x", native[0], native[1], native[2], native[3], native[4], native[5]);
+  return String(text);
+}
+
+BLEUUID::BLEUUID(const char* uuid) {
+  size_t length = uuid ? strlen(uuid) : 0;
+  if (length == 4) {
+    snprintf(text, sizeof(text), "0000%s-0000-1000-8000-00805f9b34fb", uuid);
+  } else {
+    snprintf(text, sizeof(text), "%s", uuid ? uuid : "");
+  }
+  for (char* p = text; *p; p++) {
+    *p = (char)tolower((unsigned char)*p);
+  }
+}
+
+BLEUUID::BLEUUID(uint16_t uuid) {
+  snprintf(text, sizeof(text), "0000%04x-0000-1000-8000-00805f9b34fb", uuid);
+}
+
+// ========== 客户端 ==========
+
+bool BLEClient::connect(BLEAddress address, uint8_t /*type*/, uint32_t timeoutMs) {
+  if (isConnected()) {
+    return true;
+  }
+  SimSensor* sensor = findSensor(address);
+  SimConnectionRecord* record = newRecord(sensor ? sensor->index : 0xFF);
+  uint32_t waitMs = timeoutMs < connectTimeoutMs ? timeoutMs : connectTimeoutMs;
+  uint64_t deadlineUs = SimClock::now() + (uint64_t)waitMs * 1000;
+  while (true) {
+    if (sensor && sensor->advertising()) {
+      // 等到传感器的下一次广播，再经过连接建立时间
+      SimClock::sleep((uint64_t)(SimClock::random(sensor->config.advIntervalMs) + sensor->config.connectLatencyMs) * 1000);
+      if (sensor->advertising()) {
+        sensor->establish(this, record);
+        return true;
+      }
+    }
+    if (SimClock::now() >= deadlineUs) {
+      break;
+    }
+    uint64_t stepUs = deadlineUs - SimClock::now();
+    SimClock::sleep(stepUs < 10000 ? stepUs : 10000);
+  }
+  record->endUs = SimClock::now();
+  return false;
+}
+
+void BLEClient::disconnect() {
+  if (isConnected()) {
+    peer->end(false);
+  }
+}
+
+bool BLEClient::isConnected() {
+  return peer != nullptr && peer->client == this && peer->connection == connection;
+}
+
+BLERemoteService* BLEClient::getService(BLEUUID uuid) {
+  if (!isConnected()) {
+    return nullptr;
+  }
+  if (!discovered) {
+    SimClock::sleep((uint64_t)peer->config.discoveryMs * 1000);
+    if (!isConnected()) {
+      return nullptr;
+    }
+    discovered = true;
+  }
+  if (uuid.equals(peer->cscService.uuid)) {
+    return &peer->cscService;
+  }
+  if (peer->config.batteryLevel >= 0 && uuid.equals(peer->batteryService.uuid)) {
+    return &peer->batteryService;
+  }
+  return nullptr;
+}
+
+BLEAddress BLEClient::getPeerAddress() {
+  return peer ? peer->address : BLEAddress("00:00:00:00:00:00");
+}
+
+int BLEClient::getRssi() {
+  if (!isConnected()) {
+    return 0;
+  }
+  SimClock::sleep((uint64_t)peer->config.gattRoundTripMs * 1000);
+  return isConnected() ? peer->sampleRssi() : 0;
+}
+
+BLERemoteCharacteristic* BLERemoteService::getCharacteristic(BLEUUID uuid) {
+  if (sensor->client == nullptr) {
+    return nullptr;
+  }
+  // 每次连接首次访问时发现特征值
+  if (discoveredConnection != sensor->connection) {
+    SimClock::sleep((uint64_t)sensor->config.gattRoundTripMs * 1000);
+    if (sensor->client == nullptr) {
+      return nullptr;
+    }
+    discoveredConnection = sensor->connection;
+  }
+  for (uint8_t i = 0; i < characteristicCount; i++) {
+    if (characteristics[i].uuid.equals(uuid)) {
+      return &characteristics[i];
+    }
+  }
+  return nullptr;
+}
+
+void BLERemoteCharacteristic::registerForNotify(notify_callback newCallback, bool /*notifications*/, bool /*descriptorRequiresRegistration*/) {
+  if (sensor->client == nullptr) {
+    return;
+  }
+  uint32_t connection = sensor->connection;
+  SimClock::sleep((uint64_t)sensor->config.gattRoundTripMs * 1000);  // 写CCCD
+  if (sensor->connection != connection) {
+    return;
+  }
+  callback = newCallback;
+  if (this == sensor->measurement() && newCallback != nullptr) {
+    sensor->record->subscribedUs = SimClock::now();
+    // 传感器按自己的节拍发送，第一个通知在一个间隔内的任意时刻到达
+    SimClock::scheduleIn((uint64_t)SimClock::random(sensor->config.notifyIntervalMs) * 1000,
+                         SimSensor::notifyEvent, sensor, connection);
+  }
+}
+
+String BLERemoteCharacteristic::readValue() {
+  if (sensor->client == nullptr || !canRead()) {
+    return String();
+  }
+  uint32_t connection = sensor->connection;
+  SimClock::sleep((uint64_t)sensor->config.gattRoundTripMs * 1000);
+  if (sensor->connection != connection) {
+    return String();
+  }
+  uint8_t data[20];
+  size_t length = sensor->readCharacteristic(this, data);
+  return String((const char*)data, length);
+}
+
+uint8_t BLERemoteCharacteristic::readUInt8() {
+  String value = readValue();
+  return value.length() >= 1 ? (uint8_t)value[0] : 0;
+}
+
+uint16_t BLERemoteCharacteristic::readUInt16() {
+  String value = readValue();
+  return value.length() >= 2 ? (uint16_t)((uint8_t)value[0] | ((uint8_t)value[1] << 8)) : 0;
+}
+
+uint32_t BLERemoteCharacteristic::readUInt32() {
+  String value = readValue();
+  uint32_t result = 0;
+  for (size_t i = 0; i < 4 && i < value.length(); i++) {
+    result |= (uint32_t)(uint8_t)value[i] << (8 * i);
+  }
+  return result;
+}
+
+// ========== 扫描 ==========
+
+void BLEScan::setAdvertisedDeviceCallbacks(BLEAdvertisedDeviceCallbacks* newCallbacks, bool /*wantDuplicates*/, bool /*shouldParse*/) {
+  callbacks = newCallbacks;
+}
+
+bool BLEScan::start(uint32_t duration, void (*newCompleteCallback)(BLEScanResults), bool /*isContinue*/) {
+  scanning = true;
+  generation++;
+  completeCallback = newCompleteCallback;
+  for (uint8_t i = 0; i < sensorCount; i++) {
+    SimClock::scheduleIn((uint64_t)SimClock::random(sensors[i].config.advIntervalMs) * 1000,
+                         SimSensor::advertisementEvent, &sensors[i], generation);
+  }
+  if (duration > 0) {
+    SimClock::scheduleIn((uint64_t)duration * 1000000, endEvent, this, generation);
+  }
+  return true;
+}
+
+void BLEScan::stop() {
+  scanning = false;
+  generation++;
+}
+
+void BLEScan::endEvent(void* context, uint32_t scanGeneration) {
+  BLEScan* self = static_cast<BLEScan*>(context);
+  if (!self->scanning || self->generation != scanGeneration) {
+    return;
+  }
+  self->scanning = false;
+  self->generation++;
+  if (self->completeCallback) {
+    self->completeCallback(BLEScanResults());
+  }
+}
+
+// ========== BLEDevice / GAP / GATTS ==========
+
+BLEScan* BLEDevice::getScan() {
+  return &scan;
+}
+
+BLEClient* BLEDevice::createClient() {
+  return new BLEClient();
+}
+
+void BLEDevice::setCustomGapHandler(esp_gap_ble_cb_t handler) {
+  gapHandler = handler;
+}
+
+BLEServer* BLEDevice::createServer() {
+  return new BLEServer();
+}
+
+BLEAdvertising* BLEDevice::getAdvertising() {
+  static BLEAdvertising advertising;
+  return &advertising;
+}
+
+esp_err_t esp_ble_gap_read_rssi(esp_bd_addr_t remoteAddress) {
+  SimSensor* sensor = findSensor(BLEAddress(remoteAddress));
+  if (sensor == nullptr || sensor->client == nullptr) {
+    return ESP_FAIL;
+  }
+  SimClock::scheduleIn((uint64_t)sensor->config.gattRoundTripMs * 1000, SimSensor::rssiEvent, sensor, sensor->connection);
+  return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_set_device_name(const char* /*name*/) {
+  return ESP_OK;
+}
+
+esp_err_t esp_ble_gatts_send_indicate(esp_gatt_if_t /*gattsIf*/, uint16_t /*connId*/, uint16_t /*attrHandle*/,
+                                      uint16_t /*length*/, uint8_t* /*value*/, bool /*needConfirm*/) {
+  return ESP_OK;
+}
@@ -0,0 +1,68 @@
+/**
+ * 主机仿真：脚本化的BLE传感器
+ *
+ * 每个传感器有自己的广播、连接、服务发现和通知时序参数，仿真脚本可以安排掉线（之后一段时间离开范围）。
+ * 传感器的计数器按自身时钟连续累加（与是否连接无关），重连后数据接着之前的值
+ * 每次连接的关键时间点记录在 SimConnectionRecord 中，用于统计重连耗时和首个数据的时间
+ */
+
+#ifndef FAKE_BLE_H
+#define FAKE_BLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SIM_MAX_SENSORS 4
+#define SIM_MAX_CONNECTIONS 64
+
+struct SimSensorConfig {
+  const char* address;        // "aa:bb:cc:dd:ee:ff"
+  const char* name;           // 广播名称（nullptr 表示不广播名称）
+  int8_t rssi;                // 平均信号强度 (dBm)
+  uint8_t rssiJitter;         // 每次广播/读取RSSI的随机波动 (±dB)
+  uint16_t advIntervalMs;     // 广播间隔（另加0-10ms随机延迟）
+  uint16_t connectLatencyMs;  // 收到广播后建立连接的耗时
+  uint16_t discoveryMs;       // 服务发现（首次 getService）
+  uint16_t gattRoundTripMs;   // 一次GATT往返（特征值发现、读取、写CCCD）
+  uint16_t notifyIntervalMs;  // CSC Measurement 通知间隔
+  uint16_t notifyJitterMs;    // 通知间隔的随机波动（±ms）
+  uint8_t lossPercent;        // 通知丢失概率（%）
+  float speedKmh;             // 传感器计数器对应的速度和踏频
+  float cadenceRpm;
+  int32_t cscFeature;         // CSC Feature 值（-1 表示不提供该特征值，数据包带轮转和曲柄数据）
+  int8_t batteryLevel;        // 电量（-1 表示没有电池服务）
+  bool batteryNotify;         // 电量特征值支持通知
+};
+
+// 一次连接（或连接尝试）的时间点，单位微秒，0表示未发生
+struct SimConnectionRecord {
+  uint8_t sensor;
+  bool established;           // false 表示连接尝试超时失败
+  uint64_t attemptUs;         // 调用 connect()
+  uint64_t connectedUs;       // 连接建立
+  uint64_t subscribedUs;      // CSC Measurement 订阅完成（CCCD写入）
+  uint64_t firstNotifyUs;     // 第一个CSC通知送达回调
+  uint64_t endUs;             // 断开
+  bool dropped;               // 断开原因：true = 掉线，false = 本机主动断开
+  uint32_t notifications;     // 送达的CSC通知数
+};
+
+class FakeBLE {
+public:
+  static void reset();
+  // 标准的CSC传感器参数（1秒一个通知，25 km/h，85 rpm），按需修改后传给 addSensor()
+  static SimSensorConfig defaultSensor(const char* address, const char* name);
+  static int addSensor(const SimSensorConfig& config);
+
+  // 直连时传感器不在广播的最长等待时间（之后 connect() 返回失败）
+  static void setConnectTimeoutMs(uint32_t timeoutMs);
+  // 在 [fromMs, toMs) 内离开范围：不广播、无法连接；此时已连接则掉线（协议栈报告断开）
+  static void setAway(int sensor, uint32_t fromMs, uint32_t toMs);
+  // 在 atMs 时刻掉线，之后 awayMs 内离开范围
+  static void dropLink(int sensor, uint32_t atMs, uint32_t awayMs) { setAway(sensor, atMs, atMs + awayMs); }
+
+  static size_t getConnectionCount();
+  static const SimConnectionRecord& getConnection(size_t index);
+};
+
+#endif // FAKE_BLE_H
@@ -0,0 +1,51 @@
+/**
+ * 主机仿真：Preferences（NVS）
+ * 所有实例共用一个按"命名空间/键"保存字节的内存存储，仿真脚本可以预置内容（如上次连接的设备地址）
+ */
+
+#ifndef FAKE_PREFERENCES_H
+#define FAKE_PREFERENCES_H
+
+#include "Arduino.h"
+#include <string>
+
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false);
+  void end();
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+
+  size_t putUChar(const char* key, uint8_t value) { return putBytes(key, &value, sizeof(value)); }
+  size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+  size_t putFloat(const char* key, float value) { return putBytes(key, &value, sizeof(value)); }
+  size_t putString(const char* key, const char* value) { return putBytes(key, value, strlen(value)); }
+  size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+  size_t putBytes(const char* key, const void* value, size_t length);
+
+  uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  float getFloat(const char* key, float defaultValue = 0) { return getValue(key, defaultValue); }
+  String getString(const char* key, const String& defaultValue = String());
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buffer, size_t length);
+
+  // 仿真脚本：直接读写存储（不需要先 begin）
+  static void preset(const char* name, const char* key, const void* value, size_t length);
+  static void presetString(const char* name, const char* key, const char* value);
+  static void wipe();
+  static uint32_t getWriteCount();  // 写入次数（put/remove/clear）
+
+private:
+  std::string space;
+  bool opened = false;
+
+  std::string fullKey(const char* key) const { return space + "/" + key; }
+  template <typename T> T getValue(const char* key, T defaultValue) {
+    T value;
+    return getBytesLength(key) == sizeof(T) && getBytes(key, &value, sizeof(T)) == sizeof(T) ? value : defaultValue;
+  }
+};
+
+#endif // FAKE_PREFERENCES_H
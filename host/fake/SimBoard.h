@@ -0,0 +1,23 @@
+/**
+ * 主机仿真：开发板外设的脚本接口（串口、GPIO）
+ */
+
+#ifndef SIM_BOARD_H
+#define SIM_BOARD_H
+
+#include <stdint.h>
+
+class SimBoard {
+public:
+  static void reset();
+
+  // 串口输出：verbose 时带虚拟时间戳打印到 stdout，否则丢弃
+  static void setVerbose(bool verbose);
+  // 在 atMs 时刻把一行命令（自动加换行）放入串口接收缓冲区
+  static void sendSerial(uint32_t atMs, const char* line);
+
+  // 在 atMs 时刻把引脚拉低 durationMs（模拟按下上拉输入的按键）
+  static void pressPin(uint8_t pin, uint32_t atMs, uint32_t durationMs);
+};
+
+#endif // SIM_BOARD_H
@@ -0,0 +1,85 @@
+/**
+ * 主机仿真：虚拟时钟和事件队列实现
+ */
+
+#include "SimClock.h"
+#include <queue>
+#include <vector>
+
+namespace {
+
+struct Event {
+  uint64_t atUs;
+  uint64_t sequence;
+  SimClock::EventFn fn;
+  void* context;
+  uint32_t tag;
+};
+
+struct Later {
+  bool operator()(const Event& a, const Event& b) const {
+    return a.atUs != b.atUs ? a.atUs > b.atUs : a.sequence > b.sequence;
+  }
+};
+
+uint64_t nowUs = 0;
+uint64_t nextSequence = 0;
+uint32_t randomState = 1;
+bool firing = false;
+std::priority_queue<Event, std::vector<Event>, Later> events;
+
+}  // namespace
+
+void SimClock::reset(uint32_t seed) {
+  nowUs = 0;
+  nextSequence = 0;
+  randomState = seed != 0 ? seed : 1;
+  events = std::priority_queue<Event, std::vector<Event>, Later>();
+}
+
+uint64_t SimClock::now() {
+  return nowUs;
+}
+
+void SimClock::nudge() {
+  nowUs++;
+}
+
+void SimClock::sleep(uint64_t us) {
+  uint64_t targetUs = nowUs + us;
+  // 事件回调中的阻塞调用只推进时间（BLE任务中不会嵌套运行自己）
+  if (firing) {
+    nowUs = targetUs;
+    return;
+  }
+  firing = true;
+  while (!events.empty() && events.top().atUs <= targetUs) {
+    Event event = events.top();
+    events.pop();
+    if (event.atUs > nowUs) {
+      nowUs = event.atUs;
+    }
+    event.fn(event.context, event.tag);
+  }
+  firing = false;
+  nowUs = targetUs;
+}
+
+void SimClock::schedule(uint64_t atUs, EventFn fn, void* context, uint32_t tag) {
+  events.push(Event{atUs, nextSequence++, fn, context, tag});
+}
+
+void SimClock::scheduleIn(uint64_t delayUs, EventFn fn, void* context, uint32_t tag) {
+  schedule(nowUs + delayUs, fn, context, tag);
+}
+
+uint32_t SimClock::random() {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+uint32_t SimClock::random(uint32_t bound) {
+  return bound == 0 ? 0 : random() % bound;
+}
@@ -0,0 +1,32 @@
+/**
+ * 主机仿真：虚拟时钟和事件队列
+ *
+ * 固件看到的所有时间（millis、micros、esp_timer）都来自这里。时间只在以下情况前进：
+ *   - sleep()：delay()、vTaskDelay() 和阻塞的BLE调用，期间按时间顺序触发到期的事件
+ *     （广播、通知、掉线等，相当于BLE任务在主循环阻塞时运行）
+ *   - nudge()：每次读取时间推进1微秒，不触发事件，避免轮询时间的忙等循环卡死
+ * 同一时刻的事件按加入顺序触发，给定随机种子时每次运行结果完全相同
+ */
+
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdint.h>
+
+class SimClock {
+public:
+  typedef void (*EventFn)(void* context, uint32_t tag);
+
+  static void reset(uint32_t seed);
+  static uint64_t now();
+  static void nudge();
+  static void sleep(uint64_t us);
+  static void schedule(uint64_t atUs, EventFn fn, void* context, uint32_t tag = 0);
+  static void scheduleIn(uint64_t delayUs, EventFn fn, void* context, uint32_t tag = 0);
+
+  // 确定性随机数（xorshift32），仿真中所有抖动和丢包都从这里取
+  static uint32_t random();
+  static uint32_t random(uint32_t bound);  // [0, bound)
+};
+
+#endif // SIM_CLOCK_H
@@ -0,0 +1,99 @@
+/**
+ * 主机仿真：U8g2 显示库
+ * 只保留帧缓冲区和固件调用的接口，绘制操作不产生像素（仿真关心的是连接和数据流程，不是画面）
+ */
+
+#ifndef FAKE_U8G2LIB_H
+#define FAKE_U8G2LIB_H
+
+#include "Arduino.h"
+#include "clib/u8g2.h"
+
+#define U8X8_PIN_NONE 255
+#define U8G2_DRAW_UPPER_RIGHT 0x01
+#define U8G2_DRAW_UPPER_LEFT 0x02
+#define U8G2_DRAW_LOWER_LEFT 0x04
+#define U8G2_DRAW_LOWER_RIGHT 0x08
+#define U8G2_DRAW_ALL 0x0F
+
+typedef struct u8x8_struct u8x8_t;
+typedef const void* u8g2_cb_t;
+#define U8G2_R0 ((u8g2_cb_t)0)
+
+extern "C" {
+uint8_t u8x8_DrawTile(u8x8_t* u8x8, uint8_t x, uint8_t y, uint8_t count, uint8_t* tiles);
+void u8x8_RefreshDisplay(u8x8_t* u8x8);
+}
+
+extern const uint8_t u8g2_font_6x10_tf[];
+extern const uint8_t u8g2_font_logisoso16_tn[];
+extern const uint8_t u8g2_font_logisoso24_tn[];
+extern const uint8_t u8g2_font_logisoso24_tr[];
+extern const uint8_t u8g2_font_logisoso32_tn[];
+extern const uint8_t u8g2_font_unifont_t_chinese3[];
+
+class U8G2 : public Print {
+public:
+  U8G2(uint8_t width, uint8_t height, uint8_t bufferTileRows)
+    : width(width), height(height), tileRows(bufferTileRows) {
+    u8g2.owner = this;
+  }
+
+  bool begin() { return true; }
+  void setI2CAddress(uint8_t /*address*/) {}
+  void setBusClock(uint32_t /*clock*/) {}
+  void setPowerSave(uint8_t /*enable*/) {}
+  void enableUTF8Print() {}
+  void clearDisplay() { clearBuffer(); }
+
+  void clearBuffer() { memset(buffer, 0, sizeof(buffer)); }
+  void sendBuffer() {}
+  void firstPage() { clearBuffer(); page = 0; }
+  uint8_t nextPage() { return ++page < height / 8 / tileRows; }
+
+  uint8_t* getBufferPtr() { return buffer; }
+  uint8_t getBufferTileWidth() { return width / 8; }
+  uint8_t getBufferTileHeight() { return tileRows; }
+  u8x8_t* getU8x8() { return nullptr; }
+  u8g2_t* getU8g2() { return &u8g2; }
+  uint16_t getDisplayWidth() { return width; }
+  uint16_t getDisplayHeight() { return height; }
+
+  void setFont(const uint8_t* /*font*/) {}
+  void setDrawColor(uint8_t /*color*/) {}
+  uint16_t getUTF8Width(const char* text) { return (uint16_t)(strlen(text) * 6); }
+  uint16_t drawUTF8(uint16_t /*x*/, uint16_t /*y*/, const char* text) { return getUTF8Width(text); }
+  uint16_t drawStr(uint16_t /*x*/, uint16_t /*y*/, const char* text) { return getUTF8Width(text); }
+  void drawPixel(uint16_t /*x*/, uint16_t /*y*/) {}
+  void drawLine(uint16_t /*x0*/, uint16_t /*y0*/, uint16_t /*x1*/, uint16_t /*y1*/) {}
+  void drawBox(uint16_t /*x*/, uint16_t /*y*/, uint16_t /*w*/, uint16_t /*h*/) {}
+  void drawCircle(uint16_t /*x*/, uint16_t /*y*/, uint16_t /*radius*/, uint8_t /*option*/ = U8G2_DRAW_ALL) {}
+  void drawDisc(uint16_t /*x*/, uint16_t /*y*/, uint16_t /*radius*/, uint8_t /*option*/ = U8G2_DRAW_ALL) {}
+
+  using Print::write;
+  size_t write(const uint8_t* /*data*/, size_t length) override { return length; }
+
+private:
+  u8g2_t u8g2;
+  uint8_t width;
+  uint8_t height;
+  uint8_t tileRows;
+  uint8_t page = 0;
+  uint8_t buffer[128 * 64 / 8];
+};
+
+#define FAKE_U8G2_DISPLAY(name, w, h, rows) \
+  class name : public U8G2 { \
+  public: \
+    name(u8g2_cb_t /*rotation*/, uint8_t /*reset*/ = U8X8_PIN_NONE, uint8_t /*clock*/ = U8X8_PIN_NONE, uint8_t /*data*/ = U8X8_PIN_NONE) \
+      : U8G2(w, h, rows) {} \
+  };
+
+FAKE_U8G2_DISPLAY(U8G2_SSD1306_128X64_NONAME_F_HW_I2C, 128, 64, 8)
+FAKE_U8G2_DISPLAY(U8G2_SSD1306_128X64_NONAME_2_HW_I2C, 128, 64, 2)
+FAKE_U8G2_DISPLAY(U8G2_SSD1306_128X64_NONAME_1_HW_I2C, 128, 64, 1)
+FAKE_U8G2_DISPLAY(U8G2_SSD1306_128X32_NONAME_F_HW_I2C, 128, 32, 4)
+FAKE_U8G2_DISPLAY(U8G2_SSD1306_128X32_NONAME_2_HW_I2C, 128, 32, 2)
+FAKE_U8G2_DISPLAY(U8G2_SSD1306_128X32_NONAME_1_HW_I2C, 128, 32, 1)
+
+#endif // FAKE_U8G2LIB_H
@@ -0,0 +1,27 @@
+/**
+ * 主机仿真：Arduino String 的替代实现（基于 std::string，只提供固件用到的接口）
+ */
+
+#ifndef FAKE_WSTRING_H
+#define FAKE_WSTRING_H
+
+#include <string>
+
+class String {
+public:
+  String(const char* text = "") : value(text ? text : "") {}
+  String(const char* data, size_t length) : value(data, length) {}
+  String(const std::string& text) : value(text) {}
+
+  size_t length() const { return value.size(); }
+  const char* c_str() const { return value.c_str(); }
+  char operator[](size_t index) const { return index < value.size() ? value[index] : '\0'; }
+  bool operator==(const String& other) const { return value == other.value; }
+  bool operator==(const char* other) const { return value == (other ? other : ""); }
+  bool operator!=(const String& other) const { return value != other.value; }
+
+private:
+  std::string value;
+};
+
+#endif // FAKE_WSTRING_H
@@ -0,0 +1,22 @@
+/**
+ * 主机仿真：I2C（显示数据直接丢弃）
+ */
+
+#ifndef FAKE_WIRE_H
+#define FAKE_WIRE_H
+
+#include "Arduino.h"
+
+class TwoWire {
+public:
+  bool begin(int /*sda*/, int /*scl*/, uint32_t frequency = 0) { clock = frequency; return true; }
+  void setClock(uint32_t frequency) { clock = frequency; }
+  uint32_t getClock() { return clock; }
+
+private:
+  uint32_t clock = 100000;
+};
+
+extern TwoWire Wire;
+
+#endif // FAKE_WIRE_H
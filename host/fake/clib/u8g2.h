@@ -0,0 +1,27 @@
+/**
+ * 主机仿真：U8g2 的C接口（固件中直接使用的部分，转发给 U8g2lib.h 中的仿真 U8G2 对象）
+ */
+
+#ifndef FAKE_U8G2_H
+#define FAKE_U8G2_H
+
+#include <stdint.h>
+
+class U8G2;
+typedef uint16_t u8g2_uint_t;
+
+typedef struct u8g2_struct {
+  U8G2* owner;
+} u8g2_t;
+
+void u8g2_ClearBuffer(u8g2_t* u8g2);
+void u8g2_SetFont(u8g2_t* u8g2, const uint8_t* font);
+void u8g2_SetDrawColor(u8g2_t* u8g2, uint8_t color);
+u8g2_uint_t u8g2_DrawUTF8(u8g2_t* u8g2, u8g2_uint_t x, u8g2_uint_t y, const char* text);
+u8g2_uint_t u8g2_GetUTF8Width(u8g2_t* u8g2, const char* text);
+uint8_t* u8g2_GetBufferPtr(u8g2_t* u8g2);
+uint8_t u8g2_GetBufferTileWidth(u8g2_t* u8g2);
+uint8_t u8g2_GetBufferTileHeight(u8g2_t* u8g2);
+u8g2_uint_t u8g2_GetDisplayHeight(u8g2_t* u8g2);
+
+#endif // FAKE_U8G2_H
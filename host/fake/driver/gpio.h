@@ -0,0 +1,12 @@
+/**
+ * 主机仿真：GPIO驱动（固件只包含头文件）
+ */
+
+#ifndef FAKE_DRIVER_GPIO_H
+#define FAKE_DRIVER_GPIO_H
+
+#include "../esp_err.h"
+
+typedef int gpio_num_t;
+
+#endif // FAKE_DRIVER_GPIO_H
@@ -0,0 +1,43 @@
+/**
+ * 主机仿真：GAP接口（只包含固件用到的RSSI读取）
+ */
+
+#ifndef FAKE_ESP_GAP_BLE_API_H
+#define FAKE_ESP_GAP_BLE_API_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef uint8_t esp_bd_addr_t[6];
+
+typedef enum {
+  BLE_ADDR_TYPE_PUBLIC = 0x00,
+  BLE_ADDR_TYPE_RANDOM = 0x01,
+  BLE_ADDR_TYPE_RPA_PUBLIC = 0x02,
+  BLE_ADDR_TYPE_RPA_RANDOM = 0x03
+} esp_ble_addr_type_t;
+
+typedef enum {
+  ESP_BT_STATUS_SUCCESS = 0,
+  ESP_BT_STATUS_FAIL = 1
+} esp_bt_status_t;
+
+typedef enum {
+  ESP_GAP_BLE_READ_RSSI_COMPLETE_EVT = 20
+} esp_gap_ble_cb_event_t;
+
+typedef union {
+  struct {
+    esp_bt_status_t status;
+    int8_t rssi;
+    esp_bd_addr_t remote_addr;
+  } read_rssi_cmpl;
+} esp_ble_gap_cb_param_t;
+
+typedef void (*esp_gap_ble_cb_t)(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
+
+// 结果在一次GATT往返之后通过 BLEDevice::setCustomGapHandler() 设置的回调返回
+esp_err_t esp_ble_gap_read_rssi(esp_bd_addr_t remoteAddress);
+esp_err_t esp_ble_gap_set_device_name(const char* name);
+
+#endif // FAKE_ESP_GAP_BLE_API_H
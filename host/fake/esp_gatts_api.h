@@ -0,0 +1,39 @@
+/**
+ * 主机仿真：GATT服务器接口（中继外设用到的部分）
+ */
+
+#ifndef FAKE_ESP_GATTS_API_H
+#define FAKE_ESP_GATTS_API_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_gap_ble_api.h"
+
+typedef uint8_t esp_gatt_if_t;
+
+typedef enum {
+  ESP_GATTS_CONNECT_EVT = 14,
+  ESP_GATTS_DISCONNECT_EVT = 15,
+  ESP_GATTS_CONGEST_EVT = 24
+} esp_gatts_cb_event_t;
+
+typedef union {
+  struct {
+    uint16_t conn_id;
+    esp_bd_addr_t remote_bda;
+  } connect;
+  struct {
+    uint16_t conn_id;
+    esp_bd_addr_t remote_bda;
+    int reason;
+  } disconnect;
+  struct {
+    uint16_t conn_id;
+    bool congested;
+  } congest;
+} esp_ble_gatts_cb_param_t;
+
+esp_err_t esp_ble_gatts_send_indicate(esp_gatt_if_t gattsIf, uint16_t connId, uint16_t attrHandle,
+                                      uint16_t length, uint8_t* value, bool needConfirm);
+
+#endif // FAKE_ESP_GATTS_API_H
@@ -0,0 +1,26 @@
+/**
+ * 主机仿真：堆状态（固定值，仿真只关心 new/delete 次数）
+ */
+
+#ifndef FAKE_ESP_HEAP_CAPS_H
+#define FAKE_ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+typedef struct {
+  size_t total_free_bytes;
+  size_t total_allocated_bytes;
+  size_t largest_free_block;
+  size_t minimum_free_bytes;
+  size_t allocated_blocks;
+  size_t free_blocks;
+  size_t total_blocks;
+} multi_heap_info_t;
+
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t caps);
+
+#endif // FAKE_ESP_HEAP_CAPS_H
@@ -0,0 +1,31 @@
+/**
+ * 主机仿真：深度睡眠
+ * esp_deep_sleep_start() 抛出 SimDeepSleep 结束本次仿真（见 sim_connect.cpp）
+ */
+
+#ifndef FAKE_ESP_SLEEP_H
+#define FAKE_ESP_SLEEP_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+  ESP_SLEEP_WAKEUP_UNDEFINED,
+  ESP_SLEEP_WAKEUP_ALL,
+  ESP_SLEEP_WAKEUP_EXT0,
+  ESP_SLEEP_WAKEUP_EXT1,
+  ESP_SLEEP_WAKEUP_TIMER,
+  ESP_SLEEP_WAKEUP_TOUCHPAD,
+  ESP_SLEEP_WAKEUP_ULP,
+  ESP_SLEEP_WAKEUP_GPIO
+} esp_sleep_wakeup_cause_t;
+
+struct SimDeepSleep {
+  uint64_t atUs;
+};
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause();
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs);
+void esp_deep_sleep_start();
+
+#endif // FAKE_ESP_SLEEP_H
@@ -0,0 +1,38 @@
+/**
+ * 主机仿真：FreeRTOS 类型和临界区
+ * 仿真是单线程的：临界区为空操作，BLE回调在 delay() 推进时钟时于主循环中触发
+ */
+
+#ifndef FAKE_FREERTOS_H
+#define FAKE_FREERTOS_H
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+typedef struct {
+  int owner;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
+
+typedef struct tskTaskControlBlock* TaskHandle_t;
+
+TickType_t xTaskGetTickCount();
+
+#endif // FAKE_FREERTOS_H
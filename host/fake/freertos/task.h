@@ -0,0 +1,21 @@
+/**
+ * 主机仿真：FreeRTOS 任务
+ * 仿真中不创建任务（xTaskCreate 返回失败），固件走不依赖任务的后备路径（主循环中同步刷新显示）
+ */
+
+#ifndef FAKE_FREERTOS_TASK_H
+#define FAKE_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void* parameter);
+
+BaseType_t xTaskCreate(TaskFunction_t entry, const char* name, uint32_t stackDepth,
+                       void* parameter, UBaseType_t priority, TaskHandle_t* handle);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+
+#endif // FAKE_FREERTOS_TASK_H
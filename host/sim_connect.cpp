@@ -0,0 +1,393 @@
+/**
+ * 连接/重连仿真
+ *
+ * 在主机上运行真实的固件（ble_meter.ino 的 setup()/loop() 和 src/ 下的全部模块），
+ * BLE、时钟、串口和NVS由 fake/ 下的仿真层提供。每个场景脚本化传感器的广播、连接延迟、
+ * 服务发现耗时、通知节拍和掉线，在虚拟时钟上运行，给定随机种子时结果完全确定。
+ *
+ * 统计（虚拟时间）：
+ *   首个数据    启动到主循环第一次解析出数据
+ *   重连        掉线到重新建立连接
+ *   重连到数据  掉线到主循环重新解析出数据
+ * 固件中的静态状态（函数内 static 变量、全局对象）无法在一次进程中复位，
+ * 因此每次运行在 fork() 出的子进程中进行，结果通过管道交回
+ *
+ * 用法:
+ *   sim_connect                    所有场景各运行 SIM_SEEDS 个种子，输出汇总
+ *   sim_connect <场景> [种子] [-v]  运行一次并输出连接时间线，-v 同时输出固件的串口日志
+ *   sim_connect --list             列出场景
+ */
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "config.h"
+#include "fake/FakeBLE.h"
+#include "fake/SimBoard.h"
+#include "fake/SimClock.h"
+#include "src/LatencyTracker.h"
+#include "src/StallMonitor.h"
+#include "src/SensorData.h"
+#include "src/SyntheticSensor.h"
+#include <algorithm>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define SIM_SEEDS 20
+#define SIM_LOOP_GUARD 10000000  // 单次运行的最大循环次数（防止固件卡在不推进时钟的循环中）
+
+// 固件入口和全局数据（ble_meter.ino）
+void setup();
+void loop();
+extern SensorData sensorData;
+
+static const char* const SENSOR_A = "e4:5f:01:2a:33:10";
+static const char* const SENSOR_B = "c8:11:7e:90:04:5d";
+
+// ========== 场景 ==========
+
+struct Scenario {
+  const char* name;
+  const char* description;
+  uint32_t durationMs;
+  void (*script)();  // 在 setup() 之前添加传感器、安排事件
+};
+
+static void rememberSensor(const char* address) {
+  Preferences::presetString("ble_meter", "last_device", address);
+}
+
+static void scriptColdKnown() {
+  rememberSensor(SENSOR_A);
+  FakeBLE::addSensor(FakeBLE::defaultSensor(SENSOR_A, "BT003-2"));
+}
+
+static void scriptDropShort() {
+  rememberSensor(SENSOR_A);
+  int sensor = FakeBLE::addSensor(FakeBLE::defaultSensor(SENSOR_A, "BT003-2"));
+  FakeBLE::dropLink(sensor, 40000, 1500);
+}
+
+static void scriptDropLong() {
+  rememberSensor(SENSOR_A);
+  int sensor = FakeBLE::addSensor(FakeBLE::defaultSensor(SENSOR_A, "BT003-2"));
+  FakeBLE::dropLink(sensor, 40000, 12000);
+}
+
+static void scriptSlowSensor() {
+  rememberSensor(SENSOR_A);
+  SimSensorConfig config = FakeBLE::defaultSensor(SENSOR_A, "CSC-SLOW");
+  config.connectLatencyMs = 600;
+  config.discoveryMs = 1800;
+  config.gattRoundTripMs = 120;
+  config.notifyIntervalMs = 2000;
+  int sensor = FakeBLE::addSensor(config);
+  FakeBLE::dropLink(sensor, 40000, 1000);
+}
+
+static void scriptLossy() {
+  rememberSensor(SENSOR_A);
+  SimSensorConfig config = FakeBLE::defaultSensor(SENSOR_A, "BT003-2");
+  config.rssi = -88;
+  config.rssiJitter = 6;
+  config.lossPercent = 10;
+  FakeBLE::addSensor(config);
+}
+
+static void scriptPairing() {
+  // 没有保存的设备：长按BOOT按钮进入匹配模式，扫描到两个传感器，应选中信号强的
+  SimSensorConfig weak = FakeBLE::defaultSensor(SENSOR_B, "CSC-FAR");
+  weak.rssi = -84;
+  FakeBLE::addSensor(weak);
+  SimSensorConfig strong = FakeBLE::defaultSensor(SENSOR_A, "BT003-2");
+  strong.rssi = -58;
+  FakeBLE::addSensor(strong);
+  SimBoard::pressPin(PAIR_BUTTON_GPIO, 4000, BUTTON_PRESS_TIME + 300);
+}
+
+static void scriptPairingCancel() {
+  // 长按进入匹配模式；只有一个信号弱的传感器，扫描不会提前停止，扫描期间再次长按取消：不应连接
+  SimSensorConfig weak = FakeBLE::defaultSensor(SENSOR_B, "CSC-FAR");
+  weak.rssi = -84;
+  FakeBLE::addSensor(weak);
+  SimBoard::pressPin(PAIR_BUTTON_GPIO, 4000, BUTTON_PRESS_TIME + 300);
+  SimBoard::pressPin(PAIR_BUTTON_GPIO, 9000, BUTTON_PRESS_TIME + 300);
+}
+
+static void scriptSynthetic() {
+  // 没有传感器：串口命令启动合成数据源速率扫描（数据包经通知缓冲区进入主循环）
+  SimBoard::sendSerial(3000, "synth sweep");
+}
+
+static const Scenario SCENARIOS[] = {
+  {"cold_known", "冷启动，上次的传感器在范围内", 60000, scriptColdKnown},
+  {"drop_short", "40秒时掉线，1.5秒后回到范围内", 90000, scriptDropShort},
+  {"drop_long", "40秒时掉线，12秒后回到范围内", 90000, scriptDropLong},
+  {"slow_sensor", "连接和服务发现慢、2秒通知间隔的传感器，40秒时掉线1秒", 90000, scriptSlowSensor},
+  {"lossy", "信号弱（-88 dBm），10%通知丢失", 60000, scriptLossy},
+  {"pairing", "没有保存的设备，长按按键匹配，两个候选传感器", 40000, scriptPairing},
+  {"pairing_cancel", "长按进入匹配，扫描期间再次长按取消（不应连接）", 40000, scriptPairingCancel},
+  {"synthetic", "没有传感器，合成数据源速率扫描（1-500 Hz）", 3000 + SYNTHETIC_SWEEP_STEPS * SYNTHETIC_SWEEP_STEP_MS + 2000,
+   scriptSynthetic},
+};
+
+static const size_t SCENARIO_COUNT = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+
+// ========== 单次运行 ==========
+
+struct RunResult {
+  uint32_t seed;
+  bool deepSleep;           // 以深度睡眠结束
+  uint64_t endUs;
+  uint64_t firstDataUs;     // 0 表示没有收到数据
+  uint64_t dropUs;          // 第一次掉线（0 表示没有掉线）
+  uint64_t reconnectUs;     // 掉线后重新建立连接
+  uint64_t reconnectDataUs; // 掉线后重新解析出数据
+  uint32_t connects;
+  uint32_t failedAttempts;
+  uint32_t notifications;
+  uint16_t lossPermille;
+};
+
+static void printTimeline() {
+  for (size_t i = 0; i < FakeBLE::getConnectionCount(); i++) {
+    const SimConnectionRecord& record = FakeBLE::getConnection(i);
+    if (!record.established) {
+      printf("  连接尝试 #%zu: %.3f s 开始，%.3f s 超时失败\n", i + 1, record.attemptUs / 1e6, record.endUs / 1e6);
+      continue;
+    }
+    printf("  连接 #%zu: 尝试 %.3f s, 建立 %.3f s, 订阅 %.3f s, 首个通知 %.3f s, 通知 %u 个",
+           i + 1, record.attemptUs / 1e6, record.connectedUs / 1e6, record.subscribedUs / 1e6,
+           record.firstNotifyUs / 1e6, record.notifications);
+    if (record.endUs) {
+      printf(", %s %.3f s", record.dropped ? "掉线" : "断开", record.endUs / 1e6);
+    }
+    printf("\n");
+  }
+}
+
+// 第一次掉线和之后的重新连接（从仿真层的连接记录取）
+static void observeConnections(RunResult& result) {
+  if (result.dropUs == 0) {
+    for (size_t c = 0; c < FakeBLE::getConnectionCount(); c++) {
+      const SimConnectionRecord& record = FakeBLE::getConnection(c);
+      if (record.dropped) {
+        result.dropUs = record.endUs;
+        break;
+      }
+    }
+  }
+  if (result.dropUs != 0 && result.reconnectUs == 0) {
+    for (size_t c = 0; c < FakeBLE::getConnectionCount(); c++) {
+      const SimConnectionRecord& record = FakeBLE::getConnection(c);
+      if (record.established && record.connectedUs > result.dropUs) {
+        result.reconnectUs = record.connectedUs;
+        break;
+      }
+    }
+  }
+}
+
+static RunResult runScenario(const Scenario& scenario, uint32_t seed, bool timeline, bool verbose) {
+  SimClock::reset(seed);
+  SimBoard::reset();
+  SimBoard::setVerbose(verbose);
+  FakeBLE::reset();
+  Preferences::wipe();
+  scenario.script();
+
+  RunResult result;
+  memset(&result, 0, sizeof(result));
+  result.seed = seed;
+  uint64_t endUs = (uint64_t)scenario.durationMs * 1000;
+  unsigned long lastUpdate = 0;
+  try {
+    setup();
+    for (uint32_t i = 0; i < SIM_LOOP_GUARD && SimClock::now() < endUs; i++) {
+      loop();
+      // 主循环解析出数据时更新 lastUpdateTime（毫秒）
+      if (sensorData.lastUpdateTime != lastUpdate) {
+        lastUpdate = sensorData.lastUpdateTime;
+        uint64_t updateUs = (uint64_t)lastUpdate * 1000;
+        if (result.firstDataUs == 0) {
+          result.firstDataUs = updateUs;
+        }
+        if (result.dropUs != 0 && result.reconnectDataUs == 0 && updateUs > result.dropUs) {
+          result.reconnectDataUs = updateUs;
+        }
+      }
+      observeConnections(result);
+    }
+  } catch (const SimDeepSleep& sleep) {
+    result.deepSleep = true;
+  }
+  observeConnections(result);
+  result.endUs = SimClock::now();
+  for (size_t c = 0; c < FakeBLE::getConnectionCount(); c++) {
+    const SimConnectionRecord& record = FakeBLE::getConnection(c);
+    if (record.established) {
+      result.connects++;
+    } else {
+      result.failedAttempts++;
+    }
+    result.notifications += record.notifications;
+  }
+  result.lossPermille = sensorData.linkLossPermille;
+  fflush(stdout);
+
+  if (timeline) {
+    printf("\n场景 %s（种子 %u）: %s\n", scenario.name, seed, scenario.description);
+    printTimeline();
+    if (result.firstDataUs) {
+      printf("  首个数据: %.3f s\n", result.firstDataUs / 1e6);
+    }
+    if (result.dropUs) {
+      printf("  掉线 %.3f s", result.dropUs / 1e6);
+      if (result.reconnectUs) printf(" → 重连 %.3f s (+%.3f s)", result.reconnectUs / 1e6, (result.reconnectUs - result.dropUs) / 1e6);
+      if (result.reconnectDataUs) printf(" → 数据 %.3f s (+%.3f s)", result.reconnectDataUs / 1e6, (result.reconnectDataUs - result.dropUs) / 1e6);
+      printf("\n");
+    }
+    // 固件自己记录的重连指标（重连流程开始 → 新连接的第一个通知）
+    LatencyHistogram firstNotify;
+    LatencyTracker::snapshot(LATENCY_FIRST_NOTIFY, firstNotify);
+    if (firstNotify.count > 0) {
+      printf("  固件统计 到首个通知: %lu 次，平均 %.3f s，最大 %.3f s\n", (unsigned long)firstNotify.count,
+             firstNotify.totalUs / 1e6 / firstNotify.count, firstNotify.maxUs / 1e6);
+    }
+    printf("  NVS写入: %lu 次\n", (unsigned long)Preferences::getWriteCount());
+    // 主循环卡顿（按区域）
+    StallStats stalls;
+    StallMonitor::snapshot(stalls);
+    printf("  主循环: %lu 次迭代，最长 %lu ms", (unsigned long)stalls.iterations, (unsigned long)stalls.maxMs);
+    for (uint8_t i = 0; i < STALL_REGION_COUNT; i++) {
+      if (stalls.stalls[i] > 0) {
+        printf("，%s卡顿 %lu 次（最长 %lu ms）", StallMonitor::getRegionName((StallRegion)i),
+               (unsigned long)stalls.stalls[i], (unsigned long)stalls.stallMaxMs[i]);
+      }
+    }
+    printf("\n");
+    // 合成数据源速率扫描（每一档的生成/溢出丢弃数）
+    SyntheticRateStats rates[SYNTHETIC_SWEEP_STEPS];
+    uint8_t rateCount = SyntheticSensor::getSweepSteps(rates, SYNTHETIC_SWEEP_STEPS);
+    if (rateCount > 0) {
+      printf("  合成数据源:");
+      for (uint8_t i = 0; i < rateCount; i++) {
+        printf(" %u Hz %lu/%lu", (unsigned)rates[i].rateHz, (unsigned long)rates[i].dropped,
+               (unsigned long)rates[i].generated);
+      }
+      printf("（溢出丢弃/生成），持续速率 %s%u Hz\n", SyntheticSensor::isSustainedRateCapped() ? "不低于 " : "",
+             (unsigned)SyntheticSensor::getSustainedRate());
+    }
+    printf("  结束: %.3f s%s，推断丢包 %.1f%%\n", result.endUs / 1e6, result.deepSleep ? "（进入深度睡眠）" : "",
+           result.lossPermille / 10.0);
+  }
+  return result;
+}
+
+// 在子进程中运行，父进程的固件状态保持初始值
+static bool runIsolated(const Scenario& scenario, uint32_t seed, bool timeline, bool verbose, RunResult& result) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return false;
+  }
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    RunResult childResult = runScenario(scenario, seed, timeline, verbose);
+    ssize_t written = write(fds[1], &childResult, sizeof(childResult));
+    close(fds[1]);
+    _exit(written == (ssize_t)sizeof(childResult) ? 0 : 1);
+  }
+  close(fds[1]);
+  ssize_t received = pid > 0 ? read(fds[0], &result, sizeof(result)) : -1;
+  close(fds[0]);
+  int status = 0;
+  if (pid > 0) {
+    waitpid(pid, &status, 0);
+  }
+  return received == (ssize_t)sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// ========== 汇总 ==========
+
+static void formatStat(char* out, size_t size, uint64_t* values, size_t count, size_t runs) {
+  if (count == 0) {
+    snprintf(out, size, "%-19s", "-");
+    return;
+  }
+  std::sort(values, values + count);
+  int length = snprintf(out, size, "%.2f / %.2f", values[count / 2] / 1e6, values[count - 1] / 1e6);
+  if (count < runs) {
+    snprintf(out + length, size - length, " (%zu次)", count);
+  }
+}
+
+static void summarize(const Scenario& scenario) {
+  uint64_t firstData[SIM_SEEDS], reconnect[SIM_SEEDS], reconnectData[SIM_SEEDS];
+  size_t firstCount = 0, reconnectCount = 0, reconnectDataCount = 0, runs = 0;
+  uint32_t sleeps = 0, failedAttempts = 0;
+  for (uint32_t seed = 1; seed <= SIM_SEEDS; seed++) {
+    RunResult result;
+    if (!runIsolated(scenario, seed, false, false, result)) {
+      printf("%-12s 种子 %u 运行失败\n", scenario.name, seed);
+      continue;
+    }
+    runs++;
+    if (result.firstDataUs) firstData[firstCount++] = result.firstDataUs;
+    if (result.reconnectUs) reconnect[reconnectCount++] = result.reconnectUs - result.dropUs;
+    if (result.reconnectDataUs) reconnectData[reconnectDataCount++] = result.reconnectDataUs - result.dropUs;
+    sleeps += result.deepSleep ? 1 : 0;
+    failedAttempts += result.failedAttempts;
+  }
+  char first[32], again[32], againData[32];
+  formatStat(first, sizeof(first), firstData, firstCount, runs);
+  formatStat(again, sizeof(again), reconnect, reconnectCount, runs);
+  formatStat(againData, sizeof(againData), reconnectData, reconnectDataCount, runs);
+  printf("%-12s %-20s %-20s %-20s %4u/%-4zu %6.1f\n", scenario.name, first, again, againData,
+         sleeps, runs, runs ? (double)failedAttempts / runs : 0.0);
+}
+
+static const Scenario* findScenario(const char* name) {
+  for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+    if (strcmp(SCENARIOS[i].name, name) == 0) {
+      return &SCENARIOS[i];
+    }
+  }
+  return nullptr;
+}
+
+int main(int argc, char** argv) {
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  if (argc >= 2 && strcmp(argv[1], "--list") == 0) {
+    for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+      printf("%-12s %s（%u 秒）\n", SCENARIOS[i].name, SCENARIOS[i].description, SCENARIOS[i].durationMs / 1000);
+    }
+    return 0;
+  }
+
+  if (argc >= 2) {
+    const Scenario* scenario = findScenario(argv[1]);
+    if (scenario == nullptr) {
+      fprintf(stderr, "未知场景: %s（--list 列出场景）\n", argv[1]);
+      return 2;
+    }
+    uint32_t seed = 1;
+    bool verbose = false;
+    for (int i = 2; i < argc; i++) {
+      if (strcmp(argv[i], "-v") == 0) {
+        verbose = true;
+      } else {
+        seed = (uint32_t)strtoul(argv[i], nullptr, 10);
+      }
+    }
+    RunResult result;
+    return runIsolated(*scenario, seed, true, verbose, result) ? 0 : 1;
+  }
+
+  printf("每个场景运行 %d 个种子，时间为虚拟时间（秒，中位数 / 最大值）\n", SIM_SEEDS);
+  printf("%-12s %-20s %-20s %-20s %-9s %s\n", "场景", "首个数据", "掉线→重连", "掉线→数据", "深度睡眠", "连接失败/次");
+  for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+    summarize(SCENARIOS[i]);
+  }
+  return 0;
+}
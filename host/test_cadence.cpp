@@ -0,0 +1,197 @@
+/**
+ * 踏频估算回放测试
+ *
+ * 按BT003-2的5字节数据包（只有曲柄转数）生成通知到达时间序列，逐个交给 CadenceEstimator，
+ * 检查稳定踩踏时估算值的最大误差。通知到达时间的模型：
+ *   曲柄事件之后的下一个连接事件（连接间隔 45 ms，相位随机） + 协议栈延迟 0~3 ms
+ *   重传：部分连接事件没有收到通知，推迟1~3个连接间隔
+ *   批量到达：部分通知在协议栈中滞留，与下一个通知在同一连接事件中相隔约1 ms到达
+ * 曲柄转数从 0xFFF0 开始，每条轨迹都经过16位回绕。误差上限按这个噪声模型推算（见 errorBound）。
+ * 同时输出相邻两个数据包的到达时间差直接计算的踏频误差作为对比（不检查）。
+ * 另有停止踩踏轨迹：停止后传感器每秒发送转数不变的数据包，检查踏频在 CADENCE_WINDOW_MS 之后归零、恢复后重新估算
+ *
+ * 用法: make test（或 build/test_cadence）
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include "src/CadenceEstimator.h"
+
+#define CONNECTION_INTERVAL_US 45000
+#define STACK_DELAY_US 3000
+#define MAX_RETRANSMIT_INTERVALS 3
+#define TIMER_RESOLUTION_US 1     // esp_timer 的分辨率（到达时间取整到微秒）
+#define TRACE_EVENTS 300
+#define WARMUP_EVENTS 10  // 窗口填满之前的估算值不计入误差
+#define STOP_NOTIFY_INTERVAL_US 1000000  // 停止踩踏后传感器仍每秒发送一个数据包
+
+struct Trace {
+  const char* name;
+  float rpm;
+  uint8_t missPercent;   // 通知推迟1~3个连接间隔的概率
+  uint8_t holdPercent;   // 通知滞留到与下一个通知一起到达的概率
+};
+
+static const Trace TRACES[] = {
+  {"60 rpm",         60.0f,  0,  0},
+  {"90 rpm",         90.0f,  0,  0},
+  {"120 rpm",        120.0f, 0,  0},
+  {"60 rpm 重传",    60.0f,  10, 0},
+  {"90 rpm 重传",    90.0f,  10, 0},
+  {"120 rpm 重传",   120.0f, 10, 0},
+  {"60 rpm 批量",    60.0f,  0,  5},
+  {"90 rpm 批量",    90.0f,  0,  5},
+  {"120 rpm 批量",   120.0f, 0,  5},
+};
+static const int TRACE_COUNT = sizeof(TRACES) / sizeof(TRACES[0]);
+
+// 按噪声模型推算的最大误差。每个样本的到达延迟 e 在 [0, J] 内：
+//   J = 连接间隔 + 协议栈延迟的变化范围 + 计时分辨率（重传时再加 3 个连接间隔）
+// 批量到达的前一个通知按前后两个样本插值，延迟是两者的加权平均，仍在 [0, J] 内。
+// 窗口内至少有 n = 1 + floor((窗口时长 - J) / 周期) 个样本（不超过 CADENCE_WINDOW_SAMPLES）。
+// 拟合的周期误差最多为 J × Σ|k - k̄| / 2 / Σ(k - k̄)²（k 为样本序号，延迟全部偏向一端时最大），
+// 到达时间噪声使斜率偏小（回归衰减）最多 (J²/4) × n / (周期² × Σ(k - k̄)²)，两项相加换算为 rpm
+static float errorBound(const Trace& trace) {
+  double periodUs = 60000000.0 / trace.rpm;
+  double jitterUs = CONNECTION_INTERVAL_US + STACK_DELAY_US / 2 + TIMER_RESOLUTION_US;
+  if (trace.missPercent > 0) jitterUs += MAX_RETRANSMIT_INTERVALS * (double)CONNECTION_INTERVAL_US;
+  int n = 1 + (int)floor((CADENCE_WINDOW_MS * 1000.0 - jitterUs) / periodUs);
+  if (n > CADENCE_WINDOW_SAMPLES) n = CADENCE_WINDOW_SAMPLES;
+  double mean = (n - 1) / 2.0;
+  double absSum = 0.0;
+  double squareSum = 0.0;
+  for (int k = 0; k < n; k++) {
+    absSum += fabs(k - mean);
+    squareSum += (k - mean) * (k - mean);
+  }
+  double periodError = jitterUs * absSum / 2.0 / squareSum / periodUs;
+  double attenuation = jitterUs * jitterUs / 4.0 * n / (periodUs * periodUs * squareSum);
+  return (float)(trace.rpm * (periodError / (1.0 - periodError) + attenuation));
+}
+
+// 固定种子的伪随机数，每次运行结果相同
+static uint32_t randomState = 1;
+static uint32_t nextRandom(uint32_t bound) {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState % bound;
+}
+
+struct TraceResult {
+  uint32_t estimates;
+  uint32_t batched;
+  float maxError;
+  float maxNaiveError;
+  uint32_t previousArrivalUs;
+};
+
+static void feed(CadenceEstimator& estimator, const Trace& trace, uint16_t revolutions, uint32_t arrivalUs,
+                 int event, bool measured, TraceResult& result) {
+  if (estimator.addCrankCount(revolutions, arrivalUs) && measured && event >= WARMUP_EVENTS) {
+    float error = fabsf(estimator.getCadence() - trace.rpm);
+    if (error > result.maxError) result.maxError = error;
+    result.estimates++;
+  }
+  if (result.previousArrivalUs != 0 && event >= WARMUP_EVENTS) {
+    float naive = 60000000.0f / (arrivalUs - result.previousArrivalUs);
+    float error = fabsf(naive - trace.rpm);
+    if (error > result.maxNaiveError) result.maxNaiveError = error;
+  }
+  result.previousArrivalUs = arrivalUs;
+}
+
+static bool runTrace(const Trace& trace) {
+  randomState = 0x2545F491;
+  CadenceEstimator estimator;
+  TraceResult result = {};
+  double periodUs = 60000000.0 / trace.rpm;
+  double phaseUs = nextRandom(CONNECTION_INTERVAL_US);
+  double eventUs = 1000000.0;
+  uint16_t revolutions = 0xFFF0;
+  bool wrapped = false;
+  bool held = false;
+
+  for (int i = 0; i < TRACE_EVENTS; i++) {
+    eventUs += periodUs;
+    revolutions++;
+    if (revolutions == 0) wrapped = true;
+
+    // 下一个连接事件，可能推迟几个连接间隔
+    double connectionUs = ceil((eventUs - phaseUs) / CONNECTION_INTERVAL_US) * CONNECTION_INTERVAL_US + phaseUs;
+    if (trace.missPercent > 0 && nextRandom(100) < trace.missPercent) {
+      connectionUs += (1 + nextRandom(3)) * (double)CONNECTION_INTERVAL_US;
+    }
+    uint32_t arrivalUs = (uint32_t)connectionUs + STACK_DELAY_US / 2 + nextRandom(STACK_DELAY_US / 2);
+    if (held) {
+      // 滞留的通知在这个通知之前约1 ms到达。两个通知之间的估算值还没有用到后一个通知的时间，
+      // 主循环同一次处理两个数据包，这个中间值不会显示，不计入误差
+      feed(estimator, trace, (uint16_t)(revolutions - 1), arrivalUs - 1250, i - 1, false, result);
+      result.batched++;
+      held = false;
+    } else if (trace.holdPercent > 0 && i > WARMUP_EVENTS && nextRandom(100) < trace.holdPercent) {
+      held = true;
+      continue;
+    }
+    feed(estimator, trace, revolutions, arrivalUs, i, true, result);
+  }
+
+  float bound = errorBound(trace);
+  bool passed = wrapped && result.estimates >= TRACE_EVENTS / 2 && result.maxError <= bound;
+  printf("%-12s 估算 %3lu 次, 批量到达 %2lu 次, 最大误差 %.2f rpm (上限 %.2f), 两包时间差 %.2f rpm  %s\n",
+         trace.name, (unsigned long)result.estimates, (unsigned long)result.batched, result.maxError,
+         bound, result.maxNaiveError, passed ? "通过" : "失败");
+  return passed;
+}
+
+// 停止踩踏：90 rpm 踩踏后停止，传感器每秒发送转数不变的数据包；之后恢复踩踏
+static bool runStopTrace() {
+  randomState = 0x2545F491;
+  CadenceEstimator estimator;
+  const double periodUs = 60000000.0 / 90.0;
+  uint32_t nowUs = 1000000;
+  uint16_t revolutions = 0xFFF0;
+  for (int i = 0; i < 30; i++) {
+    nowUs += (uint32_t)periodUs + nextRandom(CONNECTION_INTERVAL_US);
+    estimator.addCrankCount(++revolutions, nowUs);
+  }
+  bool pedaling = estimator.getCadence() > 80.0f;
+  uint32_t lastEventUs = nowUs;
+
+  // 窗口时长之内保持最后的踏频，超过窗口时长后的第一个数据包使踏频归零，之后保持为0
+  bool stayedZero = true;
+  uint32_t zeroAfterUs = 0;
+  while (nowUs - lastEventUs < (uint32_t)CADENCE_WINDOW_MS * 1000 + 3 * STOP_NOTIFY_INTERVAL_US) {
+    nowUs += STOP_NOTIFY_INTERVAL_US;
+    estimator.addCrankCount(revolutions, nowUs);
+    if (estimator.getCadence() == 0.0f) {
+      if (zeroAfterUs == 0) zeroAfterUs = nowUs - lastEventUs;
+    } else if (zeroAfterUs != 0) {
+      stayedZero = false;
+    }
+  }
+  bool zeroed = zeroAfterUs > (uint32_t)CADENCE_WINDOW_MS * 1000 &&
+                zeroAfterUs <= (uint32_t)CADENCE_WINDOW_MS * 1000 + STOP_NOTIFY_INTERVAL_US;
+
+  // 恢复踩踏：重新开始估算，CADENCE_MIN_SAMPLES 个曲柄事件后得到踏频
+  for (int i = 0; i < CADENCE_MIN_SAMPLES; i++) {
+    nowUs += (uint32_t)periodUs + nextRandom(CONNECTION_INTERVAL_US);
+    estimator.addCrankCount(++revolutions, nowUs);
+  }
+  bool resumed = estimator.getCadence() > 80.0f;
+
+  bool passed = pedaling && zeroed && stayedZero && resumed;
+  printf("%-12s 停止后 %.1f s 归零（窗口 %.1f s）, 恢复后踏频 %.1f rpm  %s\n", "停止踩踏",
+         zeroAfterUs / 1000000.0, CADENCE_WINDOW_MS / 1000.0, estimator.getCadence(), passed ? "通过" : "失败");
+  return passed;
+}
+
+int main() {
+  int failures = 0;
+  for (int i = 0; i < TRACE_COUNT; i++) {
+    if (!runTrace(TRACES[i])) failures++;
+  }
+  if (!runStopTrace()) failures++;
+  printf("%d/%d 通过\n", TRACE_COUNT + 1 - failures, TRACE_COUNT + 1);
+  return failures == 0 ? 0 : 1;
+}
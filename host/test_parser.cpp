@@ -0,0 +1,115 @@
+/**
+ * CSC解析测试：事件时间重复的数据包
+ *
+ * 数据包速率高于轮子和曲柄的转动时（合成数据源的高速率档位、发送频繁的传感器），连续几个数据包带有相同的
+ * 计数器和事件时间。按BT003-2的11字节 0x03 格式以 200 Hz 生成数据包，经 CSCParser 解析，检查：
+ *   - 踩踏期间速度和踏频不会因为重复的事件时间变为0，且接近实际值
+ *   - 停止后（计数器和事件时间不再变化）CSC_EVENT_HOLD_MS 内保持，之后归零
+ * CSCParser 使用 Serial（PARSER_LOG），与 sim_connect 一样链接 fake/ 下的替代实现
+ *
+ * 用法: make test（或 build/test_parser）
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include <string.h>
+#include "src/CSCParser.h"
+#include "src/SensorData.h"
+
+#define TEST_SPEED_KMH 25.0
+#define TEST_CADENCE_RPM 90.0
+#define PACKET_INTERVAL_US 5000  // 200 Hz
+#define RIDE_US 20000000
+#define WARMUP_US 2000000        // 前两个整圈之前还没有速度
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("失败: %s\n", what);
+    failures++;
+  }
+}
+
+// 计数器和事件时间为最后一次整圈的值（1/1024秒），与 SyntheticSensor 相同
+static void buildPacket(uint64_t eventUs, uint8_t* out) {
+  double seconds = eventUs / 1000000.0;
+  double wheelRps = TEST_SPEED_KMH / 3.6 / (WHEEL_CIRCUMFERENCE_MM / 1000.0);
+  double crankRps = TEST_CADENCE_RPM / 60.0;
+  uint32_t wheel = (uint32_t)(seconds * wheelRps);
+  uint16_t crank = (uint16_t)(seconds * crankRps);
+  uint16_t wheelTime = (uint16_t)(wheel / wheelRps * 1024.0);
+  uint16_t crankTime = (uint16_t)(crank / crankRps * 1024.0);
+  out[0] = 0x03;
+  memcpy(out + 1, &wheel, 4);
+  memcpy(out + 5, &wheelTime, 2);
+  memcpy(out + 7, &crank, 2);
+  memcpy(out + 9, &crankTime, 2);
+}
+
+int main() {
+  CSCParser parser;
+  parser.configure(-1);
+  SensorData data;
+  uint8_t packet[11];
+  uint64_t nowUs = 1000000;  // 到达时间（esp_timer）从1秒开始，0表示未知
+
+  // 踩踏：每个数据包都检查，重复的事件时间不使速度/踏频变为0
+  uint32_t packets = 0;
+  uint32_t zeroSpeed = 0;
+  uint32_t zeroCadence = 0;
+  float maxSpeedError = 0.0f;
+  float maxCadenceError = 0.0f;
+  for (uint64_t t = 0; t < RIDE_US; t += PACKET_INTERVAL_US) {
+    buildPacket(t, packet);
+    parser.parseData(packet, sizeof(packet), data, (uint32_t)(nowUs + t));
+    if (t < WARMUP_US) continue;
+    packets++;
+    if (data.speed == 0.0f) zeroSpeed++;
+    if (data.cadence == 0.0f) zeroCadence++;
+    maxSpeedError = fmaxf(maxSpeedError, fabsf(data.speed - (float)TEST_SPEED_KMH));
+    maxCadenceError = fmaxf(maxCadenceError, fabsf(data.cadence - (float)TEST_CADENCE_RPM));
+  }
+  printf("踩踏: %lu 个数据包, 速度为0 %lu 次, 踏频为0 %lu 次, 最大误差 %.2f km/h, %.2f rpm\n",
+         (unsigned long)packets, (unsigned long)zeroSpeed, (unsigned long)zeroCadence, maxSpeedError,
+         maxCadenceError);
+  check(zeroSpeed == 0, "事件时间重复的数据包使速度变为0");
+  check(zeroCadence == 0, "事件时间重复的数据包使踏频变为0");
+  // 事件时间的分辨率为 1/1024 秒，一圈的时间误差最多 1/1024 秒
+  check(maxSpeedError < 0.1f && maxCadenceError < 0.2f, "速度或踏频与实际值相差过大");
+
+  // 停止：之后的数据包都重复最后一次整圈的计数器和事件时间
+  uint64_t stopUs = RIDE_US;
+  buildPacket(stopUs, packet);
+  // 轮子和曲柄的最后一次整圈时间不同，各自从那时起保持，归零后不再恢复
+  bool stayedZero = true;
+  uint64_t speedZeroUs = 0;
+  uint64_t cadenceZeroUs = 0;
+  for (uint64_t t = stopUs; t < stopUs + 2ULL * CSC_EVENT_HOLD_MS * 1000; t += PACKET_INTERVAL_US) {
+    parser.parseData(packet, sizeof(packet), data, (uint32_t)(nowUs + t));
+    if (data.speed == 0.0f) {
+      if (speedZeroUs == 0) speedZeroUs = t;
+    } else if (speedZeroUs != 0) {
+      stayedZero = false;
+    }
+    if (data.cadence == 0.0f) {
+      if (cadenceZeroUs == 0) cadenceZeroUs = t;
+    } else if (cadenceZeroUs != 0) {
+      stayedZero = false;
+    }
+  }
+  printf("停止: 速度 %.2f s、踏频 %.2f s 后归零（保持时间 %.1f s）\n", (speedZeroUs - stopUs) / 1000000.0,
+         (cadenceZeroUs - stopUs) / 1000000.0, CSC_EVENT_HOLD_MS / 1000.0);
+  check(speedZeroUs != 0 && cadenceZeroUs != 0, "停止后速度或踏频没有归零");
+  check(stayedZero, "速度或踏频归零后又恢复");
+  // 最后一次整圈在停止之前，所以归零不会晚于停止后 CSC_EVENT_HOLD_MS；也不会早于停止后一圈（保持时间远大于一圈）
+  check(speedZeroUs - stopUs <= (uint64_t)CSC_EVENT_HOLD_MS * 1000 + PACKET_INTERVAL_US &&
+            cadenceZeroUs - stopUs <= (uint64_t)CSC_EVENT_HOLD_MS * 1000 + PACKET_INTERVAL_US,
+        "停止后超过保持时间仍未归零");
+  check(speedZeroUs - stopUs >= (uint64_t)CSC_EVENT_HOLD_MS * 1000 - 1000000 &&
+            cadenceZeroUs - stopUs >= (uint64_t)CSC_EVENT_HOLD_MS * 1000 - 1000000,
+        "停止后没有保持到超时就归零");
+
+  printf("%s（%d 项失败）\n", failures == 0 ? "通过" : "失败", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+/**
+ * CSC数据中继测试
+ *
+ * 按BT003-2的通知节拍生成数据包（11字节 0x03：轮转数 + 轮转时间 + 曲柄转数 + 曲柄时间；
+ * 5字节 0x02：轮转时间 + 曲柄转数，没有曲柄时间），经 CSCParser 解析后交给 CSCRelay::forward，
+ * 发送函数换成假的GATT服务器，记录中心设备收到的数据包。检查：
+ *   - 转发的都是标准格式的11字节 0x03 数据包
+ *   - 曲柄转数变化时曲柄时间单调增加（5字节数据包的曲柄时间按本机踏频推算），按转发的数据算出的踏频接近实际踏频
+ *   - 轮转时间只随轮转数一起变化
+ *   - 拥塞时计入 dropped、没有订阅者时计入 skipped，之后转发的数据包带有最新的累计值
+ * CSCRelay 使用 Serial 和 LatencyTracker，与 sim_connect 一样链接 fake/ 下的替代实现
+ *
+ * 用法: make test（或 build/test_relay）
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include <string.h>
+#include "fake/SimClock.h"
+#include "src/CSCParser.h"
+#include "src/CSCRelay.h"
+#include "src/SensorData.h"
+
+#define TEST_CADENCE_RPM 90.0
+#define TEST_WHEEL_RPM 180.0        // 约 25 km/h（2.1 m 轮周长）
+#define NOTIFY_INTERVAL_US 1000000  // BT003-2 每秒一个通知
+#define SHORT_PACKET_EVERY 2        // 每隔一个通知是5字节数据包
+#define CONNECTION_INTERVAL_US 45000
+#define WARMUP_PACKETS 20           // 本机踏频稳定之前（5字节数据包按到达间隔推算曲柄时间）不检查踏频误差
+
+// 假的GATT服务器：按设定的结果应答，记录发出的数据包
+struct FakeGattServer {
+  RelaySendResult mode;
+  uint32_t received;
+  uint8_t last[CSC_RELAY_PACKET_MAX];
+  size_t lastLength;
+  bool haveLast;
+  uint16_t lastCrankRevolutions;
+  uint16_t lastCrankEventTime;
+  uint32_t lastWheelRevolutions;
+  uint16_t lastWheelEventTime;
+  float maxCadenceError;
+};
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("失败: %s\n", what);
+    failures++;
+  }
+}
+
+static uint16_t readUInt16LE(const uint8_t* data) {
+  return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static RelaySendResult fakeSend(void* context, const uint8_t* data, size_t length) {
+  FakeGattServer& server = *(FakeGattServer*)context;
+  if (server.mode != RELAY_SENT) {
+    return server.mode;
+  }
+  server.received++;
+  check(length == 11 && data[0] == 0x03, "转发的数据包不是标准的11字节 0x03 格式");
+  if (length != 11) {
+    return RELAY_SENT;
+  }
+
+  uint32_t wheelRevolutions = data[1] | (data[2] << 8) | (data[3] << 16) | ((uint32_t)data[4] << 24);
+  uint16_t wheelEventTime = readUInt16LE(data + 5);
+  uint16_t crankRevolutions = readUInt16LE(data + 7);
+  uint16_t crankEventTime = readUInt16LE(data + 9);
+  if (server.haveLast) {
+    check(wheelEventTime == server.lastWheelEventTime || wheelRevolutions != server.lastWheelRevolutions,
+          "轮转时间变化而轮转数没有变化");
+    uint16_t revs = crankRevolutions - server.lastCrankRevolutions;
+    uint16_t ticks = crankEventTime - server.lastCrankEventTime;
+    if (revs > 0) {
+      check(ticks > 0 && ticks < 0x8000, "曲柄转数变化而曲柄时间没有增加");
+      float cadence = revs * 60.0f * 1024.0f / ticks;
+      float error = fabsf(cadence - (float)TEST_CADENCE_RPM);
+      if (server.received > WARMUP_PACKETS && error > server.maxCadenceError) server.maxCadenceError = error;
+    } else {
+      check(ticks == 0, "曲柄转数没有变化而曲柄时间变化");
+    }
+  }
+  server.haveLast = true;
+  server.lastWheelRevolutions = wheelRevolutions;
+  server.lastWheelEventTime = wheelEventTime;
+  server.lastCrankRevolutions = crankRevolutions;
+  server.lastCrankEventTime = crankEventTime;
+  memcpy(server.last, data, length);
+  server.lastLength = length;
+  return RELAY_SENT;
+}
+
+// BT003-2 传感器：事件时间为最后一次整圈的时刻（1/1024秒），计数器从接近回绕的值开始
+struct Bt003Sensor {
+  uint32_t packetIndex;
+  uint32_t wheelRevolutions;
+  uint16_t crankRevolutions;
+  uint64_t startUs;
+
+  void build(uint64_t nowUs, uint8_t* out, size_t& length) {
+    double seconds = (nowUs - startUs) / 1000000.0;
+    uint32_t wheelCount = (uint32_t)(seconds * TEST_WHEEL_RPM / 60.0);
+    uint32_t crankCount = (uint32_t)(seconds * TEST_CADENCE_RPM / 60.0);
+    uint16_t wheelTime = (uint16_t)(wheelCount * 60.0 / TEST_WHEEL_RPM * 1024.0 + 0x8000);
+    uint16_t crankTime = (uint16_t)(crankCount * 60.0 / TEST_CADENCE_RPM * 1024.0 + 0xF800);
+    uint32_t wheel = wheelRevolutions + wheelCount;
+    uint16_t crank = (uint16_t)(crankRevolutions + crankCount);
+    if (packetIndex++ % SHORT_PACKET_EVERY == SHORT_PACKET_EVERY - 1) {
+      out[0] = 0x02;
+      memcpy(out + 1, &wheelTime, 2);
+      memcpy(out + 3, &crank, 2);
+      length = 5;
+    } else {
+      out[0] = 0x03;
+      memcpy(out + 1, &wheel, 4);
+      memcpy(out + 5, &wheelTime, 2);
+      memcpy(out + 7, &crank, 2);
+      memcpy(out + 9, &crankTime, 2);
+      length = 11;
+    }
+  }
+};
+
+// 发送 count 个通知，每个都经过解析和中继
+static void run(CSCParser& parser, CSCRelay& relay, Bt003Sensor& sensor, SensorData& data, uint64_t& nowUs,
+                int count) {
+  for (int i = 0; i < count; i++) {
+    nowUs += NOTIFY_INTERVAL_US + SimClock::random(CONNECTION_INTERVAL_US);
+    uint8_t packet[11];
+    size_t length = 0;
+    sensor.build(nowUs, packet, length);
+    parser.parseData(packet, length, data, (uint32_t)nowUs);
+    relay.forward(data, (uint32_t)nowUs);
+  }
+}
+
+int main() {
+  SimClock::reset(1);
+  FakeGattServer server = {};
+  server.mode = RELAY_SENT;
+  CSCParser parser;
+  parser.configure(-1);  // BT003-2 不提供CSC Feature
+  CSCRelay relay;
+  relay.begin(fakeSend, &server);
+  Bt003Sensor sensor = {0, 0xFFFFFF00, 0xFFF0, 0};
+  SensorData data;
+  uint64_t nowUs = 0;
+
+  // 正常转发：曲柄计数器经过16位回绕
+  run(parser, relay, sensor, data, nowUs, 60);
+  printf("正常转发: 转发 %lu, 收到 %lu, 踏频最大误差 %.1f rpm\n", (unsigned long)relay.getForwarded(),
+         (unsigned long)server.received, server.maxCadenceError);
+  check(relay.getForwarded() == 60 && server.received == 60, "正常转发时数据包数量不对");
+  check(relay.getDropped() == 0 && relay.getSkipped() == 0, "正常转发时有丢弃或跳过");
+  check(server.maxCadenceError < 1.0f, "按转发数据算出的踏频与实际踏频相差超过1 rpm");
+
+  // 拥塞：全部丢弃，不排队
+  server.mode = RELAY_CONGESTED;
+  run(parser, relay, sensor, data, nowUs, 7);
+  printf("拥塞: 丢弃 %lu\n", (unsigned long)relay.getDropped());
+  check(relay.getDropped() == 7 && relay.getForwarded() == 60, "拥塞时的 dropped 计数不对");
+
+  // 没有订阅者
+  server.mode = RELAY_NO_SUBSCRIBER;
+  run(parser, relay, sensor, data, nowUs, 5);
+  printf("没有订阅者: 跳过 %lu\n", (unsigned long)relay.getSkipped());
+  check(relay.getSkipped() == 5 && relay.getDropped() == 7 && relay.getForwarded() == 60,
+        "没有订阅者时的 skipped 计数不对");
+
+  // 恢复后第一个数据包带有最新的累计值
+  server.mode = RELAY_SENT;
+  server.haveLast = false;
+  run(parser, relay, sensor, data, nowUs, 1);
+  check(server.received == 61, "恢复后没有转发");
+  check(readUInt16LE(server.last + 7) == data.crankRevolutions &&
+        (server.last[1] | (server.last[2] << 8) | (server.last[3] << 16) | ((uint32_t)server.last[4] << 24)) ==
+        data.wheelRevolutions, "恢复后转发的不是最新的累计值");
+  run(parser, relay, sensor, data, nowUs, 20);
+  check(server.received == 81, "恢复后的数据包数量不对");
+
+  printf("%s（%d 项失败）\n", failures == 0 ? "通过" : "失败", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+/**
+ * BLE广播数据解析实现
+ *
+ * 广播负载由若干AD结构组成: [长度][类型][数据...]，长度字节包含类型字节，长度为0表示负载结束
+ * 128位UUID在广播中按小端序存放，蓝牙基础UUID 0000xxxx-0000-1000-8000-00805F9B34FB
+ * 的16位部分位于第12、13字节
+ */
+
+#include "AdvParser.h"
+#include <string.h>
+
+// 蓝牙基础UUID（小端序，第12-15字节为 16/32位UUID 部分）
+static const uint8_t BASE_UUID128_LE[12] = {
+  0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00
+};
+
+static inline uint16_t readUInt16LE(const uint8_t* data) {
+  return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+const uint8_t* AdvParser::findField(const uint8_t* payload, size_t length, uint8_t type, uint8_t* dataLength) {
+  size_t index = 0;
+  while (index < length) {
+    uint8_t fieldLength = payload[index];
+    if (fieldLength == 0 || index + 1 + fieldLength > length) {
+      break;  // 负载结束或AD结构被截断
+    }
+    if (payload[index + 1] == type) {
+      *dataLength = fieldLength - 1;
+      return payload + index + 2;
+    }
+    index += 1 + fieldLength;
+  }
+  return nullptr;
+}
+
+bool AdvParser::isBaseUUID128(const uint8_t* uuid, uint16_t uuid16) {
+  return memcmp(uuid, BASE_UUID128_LE, sizeof(BASE_UUID128_LE)) == 0 &&
+         readUInt16LE(uuid + 12) == uuid16 &&
+         uuid[14] == 0x00 && uuid[15] == 0x00;
+}
+
+AdvUUIDMatch AdvParser::findService16(const uint8_t* payload, size_t length, uint16_t uuid16) {
+  if (payload == nullptr) {
+    return ADV_MATCH_NONE;
+  }
+
+  // 单次遍历所有AD结构，同一类型可能出现多次（例如广播包和扫描响应拼接）
+  size_t index = 0;
+  while (index < length) {
+    uint8_t fieldLength = payload[index];
+    if (fieldLength == 0 || index + 1 + fieldLength > length) {
+      break;
+    }
+    uint8_t type = payload[index + 1];
+    const uint8_t* data = payload + index + 2;
+    uint8_t dataLength = fieldLength - 1;
+
+    switch (type) {
+      case AD_TYPE_UUID16_INCOMPLETE:
+      case AD_TYPE_UUID16_COMPLETE:
+        for (uint8_t i = 0; i + 2 <= dataLength; i += 2) {
+          if (readUInt16LE(data + i) == uuid16) return ADV_MATCH_UUID16;
+        }
+        break;
+      case AD_TYPE_UUID128_INCOMPLETE:
+      case AD_TYPE_UUID128_COMPLETE:
+        for (uint8_t i = 0; i + 16 <= dataLength; i += 16) {
+          if (isBaseUUID128(data + i, uuid16)) return ADV_MATCH_UUID128;
+        }
+        break;
+      case AD_TYPE_SERVICE_DATA16:
+        if (dataLength >= 2 && readUInt16LE(data) == uuid16) return ADV_MATCH_SERVICE_DATA;
+        break;
+      case AD_TYPE_SERVICE_DATA128:
+        if (dataLength >= 16 && isBaseUUID128(data, uuid16)) return ADV_MATCH_SERVICE_DATA;
+        break;
+      default:
+        break;
+    }
+    index += 1 + fieldLength;
+  }
+  return ADV_MATCH_NONE;
+}
+
+size_t AdvParser::copyName(const uint8_t* payload, size_t length, char* name, size_t nameSize) {
+  if (payload == nullptr || nameSize == 0) {
+    return 0;
+  }
+
+  uint8_t dataLength = 0;
+  const uint8_t* data = findField(payload, length, AD_TYPE_NAME_COMPLETE, &dataLength);
+  if (data == nullptr) {
+    data = findField(payload, length, AD_TYPE_NAME_SHORT, &dataLength);
+  }
+  if (data == nullptr) {
+    name[0] = '\0';
+    return 0;
+  }
+
+  size_t copyLength = dataLength < nameSize - 1 ? dataLength : nameSize - 1;
+  memcpy(name, data, copyLength);
+  name[copyLength] = '\0';
+  return copyLength;
+}
+
+const char* AdvParser::matchName(AdvUUIDMatch match) {
+  switch (match) {
+    case ADV_MATCH_UUID16:       return "16位UUID";
+    case ADV_MATCH_UUID128:      return "128位UUID";
+    case ADV_MATCH_SERVICE_DATA: return "服务数据";
+    default:                     return "无";
+  }
+}
@@ -0,0 +1,47 @@
+/**
+ * BLE广播数据解析
+ * 直接遍历原始广播负载中的AD结构（长度 + 类型 + 数据），用整数比较和 memcmp 匹配服务UUID，
+ * 不构造 BLEUUID / String 对象，扫描时对每个广播设备都不产生堆分配
+ */
+
+#ifndef ADV_PARSER_H
+#define ADV_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// AD结构类型（Bluetooth Core Supplement, Part A, Section 1）
+#define AD_TYPE_UUID16_INCOMPLETE   0x02
+#define AD_TYPE_UUID16_COMPLETE     0x03
+#define AD_TYPE_UUID128_INCOMPLETE  0x06
+#define AD_TYPE_UUID128_COMPLETE    0x07
+#define AD_TYPE_NAME_SHORT          0x08
+#define AD_TYPE_NAME_COMPLETE       0x09
+#define AD_TYPE_SERVICE_DATA16      0x16
+#define AD_TYPE_SERVICE_DATA128     0x21
+
+// 服务UUID在广播中的出现位置（用于调试输出）
+enum AdvUUIDMatch {
+  ADV_MATCH_NONE = 0,
+  ADV_MATCH_UUID16,        // 16位UUID列表
+  ADV_MATCH_UUID128,       // 128位UUID列表（蓝牙基础UUID + 16位UUID）
+  ADV_MATCH_SERVICE_DATA   // 服务数据
+};
+
+class AdvParser {
+public:
+  // 在广播负载中查找16位服务UUID（同时匹配基础UUID形式的128位UUID和服务数据）
+  static AdvUUIDMatch findService16(const uint8_t* payload, size_t length, uint16_t uuid16);
+
+  // 复制设备名称（完整名称优先，其次缩写名称）到 name，返回名称长度，无名称返回0
+  static size_t copyName(const uint8_t* payload, size_t length, char* name, size_t nameSize);
+
+  static const char* matchName(AdvUUIDMatch match);
+
+private:
+  // 查找指定类型的AD结构，返回数据起始位置，dataLength 为数据长度（不含类型字节）
+  static const uint8_t* findField(const uint8_t* payload, size_t length, uint8_t type, uint8_t* dataLength);
+  static bool isBaseUUID128(const uint8_t* uuid, uint16_t uuid16);
+};
+
+#endif // ADV_PARSER_H
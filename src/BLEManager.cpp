@@ -3,6 +3,11 @@
  */
 
 #include "BLEManager.h"
+#include "AdvParser.h"
+#include "LatencyTracker.h"
+#include "LinkMonitor.h"
+#include "Settings.h"
+#include "StallMonitor.h"
 #include <Arduino.h>
 #include <string.h>
 #include <stdlib.h>
@@ -10,9 +15,32 @@
 
 // 静态成员变量定义
 BLEManager* BLEManager::instance = nullptr;
-uint8_t* BLEManager::cscDataBuffer = nullptr;
-size_t BLEManager::cscDataLength = 0;
-size_t BLEManager::lastReadDataLength = 0;
+MeasurementSlot BLEManager::packetRing[MEASUREMENT_RING_SLOTS];
+MeasurementRoute BLEManager::routes[MEASUREMENT_ROUTE_SLOTS];
+uint8_t BLEManager::ringHead = 0;
+uint8_t BLEManager::ringTail = 0;
+uint32_t BLEManager::packetsDropped = 0;
+portMUX_TYPE BLEManager::ringLock = portMUX_INITIALIZER_UNLOCKED;
+volatile int8_t BLEManager::latestBatteryLevel = -1;
+uint32_t BLEManager::reconnectStartUs = 0;
+volatile bool BLEManager::awaitingFirstNotify = false;
+
+// 扫描回调：每收到一个广播（包括重复广播）调用一次，在BLE任务中运行
+class CandidateScanCallbacks : public BLEAdvertisedDeviceCallbacks {
+  void onResult(BLEAdvertisedDevice advertisedDevice) override {
+    if (BLEManager::instance) {
+      BLEManager::instance->onScanResult(advertisedDevice);
+    }
+  }
+};
+
+static CandidateScanCallbacks scanCallbacks;
+
+// 把BLE地址格式化为 "aa:bb:cc:dd:ee:ff"（与 BLEAddress::toString() 相同，但不分配堆内存）
+static void formatAddress(BLEAddress& address, char* out) {
+  const uint8_t* mac = (const uint8_t*)address.getNative();
+  snprintf(out, 18, "%02x:%02x:%02x:%02x:%02x:%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
 
 BLEManager::BLEManager() {
   pBLEScan = nullptr;
@@ -20,11 +48,24 @@ BLEManager::BLEManager() {
   pCSCMeasurement = nullptr;
   pCSCControlPoint = nullptr;
   pBatteryLevel = nullptr;
-  deviceFound = false;
-  foundDevice = nullptr;
+  connectedAddress[0] = '\0';
+  deviceName[0] = '\0';
+  scanRssi = 0;
+  cscFeature = -1;
+  memset(candidates, 0, sizeof(candidates));
+  scanPreferredAddress[0] = '\0';
+  scanDecided = false;
+  scanComplete = false;
+  scanLock = portMUX_INITIALIZER_UNLOCKED;
+  pollCursor = 0;
+  lastPollMs = 0;
+  batteryNotifying = false;
+  lastBatteryReadMs = 0;
+  reconnectAddress[0] = '\0';
+  reconnectAttempts = 0;
+  reconnectStartMs = 0;
+  nextReconnectMs = 0;
   instance = this;
-  cscDataBuffer = nullptr;
-  cscDataLength = 0;
 }
 
 BLEManager::~BLEManager() {
@@ -44,111 +85,129 @@ bool BLEManager::begin() {
   pBLEScan->setActiveScan(true);
   pBLEScan->setInterval(100);
   pBLEScan->setWindow(99);
+  // 接收重复广播：同一设备的多次广播用于平滑RSSI和判断信号是否稳定
+  pBLEScan->setAdvertisedDeviceCallbacks(&scanCallbacks, true);
+  // 连接后的RSSI读取结果在GAP事件中返回（见 requestRSSI）
+  BLEDevice::setCustomGapHandler(gapEventHandler);
   
   pClient = BLEDevice::createClient();
   
-  // 初始化Preferences用于保存设备地址
-  preferences.begin("ble_meter", false);
-  
   return true;
 }
 
-bool BLEManager::scanAndConnect() {
-  deviceFound = false;
-  if (foundDevice) {
-    delete foundDevice;
-    foundDevice = nullptr;
+void BLEManager::beginReconnect(const char* address) {
+  // 优先使用指定地址（热恢复），其次是刚断开的设备，都没有时读取保存的地址
+  if (address == nullptr || address[0] == '\0') {
+    address = connectedAddress;
   }
-  
-  // 首先尝试连接上次保存的设备（快速连接）
-  // 减少输出频率，避免刷屏
-  static unsigned long lastConnectAttempt = 0;
-  static unsigned long lastFailMessage = 0;
-  bool shouldOutput = (millis() - lastConnectAttempt > 5000);  // 每5秒输出一次
-  
-  if (shouldOutput) {
-    Serial.println("尝试连接上次的设备...");
-    lastConnectAttempt = millis();
+  if (address[0] == '\0') {
+    address = loadLastDeviceAddress();
+  }
+  strncpy(reconnectAddress, address, sizeof(reconnectAddress) - 1);
+  reconnectAddress[sizeof(reconnectAddress) - 1] = '\0';
+  reconnectAttempts = 0;
+  reconnectStartMs = millis();
+  nextReconnectMs = reconnectStartMs;  // 立即尝试
+  reconnectStartUs = LatencyTracker::now();
+  awaitingFirstNotify = reconnectAddress[0] != '\0';
+  if (reconnectAddress[0] == '\0') {
+    Serial.println("没有保存的设备");
+    Serial.println("提示: 长按匹配按键（BOOT按钮）进入匹配模式");
+  }
+}
+
+bool BLEManager::reconnect() {
+  if (isConnected()) {
+    return true;
+  }
+  if (reconnectAddress[0] == '\0' || (long)(millis() - nextReconnectMs) < 0) {
+    return false;
   }
   
-  if (connectToLastDevice()) {
-    Serial.println("✓ 快速连接到上次的设备成功！");
-    lastFailMessage = 0;  // 重置失败消息计时
+  reconnectAttempts++;
+  Serial.printf("直接连接上次的设备: %s（第 %u 次）\n", reconnectAddress, reconnectAttempts);
+  if (connectToAddress(reconnectAddress)) {
+    Serial.printf("重连成功，用时 %lu ms\n", millis() - reconnectStartMs);
     return true;
   }
   
-  // 快速连接失败，不自动扫描
-  // 减少失败消息的输出频率
-  if (shouldOutput && (millis() - lastFailMessage > 10000)) {  // 每10秒输出一次失败消息
-    Serial.println("上次的设备不可用");
-    Serial.println("提示: 长按匹配按键（BOOT按钮）进入匹配模式");
-    lastFailMessage = millis();
+  // 指数退避，随机抖动避免每次都在传感器广播间隔的同一相位尝试
+  uint8_t shift = reconnectAttempts - 1 < 15 ? reconnectAttempts - 1 : 15;
+  uint32_t backoffMs = (uint32_t)BLE_RECONNECT_BACKOFF_MIN_MS << shift;
+  if (backoffMs > BLE_RECONNECT_BACKOFF_MAX_MS) {
+    backoffMs = BLE_RECONNECT_BACKOFF_MAX_MS;
   }
+  long jitterMs = (long)backoffMs * BLE_RECONNECT_JITTER_PERCENT / 100;
+  backoffMs += random(-jitterMs, jitterMs + 1);
+  nextReconnectMs = millis() + backoffMs;
+  Serial.printf("连接失败，%lu ms 后重试\n", (unsigned long)backoffMs);
   return false;
 }
 
-bool BLEManager::scanAndConnectForced() {
-  deviceFound = false;
-  if (foundDevice) {
-    delete foundDevice;
-    foundDevice = nullptr;
-  }
-  
+bool BLEManager::hasReconnectTarget() {
+  return reconnectAddress[0] != '\0';
+}
+
+unsigned long BLEManager::getDisconnectedMs() {
+  return millis() - reconnectStartMs;
+}
+
+bool BLEManager::scanAndConnectForced(bool (*cancelRequested)()) {
   Serial.println("=== 进入匹配模式 ===");
   Serial.println("开始扫描CSC传感器...");
   
-  // 开始扫描（返回指针）
-  BLEScanResults* foundDevices = pBLEScan->start(BLE_SCAN_TIMEOUT / 1000, false);
-  
-  if (foundDevices == nullptr) {
-    Serial.println("扫描失败");
-    return false;
-  }
-  
-  Serial.printf("扫描到 %d 个设备\n", foundDevices->getCount());
-  
-  // 获取上次保存的设备地址（优先连接）
-  String lastAddress = loadLastDeviceAddress();
-  bool foundLastDevice = false;
-  
-  // 查找CSC设备
-  for (int i = 0; i < foundDevices->getCount(); i++) {
-    BLEAdvertisedDevice device = foundDevices->getDevice(i);
-    
-    // 打印设备信息用于调试
-    Serial.printf("设备 %d: 地址=%s", i, device.getAddress().toString().c_str());
-    if (device.haveName()) {
-      Serial.printf(", 名称=%s", device.getName().c_str());
+  // 获取上次保存的设备地址（扫描到即停止并优先连接）
+  const char* lastAddress = loadLastDeviceAddress();
+  awaitingFirstNotify = false;  // 匹配不是重连，不统计到首个通知的时间
+  
+  portENTER_CRITICAL(&scanLock);
+  memset(candidates, 0, sizeof(candidates));
+  strncpy(scanPreferredAddress, lastAddress, sizeof(scanPreferredAddress) - 1);
+  scanPreferredAddress[sizeof(scanPreferredAddress) - 1] = '\0';
+  scanDecided = false;
+  scanComplete = false;
+  portEXIT_CRITICAL(&scanLock);
+  
+  // 非阻塞扫描：广播在回调中逐个评估，找到信号强且稳定的候选设备后立即停止，
+  // 不必等待整个扫描超时
+  unsigned long scanStart = millis();
+  {
+    StallScope scope(STALL_REGION_SCAN);
+    if (!pBLEScan->start(BLE_SCAN_TIMEOUT / 1000, scanCompleteCallback, false)) {
+      Serial.println("扫描失败");
+      return false;
     }
-    Serial.println();
-    
-    // 检查是否为CSC设备
-    if (isCSCDevice(device)) {
-      // 如果是上次的设备，优先连接
-      if (lastAddress.length() > 0 && device.getAddress().toString() == lastAddress) {
-        Serial.println("找到上次连接的CSC传感器，优先连接！");
-        foundDevice = new BLEAdvertisedDevice(device);
-        deviceFound = true;
-        foundLastDevice = true;
-        break;
-      }
-      
-      // 如果是新设备，先保存，等遍历完再决定
-      if (!foundLastDevice) {
-        Serial.println("找到CSC传感器！");
-        foundDevice = new BLEAdvertisedDevice(device);
-        deviceFound = true;
+    while (!scanDecided && !scanComplete && millis() - scanStart < BLE_SCAN_TIMEOUT + 500) {
+      if (cancelRequested && cancelRequested()) {
+        pBLEScan->stop();
+        pBLEScan->clearResults();
+        Serial.printf("扫描已取消（%lu ms）\n", millis() - scanStart);
+        return false;
       }
+      delay(10);
+    }
+    pBLEScan->stop();
+    pBLEScan->clearResults();
+  }
+  unsigned long scanTime = millis() - scanStart;
+  
+  int8_t best = selectCandidate();
+  Serial.printf("扫描用时 %lu ms%s\n", scanTime, scanDecided ? "（提前停止）" : "");
+  for (uint8_t i = 0; i < SCAN_CANDIDATE_SLOTS; i++) {
+    if (candidates[i].used) {
+      Serial.printf("候选 %d: 地址=%s, 名称=%s, RSSI=%.1f dBm, 广播 %d 次%s\n",
+                    i, candidates[i].address, candidates[i].name, candidates[i].rssi,
+                    candidates[i].seen, (i == best) ? " <- 选中" : "");
     }
   }
   
-  pBLEScan->clearResults();
-  
-  if (deviceFound && foundDevice) {
-    bool connected = connectToServer();
+  if (best >= 0 && cancelRequested && cancelRequested()) {
+    Serial.println("匹配已取消，不连接");
+    return false;
+  }
+  if (best >= 0) {
+    bool connected = connectToServer(candidates[best]);
     if (connected) {
-      // 连接成功，保存设备地址
-      saveLastDeviceAddress(foundDevice->getAddress());
       Serial.println("=== 匹配成功，已保存设备地址 ===");
     }
     return connected;
@@ -158,167 +217,439 @@ bool BLEManager::scanAndConnectForced() {
   return false;
 }
 
-bool BLEManager::connectToServer() {
-  if (!foundDevice) {
-    return false;
+void BLEManager::scanCompleteCallback(BLEScanResults /*results*/) {
+  if (instance) {
+    instance->scanComplete = true;
+  }
+}
+
+void BLEManager::onScanResult(BLEAdvertisedDevice& device) {
+  if (scanDecided) {
+    return;
+  }
+  // 先用原始广播数据过滤，非CSC设备不做任何其他处理
+  if (AdvParser::findService16(device.getPayload(), device.getPayloadLength(), CSC_SERVICE_UUID16) == ADV_MATCH_NONE) {
+    return;
   }
   
-  Serial.print("连接到设备: ");
-  Serial.println(foundDevice->getAddress().toString().c_str());
-  
-  if (pClient->connect(foundDevice)) {
-    Serial.println("已连接到服务器");
-    
-    // 尝试获取CSC服务（先尝试标准UUID，再尝试完整UUID）
-    BLERemoteService* pRemoteService = pClient->getService(BLEUUID(CSC_SERVICE_UUID));
-    if (pRemoteService == nullptr) {
-      Serial.println("尝试使用完整UUID...");
-      pRemoteService = pClient->getService(BLEUUID(CSC_SERVICE_UUID_FULL));
+  char address[18];
+  BLEAddress bleAddress = device.getAddress();
+  formatAddress(bleAddress, address);
+  int8_t rssi = device.haveRSSI() ? device.getRSSI() : -127;
+  
+  portENTER_CRITICAL(&scanLock);
+  // 查找已有候选，否则占用空位；表满时只有信号比最弱的候选更强才替换（上次的设备总是替换）
+  ScanCandidate* candidate = nullptr;
+  ScanCandidate* weakest = nullptr;
+  for (uint8_t i = 0; i < SCAN_CANDIDATE_SLOTS; i++) {
+    ScanCandidate* slot = &candidates[i];
+    if (slot->used && strcmp(slot->address, address) == 0) {
+      candidate = slot;
+      break;
     }
-    
-    // 如果还是找不到，尝试遍历所有服务查找CSC特征值
-    if (pRemoteService == nullptr && AUTO_DETECT_CSC_DEVICE) {
-      Serial.println("遍历所有服务查找CSC特征值...");
-      // 注意：ESP32 BLE库的getServices()可能返回不同的类型
-      // 这里先注释掉，如果标准UUID都找不到，可以手动指定服务UUID
-      // 或者通过设备名称等其他方式识别
+    if (!slot->used) {
+      if (!weakest || weakest->used) weakest = slot;
+    } else if (!weakest || (weakest->used && slot->rssi < weakest->rssi)) {
+      weakest = slot;
     }
-    
-    if (pRemoteService == nullptr) {
-      Serial.println("未找到CSC服务");
-      pClient->disconnect();
-      return false;
+  }
+  bool preferred = scanPreferredAddress[0] != '\0' && strcasecmp(address, scanPreferredAddress) == 0;
+  if (!candidate && weakest->used && rssi <= weakest->rssi && !preferred) {
+    portEXIT_CRITICAL(&scanLock);
+    return;
+  }
+  if (!candidate) {
+    candidate = weakest;
+    memset(candidate, 0, sizeof(ScanCandidate));
+    candidate->used = true;
+    strcpy(candidate->address, address);
+    candidate->addressType = device.getAddressType();
+    candidate->rssi = rssi;
+    candidate->firstSeenMs = millis();
+  } else {
+    // 指数平滑，抑制单次广播的RSSI波动
+    candidate->rssi += (rssi - candidate->rssi) * BLE_SCAN_RSSI_SMOOTHING;
+  }
+  if (candidate->seen < 255) {
+    candidate->seen++;
+  }
+  if (candidate->name[0] == '\0') {
+    AdvParser::copyName(device.getPayload(), device.getPayloadLength(), candidate->name, sizeof(candidate->name));
+  }
+  
+  // 提前停止条件：扫描到上次的设备；或者候选信号足够强、已稳定，且明显强于其他候选
+  bool decided = false;
+  if (preferred) {
+    decided = true;
+  } else if (candidate->seen >= BLE_SCAN_STABLE_SAMPLES && candidate->rssi >= BLE_SCAN_STRONG_RSSI) {
+    decided = true;
+    for (uint8_t i = 0; i < SCAN_CANDIDATE_SLOTS; i++) {
+      if (&candidates[i] != candidate && candidates[i].used &&
+          candidates[i].rssi > candidate->rssi - BLE_SCAN_RSSI_MARGIN) {
+        decided = false;
+        break;
+      }
     }
-    
-    // 获取Measurement特征值（尝试多种UUID格式）
-    pCSCMeasurement = pRemoteService->getCharacteristic(BLEUUID(CSC_MEASUREMENT_UUID));
-    if (pCSCMeasurement == nullptr) {
-      Serial.println("尝试使用完整UUID获取Measurement特征值...");
-      pCSCMeasurement = pRemoteService->getCharacteristic(BLEUUID(CSC_MEASUREMENT_UUID_FULL));
+  }
+  if (decided) {
+    scanDecided = true;
+  }
+  portEXIT_CRITICAL(&scanLock);
+}
+
+int8_t BLEManager::selectCandidate() {
+  int8_t best = -1;
+  for (uint8_t i = 0; i < SCAN_CANDIDATE_SLOTS; i++) {
+    if (!candidates[i].used) continue;
+    // 上次的设备优先
+    if (scanPreferredAddress[0] != '\0' && strcasecmp(candidates[i].address, scanPreferredAddress) == 0) {
+      return i;
     }
-    
-    if (pCSCMeasurement == nullptr) {
-      Serial.println("未找到Measurement特征值");
-      pClient->disconnect();
-      return false;
+    if (best < 0 || candidates[i].rssi > candidates[best].rssi) {
+      best = i;
     }
+  }
+  return best;
+}
+
+bool BLEManager::connectToServer(const ScanCandidate& candidate) {
+  Serial.print("连接到设备: ");
+  Serial.println(candidate.address);
+  
+  if (!setupLink(candidate.address, candidate.addressType)) {
+    return false;
+  }
+  
+  // 连接成功，保存设备地址、名称和扫描时的信号强度
+  Settings::rememberDevice(candidate.address, candidate.addressType, candidate.name);
+  Serial.printf("已保存设备地址: %s\n", candidate.address);
+  strcpy(connectedAddress, candidate.address);
+  strcpy(deviceName, candidate.name);
+  scanRssi = (int8_t)candidate.rssi;
+  
+  Serial.println("CSC服务连接成功，等待数据...");
+  return true;
+}
+
+// 连接 → 服务发现 → 订阅，扫描后连接和直接连接共用
+// CSC测量一找到就订阅，之后的特征值读取、其他服务的发现期间通知已经开始到达（进入环形缓冲区）
+bool BLEManager::setupLink(const char* address, uint8_t addressType) {
+  StallScope scope(STALL_REGION_CONNECT);
+  if (!pClient->connect(BLEAddress(address), addressType)) {
+    Serial.println("连接失败，设备可能不在范围内");
+    return false;
+  }
+  Serial.println("已连接，发现服务...");
+  
+  // 尝试获取CSC服务（先尝试标准UUID，再尝试完整UUID）
+  BLERemoteService* pRemoteService = pClient->getService(BLEUUID(CSC_SERVICE_UUID));
+  if (pRemoteService == nullptr) {
+    pRemoteService = pClient->getService(BLEUUID(CSC_SERVICE_UUID_FULL));
+  }
+  if (pRemoteService == nullptr) {
+    Serial.println("未找到CSC服务，断开连接");
+    pClient->disconnect();
+    return false;
+  }
+  
+  // 获取Measurement特征值（尝试多种UUID格式）
+  pCSCMeasurement = pRemoteService->getCharacteristic(BLEUUID(CSC_MEASUREMENT_UUID));
+  if (pCSCMeasurement == nullptr) {
+    pCSCMeasurement = pRemoteService->getCharacteristic(BLEUUID(CSC_MEASUREMENT_UUID_FULL));
+  }
+  if (pCSCMeasurement == nullptr) {
+    Serial.println("未找到Measurement特征值，断开连接");
+    pClient->disconnect();
+    return false;
+  }
+  
+  // 订阅通知（新连接重新开始链路统计）
+  resetPacketRing();
+  LinkMonitor::reset();
+  clearRoutes();
+  subscribeMeasurement(pCSCMeasurement, MEASUREMENT_CSC);
+  
+  // 以下步骤都不影响第一个CSC数据包
+  subscribeOptionalMeasurements();
+  
+  // 获取Control Point特征值（可选）
+  pCSCControlPoint = pRemoteService->getCharacteristic(BLEUUID(CSC_CONTROL_POINT_UUID));
+  
+  // 重连同一个设备时沿用上次读取的CSC Feature，省去一次读取往返
+  if (cscFeature >= 0 && strcasecmp(connectedAddress, address) == 0) {
+    Serial.printf("沿用CSC Feature: 0x%04lX\n", (unsigned long)cscFeature);
+  } else {
+    readCSCFeature(pRemoteService);
+  }
+  
+  // 尝试获取电池服务（Battery Service, UUID: 0x180F）
+  subscribeBattery(pClient->getService(BLEUUID((uint16_t)0x180F)));
+  return true;
+}
+
+void BLEManager::notifyCallback(
+  BLERemoteCharacteristic* pBLERemoteCharacteristic,
+  uint8_t* pData,
+  size_t length,
+  bool /*isNotify*/
+) {
+  if (instance && length > 0) {
+    // 先记录到达时间（踏频估算和延迟统计使用），串口日志等操作放在之后
+    uint32_t arrivalUs = LatencyTracker::now();
     
-    // 订阅通知
-    if (pCSCMeasurement->canNotify()) {
-      pCSCMeasurement->registerForNotify(notifyCallback);
-      Serial.println("已订阅CSC Measurement通知");
-    } else {
-      Serial.println("警告: CSC Measurement不支持通知，将使用轮询方式读取");
+    // 按特征值句柄确定测量类型（未订阅的特征值忽略）
+    const MeasurementRoute* route = findRoute(pBLERemoteCharacteristic->getHandle());
+    if (route == nullptr) {
+      return;
     }
     
-    // 获取Control Point特征值（可选）
-    pCSCControlPoint = pRemoteService->getCharacteristic(BLEUUID(CSC_CONTROL_POINT_UUID));
+    // 重连流程开始（掉线或启动）到新连接第一个通知的时间
+    if (awaitingFirstNotify) {
+      awaitingFirstNotify = false;
+      LatencyTracker::record(LATENCY_FIRST_NOTIFY, reconnectStartUs, arrivalUs);
+    }
     
-    // 尝试获取电池服务（Battery Service, UUID: 0x180F）
-    BLERemoteService* pBatteryService = pClient->getService(BLEUUID((uint16_t)0x180F));
-    if (pBatteryService != nullptr) {
-      // 获取电池电量特征值 (Battery Level, UUID: 0x2A19)
-      pBatteryLevel = pBatteryService->getCharacteristic(BLEUUID((uint16_t)0x2A19));
-      if (pBatteryLevel != nullptr) {
-        Serial.println("找到电池服务，可以读取电量");
-      } else {
-        Serial.println("未找到电池电量特征值");
-        pBatteryLevel = nullptr;
+    if (PACKET_LOG_ENABLED) {
+      Serial.printf("[通知] 收到%s数据，长度: %u 字节\n", MeasurementDispatcher::getKindName(route->kind), (unsigned)length);
+      Serial.print("[原始数据] ");
+      for (size_t i = 0; i < length; i++) {
+        Serial.printf("%02X ", pData[i]);
       }
-    } else {
-      Serial.println("设备不支持电池服务");
-      pBatteryLevel = nullptr;
+      Serial.println();
     }
     
-    // 连接成功，保存设备地址
-    saveLastDeviceAddress(foundDevice->getAddress());
-    
-    Serial.println("CSC服务连接成功，等待数据...");
-    return true;
+    enqueuePacket(route->kind, pData, length, arrivalUs);
+  }
+}
+
+bool BLEManager::enqueuePacket(MeasurementKind kind, const uint8_t* data, size_t length, uint32_t arrivalUs) {
+  if (length > MEASUREMENT_PACKET_MAX) {
+    length = MEASUREMENT_PACKET_MAX;
   }
   
-  Serial.println("连接失败");
-  return false;
+  // 写入环形缓冲区；已满时丢弃最旧的数据包
+  bool kept = true;
+  portENTER_CRITICAL(&ringLock);
+  MeasurementSlot& slot = packetRing[ringHead];
+  slot.length = (uint8_t)length;
+  slot.kind = kind;
+  slot.arrivalUs = arrivalUs;
+  memcpy(slot.data, data, length);
+  ringHead = (ringHead + 1) % MEASUREMENT_RING_SLOTS;
+  if (ringHead == ringTail) {
+    ringTail = (ringTail + 1) % MEASUREMENT_RING_SLOTS;
+    packetsDropped++;
+    kept = false;
+  }
+  portEXIT_CRITICAL(&ringLock);
+  return kept;
 }
 
-void BLEManager::notifyCallback(
-  BLERemoteCharacteristic* pBLERemoteCharacteristic,
+void BLEManager::batteryNotifyCallback(
+  BLERemoteCharacteristic* /*pBLERemoteCharacteristic*/,
   uint8_t* pData,
   size_t length,
-  bool isNotify
+  bool /*isNotify*/
 ) {
-  if (instance && length > 0) {
-    Serial.printf("[通知] 收到CSC数据，长度: %d 字节\n", length);
-    Serial.print("[原始数据] ");
-    for (size_t i = 0; i < length; i++) {
-      Serial.printf("%02X ", pData[i]);
+  if (length > 0) {
+    latestBatteryLevel = (int8_t)(pData[0] > 100 ? 100 : pData[0]);
+  }
+}
+
+void BLEManager::resetPacketRing() {
+  portENTER_CRITICAL(&ringLock);
+  ringHead = 0;
+  ringTail = 0;
+  portEXIT_CRITICAL(&ringLock);
+}
+
+void BLEManager::clearRoutes() {
+  portENTER_CRITICAL(&ringLock);
+  memset(routes, 0, sizeof(routes));
+  portEXIT_CRITICAL(&ringLock);
+  pollCursor = 0;
+}
+
+// 按句柄低位定位，冲突时向后探测（表只在连接时写入，通知回调中只读）
+const MeasurementRoute* BLEManager::findRoute(uint16_t handle) {
+  for (uint8_t i = 0; i < MEASUREMENT_ROUTE_SLOTS; i++) {
+    const MeasurementRoute& route = routes[(handle + i) & (MEASUREMENT_ROUTE_SLOTS - 1)];
+    if (route.handle == handle) {
+      return &route;
     }
-    Serial.println();
-    
-    // 分配缓冲区并复制数据
-    if (instance->cscDataBuffer) {
-      free(instance->cscDataBuffer);
+    if (route.handle == 0) {
+      return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+bool BLEManager::subscribeMeasurement(BLERemoteCharacteristic* characteristic, MeasurementKind kind) {
+  uint16_t handle = characteristic->getHandle();
+  MeasurementRoute* slot = nullptr;
+  for (uint8_t i = 0; i < MEASUREMENT_ROUTE_SLOTS; i++) {
+    MeasurementRoute& route = routes[(handle + i) & (MEASUREMENT_ROUTE_SLOTS - 1)];
+    if (route.handle == 0 || route.handle == handle) {
+      slot = &route;
+      break;
+    }
+  }
+  if (slot == nullptr) {
+    Serial.printf("测量特征值过多，忽略%s数据\n", MeasurementDispatcher::getKindName(kind));
+    return false;
+  }
+  
+  // 先写入路由再订阅，第一个通知到达时已能找到类型
+  bool poll = !characteristic->canNotify();
+  portENTER_CRITICAL(&ringLock);
+  slot->kind = kind;
+  slot->poll = poll;
+  slot->characteristic = characteristic;
+  slot->handle = handle;
+  portEXIT_CRITICAL(&ringLock);
+  
+  if (!poll) {
+    characteristic->registerForNotify(notifyCallback);
+    Serial.printf("已订阅%s测量通知（句柄 0x%04X）\n", MeasurementDispatcher::getKindName(kind), handle);
+  } else {
+    Serial.printf("警告: %s测量不支持通知，将使用轮询方式读取\n", MeasurementDispatcher::getKindName(kind));
+  }
+  return true;
+}
+
+void BLEManager::subscribeOptionalMeasurements() {
+  #if CYCLING_POWER_ENABLED
+  BLERemoteService* powerService = pClient->getService(BLEUUID(CYCLING_POWER_SERVICE_UUID));
+  if (powerService) {
+    BLERemoteCharacteristic* pPower = powerService->getCharacteristic(BLEUUID(CYCLING_POWER_MEASUREMENT_UUID));
+    if (pPower) {
+      subscribeMeasurement(pPower, MEASUREMENT_POWER);
     }
-    instance->cscDataBuffer = (uint8_t*)malloc(length);
-    if (instance->cscDataBuffer) {
-      memcpy(instance->cscDataBuffer, pData, length);
-      instance->cscDataLength = length;
+  }
+  #endif
+  #if HEART_RATE_ENABLED
+  BLERemoteService* heartRateService = pClient->getService(BLEUUID(HEART_RATE_SERVICE_UUID));
+  if (heartRateService) {
+    BLERemoteCharacteristic* pHeartRate = heartRateService->getCharacteristic(BLEUUID(HEART_RATE_MEASUREMENT_UUID));
+    if (pHeartRate) {
+      subscribeMeasurement(pHeartRate, MEASUREMENT_HEART_RATE);
     }
   }
+  #endif
+}
+
+// 读取CSC Feature（可选特征值，解析器据此选择数据包解码方式）
+void BLEManager::readCSCFeature(BLERemoteService* cscService) {
+  cscFeature = -1;
+  BLERemoteCharacteristic* pFeature = cscService->getCharacteristic(BLEUUID(CSC_FEATURE_UUID));
+  if (pFeature == nullptr || !pFeature->canRead()) {
+    Serial.println("设备未提供CSC Feature");
+    return;
+  }
+  StallScope scope(STALL_REGION_GATT_READ);
+  cscFeature = pFeature->readUInt16();
+  Serial.printf("CSC Feature: 0x%04lX (轮转数据: %s, 曲柄数据: %s)\n", (unsigned long)cscFeature,
+                (cscFeature & 0x0001) ? "支持" : "不支持", (cscFeature & 0x0002) ? "支持" : "不支持");
+}
+
+void BLEManager::subscribeBattery(BLERemoteService* batteryService) {
+  pBatteryLevel = nullptr;
+  batteryNotifying = false;
+  latestBatteryLevel = -1;
+  if (batteryService == nullptr) {
+    Serial.println("设备不支持电池服务");
+    return;
+  }
+  
+  // 获取电池电量特征值 (Battery Level, UUID: 0x2A19)
+  pBatteryLevel = batteryService->getCharacteristic(BLEUUID((uint16_t)0x2A19));
+  if (pBatteryLevel == nullptr) {
+    Serial.println("未找到电池电量特征值");
+    return;
+  }
+  
+  // 支持通知时订阅电量变化，之后不必周期性读取（每次读取都会在BLE库中分配内存）
+  if (pBatteryLevel->canNotify()) {
+    pBatteryLevel->registerForNotify(batteryNotifyCallback);
+    batteryNotifying = true;
+    Serial.println("找到电池服务，已订阅电量通知");
+  } else {
+    Serial.println("找到电池服务，可以读取电量");
+  }
 }
 
 bool BLEManager::isConnected() {
   return pClient && pClient->isConnected();
 }
 
-uint8_t* BLEManager::readCSCData() {
-  if (!isConnected() || !pCSCMeasurement) {
-    return nullptr;
+size_t BLEManager::readMeasurement(uint8_t* buffer, size_t size, MeasurementKind* kind, uint32_t* arrivalUs) {
+  if (buffer == nullptr || kind == nullptr) {
+    return 0;
   }
   
-  // 如果有通知数据，返回它
-  if (cscDataBuffer && cscDataLength > 0) {
-    uint8_t* data = (uint8_t*)malloc(cscDataLength);
-    if (data) {
-      memcpy(data, cscDataBuffer, cscDataLength);
-      lastReadDataLength = cscDataLength;
-      free(cscDataBuffer);
-      cscDataBuffer = nullptr;
-      cscDataLength = 0;
-      return data;
+  // 如果有通知数据，取出最旧的一个（合成数据源写入的数据包没有BLE连接）
+  size_t length = 0;
+  portENTER_CRITICAL(&ringLock);
+  if (ringTail != ringHead) {
+    const MeasurementSlot& slot = packetRing[ringTail];
+    length = slot.length < size ? slot.length : size;
+    memcpy(buffer, slot.data, length);
+    *kind = slot.kind;
+    if (arrivalUs) {
+      *arrivalUs = slot.arrivalUs;
     }
+    ringTail = (ringTail + 1) % MEASUREMENT_RING_SLOTS;
+  }
+  portEXIT_CRITICAL(&ringLock);
+  if (length > 0 || !isConnected() || !pCSCMeasurement) {
+    return length;
   }
   
-  // 否则尝试读取（轮询方式，某些设备可能不支持通知）
-  // 注意：频繁读取可能影响性能，建议使用通知方式
-  static unsigned long lastPollTime = 0;
-  if (millis() - lastPollTime > 1000) {  // 每秒轮询一次
-    String value = pCSCMeasurement->readValue();
+  // 不支持通知的特征值轮询读取：每秒读取一个，多个时轮流
+  // 注意：readValue() 会在BLE库内部分配内存，仅作为不支持通知的设备的后备方式
+  if (millis() - lastPollMs <= 1000) {
+    return 0;
+  }
+  for (uint8_t i = 0; i < MEASUREMENT_ROUTE_SLOTS; i++) {
+    const MeasurementRoute& route = routes[pollCursor];
+    pollCursor = (pollCursor + 1) % MEASUREMENT_ROUTE_SLOTS;
+    if (route.handle == 0 || !route.poll) {
+      continue;
+    }
+    lastPollMs = millis();
+    StallScope scope(STALL_REGION_GATT_READ);
+    String value = route.characteristic->readValue();
     if (value.length() > 0) {
-      Serial.printf("[轮询] 读取到CSC数据，长度: %d 字节\n", value.length());
-      Serial.print("[原始数据] ");
-      for (size_t i = 0; i < value.length(); i++) {
-        Serial.printf("%02X ", (uint8_t)value[i]);
+      if (PACKET_LOG_ENABLED) {
+        Serial.printf("[轮询] 读取到%s数据，长度: %u 字节\n", MeasurementDispatcher::getKindName(route.kind), (unsigned)value.length());
+        Serial.print("[原始数据] ");
+        for (size_t j = 0; j < value.length(); j++) {
+          Serial.printf("%02X ", (uint8_t)value[j]);
+        }
+        Serial.println();
       }
-      Serial.println();
       
-      uint8_t* data = (uint8_t*)malloc(value.length());
-      if (data) {
-        memcpy(data, value.c_str(), value.length());
-        lastReadDataLength = value.length();
-        lastPollTime = millis();
-        return data;
+      length = value.length() < size ? value.length() : size;
+      memcpy(buffer, value.c_str(), length);
+      *kind = route.kind;
+      if (arrivalUs) {
+        *arrivalUs = LatencyTracker::now();
       }
     }
-    lastPollTime = millis();
+    break;
   }
-  
-  lastReadDataLength = 0;
-  return nullptr;
+  return length;
+}
+
+uint32_t BLEManager::getPacketsDropped() {
+  return packetsDropped;
 }
 
-size_t BLEManager::getLastDataLength() {
-  return lastReadDataLength;
+bool BLEManager::hasQueuedMeasurement() {
+  portENTER_CRITICAL(&ringLock);
+  bool queued = ringTail != ringHead;
+  portEXIT_CRITICAL(&ringLock);
+  return queued;
 }
 
 int8_t BLEManager::readBatteryLevel() {
@@ -326,13 +657,23 @@ int8_t BLEManager::readBatteryLevel() {
     return -1;  // 未连接或设备不支持电池服务
   }
   
+  // 已订阅通知，或不久前刚读取过：直接返回最新值
+  // readValue() 每次都会在BLE库中分配内存，骑行中不周期性读取
+  if (latestBatteryLevel >= 0 &&
+      (batteryNotifying || millis() - lastBatteryReadMs < BLE_BATTERY_POLL_INTERVAL)) {
+    return latestBatteryLevel;
+  }
+  
+  StallScope scope(STALL_REGION_GATT_READ);
   try {
+    lastBatteryReadMs = millis();
     String value = pBatteryLevel->readValue();
     if (value.length() > 0) {
       uint8_t level = (uint8_t)value[0];
       if (level > 100) {
         level = 100;  // 确保不超过100
       }
+      latestBatteryLevel = (int8_t)level;
       return (int8_t)level;
     }
   } catch (...) {
@@ -342,15 +683,16 @@ int8_t BLEManager::readBatteryLevel() {
   return -1;  // 读取失败
 }
 
-String BLEManager::getDeviceName() {
-  if (foundDevice && foundDevice->haveName()) {
-    return String(foundDevice->getName().c_str());
+const char* BLEManager::getDeviceName() {
+  if (deviceName[0] != '\0') {
+    return deviceName;
   }
   // 如果没有名称，返回设备地址
-  if (foundDevice) {
-    return String(foundDevice->getAddress().toString().c_str());
-  }
-  return String("");
+  return connectedAddress;
+}
+
+int32_t BLEManager::getCSCFeature() {
+  return cscFeature;
 }
 
 int8_t BLEManager::getRSSI() {
@@ -358,14 +700,33 @@ int8_t BLEManager::getRSSI() {
     return 0;  // 未连接
   }
   
-  // 尝试从 foundDevice 获取 RSSI（扫描时的值）
-  if (foundDevice) {
-    return foundDevice->getRSSI();
+  // 连接后定期读取的平滑RSSI；尚未读取到时返回扫描时的平滑RSSI（直接连接上次设备时没有扫描，返回0）
+  int8_t linkRssi = LinkMonitor::getRssi();
+  return linkRssi != 0 ? linkRssi : scanRssi;
+}
+
+void BLEManager::requestRSSI() {
+  if (!isConnected() || !LinkMonitor::rssiDue(millis())) {
+    return;
   }
-  
-  // 如果连接后需要实时 RSSI，可以通过 pClient 获取
-  // 但 ESP32 BLE 库可能不直接支持，所以返回扫描时的值
-  return 0;
+  // BLEClient::getRssi() 会阻塞等待控制器回应，这里只发起读取，结果由 gapEventHandler 送给 LinkMonitor
+  esp_bd_addr_t peer;
+  memcpy(peer, pClient->getPeerAddress().getNative(), sizeof(peer));
+  esp_ble_gap_read_rssi(peer);
+}
+
+void BLEManager::gapEventHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+  if (event == ESP_GAP_BLE_READ_RSSI_COMPLETE_EVT) {
+    if (param->read_rssi_cmpl.status == ESP_BT_STATUS_SUCCESS) {
+      LinkMonitor::onRssi(param->read_rssi_cmpl.rssi);
+    } else {
+      LinkMonitor::onRssi(0);  // 读取失败，只清除等待状态
+    }
+  }
+}
+
+const char* BLEManager::getDeviceAddress() {
+  return connectedAddress;
 }
 
 void BLEManager::disconnect() {
@@ -375,110 +736,44 @@ void BLEManager::disconnect() {
 }
 
 void BLEManager::clearLastDevice() {
-  preferences.remove("last_device");
+  Settings::forgetLastDevice();
+  connectedAddress[0] = '\0';
+  reconnectAddress[0] = '\0';
   Serial.println("已清除保存的设备地址");
 }
 
-void BLEManager::saveLastDeviceAddress(BLEAddress address) {
-  String addrStr = address.toString();
-  preferences.putString("last_device", addrStr);
-  Serial.printf("已保存设备地址: %s\n", addrStr.c_str());
-}
-
-String BLEManager::loadLastDeviceAddress() {
-  String addr = preferences.getString("last_device", "");
-  if (addr.length() > 0) {
-    Serial.printf("读取到上次的设备地址: %s\n", addr.c_str());
+const char* BLEManager::loadLastDeviceAddress() {
+  const KnownDevice* device = Settings::getLastDevice();
+  if (device == nullptr) {
+    return "";
   }
-  return addr;
+  Serial.printf("读取到上次的设备地址: %s\n", device->address);
+  return device->address;
 }
 
-bool BLEManager::connectToLastDevice() {
-  String lastAddress = loadLastDeviceAddress();
-  if (lastAddress.length() == 0) {
-    return false;  // 没有保存的设备地址
+bool BLEManager::connectToAddress(const char* address) {
+  if (address == nullptr || address[0] == '\0' || !pClient) {
+    return false;
   }
   
-  Serial.printf("尝试快速连接到上次的设备: %s\n", lastAddress.c_str());
-  
-  // 使用保存的地址创建BLE地址对象
-  BLEAddress addr(lastAddress.c_str());
-  
-  // 尝试直接连接（不扫描）
-  if (pClient->connect(addr)) {
-    Serial.println("快速连接成功！");
-    
-    // 验证是否为CSC设备
-    // 尝试获取CSC服务
-    BLERemoteService* pRemoteService = pClient->getService(BLEUUID(CSC_SERVICE_UUID));
-    if (pRemoteService == nullptr) {
-      pRemoteService = pClient->getService(BLEUUID(CSC_SERVICE_UUID_FULL));
-    }
-    
-    if (pRemoteService == nullptr) {
-      Serial.println("快速连接成功，但不是CSC设备，断开连接");
-      pClient->disconnect();
-      return false;
-    }
-    
-    // 获取Measurement特征值
-    pCSCMeasurement = pRemoteService->getCharacteristic(BLEUUID(CSC_MEASUREMENT_UUID));
-    if (pCSCMeasurement == nullptr) {
-      pCSCMeasurement = pRemoteService->getCharacteristic(BLEUUID(CSC_MEASUREMENT_UUID_FULL));
-    }
-    
-    if (pCSCMeasurement == nullptr) {
-      Serial.println("快速连接成功，但未找到Measurement特征值，断开连接");
-      pClient->disconnect();
-      return false;
-    }
-    
-    // 订阅通知
-    if (pCSCMeasurement->canNotify()) {
-      pCSCMeasurement->registerForNotify(notifyCallback);
-      Serial.println("已订阅CSC Measurement通知");
-    }
-    
-    // 获取Control Point特征值（可选）
-    pCSCControlPoint = pRemoteService->getCharacteristic(BLEUUID(CSC_CONTROL_POINT_UUID));
-    
-    Serial.println("快速连接并验证成功！");
-    return true;
-  } else {
-    Serial.println("快速连接失败，设备可能不在范围内");
+  // 不扫描，直接连接保存的地址（地址类型取自匹配时的扫描结果）
+  const KnownDevice* known = Settings::findDevice(address);
+  if (!setupLink(address, known ? (esp_ble_addr_type_t)known->addressType : BLE_ADDR_TYPE_PUBLIC)) {
     return false;
   }
-}
-
-bool BLEManager::isCSCDevice(BLEAdvertisedDevice device) {
-  // 仅通过Service UUID识别CSC设备
-  if (device.haveServiceUUID()) {
-    BLEUUID serviceUUID = device.getServiceUUID();
-    String serviceUUIDStr = serviceUUID.toString();
-    
-    // 转换为小写进行比较（UUID格式可能不同）
-    serviceUUIDStr.toLowerCase();
-    String targetUUID = String(CSC_SERVICE_UUID);
-    targetUUID.toLowerCase();
-    String targetUUIDFull = String(CSC_SERVICE_UUID_FULL);
-    targetUUIDFull.toLowerCase();
-    
-    // 检查是否匹配标准UUID（16位或完整格式）
-    // 也检查UUID中是否包含"1816"（CSC标准UUID的核心部分）
-    if (serviceUUIDStr == targetUUID || 
-        serviceUUIDStr == targetUUIDFull ||
-        serviceUUIDStr.indexOf("1816") >= 0) {
-      Serial.printf("  -> ✓ 匹配CSC Service UUID: %s\n", serviceUUIDStr.c_str());
-      return true;
-    }
-    
-    // 打印所有服务UUID以便调试
-    Serial.printf("  -> Service UUID: %s (不匹配CSC UUID)\n", serviceUUIDStr.c_str());
-  } else {
-    Serial.println("  -> 设备未广播Service UUID");
+  
+  // 未经扫描，没有广播名称和RSSI；名称使用匹配时保存的广播名称
+  if (known) {
+    strcpy(deviceName, known->name);
+  } else if (strcasecmp(connectedAddress, address) != 0) {
+    deviceName[0] = '\0';
   }
+  scanRssi = 0;
+  strncpy(connectedAddress, address, sizeof(connectedAddress) - 1);
+  connectedAddress[sizeof(connectedAddress) - 1] = '\0';
   
-  return false;
+  Serial.println("直接连接并验证成功！");
+  return true;
 }
 
 bool BLEManager::checkCSCService(BLERemoteService* service) {
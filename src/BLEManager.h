@@ -11,8 +11,45 @@
 #include <BLEAdvertisedDevice.h>
 #include <BLEClient.h>
 #include <BLEUtils.h>
-#include <Preferences.h>
+#include <esp_gap_ble_api.h>
 #include "config.h"
+#include "MeasurementDispatcher.h"
+
+// 扫描候选设备表大小（同时跟踪的CSC设备数量）
+#define SCAN_CANDIDATE_SLOTS 4
+
+// 通知数据环形缓冲区（静态分配，通知回调和主循环之间不分配堆内存，所有测量类型共用）
+#define MEASUREMENT_PACKET_MAX 20   // 单个通知最大长度（默认MTU 23 - 3字节ATT头）
+#define MEASUREMENT_RING_SLOTS 8    // 缓冲的通知数量（主循环来不及处理时丢弃最旧的）
+
+// 特征值句柄 → 测量类型的路由表大小（2的幂，按句柄低位开放寻址）
+#define MEASUREMENT_ROUTE_SLOTS 8
+
+struct MeasurementSlot {
+  uint8_t length;
+  MeasurementKind kind;
+  uint32_t arrivalUs;  // 通知到达时间（esp_timer，微秒）
+  uint8_t data[MEASUREMENT_PACKET_MAX];
+};
+
+// 已订阅的测量特征值（handle 为0表示空位）
+struct MeasurementRoute {
+  uint16_t handle;
+  MeasurementKind kind;
+  bool poll;           // 不支持通知，由主循环定期读取
+  BLERemoteCharacteristic* characteristic;
+};
+
+// 扫描到的CSC候选设备（固定大小，不保存 BLEAdvertisedDevice 副本）
+struct ScanCandidate {
+  bool used;
+  char address[18];
+  uint8_t addressType;
+  char name[24];
+  float rssi;           // 平滑后的信号强度 (dBm)
+  uint8_t seen;         // 收到广播的次数
+  unsigned long firstSeenMs;
+};
 
 class BLEManager {
 private:
@@ -22,14 +59,40 @@ private:
   BLERemoteCharacteristic* pCSCControlPoint;
   BLERemoteCharacteristic* pBatteryLevel;  // 电池电量特征值
   
-  bool deviceFound;
-  BLEAdvertisedDevice* foundDevice;
+  char connectedAddress[18];  // 当前/最近连接的设备地址
+  char deviceName[24];        // 当前连接设备的广播名称
+  int8_t scanRssi;            // 扫描时的信号强度
+  int32_t cscFeature;         // CSC Feature（-1表示设备未提供）
+  
+  // 流式扫描：广播回调中更新候选表，主线程轮询扫描结果
+  ScanCandidate candidates[SCAN_CANDIDATE_SLOTS];
+  char scanPreferredAddress[18];  // 优先连接的地址（上次的设备），扫描到即停止
+  volatile bool scanDecided;      // 已找到足够好的候选设备，可以提前停止扫描
+  volatile bool scanComplete;     // 扫描超时结束
+  portMUX_TYPE scanLock;
+  
+  uint8_t pollCursor;         // 轮询读取的下一个路由（每次只读取一个特征值）
+  unsigned long lastPollMs;
+  bool batteryNotifying;      // 已订阅电量通知
+  unsigned long lastBatteryReadMs;
   
   // 静态成员变量（用于回调函数）
   static BLEManager* instance;
-  static uint8_t* cscDataBuffer;
-  static size_t cscDataLength;
-  static size_t lastReadDataLength;
+  static MeasurementSlot packetRing[MEASUREMENT_RING_SLOTS];
+  static MeasurementRoute routes[MEASUREMENT_ROUTE_SLOTS];
+  static uint8_t ringHead;    // 下一个写入位置（通知回调）
+  static uint8_t ringTail;    // 下一个读取位置（主循环）
+  static uint32_t packetsDropped;
+  static portMUX_TYPE ringLock;
+  static volatile int8_t latestBatteryLevel;  // 最近一次通知/读取的电量（-1表示未获取）
+  
+  // 重连流程：掉线（或启动）后立即直接连接保存的设备，失败后指数退避
+  char reconnectAddress[18];        // 重连目标（空表示没有可重连的设备）
+  uint8_t reconnectAttempts;        // 本次流程已尝试的次数
+  unsigned long reconnectStartMs;   // 流程开始时间
+  unsigned long nextReconnectMs;    // 下次尝试时间
+  static uint32_t reconnectStartUs;          // 流程开始时间（LatencyTracker 时钟）
+  static volatile bool awaitingFirstNotify;  // 等待新连接的第一个通知（记录到首个通知的时间）
   
   // 回调函数
   static void notifyCallback(
@@ -38,31 +101,60 @@ private:
     size_t length,
     bool isNotify
   );
+  static void batteryNotifyCallback(
+    BLERemoteCharacteristic* pBLERemoteCharacteristic,
+    uint8_t* pData,
+    size_t length,
+    bool isNotify
+  );
   
-  bool connectToServer();
-  bool isCSCDevice(BLEAdvertisedDevice device);
-  bool checkCSCService(BLERemoteService* service);
+  void resetPacketRing();
+  void clearRoutes();
+  static const MeasurementRoute* findRoute(uint16_t handle);
+  bool subscribeMeasurement(BLERemoteCharacteristic* characteristic, MeasurementKind kind);
+  void subscribeOptionalMeasurements();  // 同一设备上的功率、心率服务
+  void subscribeBattery(BLERemoteService* batteryService);
+  void readCSCFeature(BLERemoteService* cscService);
   
-  // 设备记忆功能
-  void saveLastDeviceAddress(BLEAddress address);
-  String loadLastDeviceAddress();
-  bool connectToLastDevice();
+  static void scanCompleteCallback(BLEScanResults results);
+  static void gapEventHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
+  friend class CandidateScanCallbacks;
+  
+  void onScanResult(BLEAdvertisedDevice& device);
+  int8_t selectCandidate();
+  bool connectToServer(const ScanCandidate& candidate);
+  bool setupLink(const char* address, uint8_t addressType);  // 连接 → 服务发现 → 订阅
+  bool checkCSCService(BLERemoteService* service);
   
-  Preferences preferences;
+  // 设备记忆功能（保存在设置记录中，见 Settings）
+  const char* loadLastDeviceAddress();
   
 public:
   BLEManager();
   ~BLEManager();
   
   bool begin();
-  bool scanAndConnect();
-  bool scanAndConnectForced();  // 强制扫描（用于匹配模式）
+  // 开始重连流程（启动、掉线、热恢复时调用）：address 为空时重连刚断开的设备或保存的设备
+  void beginReconnect(const char* address = nullptr);
+  bool reconnect();               // 到了尝试时间时直接连接重连目标，返回是否已连接（不阻塞等待退避）
+  bool hasReconnectTarget();      // 有可重连的设备（否则需要匹配）
+  unsigned long getDisconnectedMs();  // 重连流程开始以来的时间
+  // 强制扫描（用于匹配模式）；cancelRequested 不为空时在扫描期间和连接之前检查，返回 true 则中止、不连接
+  bool scanAndConnectForced(bool (*cancelRequested)() = nullptr);
+  bool connectToAddress(const char* address);  // 不扫描，直接连接指定地址
+  const char* getDeviceAddress();              // 当前/最近连接的设备地址
   bool isConnected();
-  uint8_t* readCSCData();
-  size_t getLastDataLength();
+  // 取出一个测量数据包复制到 buffer，返回长度（0表示没有新数据），kind 返回测量类型，arrivalUs 返回到达时间
+  size_t readMeasurement(uint8_t* buffer, size_t size, MeasurementKind* kind, uint32_t* arrivalUs = nullptr);
+  uint32_t getPacketsDropped();  // 环形缓冲区溢出丢弃的数据包数
+  bool hasQueuedMeasurement();   // 环形缓冲区中还有未取出的数据包
+  // 写入测量数据包环形缓冲区（通知回调和合成数据源共用），已满时丢弃最旧的一个并返回 false
+  static bool enqueuePacket(MeasurementKind kind, const uint8_t* data, size_t length, uint32_t arrivalUs);
   int8_t readBatteryLevel();  // 读取电池电量 (0-100, -1表示未获取)
-  String getDeviceName();     // 获取设备名称
+  const char* getDeviceName(); // 获取设备名称（无名称时返回地址）
   int8_t getRSSI();           // 获取信号强度 (dBm)
+  void requestRSSI();         // 到了采样间隔时发起一次异步RSSI读取（不阻塞，结果送给 LinkMonitor）
+  int32_t getCSCFeature();    // 连接时读取的CSC Feature（-1表示设备未提供）
   void disconnect();
   void clearLastDevice();  // 清除保存的设备地址
 };
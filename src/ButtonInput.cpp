@@ -0,0 +1,122 @@
+/**
+ * 按键输入实现
+ * 按键按下为LOW（内部上拉）。状态（pressed、pressStartUs）只在定时器回调中修改，
+ * 中断只操作定时器，事件队列用自旋锁保护
+ */
+
+#include "ButtonInput.h"
+
+uint8_t ButtonInput::buttonPin = 0;
+esp_timer_handle_t ButtonInput::timer = nullptr;
+bool ButtonInput::pressed = false;
+bool ButtonInput::longPressPosted = false;
+int64_t ButtonInput::pressStartUs = 0;
+volatile uint32_t ButtonInput::edges = 0;
+ButtonEvent ButtonInput::events[BUTTON_EVENT_SLOTS];
+int64_t ButtonInput::eventTimesUs[BUTTON_EVENT_SLOTS];
+uint8_t ButtonInput::eventHead = 0;
+uint8_t ButtonInput::eventTail = 0;
+portMUX_TYPE ButtonInput::lock = portMUX_INITIALIZER_UNLOCKED;
+
+bool ButtonInput::begin(uint8_t pin) {
+  buttonPin = pin;
+  pinMode(pin, INPUT_PULLUP);
+
+  esp_timer_create_args_t args = {};
+  args.callback = onTimer;
+  args.name = "button";
+  if (esp_timer_create(&args, &timer) != ESP_OK) {
+    Serial.println("按键定时器创建失败");
+    return false;
+  }
+  attachInterrupt(digitalPinToInterrupt(pin), onEdge, CHANGE);
+  return true;
+}
+
+// 每个边沿（包括抖动）都把防抖定时器重新计时，电平稳定 BUTTON_DEBOUNCE_TIME 后才处理
+void IRAM_ATTR ButtonInput::onEdge() {
+  edges++;
+  portENTER_CRITICAL_ISR(&lock);
+  esp_timer_stop(timer);
+  esp_timer_start_once(timer, BUTTON_DEBOUNCE_TIME * 1000ULL);
+  portEXIT_CRITICAL_ISR(&lock);
+}
+
+// 防抖结束或长按时间到（同一个定时器）
+void ButtonInput::onTimer(void* /*arg*/) {
+  bool down = digitalRead(buttonPin) == LOW;
+  int64_t nowUs = esp_timer_get_time();
+
+  if (down && !pressed) {
+    pressed = true;
+    longPressPosted = false;
+    pressStartUs = nowUs - BUTTON_DEBOUNCE_TIME * 1000LL;  // 按下的边沿在防抖时间之前
+  } else if (!down && pressed) {
+    pressed = false;
+    if (!longPressPosted) {
+      post(BUTTON_EVENT_SHORT_PRESS, nowUs);
+    }
+    return;
+  }
+
+  if (pressed && !longPressPosted) {
+    int64_t heldUs = nowUs - pressStartUs;
+    if (heldUs >= BUTTON_PRESS_TIME * 1000LL) {
+      longPressPosted = true;
+      post(BUTTON_EVENT_LONG_PRESS, nowUs);
+    } else {
+      // 按住期间等到长按时间；这期间有新的边沿时中断会改为防抖计时，之后再从这里重新计算剩余时间
+      portENTER_CRITICAL(&lock);
+      if (!esp_timer_is_active(timer)) {
+        esp_timer_start_once(timer, (uint64_t)(BUTTON_PRESS_TIME * 1000LL - heldUs));
+      }
+      portEXIT_CRITICAL(&lock);
+    }
+  }
+}
+
+void ButtonInput::post(ButtonEvent event, int64_t eventUs) {
+  portENTER_CRITICAL(&lock);
+  uint8_t next = (eventHead + 1) % BUTTON_EVENT_SLOTS;
+  if (next != eventTail) {
+    events[eventHead] = event;
+    eventTimesUs[eventHead] = eventUs;
+    eventHead = next;
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+ButtonEvent ButtonInput::poll(int64_t* eventUs) {
+  ButtonEvent event = BUTTON_EVENT_NONE;
+  portENTER_CRITICAL(&lock);
+  if (eventTail != eventHead) {
+    event = events[eventTail];
+    if (eventUs) *eventUs = eventTimesUs[eventTail];
+    eventTail = (eventTail + 1) % BUTTON_EVENT_SLOTS;
+  }
+  portEXIT_CRITICAL(&lock);
+  return event;
+}
+
+bool ButtonInput::take(ButtonEvent event, int64_t* eventUs) {
+  bool found = false;
+  portENTER_CRITICAL(&lock);
+  for (uint8_t i = eventTail; i != eventHead; i = (i + 1) % BUTTON_EVENT_SLOTS) {
+    if (events[i] != event) continue;
+    if (eventUs) *eventUs = eventTimesUs[i];
+    // 之后的事件依次前移一格
+    for (uint8_t j = i; (j + 1) % BUTTON_EVENT_SLOTS != eventHead; j = (j + 1) % BUTTON_EVENT_SLOTS) {
+      events[j] = events[(j + 1) % BUTTON_EVENT_SLOTS];
+      eventTimesUs[j] = eventTimesUs[(j + 1) % BUTTON_EVENT_SLOTS];
+    }
+    eventHead = (eventHead + BUTTON_EVENT_SLOTS - 1) % BUTTON_EVENT_SLOTS;
+    found = true;
+    break;
+  }
+  portEXIT_CRITICAL(&lock);
+  return found;
+}
+
+uint32_t ButtonInput::getEdgeCount() {
+  return edges;
+}
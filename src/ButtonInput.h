@@ -0,0 +1,51 @@
+/**
+ * 按键输入（中断 + 单次定时器）
+ * GPIO边沿中断只重新启动防抖定时器；定时器到期（在esp_timer任务中）读取稳定电平，
+ * 判断按下/释放，按住期间再定时到长按时间。识别出的事件（带发生时间）放入队列，由主循环取出处理，
+ * 主循环阻塞（扫描、连接）期间的按键不会丢失；阻塞的操作也可以用 take() 单独取出长按来中止自己
+ */
+
+#ifndef BUTTON_INPUT_H
+#define BUTTON_INPUT_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "config.h"
+
+enum ButtonEvent : uint8_t {
+  BUTTON_EVENT_NONE = 0,
+  BUTTON_EVENT_SHORT_PRESS,  // 短按（释放时）
+  BUTTON_EVENT_LONG_PRESS,   // 按住达到 BUTTON_PRESS_TIME（按住期间立即触发，释放时不再产生短按）
+};
+
+// 主循环来不及处理时最多缓存的事件数（满时丢弃新事件）
+#define BUTTON_EVENT_SLOTS 4
+
+class ButtonInput {
+public:
+  static bool begin(uint8_t pin);  // 配置上拉输入、创建定时器并启用边沿中断
+  // 取出一个事件，没有时返回 BUTTON_EVENT_NONE；eventUs 不为空时写入事件发生的时间（esp_timer 微秒）
+  static ButtonEvent poll(int64_t* eventUs = nullptr);
+  // 取出队列中第一个指定类型的事件，其他事件保留顺序留在队列中
+  static bool take(ButtonEvent event, int64_t* eventUs = nullptr);
+  static uint32_t getEdgeCount();  // 中断次数（包括抖动）
+
+private:
+  static uint8_t buttonPin;
+  static esp_timer_handle_t timer;
+  static bool pressed;
+  static bool longPressPosted;
+  static int64_t pressStartUs;
+  static volatile uint32_t edges;
+  static ButtonEvent events[BUTTON_EVENT_SLOTS];
+  static int64_t eventTimesUs[BUTTON_EVENT_SLOTS];
+  static uint8_t eventHead;
+  static uint8_t eventTail;
+  static portMUX_TYPE lock;
+
+  static void onEdge();
+  static void onTimer(void* arg);
+  static void post(ButtonEvent event, int64_t eventUs);
+};
+
+#endif // BUTTON_INPUT_H
@@ -17,23 +17,228 @@
  * 
  * 注意: 设备不设置曲柄数据的标志位(bit 2,3)，需要根据数据包长度判断
  * 详细文档请参考: docs/ble_csc_protocol.md
+ * 
+ * 标准CSC规范中标志位 bit 0 = 轮转数据（轮转数+时间），bit 1 = 曲柄数据（曲柄转数+时间），
+ * 因此标志0x02的5字节数据包也可以是标准的 曲柄转数+曲柄时间，连接后根据数据判断（见 CSC_DECODE_PROFILE）
+ * 
+ * 解码方式：编译时按 (解码方式, 标志位, 长度) 计算每种数据包的字段偏移，
+ * 并为每种偏移组合生成一个固定偏移的解码函数，每个数据包只需查表调用一次
  */
 
 #include "CSCParser.h"
+#include "SensorData.h"
 #include <Arduino.h>
+#include <array>
+#include <utility>
+
+// 逐包解析日志（二进制遥测模式下关闭，见 config.h 中的 PACKET_LOG_ENABLED）
+#define PARSER_LOG(...) do { if (PACKET_LOG_ENABLED) Serial.printf(__VA_ARGS__); } while (0)
+
+// 布局表维度：解码方式 × 标志位低4位 × 长度（超过11字节的部分不含字段，按11字节处理）
+#define CSC_LAYOUT_PROFILES 3
+#define CSC_LAYOUT_FLAGS 16
+#define CSC_LAYOUT_MAX_LENGTH 11
+#define CSC_LAYOUT_LENGTHS (CSC_LAYOUT_MAX_LENGTH + 1)
+#define CSC_LAYOUT_COUNT (CSC_LAYOUT_PROFILES * CSC_LAYOUT_FLAGS * CSC_LAYOUT_LENGTHS)
+
+// 布局选项
+#define CSC_LAYOUT_CHECK_CRANK_TIME 0x01  // 按剩余长度推断的曲柄数据，曲柄时间为0时丢弃
+#define CSC_LAYOUT_LEARN            0x02  // 有歧义的数据包，先判断解码方式再解码
+
+// 一种数据包的字段偏移（-1表示不存在）
+struct CSCLayout {
+  int8_t wheelRevolutions;
+  int8_t wheelEventTime;
+  int8_t crankRevolutions;
+  int8_t crankEventTime;
+  uint8_t options;
+};
+
+// 标准格式：bit 0 = 轮转数(4)+轮转时间(2)，bit 1 = 曲柄转数(2)+曲柄时间(2)，其余位保留
+static constexpr CSCLayout standardLayout(uint8_t flags, uint8_t length) {
+  CSCLayout layout = {-1, -1, -1, -1, 0};
+  int8_t offset = 1;
+  if (flags & 0x01) {
+    if (offset + 6 > length) return layout;
+    layout.wheelRevolutions = offset;
+    layout.wheelEventTime = offset + 4;
+    offset += 6;
+  }
+  if (flags & 0x02) {
+    if (offset + 4 > length) return layout;
+    layout.crankRevolutions = offset;
+    layout.crankEventTime = offset + 2;
+  }
+  return layout;
+}
+
+// BT003-2格式：bit 0~3 分别表示 轮转数/轮转时间/曲柄转数/曲柄时间，
+// 没有曲柄标志位时按剩余长度推断曲柄数据（2字节 = 转数，4字节 = 转数+时间）
+static constexpr CSCLayout bt003Layout(uint8_t flags, uint8_t length) {
+  CSCLayout layout = {-1, -1, -1, -1, 0};
+  int8_t offset = 1;
+  if (flags & 0x01) {
+    if (offset + 4 > length) return layout;
+    layout.wheelRevolutions = offset;
+    offset += 4;
+    if (flags & 0x02) {
+      if (offset + 2 > length) return layout;
+      layout.wheelEventTime = offset;
+      offset += 2;
+    }
+  } else if (flags & 0x02) {
+    if (offset + 2 > length) return layout;
+    layout.wheelEventTime = offset;
+    offset += 2;
+  }
+  if (flags & 0x04) {
+    if (offset + 2 > length) return layout;
+    layout.crankRevolutions = offset;
+    offset += 2;
+    if (flags & 0x08) {
+      if (offset + 2 > length) return layout;
+      layout.crankEventTime = offset;
+    }
+  } else if (flags & 0x08) {
+    if (offset + 2 > length) return layout;
+    layout.crankEventTime = offset;
+  } else if (offset + 2 <= length) {
+    layout.crankRevolutions = offset;
+    if (offset + 4 <= length) {
+      layout.crankEventTime = offset + 2;
+      layout.options = CSC_LAYOUT_CHECK_CRANK_TIME;
+    }
+  }
+  return layout;
+}
+
+// 自动：标准格式的数据包按标准解码，标志0x02的5字节数据包需要判断，其余按BT003-2格式解码
+static constexpr CSCLayout autoLayout(uint8_t flags, uint8_t length) {
+  bool standardShape = (flags & 0x0C) == 0 &&
+                       length == 1 + ((flags & 0x01) ? 6 : 0) + ((flags & 0x02) ? 4 : 0);
+  if (flags == 0x02 && length == 5) {
+    CSCLayout layout = {-1, -1, -1, -1, CSC_LAYOUT_LEARN};
+    return layout;
+  }
+  return standardShape ? standardLayout(flags, length) : bt003Layout(flags, length);
+}
+
+static constexpr CSCLayout layoutAt(size_t index) {
+  uint8_t profile = index / (CSC_LAYOUT_FLAGS * CSC_LAYOUT_LENGTHS);
+  uint8_t flags = (index / CSC_LAYOUT_LENGTHS) % CSC_LAYOUT_FLAGS;
+  uint8_t length = index % CSC_LAYOUT_LENGTHS;
+  return profile == CSC_PROFILE_STANDARD ? standardLayout(flags, length) :
+         profile == CSC_PROFILE_BT003 ? bt003Layout(flags, length) : autoLayout(flags, length);
+}
+
+static inline uint16_t readUInt16(const uint8_t* data) {
+  return (uint16_t)data[0] | ((uint16_t)data[1] << 8);
+}
+
+static inline uint32_t readUInt32(const uint8_t* data) {
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+typedef void (*CSCDecodeFn)(CSCParser& parser, const uint8_t* data, SensorData& sensorData, uint32_t arrivalUs);
 
-// 前向声明结构体（在ble_meter.ino中定义）
-struct SensorData {
-  float speed;
-  float cadence;
-  uint32_t wheelRevolutions;
-  uint16_t lastWheelEventTime;
-  uint16_t crankRevolutions;
-  uint16_t lastCrankEventTime;
+struct CSCDecoders {
+  // 固定偏移的解码函数（每种布局实例化一次）
+  template <int8_t WR, int8_t WT, int8_t CR, int8_t CT, uint8_t OPTIONS>
+  static void decode(CSCParser& parser, const uint8_t* data, SensorData& sensorData, uint32_t arrivalUs) {
+    if (WR >= 0) {
+      sensorData.wheelRevolutions = readUInt32(data + WR);
+      PARSER_LOG("[解析] 轮转数: %lu\n", (unsigned long)sensorData.wheelRevolutions);
+    }
+    if (WT >= 0) {
+      uint16_t wheelEventTime = readUInt16(data + WT);
+      if (WR >= 0) {
+        sensorData.speed = parser.calculateSpeed(sensorData.wheelRevolutions, wheelEventTime, arrivalUs);
+        PARSER_LOG("[解析] 轮转时间: %u (1/1024秒), 速度: %.2f km/h\n", wheelEventTime, sensorData.speed);
+      } else {
+        PARSER_LOG("[解析] 仅轮转时间: %u (1/1024秒)，无轮转数，无法计算速度\n", wheelEventTime);
+      }
+      sensorData.lastWheelEventTime = wheelEventTime;
+    }
+    if (CR >= 0 && CT >= 0) {
+      uint16_t crankRevolutions = readUInt16(data + CR);
+      uint16_t crankEventTime = readUInt16(data + CT);
+      if ((OPTIONS & CSC_LAYOUT_CHECK_CRANK_TIME) && crankEventTime == 0) {
+        PARSER_LOG("[解析] 曲柄时间值不合理，跳过\n");
+        return;
+      }
+      sensorData.cadence = parser.calculateCadence(crankRevolutions, crankEventTime, arrivalUs);
+      sensorData.crankRevolutions = crankRevolutions;
+      sensorData.lastCrankEventTime = crankEventTime;
+      PARSER_LOG("[解析] 曲柄转数: %u, 时间: %u (1/1024秒), 踏频: %.1f rpm\n",
+                 crankRevolutions, crankEventTime, sensorData.cadence);
+    } else if (CR >= 0) {
+      sensorData.crankRevolutions = readUInt16(data + CR);
+      // 没有曲柄时间：用通知到达时间估算踏频
+      if (CADENCE_ESTIMATE_ENABLED && arrivalUs != 0 &&
+          parser.cadenceEstimator.addCrankCount(sensorData.crankRevolutions, arrivalUs)) {
+        sensorData.cadence = parser.cadenceEstimator.getCadence();
+        PARSER_LOG("[解析] 曲柄转数: %u (无时间), 按到达时间估算踏频: %.1f rpm\n",
+                   sensorData.crankRevolutions, sensorData.cadence);
+      } else {
+        PARSER_LOG("[解析] 曲柄转数: %u (无时间，等待更多数据包)\n", sensorData.crankRevolutions);
+      }
+    } else if (CT >= 0) {
+      sensorData.lastCrankEventTime = readUInt16(data + CT);
+      PARSER_LOG("[解析] 仅曲柄时间: %u (1/1024秒)，无转数，无法计算踏频\n", sensorData.lastCrankEventTime);
+    }
+  }
+  
+  static void learn(CSCParser& parser, const uint8_t* data, SensorData& sensorData, uint32_t arrivalUs);
+  
+  template <size_t I>
+  static constexpr CSCDecodeFn decoderAt() {
+    constexpr CSCLayout layout = layoutAt(I);
+    return (layout.options & CSC_LAYOUT_LEARN) ? &learn :
+           &decode<layout.wheelRevolutions, layout.wheelEventTime,
+                   layout.crankRevolutions, layout.crankEventTime, layout.options>;
+  }
+  
+  template <size_t... I>
+  static constexpr std::array<CSCDecodeFn, sizeof...(I)> makeTable(std::index_sequence<I...>) {
+    return {{decoderAt<I>()...}};
+  }
 };
 
+static constexpr std::array<CSCDecodeFn, CSC_LAYOUT_COUNT> CSC_DECODERS =
+  CSCDecoders::makeTable(std::make_index_sequence<CSC_LAYOUT_COUNT>());
+
+static inline CSCDecodeFn decoderFor(CSCDecodeProfile profile, uint8_t flags, size_t length) {
+  size_t lengthIndex = length < CSC_LAYOUT_MAX_LENGTH ? length : CSC_LAYOUT_MAX_LENGTH;
+  return CSC_DECODERS[(profile * CSC_LAYOUT_FLAGS + (flags & 0x0F)) * CSC_LAYOUT_LENGTHS + lengthIndex];
+}
+
+// 标志0x02的5字节数据包：标准格式为 曲柄转数+曲柄时间，BT003-2格式为 轮转时间+曲柄转数
+// 与上次完整数据包的曲柄转数比较，哪种格式的曲柄转数接近就使用哪种
+void CSCDecoders::learn(CSCParser& parser, const uint8_t* data, SensorData& sensorData, uint32_t arrivalUs) {
+  if (parser.profile == CSC_PROFILE_AUTO && parser.lastCrankEventTime != 0) {
+    uint16_t reference = (uint16_t)parser.lastCrankRevolutions;
+    bool standardMatch = (uint16_t)(readUInt16(data + 1) - reference) <= CSC_PROFILE_MATCH_REVS;
+    bool bt003Match = (uint16_t)(readUInt16(data + 3) - reference) <= CSC_PROFILE_MATCH_REVS;
+    if (standardMatch != bt003Match) {
+      parser.setProfile(standardMatch ? CSC_PROFILE_STANDARD : CSC_PROFILE_BT003, "5字节数据包与完整数据包的曲柄转数一致");
+    }
+  }
+  if (parser.profile == CSC_PROFILE_AUTO && ++parser.learnPackets >= CSC_PROFILE_LEARN_PACKETS) {
+    parser.setProfile(CSC_PROFILE_BT003, "无法判断5字节数据包格式");
+  }
+  
+  CSCDecodeProfile profile = parser.profile == CSC_PROFILE_AUTO ? CSC_PROFILE_BT003 : parser.profile;
+  decoderFor(profile, data[0], 5)(parser, data, sensorData, arrivalUs);
+}
+
 CSCParser::CSCParser() {
+  wheelCircumferenceMm = WHEEL_CIRCUMFERENCE_MM;
   reset();
+  configure(-1);
+}
+
+void CSCParser::setWheelCircumference(uint16_t mm) {
+  wheelCircumferenceMm = mm;
 }
 
 void CSCParser::reset() {
@@ -41,179 +246,108 @@ void CSCParser::reset() {
   lastWheelEventTime = 0;
   lastCrankRevolutions = 0;
   lastCrankEventTime = 0;
+  lastSpeed = 0.0;
+  lastCadence = 0.0;
+  lastWheelEventUs = 0;
+  lastCrankEventUs = 0;
+  cadenceEstimator.reset();
 }
 
-void CSCParser::parseData(uint8_t* data, size_t length, SensorData& sensorData) {
-  if (data == nullptr || length < 1) {
-    return;
-  }
+void CSCParser::configure(int32_t cscFeature) {
+  feature = cscFeature;
+  memset(shapesSeen, 0, sizeof(shapesSeen));
+  learnPackets = 0;
+  cadenceEstimator.reset();  // 新连接的到达时间与之前的样本不连续
   
-  if (DEBUG_MODE) {
-    Serial.printf("[解析] 数据总长度: %d 字节\n", length);
+  if (CSC_DECODE_PROFILE != CSC_PROFILE_AUTO) {
+    profile = (CSCDecodeProfile)CSC_DECODE_PROFILE;
+  } else if (feature >= 0 && !(feature & CSC_FEATURE_WHEEL)) {
+    // 只有踏频的传感器：5字节数据包不可能包含轮转时间
+    profile = CSC_PROFILE_STANDARD;
+  } else {
+    profile = CSC_PROFILE_AUTO;
   }
   
-  // 首先需要知道数据长度，但CSC数据格式是变长的
-  // 根据BLE规范，最大13字节，但实际长度取决于标志位
-  // 先假设数据足够长，根据标志位解析
-  
-  uint8_t flags = data[0];
-  Serial.printf("[解析] 标志位: 0x%02X", flags);
-  if (DEBUG_MODE) {
-    Serial.printf("\n  - 轮转数存在 (bit 0): %s", (flags & 0x01) ? "是" : "否");
-    Serial.printf("\n  - 轮转时间存在 (bit 1): %s", (flags & 0x02) ? "是" : "否");
-    Serial.printf("\n  - 曲柄转数存在 (bit 2): %s", (flags & 0x04) ? "是" : "否");
-    Serial.printf("\n  - 曲柄时间存在 (bit 3): %s", (flags & 0x08) ? "是" : "否");
+  if (feature >= 0) {
+    Serial.printf("[解析] CSC Feature: 0x%04lX, 解码方式: %s\n", (unsigned long)feature, getProfileName());
+  } else {
+    Serial.printf("[解析] 设备未提供CSC Feature, 解码方式: %s\n", getProfileName());
+  }
+}
+
+void CSCParser::setProfile(CSCDecodeProfile newProfile, const char* reason) {
+  profile = newProfile;
+  Serial.printf("[解析] 解码方式: %s（%s）\n", getProfileName(), reason);
+}
+
+CSCDecodeProfile CSCParser::getProfile() {
+  return profile;
+}
+
+const char* CSCParser::getProfileName() {
+  switch (profile) {
+    case CSC_PROFILE_STANDARD: return "标准格式";
+    case CSC_PROFILE_BT003:    return "BT003-2格式";
+    case CSC_PROFILE_AUTO:
+    default:                   return "自动判断中";
+  }
+}
+
+void CSCParser::parseData(const uint8_t* data, size_t length, SensorData& sensorData, uint32_t arrivalUs) {
+  if (data == nullptr || length < 1) {
+    return;
   }
-  Serial.println();
-  
-  int offset = 1;
   
-  // 注意：根据BLE CSC规范，某些设备可能只发送部分数据
-  // 如果只有轮转时间而没有轮转数，无法计算速度
-  // 如果只有曲柄转数或时间之一，无法计算踏频
+  uint8_t flags = data[0];
+  PARSER_LOG("[解析] 标志位: 0x%02X, 长度: %u 字节\n", flags, (unsigned)length);
   
-  // 解析轮转数据
-  // 根据BLE规范，轮转数（如果存在）是32位，轮转时间（如果存在）是16位
-  if (flags & 0x01) {  // 轮转数存在
-    if (offset + 4 > length) {
-      Serial.println("[解析] 错误: 数据长度不足，无法读取轮转数");
-      return;
-    }
-    // 轮转数是uint32_t (4字节)
-    uint32_t wheelRevolutions = 
-      (uint32_t)data[offset] |
-      ((uint32_t)data[offset + 1] << 8) |
-      ((uint32_t)data[offset + 2] << 16) |
-      ((uint32_t)data[offset + 3] << 24);
-    offset += 4;
-    sensorData.wheelRevolutions = wheelRevolutions;
-    Serial.printf("[解析] 轮转数: %lu\n", wheelRevolutions);
-    
-    if (flags & 0x02) {  // 轮转时间存在
-      if (offset + 2 > length) {
-        Serial.println("[解析] 错误: 数据长度不足，无法读取轮转时间");
-        return;
-      }
-      // 轮转时间是uint16_t (2字节)
-      uint16_t wheelEventTime = 
-        (uint16_t)data[offset] |
-        ((uint16_t)data[offset + 1] << 8);
-      offset += 2;
-      
-      // 计算速度（需要轮转数和时间）
-      sensorData.speed = calculateSpeed(wheelRevolutions, wheelEventTime);
-      sensorData.lastWheelEventTime = wheelEventTime;
-      Serial.printf("[解析] 轮转时间: %u (1/1024秒), 速度: %.2f km/h\n", wheelEventTime, sensorData.speed);
-    } else {
-      // 只有轮转数，没有时间，无法计算速度
-      Serial.println("[解析] 警告: 有轮转数但无时间，无法计算速度");
-    }
-  } else if (flags & 0x02) {
-    // 只有轮转时间，没有轮转数（非标准，但某些设备可能这样）
-    if (offset + 2 > length) {
-      Serial.println("[解析] 错误: 数据长度不足，无法读取轮转时间");
-      return;
-    }
-    uint16_t wheelEventTime = 
-      (uint16_t)data[offset] |
-      ((uint16_t)data[offset + 1] << 8);
-    offset += 2;
-    sensorData.lastWheelEventTime = wheelEventTime;
-    Serial.printf("[解析] 仅轮转时间: %u (1/1024秒)，无轮转数，无法计算速度\n", wheelEventTime);
+  // 记录数据包格式（每种格式第一次出现时输出）
+  uint16_t shapeBit = 1u << (length < CSC_LAYOUT_MAX_LENGTH ? length : CSC_LAYOUT_MAX_LENGTH);
+  if (!(shapesSeen[flags & 0x0F] & shapeBit)) {
+    shapesSeen[flags & 0x0F] |= shapeBit;
+    PARSER_LOG("[解析] 新的数据包格式: 标志位 0x%02X, 长度 %u 字节\n", flags, (unsigned)length);
   }
   
-  // 解析曲柄数据
-  // 根据BLE规范，曲柄转数是uint16_t (2字节)，曲柄时间也是uint16_t (2字节)
-  // 参考: https://github.com/av1d/BLE-Cycling-Speed-and-Cadence-Service-examples-decode-data
-  if (flags & 0x04) {  // 曲柄转数存在
-    if (offset + 2 > length) {
-      Serial.println("[解析] 错误: 数据长度不足，无法读取曲柄转数");
-      return;
-    }
-    uint16_t crankRevolutions = 
-      (uint16_t)data[offset] |
-      ((uint16_t)data[offset + 1] << 8);
-    offset += 2;
-    sensorData.crankRevolutions = crankRevolutions;
-    Serial.printf("[解析] 曲柄转数: %u\n", crankRevolutions);
-    
-    if (flags & 0x08) {  // 曲柄时间存在
-      if (offset + 2 > length) {
-        Serial.println("[解析] 错误: 数据长度不足，无法读取曲柄时间");
-        return;
-      }
-      uint16_t crankEventTime = 
-        (uint16_t)data[offset] |
-        ((uint16_t)data[offset + 1] << 8);
-      offset += 2;
-      
-      // 计算踏频（需要转数和时间）
-      sensorData.cadence = calculateCadence(crankRevolutions, crankEventTime);
-      sensorData.lastCrankEventTime = crankEventTime;
-      Serial.printf("[解析] 曲柄时间: %u (1/1024秒), 踏频: %.1f rpm\n", crankEventTime, sensorData.cadence);
-    } else {
-      // 只有曲柄转数，没有时间，无法计算踏频
-      Serial.println("[解析] 警告: 有曲柄转数但无时间，无法计算踏频");
-    }
-  } else if (flags & 0x08) {
-    // 只有曲柄时间，没有转数（非标准）
-    if (offset + 2 > length) {
-      Serial.println("[解析] 错误: 数据长度不足，无法读取曲柄时间");
-      return;
-    }
-    uint16_t crankEventTime = 
-      (uint16_t)data[offset] |
-      ((uint16_t)data[offset + 1] << 8);
-    offset += 2;
-    sensorData.lastCrankEventTime = crankEventTime;
-    Serial.printf("[解析] 仅曲柄时间: %u (1/1024秒)，无转数，无法计算踏频\n", crankEventTime);
-  } else {
-    // 没有曲柄数据标志，但设备实际会在数据包中包含曲柄信息
-    // 根据测试确认的数据格式：
-    // - 5字节数据包: 标志位0x02，只有轮转时间 + 曲柄转数（无曲柄时间）
-    // - 11字节数据包: 标志位0x03，轮转数+时间 + 曲柄转数+时间（完整数据）
-    
-    // 如果还有2字节数据，是曲柄转数
-    if (offset + 2 <= length) {
-      uint16_t crankRevolutions = 
-        (uint16_t)data[offset] |
-        ((uint16_t)data[offset + 1] << 8);
-      
-      // 如果还有额外2字节，是曲柄时间（11字节数据包格式）
-      if (offset + 4 <= length) {
-        uint16_t crankEventTime = 
-          (uint16_t)data[offset + 2] |
-          ((uint16_t)data[offset + 3] << 8);
-        
-        // 检查时间值是否合理（1/1024秒，范围0-65535）
-        if (crankEventTime > 0 && crankEventTime <= 65535) {
-          sensorData.cadence = calculateCadence(crankRevolutions, crankEventTime);
-          sensorData.crankRevolutions = crankRevolutions;
-          sensorData.lastCrankEventTime = crankEventTime;
-          Serial.printf("[解析] 曲柄转数: %u, 时间: %u (1/1024秒), 踏频: %.1f rpm\n", 
-                       crankRevolutions, crankEventTime, sensorData.cadence);
-        } else {
-          Serial.println("[解析] 曲柄时间值不合理，跳过");
-        }
-      } else {
-        // 只有转数，没有时间（5字节数据包格式）
-        // 保存转数，等待下次11字节数据包（包含曲柄时间）
-        sensorData.crankRevolutions = crankRevolutions;
-        Serial.printf("[解析] 曲柄转数: %u (无时间，等待11字节数据包)\n", crankRevolutions);
-      }
+  decoderFor(profile, flags, length)(*this, data, sensorData, arrivalUs);
+}
+
+// 事件时间与上一个数据包相同：传感器重复发送最后一次整圈的数据，没有新的事件。
+// CSC_EVENT_HOLD_MS 内保持上次的值（否则高数据包速率时显示会在0和实际值之间闪烁），之后视为停止；
+// 到达时间未知（0）时无法判断，直接视为停止
+static bool holdLastValue(uint32_t arrivalUs, uint32_t lastEventUs) {
+  return arrivalUs != 0 && arrivalUs - lastEventUs < (uint32_t)CSC_EVENT_HOLD_MS * 1000;
+}
+
+float CSCParser::calculateSpeed(uint32_t wheelRevolutions, uint16_t wheelEventTime, uint32_t arrivalUs) {
+  if (lastWheelEventTime != 0 && wheelEventTime == lastWheelEventTime) {
+    if (!holdLastValue(arrivalUs, lastWheelEventUs)) {
+      lastSpeed = 0.0;
     }
+    PARSER_LOG("[速度计算] 时间差为0（没有新的轮转事件），速度: %.2f km/h\n", lastSpeed);
+    return lastSpeed;
   }
-  
-  if (DEBUG_MODE) {
-    Serial.printf("[解析] 解析完成，最终偏移: %d\n", offset);
+  lastSpeed = speedFromWheelEvent(wheelRevolutions, wheelEventTime);
+  lastWheelEventUs = arrivalUs;
+  return lastSpeed;
+}
+
+float CSCParser::calculateCadence(uint16_t crankRevolutions, uint16_t crankEventTime, uint32_t arrivalUs) {
+  if (lastCrankEventTime != 0 && crankEventTime == lastCrankEventTime) {
+    if (!holdLastValue(arrivalUs, lastCrankEventUs)) {
+      lastCadence = 0.0;
+    }
+    return lastCadence;
   }
+  lastCadence = cadenceFromCrankEvent(crankRevolutions, crankEventTime);
+  lastCrankEventUs = arrivalUs;
+  return lastCadence;
 }
 
-float CSCParser::calculateSpeed(uint32_t wheelRevolutions, uint16_t wheelEventTime) {
+float CSCParser::speedFromWheelEvent(uint32_t wheelRevolutions, uint16_t wheelEventTime) {
   if (lastWheelEventTime == 0) {
     lastWheelRevolutions = wheelRevolutions;
     lastWheelEventTime = wheelEventTime;
-    Serial.printf("[速度计算] 第一次数据，保存初始值: 转数=%lu, 时间=%u\n", wheelRevolutions, wheelEventTime);
+    PARSER_LOG("[速度计算] 第一次数据，保存初始值: 转数=%lu, 时间=%u\n", (unsigned long)wheelRevolutions, wheelEventTime);
     return 0.0;
   }
   
@@ -224,18 +358,13 @@ float CSCParser::calculateSpeed(uint32_t wheelRevolutions, uint16_t wheelEventTi
   } else {
     // 处理溢出（65535 -> 0）
     timeDiff = (65535 - lastWheelEventTime) + wheelEventTime + 1;
-    Serial.printf("[速度计算] 时间溢出检测: 上次=%u, 当前=%u, 差值=%u\n", 
+    PARSER_LOG("[速度计算] 时间溢出检测: 上次=%u, 当前=%u, 差值=%u\n", 
                  lastWheelEventTime, wheelEventTime, timeDiff);
   }
   
   float timeSeconds = timeDiff / 1024.0;
   
-  if (timeSeconds == 0) {
-    Serial.println("[速度计算] 时间差为0，跳过");
-    return 0.0;
-  }
-  
-  // 计算转数差
+  // 计算转数差（时间差为0的数据包已在 calculateSpeed 中处理）
   uint32_t revDiff = wheelRevolutions - lastWheelRevolutions;
   
   // 数据验证：检查是否合理
@@ -244,7 +373,7 @@ float CSCParser::calculateSpeed(uint32_t wheelRevolutions, uint16_t wheelEventTi
   // 3. 转数差应该合理（单次最多几转）
   
   if (timeDiff < MIN_TIME_DIFF) {
-    Serial.printf("[速度计算] 时间差太小: %u (1/1024秒)，跳过\n", timeDiff);
+    PARSER_LOG("[速度计算] 时间差太小: %u (1/1024秒)，跳过\n", timeDiff);
     lastWheelRevolutions = wheelRevolutions;
     lastWheelEventTime = wheelEventTime;
     return 0.0;
@@ -252,7 +381,7 @@ float CSCParser::calculateSpeed(uint32_t wheelRevolutions, uint16_t wheelEventTi
   
   // 如果时间差太大（超过10秒），可能是传感器重新启动，重置
   if (timeSeconds > MAX_TIME_DIFF_SEC) {
-    Serial.printf("[速度计算] 时间差过大: %.2f秒，可能是传感器重启，重置\n", timeSeconds);
+    PARSER_LOG("[速度计算] 时间差过大: %.2f秒，可能是传感器重启，重置\n", timeSeconds);
     lastWheelRevolutions = wheelRevolutions;
     lastWheelEventTime = wheelEventTime;
     return 0.0;
@@ -260,30 +389,30 @@ float CSCParser::calculateSpeed(uint32_t wheelRevolutions, uint16_t wheelEventTi
   
   // 如果转数差异常大（超过10转），可能是数据错误
   if (revDiff > MAX_REV_DIFF) {
-    Serial.printf("[速度计算] 转数差异常: %lu转，时间差: %.3f秒，可能数据错误\n", revDiff, timeSeconds);
+    PARSER_LOG("[速度计算] 转数差异常: %lu转，时间差: %.3f秒，可能数据错误\n", (unsigned long)revDiff, timeSeconds);
     // 仍然更新，但可能需要过滤
   }
   
   // 计算速度 (km/h)
   // 速度 = (转数 * 轮周长) / 时间 * 3.6
-  float distance = (revDiff * WHEEL_CIRCUMFERENCE_MM) / 1000000.0;  // 转换为km
+  float distance = (revDiff * wheelCircumferenceMm) / 1000000.0;  // 转换为km
   float speed = (distance / timeSeconds) * 3600.0;  // 转换为km/h
   
   // 速度合理性检查（自行车速度通常在0-100 km/h）
   if (speed > MAX_REASONABLE_SPEED) {
-    Serial.printf("[速度计算] 警告: 速度异常高 %.2f km/h (转数差=%lu, 时间=%.3f秒)\n", 
-                 speed, revDiff, timeSeconds);
-    Serial.printf("[速度计算] 可能原因: 传感器触发不稳定或时间戳异常\n");
+    PARSER_LOG("[速度计算] 警告: 速度异常高 %.2f km/h (转数差=%lu, 时间=%.3f秒)\n", 
+                 speed, (unsigned long)revDiff, timeSeconds);
+    PARSER_LOG("[速度计算] 可能原因: 传感器触发不稳定或时间戳异常\n");
     // 如果速度异常高且时间差很小，可能是传感器抖动，返回0
     if (timeSeconds < 0.1) {
-      Serial.println("[速度计算] 时间差过小，可能是传感器抖动，返回0");
+      PARSER_LOG("[速度计算] 时间差过小，可能是传感器抖动，返回0\n");
       lastWheelRevolutions = wheelRevolutions;
       lastWheelEventTime = wheelEventTime;
       return 0.0;
     }
   }
   
-  Serial.printf("[速度计算] 转数差=%lu, 时间差=%.3f秒, 速度=%.2f km/h\n", revDiff, timeSeconds, speed);
+  PARSER_LOG("[速度计算] 转数差=%lu, 时间差=%.3f秒, 速度=%.2f km/h\n", (unsigned long)revDiff, timeSeconds, speed);
   
   lastWheelRevolutions = wheelRevolutions;
   lastWheelEventTime = wheelEventTime;
@@ -291,7 +420,7 @@ float CSCParser::calculateSpeed(uint32_t wheelRevolutions, uint16_t wheelEventTi
   return speed;
 }
 
-float CSCParser::calculateCadence(uint16_t crankRevolutions, uint16_t crankEventTime) {
+float CSCParser::cadenceFromCrankEvent(uint16_t crankRevolutions, uint16_t crankEventTime) {
   if (lastCrankEventTime == 0) {
     lastCrankRevolutions = crankRevolutions;
     lastCrankEventTime = crankEventTime;
@@ -309,11 +438,7 @@ float CSCParser::calculateCadence(uint16_t crankRevolutions, uint16_t crankEvent
   
   float timeSeconds = timeDiff / 1024.0;
   
-  if (timeSeconds == 0) {
-    return 0.0;
-  }
-  
-  // 计算转数差
+  // 计算转数差（时间差为0的数据包已在 calculateCadence 中处理）
   uint16_t revDiff;
   if (crankRevolutions >= lastCrankRevolutions) {
     revDiff = crankRevolutions - lastCrankRevolutions;
@@ -9,26 +9,59 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "config.h"
+#include "CadenceEstimator.h"
 
 // 前向声明
 struct SensorData;
 
+// 数据包解码方式（与 config.h 中的 CSC_DECODE_PROFILE 取值相同）
+enum CSCDecodeProfile : uint8_t {
+  CSC_PROFILE_AUTO = 0,      // 尚未确定：有歧义的5字节数据包暂按BT003-2格式解码
+  CSC_PROFILE_STANDARD = 1,  // Bluetooth SIG CSC规范
+  CSC_PROFILE_BT003 = 2      // BT003-2：不设置曲柄标志位，曲柄数据按剩余长度判断
+};
+
+// CSC Feature 标志位
+#define CSC_FEATURE_WHEEL 0x0001  // 支持轮转数据
+#define CSC_FEATURE_CRANK 0x0002  // 支持曲柄数据
+
 class CSCParser {
 private:
   uint32_t lastWheelRevolutions;
   uint16_t lastWheelEventTime;
   uint32_t lastCrankRevolutions;
   uint16_t lastCrankEventTime;
+  float lastSpeed;            // 上一次按新的轮转事件算出的速度
+  float lastCadence;
+  uint32_t lastWheelEventUs;  // 上一次新的轮转/曲柄事件所在数据包的到达时间
+  uint32_t lastCrankEventUs;
   
-  float calculateSpeed(uint32_t wheelRevolutions, uint16_t wheelEventTime);
-  float calculateCadence(uint16_t crankRevolutions, uint16_t crankEventTime);
+  CSCDecodeProfile profile;
+  int32_t feature;            // 连接时读取的CSC Feature（-1表示设备未提供）
+  uint16_t shapesSeen[16];    // 已收到的数据包格式：按标志位低4位索引，每位对应一种长度
+  uint8_t learnPackets;       // 自动判断时已收到的有歧义数据包数量
+  uint16_t wheelCircumferenceMm;
+  CadenceEstimator cadenceEstimator;  // 没有曲柄时间的数据包按到达时间估算踏频
+  
+  friend struct CSCDecoders;  // 按布局表生成的解码函数
+  
+  float calculateSpeed(uint32_t wheelRevolutions, uint16_t wheelEventTime, uint32_t arrivalUs);
+  float calculateCadence(uint16_t crankRevolutions, uint16_t crankEventTime, uint32_t arrivalUs);
+  float speedFromWheelEvent(uint32_t wheelRevolutions, uint16_t wheelEventTime);
+  float cadenceFromCrankEvent(uint16_t crankRevolutions, uint16_t crankEventTime);
+  void setProfile(CSCDecodeProfile newProfile, const char* reason);
   
 public:
   CSCParser();
   
-  void parseData(uint8_t* data, size_t length, SensorData& sensorData);
+  // 连接后调用：根据CSC Feature选择解码方式，并重新学习数据包格式
+  void configure(int32_t cscFeature);
+  void setWheelCircumference(uint16_t mm);  // 默认 WHEEL_CIRCUMFERENCE_MM，启动和修改设置时调用
+  // arrivalUs: 通知到达时间（esp_timer，微秒），0表示未知（不估算踏频）
+  void parseData(const uint8_t* data, size_t length, SensorData& sensorData, uint32_t arrivalUs = 0);
   void reset();
+  CSCDecodeProfile getProfile();
+  const char* getProfileName();
 };
 
 #endif // CSC_PARSER_H
-
@@ -0,0 +1,144 @@
+/**
+ * CSC数据中继实现
+ *
+ * 不直接转发原始通知：BT003-2等设备的非标准数据包（见 docs/ble_csc_protocol.md）会被手机按标准格式误读，
+ * 这里从解析后的 SensorData 重新编码为标准格式（标志位0x01/0x02/0x03）：
+ *   - 轮转数变化时才取新的轮转时间（只有轮转时间的数据包不改变转发的数据，否则接收端会算出速度0）
+ *   - 曲柄转数变化而传感器没有给出新的曲柄时间时，从上次的曲柄时间按本机踏频推算（还没有踏频时按通知到达间隔）
+ * 每个数据包只在栈上编码一次交给协议栈；拥塞时直接丢弃，下一个数据包带有最新的累计值，不会丢失路程
+ */
+
+#include "CSCRelay.h"
+#include "SensorData.h"
+#include "LatencyTracker.h"
+#include <Arduino.h>
+
+CSCRelay::CSCRelay() {
+  send = nullptr;
+  context = nullptr;
+  forwarded = 0;
+  dropped = 0;
+  skipped = 0;
+  reset();
+}
+
+void CSCRelay::begin(SendFn send, void* context) {
+  this->send = send;
+  this->context = context;
+}
+
+void CSCRelay::reset() {
+  haveWheel = false;
+  haveCrank = false;
+  wheelRevolutions = 0;
+  wheelEventTime = 0;
+  crankRevolutions = 0;
+  crankEventTime = 0;
+  sourceCrankEventTime = 0;
+  haveArrival = false;
+  lastArrivalUs = 0;
+  clockUs = 0;
+  crankAnchorUs = 0;
+  crankAnchorTime = 0;
+}
+
+size_t CSCRelay::encode(uint8_t* buffer) const {
+  if (!haveWheel && !haveCrank) {
+    return 0;
+  }
+  size_t length = 1;
+  buffer[0] = (haveWheel ? 0x01 : 0x00) | (haveCrank ? 0x02 : 0x00);
+  if (haveWheel) {
+    buffer[length++] = (uint8_t)(wheelRevolutions & 0xFF);
+    buffer[length++] = (uint8_t)((wheelRevolutions >> 8) & 0xFF);
+    buffer[length++] = (uint8_t)((wheelRevolutions >> 16) & 0xFF);
+    buffer[length++] = (uint8_t)(wheelRevolutions >> 24);
+    buffer[length++] = (uint8_t)(wheelEventTime & 0xFF);
+    buffer[length++] = (uint8_t)(wheelEventTime >> 8);
+  }
+  if (haveCrank) {
+    buffer[length++] = (uint8_t)(crankRevolutions & 0xFF);
+    buffer[length++] = (uint8_t)(crankRevolutions >> 8);
+    buffer[length++] = (uint8_t)(crankEventTime & 0xFF);
+    buffer[length++] = (uint8_t)(crankEventTime >> 8);
+  }
+  return length;
+}
+
+RelaySendResult CSCRelay::forward(const SensorData& data, uint32_t arrivalUs) {
+  if (haveArrival) {
+    clockUs += arrivalUs - lastArrivalUs;
+  }
+  haveArrival = true;
+  lastArrivalUs = arrivalUs;
+
+  // 第一个数据包建立基准；之后转数变化时连同事件时间一起更新
+  if (!haveWheel ? data.wheelRevolutions != 0 : data.wheelRevolutions != wheelRevolutions) {
+    haveWheel = true;
+    wheelRevolutions = data.wheelRevolutions;
+    wheelEventTime = data.lastWheelEventTime;
+  }
+  if (!haveCrank ? data.crankRevolutions != 0 : data.crankRevolutions != crankRevolutions) {
+    uint16_t revolutions = data.crankRevolutions - crankRevolutions;
+    if (data.lastCrankEventTime != sourceCrankEventTime) {
+      crankEventTime = data.lastCrankEventTime;
+      crankAnchorTime = data.lastCrankEventTime;
+      crankAnchorUs = clockUs;
+    } else if (haveCrank && data.cadence >= 1.0f) {
+      // 按本机的踏频推算这几转的时间，接收端按相邻两个数据包算出的踏频与本机显示的一致。
+      // 曲柄事件不会晚于通知到达：采用传感器曲柄时间的那个通知最多在事件之后一圈到达，
+      // 因此推算的时间不超过按到达间隔推算的时间再加一圈
+      uint16_t period = (uint16_t)(61440.0f / data.cadence + 0.5f);  // 60 × 1024
+      uint16_t latest = (uint16_t)(crankAnchorTime + (clockUs - crankAnchorUs) * 1024 / 1000000 + period);
+      uint32_t ticks = (uint32_t)revolutions * period;
+      int16_t ahead = (int16_t)(latest - crankEventTime);
+      if (ahead > 0) {
+        crankEventTime += ticks < (uint32_t)ahead ? ticks : ahead;
+      }
+    } else {
+      crankEventTime = (uint16_t)(crankAnchorTime + (clockUs - crankAnchorUs) * 1024 / 1000000);
+    }
+    haveCrank = true;
+    crankRevolutions = data.crankRevolutions;
+    sourceCrankEventTime = data.lastCrankEventTime;
+  }
+
+  uint8_t packet[CSC_RELAY_PACKET_MAX];
+  size_t length = encode(packet);
+  if (length == 0 || send == nullptr) {
+    return RELAY_NO_SUBSCRIBER;
+  }
+
+  RelaySendResult result = send(context, packet, length);
+  switch (result) {
+    case RELAY_SENT:
+      forwarded++;
+      LatencyTracker::record(LATENCY_RELAY, arrivalUs, LatencyTracker::now());
+      break;
+    case RELAY_CONGESTED:
+      dropped++;
+      break;
+    case RELAY_NO_SUBSCRIBER:
+    default:
+      skipped++;
+      break;
+  }
+  return result;
+}
+
+uint32_t CSCRelay::getForwarded() {
+  return forwarded;
+}
+
+uint32_t CSCRelay::getDropped() {
+  return dropped;
+}
+
+uint32_t CSCRelay::getSkipped() {
+  return skipped;
+}
+
+void CSCRelay::report() {
+  Serial.printf("[中继] 已转发 %lu, 拥塞丢弃 %lu, 无订阅跳过 %lu（转发延迟见 latency 命令）\n",
+                (unsigned long)forwarded, (unsigned long)dropped, (unsigned long)skipped);
+}
@@ -0,0 +1,73 @@
+/**
+ * CSC数据中继
+ * 把解析后的传感器数据重新编码为标准CSC Measurement，转发给通过外设角色订阅的中心设备（手机等），
+ * 使只允许一个连接的传感器（如BT003-2）同时供本机和手机使用
+ *
+ * 中继逻辑不依赖BLE库：数据包通过发送函数交出（设备上由 RelayPeripheral 发送，主机测试时可替换为假的GATT服务器）
+ */
+
+#ifndef CSC_RELAY_H
+#define CSC_RELAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// 前向声明
+struct SensorData;
+
+// 标准CSC Measurement最大长度：标志位 + 轮转数据(6) + 曲柄数据(4)
+#define CSC_RELAY_PACKET_MAX 11
+
+enum RelaySendResult : uint8_t {
+  RELAY_SENT = 0,         // 已交给协议栈
+  RELAY_NO_SUBSCRIBER,    // 没有中心设备订阅，不发送
+  RELAY_CONGESTED         // 协议栈拥塞或发送失败，丢弃（不排队，避免转发过时数据）
+};
+
+class CSCRelay {
+public:
+  typedef RelaySendResult (*SendFn)(void* context, const uint8_t* data, size_t length);
+
+  CSCRelay();
+
+  void begin(SendFn send, void* context);
+  void reset();  // 连接新的传感器时调用，重新建立计数器基准
+  // 每个CSC数据包解析后调用，arrivalUs 为通知到达时间（用于统计转发延迟和补齐曲柄时间）
+  RelaySendResult forward(const SensorData& data, uint32_t arrivalUs);
+  // 按当前状态编码标准CSC Measurement，返回长度（没有数据时为0）
+  size_t encode(uint8_t* buffer) const;
+
+  uint32_t getForwarded();
+  uint32_t getDropped();
+  uint32_t getSkipped();
+  void report();
+
+private:
+  SendFn send;
+  void* context;
+
+  // 转发给中心设备的计数器和事件时间（转数和时间总是成对更新，接收端才能算出正确的速度和踏频）
+  bool haveWheel;
+  bool haveCrank;
+  uint32_t wheelRevolutions;
+  uint16_t wheelEventTime;
+  uint16_t crankRevolutions;
+  uint16_t crankEventTime;
+  uint16_t sourceCrankEventTime;  // 传感器上次给出的曲柄时间（不变说明数据包中没有曲柄时间）
+
+  // 没有曲柄时间的数据包补齐曲柄时间（1/1024秒）：从传感器最近给出的曲柄时间按本机踏频推算，
+  // 以到达间隔为上限（还没有踏频时直接按到达间隔），与传感器的时间基准保持连续；
+  // 到达间隔累加到64位，不受32位微秒计时回绕影响
+  bool haveArrival;
+  uint32_t lastArrivalUs;
+  uint64_t clockUs;
+  uint64_t crankAnchorUs;      // 最近一次采用传感器曲柄时间时的 clockUs
+  uint16_t crankAnchorTime;    // 当时的曲柄时间
+
+  uint32_t forwarded;
+  uint32_t dropped;   // 拥塞或发送失败
+  uint32_t skipped;   // 没有订阅者
+};
+
+#endif // CSC_RELAY_H
@@ -0,0 +1,141 @@
+/**
+ * 踏频估算类实现
+ * 
+ * 传感器在曲柄事件发生后的下一个连接事件发送通知，到达时间 = 事件时间 + 0~1个连接间隔 + 协议栈延迟，
+ * 单个间隔的误差可达几十毫秒，直接用相邻两个数据包的时间差计算踏频会明显跳动。
+ * 抖动补偿：
+ *   1. 通知回调中第一时间用 esp_timer 记录到达时间（不受主循环延迟影响）
+ *   2. 到达间隔短于最高踏频周期的通知视为批量到达：被推迟的前一个通知按转数在前后样本之间插值
+ *   3. 对窗口内的 (时间, 累计转数) 做最小二乘直线拟合，斜率即为踏频，随机延迟在拟合中相互抵消
+ * 停止踩踏后传感器仍按固定间隔发送转数不变的数据包，超过窗口时长没有新的曲柄事件时踏频归零
+ */
+
+#include "CadenceEstimator.h"
+
+// 转数一次跳变超过此值视为传感器重启或数据错误，重新开始估算
+#define CADENCE_MAX_REV_JUMP 10
+
+CadenceEstimator::CadenceEstimator() {
+  reset();
+}
+
+void CadenceEstimator::reset() {
+  head = 0;
+  count = 0;
+  lastRaw = 0;
+  hasRaw = false;
+  revolutions = 0;
+  cadence = 0.0;
+}
+
+void CadenceEstimator::restart(uint32_t timeUs) {
+  head = 0;
+  count = 0;
+  samples[head].timeUs = timeUs;
+  samples[head].revolutions = revolutions;
+  head = (head + 1) % CADENCE_WINDOW_SAMPLES;
+  count = 1;
+}
+
+const CadenceEstimator::Sample& CadenceEstimator::sampleAt(uint8_t age) {
+  return samples[(head + CADENCE_WINDOW_SAMPLES - 1 - age) % CADENCE_WINDOW_SAMPLES];
+}
+
+bool CadenceEstimator::addCrankCount(uint16_t crankRevolutions, uint32_t arrivalUs) {
+  if (!hasRaw) {
+    hasRaw = true;
+    lastRaw = crankRevolutions;
+    restart(arrivalUs);
+    return false;
+  }
+  
+  uint16_t delta = crankRevolutions - lastRaw;
+  if (delta == 0) {
+    // 转数未变化（没有新的曲柄事件）：超过窗口时长没有曲柄事件视为停止踩踏，踏频归零。
+    // 最新样本可能被按最小间隔向后展开到到达时间之后，按有符号差比较
+    if (cadence > 0.0 && (int32_t)(arrivalUs - sampleAt(0).timeUs) > (int32_t)CADENCE_WINDOW_MS * 1000) {
+      cadence = 0.0;
+      return true;
+    }
+    return false;
+  }
+  lastRaw = crankRevolutions;
+  revolutions += delta;
+  
+  const Sample& previous = sampleAt(0);
+  uint32_t elapsedUs = arrivalUs - previous.timeUs;
+  if (delta > CADENCE_MAX_REV_JUMP || elapsedUs > (uint32_t)CADENCE_WINDOW_MS * 1000) {
+    // 停止踩踏后重新开始，或转数异常：之前的样本不再代表当前踏频
+    restart(arrivalUs);
+    cadence = 0.0;
+    return false;
+  }
+  
+  // 批量到达的通知：事件间隔不可能短于最高踏频对应的周期。
+  // 前一个通知被推迟到与这个通知一起到达，它的曲柄事件在更早的样本和这个通知之间，按转数线性插值；
+  // 没有更早的样本时把这个通知按最小间隔向后展开
+  uint32_t minGapUs = (uint32_t)delta * (60000000UL / CADENCE_MAX_RPM);
+  uint32_t timeUs = arrivalUs;
+  if (elapsedUs < minGapUs) {
+    if (count >= 2) {
+      const Sample& earlier = sampleAt(1);
+      Sample& delayed = samples[(head + CADENCE_WINDOW_SAMPLES - 1) % CADENCE_WINDOW_SAMPLES];
+      uint32_t spanUs = arrivalUs - earlier.timeUs;
+      uint32_t spanRevs = revolutions - earlier.revolutions;
+      delayed.timeUs = earlier.timeUs + (uint32_t)((uint64_t)spanUs * (delayed.revolutions - earlier.revolutions) / spanRevs);
+    } else {
+      timeUs = previous.timeUs + minGapUs;
+    }
+  }
+  
+  samples[head].timeUs = timeUs;
+  samples[head].revolutions = revolutions;
+  head = (head + 1) % CADENCE_WINDOW_SAMPLES;
+  if (count < CADENCE_WINDOW_SAMPLES) {
+    count++;
+  }
+  
+  // 只使用窗口时长内的样本
+  uint8_t used = 1;
+  while (used < count && timeUs - sampleAt(used).timeUs <= (uint32_t)CADENCE_WINDOW_MS * 1000) {
+    used++;
+  }
+  if (used < CADENCE_MIN_SAMPLES) {
+    return false;
+  }
+  
+  // 最小二乘拟合 转数 = a + b × 时间（以最旧样本为原点，避免浮点精度损失）
+  const Sample& oldest = sampleAt(used - 1);
+  float meanT = 0.0;
+  float meanR = 0.0;
+  for (uint8_t i = 0; i < used; i++) {
+    const Sample& sample = sampleAt(i);
+    meanT += (float)(sample.timeUs - oldest.timeUs);
+    meanR += (float)(sample.revolutions - oldest.revolutions);
+  }
+  meanT /= used;
+  meanR /= used;
+  float covariance = 0.0;
+  float variance = 0.0;
+  for (uint8_t i = 0; i < used; i++) {
+    const Sample& sample = sampleAt(i);
+    float dt = (float)(sample.timeUs - oldest.timeUs) - meanT;
+    float dr = (float)(sample.revolutions - oldest.revolutions) - meanR;
+    covariance += dt * dr;
+    variance += dt * dt;
+  }
+  if (variance <= 0.0) {
+    return false;
+  }
+  
+  float estimate = covariance / variance * 60000000.0;  // 转/微秒 -> rpm
+  if (estimate < 0.0 || estimate > CADENCE_MAX_RPM) {
+    return false;
+  }
+  cadence = estimate;
+  return true;
+}
+
+float CadenceEstimator::getCadence() {
+  return cadence;
+}
@@ -0,0 +1,41 @@
+/**
+ * 踏频估算类
+ * 传感器只发送曲柄转数、不发送曲柄事件时间时（BT003-2的5字节数据包），
+ * 用通知到达的本地时间戳估算踏频
+ */
+
+#ifndef CADENCE_ESTIMATOR_H
+#define CADENCE_ESTIMATOR_H
+
+#include <stdint.h>
+#include "config.h"
+
+class CadenceEstimator {
+private:
+  struct Sample {
+    uint32_t timeUs;       // 曲柄事件时间（通知到达时间，经过抖动补偿）
+    uint32_t revolutions;  // 累计曲柄转数（已处理16位溢出）
+  };
+  
+  Sample samples[CADENCE_WINDOW_SAMPLES];
+  uint8_t head;          // 下一个写入位置
+  uint8_t count;
+  uint16_t lastRaw;      // 上一个数据包中的曲柄转数
+  bool hasRaw;
+  uint32_t revolutions;
+  float cadence;
+  
+  void restart(uint32_t timeUs);
+  const Sample& sampleAt(uint8_t age);  // age = 0 为最新的样本
+  
+public:
+  CadenceEstimator();
+  
+  void reset();
+  // 加入一个只有曲柄转数的数据包，转数变化且窗口内样本足够时更新踏频并返回 true；
+  // 超过 CADENCE_WINDOW_MS 没有新的曲柄事件时踏频归零，同样返回 true
+  bool addCrankCount(uint16_t crankRevolutions, uint32_t arrivalUs);
+  float getCadence();
+};
+
+#endif // CADENCE_ESTIMATOR_H
@@ -0,0 +1,176 @@
+/**
+ * 数字字形图集实现
+ * 帧缓冲区为SSD1306的页格式：第 page 页（8行）第 x 列的字节在 buffer[page * 宽度 + x]，bit 0 为最上面一行。
+ * 建立图集时把同一列各页的字节拼成一列位图；绘制时把列位图移到目标行所在的位，逐页按位或写入帧缓冲区
+ */
+
+#include "DigitAtlas.h"
+#include <string.h>
+
+static const char ATLAS_CHARS[DIGIT_ATLAS_GLYPHS + 1] = "0123456789.";
+
+// 帧缓冲区第 x 列的所有行（最多8页 = 64行）
+static uint64_t columnBits(const uint8_t* buffer, uint8_t tileWidth, uint8_t tileHeight, int16_t x) {
+  uint64_t bits = 0;
+  for (uint8_t page = 0; page < tileHeight && page < 8; page++) {
+    bits |= (uint64_t)buffer[page * tileWidth * 8 + x] << (page * 8);
+  }
+  return bits;
+}
+
+DigitAtlas::DigitAtlas() {
+  font = nullptr;
+  baseline = 0;
+  top = 0;
+  memset(glyphs, 0, sizeof(glyphs));
+}
+
+bool DigitAtlas::build(u8g2_t* u8g2, const uint8_t* font, int16_t baseline) {
+  this->font = nullptr;
+  uint8_t tileWidth = u8g2_GetBufferTileWidth(u8g2);
+  uint8_t tileHeight = u8g2_GetBufferTileHeight(u8g2);
+  if (tileHeight * 8 < u8g2_GetDisplayHeight(u8g2) || tileHeight > 8) {
+    return false;  // 分页模式：缓冲区放不下整个字形
+  }
+  uint8_t* buffer = u8g2_GetBufferPtr(u8g2);
+  int16_t bufferWidth = tileWidth * 8;
+  u8g2_SetFont(u8g2, font);
+  u8g2_SetDrawColor(u8g2, 1);
+  uint16_t zeroWidth = u8g2_GetUTF8Width(u8g2, "0");
+
+  // 第一遍：字形的列数和所有字形共同的行范围
+  uint64_t rows = 0;
+  for (uint8_t i = 0; i < DIGIT_ATLAS_GLYPHS; i++) {
+    char text[3] = {ATLAS_CHARS[i], '0', '\0'};
+    DigitGlyph& glyph = glyphs[i];
+    glyph.advance = (uint8_t)(u8g2_GetUTF8Width(u8g2, text) - zeroWidth);
+    text[1] = '\0';
+    glyph.width = (uint8_t)u8g2_GetUTF8Width(u8g2, text);
+
+    u8g2_ClearBuffer(u8g2);
+    u8g2_DrawUTF8(u8g2, 0, baseline, text);
+    int16_t columns = 0;
+    for (int16_t x = 0; x < bufferWidth; x++) {
+      uint64_t bits = columnBits(buffer, tileWidth, tileHeight, x);
+      if (bits != 0) {
+        rows |= bits;
+        columns = x + 1;
+      }
+    }
+    if (columns > DIGIT_ATLAS_MAX_COLUMNS) {
+      u8g2_ClearBuffer(u8g2);
+      return false;
+    }
+    glyph.columns = (uint8_t)columns;
+  }
+  if (rows == 0) {
+    u8g2_ClearBuffer(u8g2);
+    return false;
+  }
+  int16_t firstRow = 0;
+  while (!(rows & (1ULL << firstRow))) firstRow++;
+  int16_t lastRow = 63;
+  while (!(rows & (1ULL << lastRow))) lastRow--;
+  if (lastRow - firstRow >= 32) {
+    u8g2_ClearBuffer(u8g2);
+    return false;
+  }
+
+  // 第二遍：从第一行开始的列位图
+  for (uint8_t i = 0; i < DIGIT_ATLAS_GLYPHS; i++) {
+    char text[2] = {ATLAS_CHARS[i], '\0'};
+    DigitGlyph& glyph = glyphs[i];
+    u8g2_ClearBuffer(u8g2);
+    u8g2_DrawUTF8(u8g2, 0, baseline, text);
+    for (uint8_t x = 0; x < glyph.columns; x++) {
+      glyph.bits[x] = (uint32_t)(columnBits(buffer, tileWidth, tileHeight, x) >> firstRow);
+    }
+  }
+  u8g2_ClearBuffer(u8g2);
+
+  this->font = font;
+  this->baseline = baseline;
+  top = firstRow;
+  return true;
+}
+
+bool DigitAtlas::isReady() const {
+  return font != nullptr;
+}
+
+bool DigitAtlas::matches(const uint8_t* font, int16_t baseline) const {
+  return this->font != nullptr && this->font == font && this->baseline == baseline;
+}
+
+int8_t DigitAtlas::glyphIndex(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c == '.') return 10;
+  return -1;
+}
+
+// U8g2 的字符串宽度：前面的字符按步进累加，最后一个字符按字形本身的宽度
+int16_t DigitAtlas::getWidth(const char* text) const {
+  int16_t width = 0;
+  for (; *text; text++) {
+    int8_t index = glyphIndex(*text);
+    if (index < 0) return -1;
+    width += text[1] != '\0' ? glyphs[index].advance : glyphs[index].width;
+  }
+  return width;
+}
+
+void DigitAtlas::draw(uint8_t* buffer, uint8_t tileWidth, uint8_t tileHeight, int16_t x, const char* text) const {
+  int16_t bufferWidth = tileWidth * 8;
+  uint8_t firstPage = top / 8;
+  uint8_t shift = top % 8;
+  for (; *text; text++) {
+    int8_t index = glyphIndex(*text);
+    if (index < 0) continue;
+    const DigitGlyph& glyph = glyphs[index];
+    for (uint8_t column = 0; column < glyph.columns; column++) {
+      int16_t px = x + column;
+      if (px < 0 || px >= bufferWidth) continue;
+      uint64_t bits = (uint64_t)glyph.bits[column] << shift;
+      uint8_t* out = buffer + firstPage * bufferWidth + px;
+      for (uint8_t page = firstPage; page < tileHeight && bits != 0; page++, out += bufferWidth) {
+        *out |= (uint8_t)bits;
+        bits >>= 8;
+      }
+    }
+    x += glyph.advance;
+  }
+}
+
+void DigitAtlas::formatFixed(float value, uint8_t decimals, char* out, size_t size) {
+  static const uint32_t SCALES[] = {1, 10, 100, 1000};
+  if (size == 0) return;
+  if (decimals > 3) decimals = 3;
+  if (!(value > 0)) value = 0;  // 负数和NaN
+  if (value > 999999.0f) value = 999999.0f;
+  // float 乘以10的幂在 double 中没有误差；与 printf 一致，正好一半时向偶数舍入
+  double exact = (double)value * SCALES[decimals];
+  uint32_t scaled = (uint32_t)exact;
+  double remainder = exact - scaled;
+  if (remainder > 0.5 || (remainder == 0.5 && (scaled & 1))) scaled++;
+  uint32_t whole = scaled / SCALES[decimals];
+  uint32_t fraction = scaled % SCALES[decimals];
+
+  char digits[8];
+  uint8_t count = 0;
+  do {
+    digits[count++] = (char)('0' + whole % 10);
+    whole /= 10;
+  } while (whole > 0);
+
+  size_t length = 0;
+  while (count > 0 && length + 1 < size) {
+    out[length++] = digits[--count];
+  }
+  if (decimals > 0 && length + 1 < size) {
+    out[length++] = '.';
+    for (uint8_t d = decimals; d > 0 && length + 1 < size; d--) {
+      out[length++] = (char)('0' + fraction / SCALES[d - 1] % 10);
+    }
+  }
+  out[length] = '\0';
+}
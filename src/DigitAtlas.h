@@ -0,0 +1,53 @@
+/**
+ * 数字字形图集
+ * 速度、踏频等大号数字每帧都要经过 snprintf 和 U8g2 的字形解码（字体数据是压缩的，每个字形逐段解码）。
+ * 启动时用 U8g2 把 "0123456789." 逐个画到帧缓冲区，按帧缓冲区的页格式（每字节纵向8像素）
+ * 读出不压缩的列位图；之后绘制时直接把列位图移位后写入帧缓冲区，不再调用 U8g2。
+ * 位图来自同一个字体、同一条基线，绘制结果与 U8g2 逐像素相同（host/bench_digits 验证并比较耗时）
+ */
+
+#ifndef DIGIT_ATLAS_H
+#define DIGIT_ATLAS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <clib/u8g2.h>
+
+#define DIGIT_ATLAS_GLYPHS 11        // "0123456789."
+#define DIGIT_ATLAS_MAX_COLUMNS 24   // 单个字形最多的像素列数（更宽的字体不建立图集）
+
+struct DigitGlyph {
+  uint8_t advance;  // 画完后下一个字符的起点右移的像素数
+  uint8_t width;    // 作为字符串最后一个字符时计入的宽度（与 U8g2 的 getUTF8Width 一致）
+  uint8_t columns;  // 位图列数
+  uint32_t bits[DIGIT_ATLAS_MAX_COLUMNS];  // 每列一个字，bit 0 为位图最上面一行（最多32行）
+};
+
+class DigitAtlas {
+public:
+  DigitAtlas();
+
+  // 用 U8g2 把每个字符画在基线 baseline 上再从帧缓冲区读出（会清空帧缓冲区）。
+  // 需要完整帧缓冲区；字形超过32行或 DIGIT_ATLAS_MAX_COLUMNS 列时返回 false
+  bool build(u8g2_t* u8g2, const uint8_t* font, int16_t baseline);
+  bool isReady() const;
+  bool matches(const uint8_t* font, int16_t baseline) const;
+
+  // 字符串宽度（与 U8g2 的 getUTF8Width 一致），含有图集之外的字符时返回 -1
+  int16_t getWidth(const char* text) const;
+  // 从 x 开始把字符串写入帧缓冲区（只设置像素，调用前需已清除区域），图集之外的字符跳过
+  void draw(uint8_t* buffer, uint8_t tileWidth, uint8_t tileHeight, int16_t x, const char* text) const;
+
+  // 非负数按 "%.Nf" 格式化（decimals 最多3位，负数按0），不经过 printf
+  static void formatFixed(float value, uint8_t decimals, char* out, size_t size);
+
+private:
+  const uint8_t* font;
+  int16_t baseline;
+  int16_t top;  // 位图第一行在帧缓冲区中的行号
+  DigitGlyph glyphs[DIGIT_ATLAS_GLYPHS];
+
+  static int8_t glyphIndex(char c);
+};
+
+#endif // DIGIT_ATLAS_H
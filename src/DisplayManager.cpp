@@ -4,56 +4,67 @@
  */
 
 #include "DisplayManager.h"
+#include "SensorData.h"
+#include "LatencyTracker.h"
 #include <Arduino.h>
+#include <esp_timer.h>
 #include <math.h>
 
-// 前向声明结构体（在ble_meter.ino中定义）
-struct SensorData {
-  float speed;
-  float cadence;
-  bool connected;
-  int8_t batteryLevel;
-  String deviceName;
-  int8_t rssi;
-  float distance;
-  float totalDistance;
-  float averageSpeed;
-  unsigned long rideDuration;
-  uint32_t wheelRevolutions;
-  uint32_t initialWheelRevolutions;
-  unsigned long connectionStartTime;
-};
-
 DisplayManager::DisplayManager() {
-#ifdef OLED_128x64
-  display = new U8G2_SSD1306_128X64_NONAME_F_HW_I2C(U8G2_R0, /* reset=*/ U8X8_PIN_NONE);
-#else
-  display = new U8G2_SSD1306_128X32_NONAME_F_HW_I2C(U8G2_R0, /* reset=*/ U8X8_PIN_NONE);
-#endif
+  display = new OLEDDisplay(U8G2_R0, /* reset=*/ U8X8_PIN_NONE);
   initialized = false;
+  lastFrameUs = 0;
+  firstFrameUs = 0;
+  maxFrameUs = 0;
+  lastStampedArrivalUs = 0;
+  mailbox.theme = 0;
+  mailbox.hasData = false;
+  mailbox.statusKind = FRAME_BLANK;
+  mailbox.statusText[0] = '\0';
+  mailbox.statusMs = 0;
+  mailbox.hasStatus = false;
+  memset(&publishedKey, 0, sizeof(publishedKey));
+  mailboxLock = portMUX_INITIALIZER_UNLOCKED;
+  renderTask = nullptr;
+  renderRunning = false;
+  framePeriodMs = DISPLAY_REFRESH_INTERVAL;
+  lastJitterUs = 0;
+  maxJitterUs = 0;
+  framesRendered = 0;
+  framesSkipped = 0;
 }
 
 DisplayManager::~DisplayManager() {
+  stopRenderTask();
   if (display) {
     delete display;
   }
 }
 
 bool DisplayManager::begin() {
-  // 初始化 I2C 总线（使用自定义引脚）
-  Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
+  // 初始化 I2C 总线（使用自定义引脚和快速模式时钟）
+  Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN, OLED_I2C_CLOCK);
   
   // 设置 I2C 地址（U8g2 需要 8 位地址，所以需要乘以 2）
   display->setI2CAddress(OLED_I2C_ADDRESS * 2);
+  // U8g2 每次传输前都会重新设置 Wire 时钟，需要同步设置
+  display->setBusClock(OLED_I2C_CLOCK);
   
   // 初始化显示（HW_I2C 版本使用硬件 I2C）
   display->begin();
   display->enableUTF8Print();
-  display->clearBuffer();
-  display->sendBuffer();
+  display->clearDisplay();  // 完整帧缓冲区和分页模式下均可用
+  
+  // 控件渲染：建立数字图集时借用帧缓冲区并切换字体，需在设置默认字体之前
+  widgets.begin(display);
   
-  // 默认中文字体：unifont Chinese3（覆盖更多汉字）
-  display->setFont(u8g2_font_unifont_t_chinese3);
+  // 默认中文字体：unifont Chinese3 或界面子集字体（见 UI_FONT）
+  display->setFont(UI_FONT);
+  
+#if OLED_BUFFER_MODE == 0
+  // 初始化帧传输（异步模式下由独立任务发送帧缓冲区）
+  transport.begin(display, OLED_ASYNC_TRANSFER);
+#endif
   
   initialized = true;
   
@@ -63,434 +74,449 @@ bool DisplayManager::begin() {
   Serial.print(" (设置值: 0x");
   Serial.print(OLED_I2C_ADDRESS * 2, HEX);
   Serial.println(")");
+#if OLED_BUFFER_MODE == 0
+  Serial.printf("I2C时钟: %lu Hz, 完整帧缓冲区 %u 字节, 传输方式: %s\n", (unsigned long)OLED_I2C_CLOCK,
+                (unsigned)getFrameBufferBytes(), transport.isAsync() ? "异步" : "同步");
+#else
+  Serial.printf("I2C时钟: %lu Hz, 分页缓冲区 %u 字节（每帧 %u 页）\n", (unsigned long)OLED_I2C_CLOCK,
+                (unsigned)getFrameBufferBytes(),
+                (unsigned)(display->getDisplayHeight() / 8 / display->getBufferTileHeight()));
+#endif
+  Serial.printf("数字图集: %u 个, %u 字节\n", widgets.getAtlasCount(), (unsigned)widgets.getAtlasBytes());
   return true;
 }
 
-void DisplayManager::clear() {
-  if (display) {
+// 渲染一帧
+// 完整帧缓冲区模式：绘制一次后发送（传感器界面只发送变化的tile区域）
+// 分页模式：U8g2 每次只缓冲若干行tile，firstPage/nextPage 循环中对每一页重复绘制并发送
+void DisplayManager::render(const FrameRequest& request) {
+  unsigned long startUs = micros();
+  
+  // 延迟标记：每个数据包只在第一次出现在帧中时统计
+  FrameStamp stamp = FrameStamp();
+  if (request.kind == FRAME_SENSOR && request.data->packetArrivalUs != 0 &&
+      request.data->packetArrivalUs != lastStampedArrivalUs) {
+    stamp.arrivalUs = request.data->packetArrivalUs;
+    stamp.frameStartUs = LatencyTracker::now();
+    lastStampedArrivalUs = stamp.arrivalUs;
+    LatencyTracker::record(LATENCY_DISPLAY_WAIT, request.data->packetParsedUs, stamp.frameStartUs);
+  }
+  
+#if OLED_BUFFER_MODE == 0
+  if (request.kind == FRAME_SENSOR) {
+    // 传感器界面增量绘制：只重绘并发送内容变化的控件
+    TileRegion region = widgets.draw(getThemeLayout(request.theme), *request.data, request.time);
+    transport.submit(region, stamp);
+  } else {
     display->clearBuffer();
-    display->sendBuffer();
+    drawFrame(request);
+    widgets.invalidate();
+    transport.submit();
+  }
+#else
+  display->firstPage();
+  do {
+    drawFrame(request);
+  } while (display->nextPage());
+  uint32_t sentUs = LatencyTracker::now();
+  LatencyTracker::record(LATENCY_FRAME, stamp.frameStartUs, sentUs);
+  LatencyTracker::record(LATENCY_END_TO_END, stamp.arrivalUs, sentUs);
+#endif
+  
+  lastFrameUs = micros() - startUs;
+  if (lastFrameUs > maxFrameUs) {
+    maxFrameUs = lastFrameUs;
+  }
+  if (firstFrameUs == 0) {
+    firstFrameUs = (uint32_t)esp_timer_get_time();
   }
 }
 
-void DisplayManager::showSplash(const char* text) {
+// 绘制一帧内容（分页模式下每页调用一次，不能有副作用）
+void DisplayManager::drawFrame(const FrameRequest& request) {
+  switch (request.kind) {
+    case FRAME_SPLASH: {
+      // 使用较大英文字体并居中显示
+      display->setFont(u8g2_font_logisoso24_tr);
+      int16_t x = (display->getDisplayWidth() - display->getUTF8Width(request.text)) / 2;
+      int16_t y = 44;  // 适配128x64，垂直居中略下
+      if (x < 0) x = 0;
+      display->drawUTF8(x, y, request.text);
+      break;
+    }
+    case FRAME_STATUS:
+      // 使用中文字体，略微右移防止裁剪
+      display->setFont(UI_FONT);
+      display->drawUTF8(2, 32, request.text);
+      break;
+    case FRAME_ERROR:
+      display->setFont(UI_FONT);
+      display->drawUTF8(0, 12, "错误:");
+      display->drawUTF8(0, 28, request.text);
+      break;
+    case FRAME_SENSOR:
+      // 按主题布局表绘制（0=数字表盘，1=模拟表盘，2=数据统计表盘，见 ThemeLayouts.cpp）
+      widgets.drawAll(getThemeLayout(request.theme), *request.data, request.time);
+      break;
+    case FRAME_BLANK:
+    default:
+      break;
+  }
+}
+
+void DisplayManager::post(FrameKind kind, const char* text) {
   if (!display) return;
   
-  display->clearBuffer();
-  // 使用较大英文字体并居中显示
-  display->setFont(u8g2_font_logisoso24_tr);
-  int16_t x = (display->getDisplayWidth() - display->getUTF8Width(text)) / 2;
-  int16_t y = 44;  // 适配128x64，垂直居中略下
-  if (x < 0) x = 0;
-  display->drawUTF8(x, y, text);
-  display->sendBuffer();
+  if (!renderRunning) {
+    FrameRequest request = {kind, text, nullptr, 0, 0};
+    render(request);
+    return;
+  }
+  
+  // 渲染任务运行时只复制文字到邮箱（调用者的字符串可能是临时的）
+  portENTER_CRITICAL(&mailboxLock);
+  mailbox.statusKind = kind;
+  if (text) {
+    strncpy(mailbox.statusText, text, sizeof(mailbox.statusText) - 1);
+    mailbox.statusText[sizeof(mailbox.statusText) - 1] = '\0';
+  } else {
+    mailbox.statusText[0] = '\0';
+  }
+  mailbox.statusMs = millis();
+  mailbox.hasStatus = true;
+  portEXIT_CRITICAL(&mailboxLock);
+  if (renderTask) {
+    xTaskNotifyGive(renderTask);
+  }
+}
+
+void DisplayManager::clear() {
+  post(FRAME_BLANK, nullptr);
+}
+
+void DisplayManager::showSplash(const char* text) {
+  post(FRAME_SPLASH, text);
 }
 
 void DisplayManager::showStatus(const char* text) {
-  if (!display) return;
-  
-  display->clearBuffer();
-  // 使用 unifont Chinese3，覆盖更多汉字，略微右移防止裁剪
-  display->setFont(u8g2_font_unifont_t_chinese3);
-  display->drawUTF8(2, 32, text);
-  display->sendBuffer();
+  post(FRAME_STATUS, text);
 }
 
 void DisplayManager::showError(const char* text) {
-  if (!display) return;
-  
-  display->clearBuffer();
-  display->setFont(u8g2_font_unifont_t_chinese3);
-  display->drawUTF8(0, 12, "错误:");
-  display->drawUTF8(0, 28, text);
-  display->sendBuffer();
+  post(FRAME_ERROR, text);
 }
 
 void DisplayManager::updateDisplay(const SensorData& data, uint8_t theme) {
   if (!display) return;
-  
-  display->clearBuffer();
-  
-  // 根据主题选择显示方式
-  if (theme == 1) {
-    // 模拟仪表盘主题
-    drawAnalogSpeedometer(data);
-    display->sendBuffer();
-    return;
-  } else if (theme == 2) {
-    // 数据统计表盘主题
-    drawStatisticsPanel(data);
-    display->sendBuffer();
+  if (renderRunning) {
+    publish(data, theme);
     return;
   }
-  
-  // 主题0：数字显示仪表盘主题（默认）
-  
-  // 显示速度（大字体）
-  display->setFont(u8g2_font_logisoso32_tn);  // 使用数字字体显示速度
-  char speedStr[16];
-  snprintf(speedStr, sizeof(speedStr), "%.1f", data.speed);
-  display->setCursor(0, 32);
-  display->print(speedStr);
-  
-  // 显示单位
-  display->setFont(u8g2_font_unifont_t_chinese3);
-  display->drawUTF8(85, 12, "km/h");
-  
-  // 显示踏频（仅128x64屏幕）
+  // 动画时间在帧开始时取一次，保证分页模式下各页绘制一致
+  FrameRequest request = {FRAME_SENSOR, nullptr, &data, theme, millis()};
+  render(request);
+}
+
+void DisplayManager::publish(const SensorData& data, uint8_t theme) {
+  // 主循环每次循环都会发布。邮箱总是保存最新数据，只有可见内容（按显示精度）变化时才唤醒渲染任务；
+  // 按 VisibleKey 比较（各字段逐个填入，填充字节已清零），不比较 SensorData 的原始字节
+  FrameRequest request = {FRAME_SENSOR, nullptr, &data, theme, 0};
+  VisibleKey key;
+  makeVisibleKey(request, key);
+  portENTER_CRITICAL(&mailboxLock);
+  bool changed = !mailbox.hasData || memcmp(&key, &publishedKey, sizeof(key)) != 0;
+  mailbox.data = data;
+  mailbox.theme = theme;
+  mailbox.hasData = true;
+  portEXIT_CRITICAL(&mailboxLock);
+  publishedKey = key;
+  if (changed && renderTask) {
+    xTaskNotifyGive(renderTask);
+  }
+}
+
+bool DisplayManager::startRenderTask(uint32_t periodMs) {
+  if (!display || renderRunning) return renderRunning;
+  
+  framePeriodMs = periodMs > 0 ? periodMs : 1;
+  lastJitterUs = 0;
+  maxJitterUs = 0;
+  renderRunning = true;
+  // 优先级高于主循环（1），刷新节拍不受数据包处理和连接过程影响；绘制完即休眠到下一次数据或计划刷新
+  if (xTaskCreate(renderTaskEntry, "render", DISPLAY_RENDER_TASK_STACK, this, 2, &renderTask) != pdPASS) {
+    renderRunning = false;
+    renderTask = nullptr;
+    Serial.println("渲染任务创建失败，在主循环中刷新显示");
+    return false;
+  }
+  Serial.printf("渲染任务已启动，空闲刷新间隔 %lu ms\n", (unsigned long)framePeriodMs);
+  return true;
+}
+
+void DisplayManager::stopRenderTask() {
+  if (!renderRunning) return;
+  renderRunning = false;
+  // 渲染任务可能在 ulTaskNotifyTake 中等待下一次空闲刷新（最长 DISPLAY_IDLE_REFRESH_MAX），先唤醒它；
+  // 之后等待它画完当前帧退出（退出时清空 renderTask），再由调用者直接操作显示
+  TaskHandle_t task = renderTask;
+  if (task != nullptr) {
+    xTaskNotifyGive(task);
+  }
+  while (renderTask != nullptr) {
+    delay(1);
+  }
+}
+
+bool DisplayManager::isRenderTaskRunning() {
+  return renderRunning;
+}
+
+void DisplayManager::renderTaskEntry(void* param) {
+  static_cast<DisplayManager*>(param)->renderLoop();
+}
+
+// 生成当前帧的可见内容键：各数值按屏幕显示精度量化，键不变则画面不变，无需重绘
+void DisplayManager::makeVisibleKey(const FrameRequest& request, VisibleKey& key) {
+  memset(&key, 0, sizeof(key));
+  key.kind = request.kind;
+  if (request.kind == FRAME_SENSOR) {
+    const SensorData& data = *request.data;
+    key.theme = request.theme;
+    key.connected = data.connected;
+    key.rssi = data.rssi;
+    key.batteryLevel = data.batteryLevel;
+    key.speed = lroundf(data.speed * 10.0f);           // %.1f
+    key.cadence = lroundf(data.cadence);               // %.0f
+    key.averageSpeed = lroundf(data.averageSpeed * 10.0f);
+    key.distance = lroundf(data.distance * 1000.0f);   // 米（覆盖 %.0f m 和 %.2f km）
+    key.totalDistance = lroundf(data.totalDistance * 1000.0f);
+    key.rideDuration = data.rideDuration;
+    key.linkLossPermille = data.linkLossPermille;
+    key.rssiTrend = data.rssiTrend;
+    key.historyIndex = data.historyIndex;
+    key.historyCount = data.historyCount;
+    key.historySequence = data.historyRide.sequence;
+    strncpy(key.text, data.deviceName, sizeof(key.text) - 1);
+  } else if (request.text) {
+    strncpy(key.text, request.text, sizeof(key.text) - 1);
+  }
+}
+
+// 变化驱动的刷新策略：
+// - 可见内容变化后立即重绘（与上一帧至少间隔 DISPLAY_MIN_FRAME_INTERVAL）
+// - 踏频轮子动画只在数字表盘显示且踏频大于0时，按 DISPLAY_ANIMATION_INTERVAL 固定节拍刷新
+// - 内容不变时按空闲间隔刷新，空闲间隔从 DISPLAY_REFRESH_INTERVAL 开始每次加倍，最长 DISPLAY_IDLE_REFRESH_MAX
+void DisplayManager::renderLoop() {
+  SensorData data;
+  char statusText[sizeof(mailbox.statusText)];
+  VisibleKey lastKey;
+  VisibleKey key;
+  memset(&lastKey, 0, sizeof(lastKey));
+  bool firstFrame = true;
+  uint32_t idleIntervalMs = framePeriodMs;
+  uint32_t lastFrameStartUs = micros();
+  uint32_t waitMs = 0;
+  
+  while (renderRunning) {
+    // 等待新数据通知或下一个计划刷新时间
+    ulTaskNotifyTake(pdTRUE, waitMs > 0 ? pdMS_TO_TICKS(waitMs) : 0);
+    if (!renderRunning) break;
+    
+    // 取出最新内容：状态文字在保持时间内优先显示，之后显示传感器数据
+    unsigned long nowMs = millis();
+    FrameRequest request = {FRAME_BLANK, nullptr, nullptr, 0, nowMs};
+    uint32_t statusRemainingMs = 0;
+    portENTER_CRITICAL(&mailboxLock);
+    bool statusHeld = mailbox.hasStatus && mailbox.hasData && nowMs - mailbox.statusMs < DISPLAY_STATUS_HOLD_MS;
+    if (mailbox.hasStatus && (!mailbox.hasData || statusHeld)) {
+      request.kind = mailbox.statusKind;
+      memcpy(statusText, mailbox.statusText, sizeof(statusText));
+      request.text = statusText;
+      if (statusHeld) {
+        statusRemainingMs = DISPLAY_STATUS_HOLD_MS - (nowMs - mailbox.statusMs);
+      }
+    } else if (mailbox.hasData) {
+      data = mailbox.data;
+      request.kind = FRAME_SENSOR;
+      request.data = &data;
+      request.theme = mailbox.theme;
+    }
+    portEXIT_CRITICAL(&mailboxLock);
+    
+    makeVisibleKey(request, key);
+    bool changed = firstFrame || memcmp(&key, &lastKey, sizeof(key)) != 0;
 #ifdef OLED_128x64
-  // 踏频数字（中等字体，比速度小）
-  display->setFont(u8g2_font_logisoso24_tn);  // 使用中等字体显示踏频（比速度的32小）
-  char cadenceStr[16];
-  snprintf(cadenceStr, sizeof(cadenceStr), "%.0f", data.cadence);
-  display->setCursor(0, 64);  // 底部对齐
-  display->print(cadenceStr);
-  
-  // 显示"rpm"单位（在踏频数字后面，紧跟着）
-  display->setFont(u8g2_font_unifont_t_chinese3);
-  display->drawUTF8(display->getCursorX() + 2, 64, "rpm");
-  
-  // 绘制踏频轮子动画（在右侧）
-  drawCadenceWheel(data.cadence, millis());
+    bool animating = request.kind == FRAME_SENSOR && request.theme == 0 && data.cadence > 0;
 #else
-  // 128x32 屏幕空间较小，只显示关键信息
-  display->setFont(u8g2_font_unifont_t_chinese3);
-  if (data.connected) {
-    int16_t x = 0;
-    // 显示设备名称（如果有，最多7个字符）
-    if (data.deviceName.length() > 0) {
-      String name = data.deviceName;
-      if (name.length() > 7) {
-        name = name.substring(0, 7);
+    bool animating = false;
+#endif
+    
+    uint32_t nowUs = micros();
+    uint32_t sinceFrameMs = (nowUs - lastFrameStartUs) / 1000;
+    uint32_t scheduledMs = animating ? DISPLAY_ANIMATION_INTERVAL : idleIntervalMs;
+    bool minIntervalPassed = sinceFrameMs >= DISPLAY_MIN_FRAME_INTERVAL;
+    bool due = sinceFrameMs >= scheduledMs;
+    
+    if ((changed && minIntervalPassed) || due) {
+      // 计划刷新（动画/空闲）的实际时间与计划时间之差即帧节拍抖动
+      if (!changed && !firstFrame) {
+        uint32_t lateUs = (nowUs - lastFrameStartUs) - scheduledMs * 1000;
+        lastJitterUs = lateUs;
+        if (lateUs > maxJitterUs) {
+          maxJitterUs = lateUs;
+        }
+      }
+      
+      render(request);
+      framesRendered++;
+      lastFrameStartUs = nowUs;
+      lastKey = key;
+      firstFrame = false;
+      
+      if (changed) {
+        idleIntervalMs = framePeriodMs;
+      } else if (!animating) {
+        idleIntervalMs = idleIntervalMs * 2 < DISPLAY_IDLE_REFRESH_MAX ? idleIntervalMs * 2 : DISPLAY_IDLE_REFRESH_MAX;
       }
-      display->drawUTF8(x, 20, name.c_str());
-      x += display->getUTF8Width(name.c_str()) + 1;
+      sinceFrameMs = 0;
+      changed = false;
+    } else {
+      framesSkipped++;
     }
     
-    // 显示信号强度（去掉单位）
-    if (data.rssi != 0) {
-      char rssiStr[16];
-      snprintf(rssiStr, sizeof(rssiStr), "%d", data.rssi);
-      display->drawUTF8(x, 20, rssiStr);
-      x += display->getUTF8Width(rssiStr) + 1;
+    // 下一次唤醒：计划刷新时间、待显示变化的最小间隔到期时间、状态文字保持到期时间中最早的一个
+    scheduledMs = animating ? DISPLAY_ANIMATION_INTERVAL : idleIntervalMs;
+    waitMs = scheduledMs > sinceFrameMs ? scheduledMs - sinceFrameMs : 1;
+    if (changed && DISPLAY_MIN_FRAME_INTERVAL > sinceFrameMs && DISPLAY_MIN_FRAME_INTERVAL - sinceFrameMs < waitMs) {
+      waitMs = DISPLAY_MIN_FRAME_INTERVAL - sinceFrameMs;
     }
-    
-    // 显示电量（如果有，显示在右侧）
-    if (data.batteryLevel >= 0) {
-      char batteryStr[16];
-      snprintf(batteryStr, sizeof(batteryStr), "%d%%", data.batteryLevel);
-      int16_t batteryX = display->getDisplayWidth() - display->getUTF8Width(batteryStr);
-      display->drawUTF8(batteryX, 20, batteryStr);
+    if (statusRemainingMs > 0 && statusRemainingMs < waitMs) {
+      waitMs = statusRemainingMs;
     }
-  } else {
-    display->drawUTF8(0, 20, "Disconnected");
   }
-#endif
   
-  display->sendBuffer();
+  renderTask = nullptr;
+  vTaskDelete(nullptr);
 }
 
 // 关闭显示（清空并进入省电）
 void DisplayManager::powerOff() {
   if (!display) return;
-  display->clearBuffer();
-  display->sendBuffer();
+  stopRenderTask();
+  clear();
+#if OLED_BUFFER_MODE == 0
+  // 异步模式下等待传输任务发送完成，再直接发送省电命令
+  transport.waitIdle(200);
+#endif
   display->setPowerSave(1);
 }
 
-void DisplayManager::drawSpeed(float speed) {
-  // 可以在这里实现更复杂的速度显示
+uint32_t DisplayManager::getFrameJitterUs() {
+  return lastJitterUs;
 }
 
-void DisplayManager::drawCadence(float cadence) {
-  // 可以在这里实现更复杂的踏频显示
+uint32_t DisplayManager::getMaxFrameJitterUs() {
+  return maxJitterUs;
 }
 
-void DisplayManager::drawConnectionStatus(bool connected) {
-  // 可以在这里实现连接状态指示
+uint32_t DisplayManager::getFramesRendered() {
+  return framesRendered;
 }
 
-// 绘制模拟仪表盘
-void DisplayManager::drawAnalogSpeedometer(const SensorData& data) {
-  if (!display) return;
-  
-#ifdef OLED_128x64
-  const int16_t centerX = 64;   // 表盘中心X坐标（屏幕中心）
-  const int16_t centerY = 55;   // 表盘中心Y坐标（减少与顶部距离）
-  const int16_t radiusX = 62;   // 表盘X方向半径（水平方向，增大）
-  const int16_t radiusY = 52;   // 表盘Y方向半径（垂直方向，压扁，增大）
-  const float maxSpeed = 60.0;  // 最大速度 60 km/h
-  const float startAngle = 180.0;  // 起始角度（左侧，0 km/h）
-  const float endAngle = 0.0;      // 结束角度（右侧，60 km/h）
-  const float angleRange = 180.0;  // 角度范围（180度，半圆）
-  
-  // 绘制表盘外圆（半椭圆，压扁适配）
-  for (float angle = startAngle; angle >= endAngle; angle -= 2.0) {
-    float rad = angle * M_PI / 180.0;
-    int16_t x = centerX + (int16_t)(cos(rad) * radiusX);
-    int16_t y = centerY - (int16_t)(sin(rad) * radiusY);  // 负号修正上下颠倒
-    display->drawPixel(x, y);
-  }
-  
-  // 绘制刻度线
-  for (int i = 0; i <= 6; i++) {
-    float speed = i * 10.0;  // 0, 10, 20, 30, 40, 50, 60
-    float angle = startAngle - (speed / maxSpeed) * angleRange;  // 左边0，右边60
-    float rad = angle * M_PI / 180.0;
-    
-    // 长刻度线
-    int16_t x1 = centerX + (int16_t)(cos(rad) * (radiusX - 6));
-    int16_t y1 = centerY - (int16_t)(sin(rad) * (radiusY - 6));  // 负号修正
-    int16_t x2 = centerX + (int16_t)(cos(rad) * radiusX);
-    int16_t y2 = centerY - (int16_t)(sin(rad) * radiusY);  // 负号修正
-    display->drawLine(x1, y1, x2, y2);
-    
-    // 显示刻度值（0, 20, 40, 60）
-    if (i % 2 == 0) {
-      display->setFont(u8g2_font_6x10_tf);
-      char speedLabel[4];
-      snprintf(speedLabel, sizeof(speedLabel), "%.0f", speed);
-      int16_t labelX = centerX + (int16_t)(cos(rad) * (radiusX - 15)) - 6;
-      int16_t labelY = centerY - (int16_t)(sin(rad) * (radiusY - 15)) + 3;  // 负号修正
-      display->drawStr(labelX, labelY, speedLabel);
-    }
-  }
-  
-  // 绘制指针
-  float currentSpeed = data.speed;
-  if (currentSpeed > maxSpeed) currentSpeed = maxSpeed;
-  if (currentSpeed < 0) currentSpeed = 0;
-  
-  float pointerAngle = startAngle - (currentSpeed / maxSpeed) * angleRange;  // 左边0，右边60
-  float pointerRad = pointerAngle * M_PI / 180.0;
-  
-  // 指针长度（从中心到表盘边缘）
-  int16_t pointerLengthX = radiusX - 10;
-  int16_t pointerLengthY = radiusY - 10;
-  int16_t pointerX = centerX + (int16_t)(cos(pointerRad) * pointerLengthX);
-  int16_t pointerY = centerY - (int16_t)(sin(pointerRad) * pointerLengthY);  // 负号修正
-  
-  // 绘制指针线
-  display->drawLine(centerX, centerY, pointerX, pointerY);
-  
-  // 绘制指针中心点
-  display->drawDisc(centerX, centerY, 3, U8G2_DRAW_ALL);
-  
-  // 左上角显示信号强度
-  if (data.rssi != 0) {
-    display->setFont(u8g2_font_6x10_tf);
-    char rssiStr[8];
-    snprintf(rssiStr, sizeof(rssiStr), "%d", data.rssi);
-    display->drawStr(2, 10, rssiStr);
-  }
-  
-  // 右上角显示电量
-  if (data.batteryLevel >= 0) {
-    display->setFont(u8g2_font_6x10_tf);
-    char batteryStr[8];
-    snprintf(batteryStr, sizeof(batteryStr), "%d%%", data.batteryLevel);
-    int16_t batteryX = display->getDisplayWidth() - display->getStrWidth(batteryStr) - 2;
-    display->drawStr(batteryX, 10, batteryStr);
-  }
-  
-  // 表中间显示踏频
-  display->setFont(u8g2_font_logisoso16_tn);
-  char cadenceStr[8];
-  snprintf(cadenceStr, sizeof(cadenceStr), "%.0f", data.cadence);
-  int16_t cadenceX = centerX - display->getStrWidth(cadenceStr) / 2;
-  int16_t cadenceY = centerY + 2;  // 上移，从+8改为+2
-  display->drawStr(cadenceX, cadenceY, cadenceStr);
-  
-  // 显示"rpm"单位
-  display->setFont(u8g2_font_6x10_tf);
-  int16_t rpmX = centerX - 12;
-  int16_t rpmY = cadenceY + 12;
-  display->drawStr(rpmX, rpmY, "rpm");
-#endif
+uint32_t DisplayManager::getFramesSkipped() {
+  return framesSkipped;
 }
 
-// 绘制数据统计表盘
-void DisplayManager::drawStatisticsPanel(const SensorData& data) {
-  if (!display) return;
-  
-#ifdef OLED_128x64
-  // 128x64屏幕：显示完整统计信息
-  display->setFont(u8g2_font_6x10_tf);
-  int16_t y = 10;
-  int16_t lineHeight = 9;
-  
-  // 第1行：速度
-  char speedStr[32];
-  snprintf(speedStr, sizeof(speedStr), "Speed: %.1f km/h", data.speed);
-  display->drawStr(2, y, speedStr);
-  y += lineHeight;
-  
-  // 第2行：踏频
-  char cadenceStr[32];
-  snprintf(cadenceStr, sizeof(cadenceStr), "Cadence: %.0f rpm", data.cadence);
-  display->drawStr(2, y, cadenceStr);
-  y += lineHeight;
-  
-  // 第3行：本次路程
-  char distanceStr[32];
-  if (data.distance < 1.0) {
-    snprintf(distanceStr, sizeof(distanceStr), "Distance: %.0f m", data.distance * 1000.0);
-  } else {
-    snprintf(distanceStr, sizeof(distanceStr), "Distance: %.2f km", data.distance);
-  }
-  display->drawStr(2, y, distanceStr);
-  y += lineHeight;
-  
-  // 第4行：总路程
-  char totalDistStr[32];
-  if (data.totalDistance < 1.0) {
-    snprintf(totalDistStr, sizeof(totalDistStr), "Total: %.0f m", data.totalDistance * 1000.0);
-  } else {
-    snprintf(totalDistStr, sizeof(totalDistStr), "Total: %.2f km", data.totalDistance);
-  }
-  display->drawStr(2, y, totalDistStr);
-  y += lineHeight;
-  
-  // 第5行：平均速度
-  char avgSpeedStr[32];
-  snprintf(avgSpeedStr, sizeof(avgSpeedStr), "Avg Speed: %.1f km/h", data.averageSpeed);
-  display->drawStr(2, y, avgSpeedStr);
-  y += lineHeight;
-  
-  // 第6行：本次骑行时长
-  char durationStr[32];
-  unsigned long hours = data.rideDuration / 3600;
-  unsigned long minutes = (data.rideDuration % 3600) / 60;
-  unsigned long seconds = data.rideDuration % 60;
-  if (hours > 0) {
-    snprintf(durationStr, sizeof(durationStr), "Duration: %lu:%02lu:%02lu", hours, minutes, seconds);
-  } else {
-    snprintf(durationStr, sizeof(durationStr), "Duration: %lu:%02lu", minutes, seconds);
-  }
-  display->drawStr(2, y, durationStr);
-  y += lineHeight;
-  
-  // 第7行：设备名称 + 信号/电量（合并为一行，保持总行数≤7）
-  char infoStr[48];
-  if (data.connected) {
-    String deviceName = "";
-    if (data.deviceName.length() > 0) {
-      deviceName = data.deviceName;
-      if (deviceName.length() > 7) {
-        deviceName = deviceName.substring(0, 7);
-      }
-    }
-    
-    int len = 0;
-    if (deviceName.length() > 0) {
-      len = snprintf(infoStr, sizeof(infoStr), "%s", deviceName.c_str());
-    } else {
-      len = snprintf(infoStr, sizeof(infoStr), "Connected");
-    }
-    
-    if (data.rssi != 0 && len < (int)sizeof(infoStr)) {
-      len += snprintf(infoStr + len, sizeof(infoStr) - len, " R:%d", data.rssi);
-    }
-    if (data.batteryLevel >= 0 && len < (int)sizeof(infoStr)) {
-      len += snprintf(infoStr + len, sizeof(infoStr) - len, " B:%d%%", data.batteryLevel);
-    }
-    display->drawStr(2, y, infoStr);
-  } else {
-    snprintf(infoStr, sizeof(infoStr), "Disconnected");
-    display->drawStr(2, y, infoStr);
-  }
+uint32_t DisplayManager::getFrameBlockingUs() {
+  return lastFrameUs;
+}
+
+uint32_t DisplayManager::getMaxFrameBlockingUs() {
+  return maxFrameUs;
+}
+
+uint32_t DisplayManager::getFrameTransferUs() {
+#if OLED_BUFFER_MODE == 0
+  return transport.getLastTransferUs();
 #else
-  // 128x32屏幕：显示简化统计信息
-  display->setFont(u8g2_font_6x10_tf);
-  int16_t y = 8;
-  int16_t lineHeight = 8;
-  
-  // 第1行：速度和踏频
-  char line1[32];
-  snprintf(line1, sizeof(line1), "S:%.1f C:%.0f", data.speed, data.cadence);
-  display->drawStr(2, y, line1);
-  y += lineHeight;
-  
-  // 第2行：路程
-  char line2[32];
-  if (data.distance < 1.0) {
-    snprintf(line2, sizeof(line2), "D:%.0fm T:%.0fm", data.distance * 1000.0, data.totalDistance * 1000.0);
-  } else {
-    snprintf(line2, sizeof(line2), "D:%.2fkm T:%.1fkm", data.distance, data.totalDistance);
-  }
-  display->drawStr(2, y, line2);
-  y += lineHeight;
-  
-  // 第3行：平均速度和骑行时长
-  char line3[32];
-  unsigned long hours = data.rideDuration / 3600;
-  unsigned long minutes = (data.rideDuration % 3600) / 60;
-  if (hours > 0) {
-    snprintf(line3, sizeof(line3), "Avg:%.1f T:%lu:%02lu", data.averageSpeed, hours, minutes);
-  } else {
-    snprintf(line3, sizeof(line3), "Avg:%.1f T:%lum", data.averageSpeed, minutes);
-  }
-  display->drawStr(2, y, line3);
-  y += lineHeight;
-  
-  // 第4行：信号和电量
-  char line4[32];
-  if (data.rssi != 0 && data.batteryLevel >= 0) {
-    snprintf(line4, sizeof(line4), "R:%d B:%d%%", data.rssi, data.batteryLevel);
-  } else if (data.rssi != 0) {
-    snprintf(line4, sizeof(line4), "RSSI:%d", data.rssi);
-  } else if (data.batteryLevel >= 0) {
-    snprintf(line4, sizeof(line4), "Battery:%d%%", data.batteryLevel);
-  } else {
-    snprintf(line4, sizeof(line4), "");
-  }
-  if (strlen(line4) > 0) {
-    display->drawStr(2, y, line4);
+  return lastFrameUs;  // 分页模式下传输与绘制交替进行，无法单独计时
+#endif
+}
+
+uint32_t DisplayManager::getFirstFrameUs() {
+  return firstFrameUs;
+}
+
+size_t DisplayManager::getFrameBufferBytes() {
+  size_t bytes = (size_t)display->getBufferTileWidth() * display->getBufferTileHeight() * 8;
+#if OLED_BUFFER_MODE == 0
+  if (transport.isAsync()) {
+    bytes += 2 * OLED_FRAMEBUFFER_SIZE;  // 异步传输双缓冲
   }
 #endif
+  return bytes;
 }
 
-// 绘制踏频轮子动画
-void DisplayManager::drawCadenceWheel(float cadence, unsigned long currentTime) {
+// 帧缓冲区模式基准测试：统计RAM占用和每个主题的帧延迟（主循环被阻塞的时间）
+// 分别以 OLED_BUFFER_MODE = 0/1/2 编译运行，对比串口输出
+void DisplayManager::runBenchmark(uint16_t framesPerTheme) {
   if (!display) return;
   
-#ifdef OLED_128x64
-  // 轮子位置：右下角
-  const int16_t radius = 18;    // 轮子半径（放大，从14增加到18）
-  const int16_t centerX = 128 - radius - 2;  // 轮子中心X坐标（右下角，留2像素边距）
-  const int16_t centerY = 64 - radius - 2;   // 轮子中心Y坐标（右下角，留2像素边距）
-  
-  // 根据踏频计算旋转角度
-  // 踏频单位是rpm（每分钟转数），转换为每秒转数，再计算角度
-  // 增加速度倍数，让轮子转得更快更明显
-  const float speedMultiplier = 3.0;  // 速度倍数，让视觉上更明显
-  float rotationAngle = 0.0;
-  if (cadence > 0) {
-    // 使用时间计算旋转角度，使轮子持续旋转
-    // 角度 = (当前时间毫秒 / 1000.0) * (踏频 / 60.0) * 360.0 * 速度倍数
-    float seconds = currentTime / 1000.0;
-    float rotations = seconds * (cadence / 60.0) * speedMultiplier;
-    rotationAngle = fmod(rotations * 360.0, 360.0);
-  }
-  
-  // 绘制轮子外圆
-  display->drawCircle(centerX, centerY, radius, U8G2_DRAW_ALL);
-  
-  // 绘制辐条（4条，表示旋转）
-  const int numSpokes = 4;
-  for (int i = 0; i < numSpokes; i++) {
-    float angle = (rotationAngle + i * 90.0) * M_PI / 180.0;
-    // 辐条从中心到边缘
-    int16_t x1 = centerX;
-    int16_t y1 = centerY;
-    int16_t x2 = centerX + (int16_t)(cos(angle) * (radius - 1));
-    int16_t y2 = centerY + (int16_t)(sin(angle) * (radius - 1));
-    display->drawLine(x1, y1, x2, y2);
+  static const char* modeNames[] = {"完整帧缓冲(_F)", "单页缓冲(_1)", "双页缓冲(_2)"};
+  SensorData benchData;
+  benchData.speed = 25.5;
+  benchData.cadence = 85;
+  benchData.connected = true;
+  benchData.batteryLevel = 75;
+  strcpy(benchData.deviceName, "CSC-Sensor");
+  benchData.rssi = -65;
+  benchData.distance = 1.5;
+  benchData.totalDistance = 150.3;
+  benchData.averageSpeed = 22.8;
+  benchData.rideDuration = 240;
+  benchData.historyIndex = 1;
+  benchData.historyCount = 5;
+  benchData.historyRide = {5, 0, 3725, 3410, 3100, 24.6, 23.3, 41.2, 82.0};
+  
+  Serial.println("=== 显示基准测试 ===");
+  Serial.printf("模式: %s, 帧缓冲区RAM: %u 字节, 空闲堆: %u 字节\n", modeNames[OLED_BUFFER_MODE],
+                (unsigned)getFrameBufferBytes(), (unsigned)ESP.getFreeHeap());
+  
+  for (uint8_t theme = 0; theme < DISPLAY_THEME_COUNT; theme++) {
+    uint32_t totalUs = 0;
+    uint32_t worstUs = 0;
+    for (uint16_t i = 0; i < framesPerTheme; i++) {
+      benchData.speed = 20.0 + (i % 100) * 0.1;  // 每帧数值不同，避免缓存效应
+      updateDisplay(benchData, theme);
+      totalUs += lastFrameUs;
+      if (lastFrameUs > worstUs) worstUs = lastFrameUs;
+    }
+#if OLED_BUFFER_MODE == 0
+    transport.waitIdle(200);
+#endif
+    Serial.printf("主题%d: 平均 %lu us/帧, 最大 %lu us/帧 (%u 帧)\n", theme,
+                  (unsigned long)(totalUs / framesPerTheme), (unsigned long)worstUs, framesPerTheme);
   }
   
-  // 绘制中心点
-  display->drawDisc(centerX, centerY, 2, U8G2_DRAW_ALL);
+  // 数字表盘的速度/踏频改用字体绘制（snprintf + U8g2字形解码），与上面的数字图集结果对比
+  if (widgets.getAtlasCount() > 0) {
+    widgets.setAtlasEnabled(false);
+    uint32_t totalUs = 0;
+    uint32_t worstUs = 0;
+    for (uint16_t i = 0; i < framesPerTheme; i++) {
+      benchData.speed = 20.0 + (i % 100) * 0.1;
+      updateDisplay(benchData, 0);
+      totalUs += lastFrameUs;
+      if (lastFrameUs > worstUs) worstUs = lastFrameUs;
+    }
+#if OLED_BUFFER_MODE == 0
+    transport.waitIdle(200);
 #endif
+    widgets.setAtlasEnabled(true);
+    Serial.printf("主题0（字体绘制）: 平均 %lu us/帧, 最大 %lu us/帧 (%u 帧)\n",
+                  (unsigned long)(totalUs / framesPerTheme), (unsigned long)worstUs, framesPerTheme);
+  }
+  Serial.println("====================");
 }
 
 // 显示调试主界面（使用模拟数据，方便调试界面布局）
@@ -503,7 +529,7 @@ void DisplayManager::showDebugDisplay(uint8_t theme) {
   debugData.cadence = 85;      // 模拟踏频 85 rpm
   debugData.connected = true;  // 模拟已连接状态
   debugData.batteryLevel = 75; // 模拟电量 75%
-  debugData.deviceName = "CSC-Sensor"; // 模拟设备名称
+  strcpy(debugData.deviceName, "CSC-Sensor"); // 模拟设备名称
   debugData.rssi = -65;        // 模拟信号强度 -65 dBm
   debugData.distance = 1.5;    // 模拟本次路程 1.5 km
   debugData.totalDistance = 150.3; // 模拟总路程 150.3 km
@@ -10,25 +10,121 @@
 #include <Wire.h>
 #include <U8g2lib.h>
 #include "config.h"
+#include "DisplayTransport.h"
+#include "SensorData.h"
+#include "WidgetRenderer.h"
 
-// 前向声明
-struct SensorData;
+// 界面中文字体
+// USE_UI_FONT_SUBSET 为 true 时使用 tools/gen_ui_font.py 生成的子集字体（只含界面用到的字形）
+#if USE_UI_FONT_SUBSET
+  #include "fonts/ui_font.h"
+  #define UI_FONT u8g2_font_ble_meter_ui
+#else
+  #define UI_FONT u8g2_font_unifont_t_chinese3
+#endif
 
-class DisplayManager {
-private:
+// 标记会显示到屏幕上的字符串（先存入数组/变量再显示的文字）
+// tools/gen_ui_font.py 据此收集子集字体需要的字形
+#define UI_TEXT(s) (s)
+
+// 根据屏幕尺寸和帧缓冲区模式选择 U8g2 构造类
+// _F: 完整帧缓冲区，_1/_2: 分页缓冲（1或2行tile）
 #ifdef OLED_128x64
-  U8G2_SSD1306_128X64_NONAME_F_HW_I2C* display;
+  #if OLED_BUFFER_MODE == 1
+    typedef U8G2_SSD1306_128X64_NONAME_1_HW_I2C OLEDDisplay;
+  #elif OLED_BUFFER_MODE == 2
+    typedef U8G2_SSD1306_128X64_NONAME_2_HW_I2C OLEDDisplay;
+  #else
+    typedef U8G2_SSD1306_128X64_NONAME_F_HW_I2C OLEDDisplay;
+  #endif
 #else
-  U8G2_SSD1306_128X32_NONAME_F_HW_I2C* display;
+  #if OLED_BUFFER_MODE == 1
+    typedef U8G2_SSD1306_128X32_NONAME_1_HW_I2C OLEDDisplay;
+  #elif OLED_BUFFER_MODE == 2
+    typedef U8G2_SSD1306_128X32_NONAME_2_HW_I2C OLEDDisplay;
+  #else
+    typedef U8G2_SSD1306_128X32_NONAME_F_HW_I2C OLEDDisplay;
+  #endif
 #endif
+
+class DisplayManager {
+private:
+  // 一帧的绘制内容（分页模式下同一帧会被重复绘制多次）
+  enum FrameKind {
+    FRAME_BLANK,
+    FRAME_SPLASH,
+    FRAME_STATUS,
+    FRAME_ERROR,
+    FRAME_SENSOR
+  };
+  struct FrameRequest {
+    FrameKind kind;
+    const char* text;
+    const SensorData* data;
+    uint8_t theme;
+    unsigned long time;  // 动画时间（帧开始时取一次）
+  };
+  
+  // 可见内容键（各数值按显示精度量化），用于判断画面是否需要重绘
+  struct VisibleKey {
+    uint8_t kind;
+    uint8_t theme;
+    bool connected;
+    int8_t rssi;
+    int8_t batteryLevel;
+    int32_t speed;          // 0.1 km/h
+    int32_t cadence;        // rpm
+    int32_t averageSpeed;   // 0.1 km/h
+    int32_t distance;       // m
+    int32_t totalDistance;  // m
+    uint32_t rideDuration;  // s
+    uint16_t linkLossPermille;
+    int8_t rssiTrend;
+    uint8_t historyIndex;
+    uint8_t historyCount;
+    uint32_t historySequence;  // 显示的骑行记录编号
+    char text[32];          // 状态文字或设备名称
+  };
+  
+  // 最新值邮箱：主循环写入最新数据/状态，渲染任务每帧取出最新内容，双方都只在复制时短暂持锁
+  struct Mailbox {
+    SensorData data;
+    uint8_t theme;
+    bool hasData;
+    FrameKind statusKind;
+    char statusText[32];
+    unsigned long statusMs;  // 状态文字的发布时间（在 DISPLAY_STATUS_HOLD_MS 内优先于传感器数据显示）
+    bool hasStatus;
+  };
+  
+  OLEDDisplay* display;
   bool initialized;
   
-  void drawSpeed(float speed);
-  void drawCadence(float cadence);
-  void drawConnectionStatus(bool connected);
-  void drawCadenceWheel(float cadence, unsigned long currentTime);  // 绘制踏频轮子动画
-  void drawAnalogSpeedometer(const SensorData& data);  // 绘制模拟仪表盘
-  void drawStatisticsPanel(const SensorData& data);  // 绘制数据统计表盘
+  Mailbox mailbox;
+  portMUX_TYPE mailboxLock;
+  VisibleKey publishedKey;  // 最近一次发布的数据的可见内容键（只由主循环访问）
+  TaskHandle_t renderTask;
+  volatile bool renderRunning;
+  uint32_t framePeriodMs;
+  uint32_t lastJitterUs;   // 最近一次计划刷新（动画/空闲）比计划时间延迟的时间
+  uint32_t maxJitterUs;
+  uint32_t framesRendered;
+  uint32_t framesSkipped;  // 被唤醒但可见内容未变化、未重绘的次数
+  WidgetRenderer widgets;  // 主题控件绘制（记录各控件上一帧的内容）
+#if OLED_BUFFER_MODE == 0
+  DisplayTransport transport;  // 帧缓冲区传输（同步或异步）
+#endif
+  uint32_t lastFrameUs;  // 最近一帧主循环被阻塞的时间（绘制+传输或提交）
+  uint32_t firstFrameUs; // 启动到第一帧绘制完成的时间（0表示还没有绘制）
+  uint32_t maxFrameUs;
+  uint32_t lastStampedArrivalUs;  // 最近一次统计延迟的数据包到达时间（同一数据包重绘时不重复统计）
+  
+  void render(const FrameRequest& request);
+  void post(FrameKind kind, const char* text);  // 渲染任务运行时写入邮箱，否则直接渲染
+  static void renderTaskEntry(void* param);
+  void renderLoop();
+  void makeVisibleKey(const FrameRequest& request, VisibleKey& key);
+  void drawFrame(const FrameRequest& request);
   
 public:
   DisplayManager();
@@ -45,6 +141,28 @@ public:
   void showDebugDisplay(uint8_t theme = 0);
   // 关闭显示（进入低功耗），清空并关闭面板
   void powerOff();
+  
+  // 渲染任务：独立刷新显示，主循环只通过 publish() 发布最新数据，互不阻塞
+  // 可见内容变化时立即重绘，内容不变时空闲刷新间隔从 periodMs 开始逐步加倍
+  // 任务运行时 show*/clear 也只写入邮箱，由渲染任务绘制
+  bool startRenderTask(uint32_t periodMs = DISPLAY_REFRESH_INTERVAL);
+  void stopRenderTask();
+  bool isRenderTaskRunning();
+  void publish(const SensorData& data, uint8_t theme);
+  uint32_t getFrameJitterUs();     // 最近一次计划刷新的节拍抖动（微秒）
+  uint32_t getMaxFrameJitterUs();
+  uint32_t getFramesRendered();
+  uint32_t getFramesSkipped();
+  
+  // 显示统计（微秒）：每帧主循环阻塞时间（绘制+传输）、最大阻塞时间、I2C总线传输时间
+  uint32_t getFrameBlockingUs();
+  uint32_t getMaxFrameBlockingUs();
+  uint32_t getFrameTransferUs();
+  uint32_t getFirstFrameUs();     // 启动（唤醒）到第一帧的时间（微秒）
+  size_t getFrameBufferBytes();  // 帧缓冲区占用的RAM（字节）
+  
+  // 帧缓冲区模式基准测试（输出RAM占用和各主题帧延迟到串口）
+  void runBenchmark(uint16_t framesPerTheme = 50);
 };
 
 #endif // DISPLAY_MANAGER_H
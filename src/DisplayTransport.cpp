@@ -0,0 +1,199 @@
+/**
+ * 显示传输类实现
+ *
+ * 同步模式：直接调用 sendBuffer()，主循环阻塞整个I2C传输过程
+ * 异步模式：submit() 只把帧缓冲区复制到空闲的发送缓冲区并通知传输任务，
+ *          传输任务逐行（8像素为一行tile）调用 u8x8_DrawTile 发送，
+ *          I2C驱动等待传输完成时CPU可以继续处理数据包或进入空闲
+ * 局部发送：只发送变化区域覆盖的tile行和列范围，其余部分屏幕上的内容保持不变
+ */
+
+#include "DisplayTransport.h"
+#include "LatencyTracker.h"
+
+void TileRegion::add(const TileRegion& other) {
+  if (other.isEmpty()) return;
+  if (isEmpty()) {
+    *this = other;
+    return;
+  }
+  rowMask |= other.rowMask;
+  if (other.colStart < colStart) colStart = other.colStart;
+  if (other.colEnd > colEnd) colEnd = other.colEnd;
+}
+
+TileRegion TileRegion::full() {
+  TileRegion region = {(uint8_t)((1u << (OLED_FRAMEBUFFER_SIZE / 128)) - 1), 0, 15};
+  return region;
+}
+
+DisplayTransport::DisplayTransport() {
+  display = nullptr;
+  async = false;
+  sendingIndex = -1;
+  pendingIndex = -1;
+  pendingRegion = {0, 0, 0};
+  pendingStamp = FrameStamp();
+  lock = portMUX_INITIALIZER_UNLOCKED;
+  task = nullptr;
+  lastBlockingUs = 0;
+  maxBlockingUs = 0;
+  lastTransferUs = 0;
+  framesSent = 0;
+  framesCoalesced = 0;
+}
+
+bool DisplayTransport::begin(U8G2* display, bool async) {
+  this->display = display;
+  this->async = false;
+
+  if (async) {
+    // 传输任务与主循环同优先级，主循环 delay() 或等待时运行
+    if (xTaskCreate(taskEntry, "oled_tx", 2048, this, 1, &task) == pdPASS) {
+      this->async = true;
+    } else {
+      Serial.println("显示传输任务创建失败，使用同步传输");
+    }
+  }
+  return this->async == async;
+}
+
+void DisplayTransport::submit(const TileRegion& region, const FrameStamp& stamp) {
+  if (!display || region.isEmpty()) return;
+
+  unsigned long startUs = micros();
+
+  if (!async) {
+    sendFrame(display->getBufferPtr(), region);
+    recordSent(stamp);
+    lastTransferUs = micros() - startUs;
+    lastBlockingUs = lastTransferUs;
+    framesSent++;
+  } else {
+    // 选择未在发送的缓冲区；若它正等待发送，先撤销，避免任务读到复制了一半的帧
+    portENTER_CRITICAL(&lock);
+    int8_t index = (sendingIndex == 0) ? 1 : 0;
+    if (pendingIndex == index) {
+      pendingIndex = -1;
+      framesCoalesced++;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    memcpy(buffers[index], display->getBufferPtr(), OLED_FRAMEBUFFER_SIZE);
+
+    // 区域累加到上次发送之后的变化区域中（被撤销的待发送帧的区域也在其中）
+    portENTER_CRITICAL(&lock);
+    pendingIndex = index;
+    pendingRegion.add(region);
+    // 被撤销的帧没有发出：新帧有标记时以新帧为准，否则新帧显示的仍是被撤销帧的数据
+    if (stamp.arrivalUs != 0) {
+      pendingStamp = stamp;
+    }
+    portEXIT_CRITICAL(&lock);
+    xTaskNotifyGive(task);
+
+    lastBlockingUs = micros() - startUs;
+  }
+
+  if (lastBlockingUs > maxBlockingUs) {
+    maxBlockingUs = lastBlockingUs;
+  }
+}
+
+bool DisplayTransport::waitIdle(uint32_t timeoutMs) {
+  if (!async) return true;
+
+  unsigned long start = millis();
+  while (millis() - start < timeoutMs) {
+    portENTER_CRITICAL(&lock);
+    bool idle = (sendingIndex < 0 && pendingIndex < 0);
+    portEXIT_CRITICAL(&lock);
+    if (idle) return true;
+    delay(1);
+  }
+  return false;
+}
+
+void DisplayTransport::taskEntry(void* param) {
+  static_cast<DisplayTransport*>(param)->taskLoop();
+}
+
+void DisplayTransport::taskLoop() {
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    while (true) {
+      portENTER_CRITICAL(&lock);
+      int8_t index = pendingIndex;
+      TileRegion region = pendingRegion;
+      FrameStamp stamp = pendingStamp;
+      pendingIndex = -1;
+      if (index >= 0) {
+        pendingRegion.rowMask = 0;
+        pendingStamp = FrameStamp();
+      }
+      sendingIndex = index;
+      portEXIT_CRITICAL(&lock);
+
+      if (index < 0) break;
+
+      unsigned long startUs = micros();
+      sendFrame(buffers[index], region);
+      recordSent(stamp);
+      lastTransferUs = micros() - startUs;
+      framesSent++;
+
+      portENTER_CRITICAL(&lock);
+      sendingIndex = -1;
+      portEXIT_CRITICAL(&lock);
+    }
+  }
+}
+
+void DisplayTransport::recordSent(const FrameStamp& stamp) {
+  uint32_t sentUs = LatencyTracker::now();
+  LatencyTracker::record(LATENCY_FRAME, stamp.frameStartUs, sentUs);
+  LatencyTracker::record(LATENCY_END_TO_END, stamp.arrivalUs, sentUs);
+}
+
+void DisplayTransport::sendFrame(const uint8_t* buffer, const TileRegion& region) {
+  // 与 U8g2 的 sendBuffer() 相同：逐个tile行发送，最后刷新显示
+  // 只发送区域内的tile行，每行只发送 [colStart, colEnd] 列
+  u8x8_t* u8x8 = display->getU8x8();
+  uint8_t tileWidth = display->getBufferTileWidth();
+  uint8_t tileHeight = display->getBufferTileHeight();
+  uint8_t colEnd = region.colEnd < tileWidth ? region.colEnd : tileWidth - 1;
+  if (region.colStart > colEnd) return;
+  uint8_t count = colEnd - region.colStart + 1;
+  for (uint8_t row = 0; row < tileHeight; row++) {
+    if (region.rowMask & (1u << row)) {
+      u8x8_DrawTile(u8x8, region.colStart, row, count,
+                    (uint8_t*)(buffer + (row * tileWidth + region.colStart) * 8));
+    }
+  }
+  u8x8_RefreshDisplay(u8x8);
+}
+
+bool DisplayTransport::isAsync() {
+  return async;
+}
+
+uint32_t DisplayTransport::getLastBlockingUs() {
+  return lastBlockingUs;
+}
+
+uint32_t DisplayTransport::getMaxBlockingUs() {
+  return maxBlockingUs;
+}
+
+uint32_t DisplayTransport::getLastTransferUs() {
+  return lastTransferUs;
+}
+
+uint32_t DisplayTransport::getFramesSent() {
+  return framesSent;
+}
+
+uint32_t DisplayTransport::getFramesCoalesced() {
+  return framesCoalesced;
+}
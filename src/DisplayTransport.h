@@ -0,0 +1,80 @@
+/**
+ * 显示传输类
+ * 负责把 U8g2 帧缓冲区发送到 OLED
+ * 异步模式下由独立的 FreeRTOS 任务完成 I2C 传输，主循环只需复制帧缓冲区后立即返回
+ */
+
+#ifndef DISPLAY_TRANSPORT_H
+#define DISPLAY_TRANSPORT_H
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include "config.h"
+
+// 帧缓冲区大小（每字节8个竖向像素）
+#ifdef OLED_128x64
+#define OLED_FRAMEBUFFER_SIZE (128 * 64 / 8)
+#else
+#define OLED_FRAMEBUFFER_SIZE (128 * 32 / 8)
+#endif
+
+// 需要发送的tile区域（8x8像素为一个tile）：rowMask 每位对应一行tile，列范围 [colStart, colEnd]
+struct TileRegion {
+  uint8_t rowMask;
+  uint8_t colStart;
+  uint8_t colEnd;
+
+  bool isEmpty() const { return rowMask == 0; }
+  void add(const TileRegion& other);
+  static TileRegion full();
+};
+
+// 帧的延迟标记：帧中最新数据包的通知到达时间和开始绘制的时间（0表示不统计，见 LatencyTracker）
+struct FrameStamp {
+  uint32_t arrivalUs;
+  uint32_t frameStartUs;
+};
+
+class DisplayTransport {
+private:
+  U8G2* display;
+  bool async;
+
+  // 双缓冲：任务发送其中一个时，主循环写入另一个
+  uint8_t buffers[2][OLED_FRAMEBUFFER_SIZE];
+  int8_t sendingIndex;   // 正在发送的缓冲区（-1表示空闲）
+  int8_t pendingIndex;   // 等待发送的缓冲区（-1表示没有）
+  TileRegion pendingRegion;  // 上一次发送之后变化的区域（被合并的帧的区域也累加在内）
+  FrameStamp pendingStamp;   // 等待发送的帧中最新的延迟标记
+  portMUX_TYPE lock;
+  TaskHandle_t task;
+
+  // 统计数据（微秒）
+  uint32_t lastBlockingUs;   // 最近一帧主循环被阻塞的时间
+  uint32_t maxBlockingUs;
+  uint32_t lastTransferUs;   // 最近一帧I2C总线传输时间
+  uint32_t framesSent;
+  uint32_t framesCoalesced;  // 上一帧还未发出就被新帧替换的次数
+
+  static void taskEntry(void* param);
+  void taskLoop();
+  void sendFrame(const uint8_t* buffer, const TileRegion& region);
+  static void recordSent(const FrameStamp& stamp);
+
+public:
+  DisplayTransport();
+
+  bool begin(U8G2* display, bool async);
+  // 提交当前帧缓冲区中变化的区域，帧发送完成时按 stamp 记录延迟
+  void submit(const TileRegion& region = TileRegion::full(), const FrameStamp& stamp = FrameStamp());
+  bool waitIdle(uint32_t timeoutMs);    // 等待所有帧发送完成（同步操作前调用）
+  bool isAsync();
+
+  uint32_t getLastBlockingUs();
+  uint32_t getMaxBlockingUs();
+  uint32_t getLastTransferUs();
+  uint32_t getFramesSent();
+  uint32_t getFramesCoalesced();
+};
+
+#endif // DISPLAY_TRANSPORT_H
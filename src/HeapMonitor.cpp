@@ -0,0 +1,164 @@
+/**
+ * 堆内存监控实现
+ *
+ * 堆状态来自 heap_caps_get_info()（MALLOC_CAP_DEFAULT），已分配块数可以反映所有分配，
+ * 包括 malloc 和 Arduino String；new/delete 次数通过替换全局 operator new/delete 统计，
+ * 可以按子系统区分。HEAP_MONITOR_ENABLED 为 false 时不替换 operator new/delete
+ */
+
+#include "HeapMonitor.h"
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <new>
+
+static uint32_t allocCounts[HEAP_TAG_COUNT];
+static uint32_t freeCounts[HEAP_TAG_COUNT];
+static portMUX_TYPE countLock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* const TAG_NAMES[HEAP_TAG_COUNT] = {
+  "主循环", "BLE", "解析", "显示", "存储", "其他任务"
+};
+
+void* HeapMonitor::loopTask = nullptr;
+HeapTag HeapMonitor::currentTag = HEAP_TAG_MAIN;
+bool HeapMonitor::marked = false;
+HeapSnapshot HeapMonitor::mark;
+
+void HeapMonitor::begin() {
+  loopTask = xTaskGetCurrentTaskHandle();
+}
+
+HeapTag HeapMonitor::setTag(HeapTag tag) {
+  HeapTag previous = currentTag;
+  currentTag = tag;
+  return previous;
+}
+
+// 在分配时判断所属子系统：主循环任务按当前标记，其他任务统一归类
+static inline HeapTag allocationTag(void* loopTask, HeapTag currentTag) {
+  if (loopTask != nullptr && xTaskGetCurrentTaskHandle() != loopTask) {
+    return HEAP_TAG_TASKS;
+  }
+  return currentTag;
+}
+
+void HeapMonitor::recordAlloc() {
+  HeapTag tag = allocationTag(loopTask, currentTag);
+  portENTER_CRITICAL(&countLock);
+  allocCounts[tag]++;
+  portEXIT_CRITICAL(&countLock);
+}
+
+void HeapMonitor::recordFree() {
+  HeapTag tag = allocationTag(loopTask, currentTag);
+  portENTER_CRITICAL(&countLock);
+  freeCounts[tag]++;
+  portEXIT_CRITICAL(&countLock);
+}
+
+void HeapMonitor::snapshot(HeapSnapshot& out) {
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_DEFAULT);
+  out.freeBytes = info.total_free_bytes;
+  out.minFreeBytes = info.minimum_free_bytes;
+  out.largestFreeBlock = info.largest_free_block;
+  out.allocatedBlocks = info.allocated_blocks;
+
+  portENTER_CRITICAL(&countLock);
+  memcpy(out.allocs, allocCounts, sizeof(allocCounts));
+  memcpy(out.frees, freeCounts, sizeof(freeCounts));
+  portEXIT_CRITICAL(&countLock);
+}
+
+void HeapMonitor::markSteadyState() {
+  snapshot(mark);
+  marked = true;
+}
+
+void HeapMonitor::report() {
+  HeapSnapshot now;
+  snapshot(now);
+
+  Serial.printf("[堆] 空闲: %lu 字节, 最低: %lu 字节, 最大块: %lu 字节, 已分配块: %lu\n",
+                (unsigned long)now.freeBytes, (unsigned long)now.minFreeBytes,
+                (unsigned long)now.largestFreeBlock, (unsigned long)now.allocatedBlocks);
+
+  Serial.print("[堆] new/delete:");
+  for (uint8_t i = 0; i < HEAP_TAG_COUNT; i++) {
+    Serial.printf(" %s %lu/%lu", TAG_NAMES[i], (unsigned long)now.allocs[i], (unsigned long)now.frees[i]);
+  }
+  Serial.println();
+
+  if (marked) {
+    // 骑行中（基准之后）的分配：按子系统列出 new 次数，已分配块数变化反映 malloc/String 的净分配
+    uint32_t total = 0;
+    Serial.print("[堆] 骑行中 new:");
+    for (uint8_t i = 0; i < HEAP_TAG_COUNT; i++) {
+      uint32_t count = now.allocs[i] - mark.allocs[i];
+      total += count;
+      if (count > 0) {
+        Serial.printf(" %s %lu", TAG_NAMES[i], (unsigned long)count);
+      }
+    }
+    Serial.printf("%s (共 %lu 次), 已分配块变化: %ld, 空闲变化: %ld 字节\n",
+                  total == 0 ? " 无" : "", (unsigned long)total,
+                  (long)now.allocatedBlocks - (long)mark.allocatedBlocks,
+                  (long)now.freeBytes - (long)mark.freeBytes);
+  }
+}
+
+#if HEAP_MONITOR_ENABLED
+// 替换全局 operator new/delete，统计各子系统的分配次数
+
+static void* countedAlloc(size_t size) {
+  HeapMonitor::recordAlloc();
+  return malloc(size ? size : 1);
+}
+
+static void countedFree(void* ptr) {
+  if (ptr) {
+    HeapMonitor::recordFree();
+    free(ptr);
+  }
+}
+
+void* operator new(size_t size) {
+  void* ptr = countedAlloc(size);
+  if (!ptr) {
+#if __cpp_exceptions
+    throw std::bad_alloc();
+#else
+    abort();
+#endif
+  }
+  return ptr;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  countedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  countedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  countedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  countedFree(ptr);
+}
+#endif // HEAP_MONITOR_ENABLED
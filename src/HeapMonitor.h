@@ -0,0 +1,64 @@
+/**
+ * 堆内存监控
+ * 统计空闲堆、历史最低空闲、最大可分配块和已分配块数，并按子系统统计 new/delete 次数，
+ * 用于确认骑行过程中（连接并开始接收数据后）不再发生堆分配
+ *
+ * 子系统归属：主循环任务中的分配记到当前 HeapScope 标记的子系统，
+ * 其他任务（BLE协议栈、显示传输等）中的分配统一记为"其他任务"
+ */
+
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+enum HeapTag : uint8_t {
+  HEAP_TAG_MAIN = 0,   // 主循环（未标记的代码）
+  HEAP_TAG_BLE,        // BLE连接、数据读取
+  HEAP_TAG_PARSER,     // CSC数据解析
+  HEAP_TAG_DISPLAY,    // 显示刷新
+  HEAP_TAG_STORAGE,    // Preferences读写
+  HEAP_TAG_TASKS,      // 其他任务
+  HEAP_TAG_COUNT
+};
+
+struct HeapSnapshot {
+  uint32_t freeBytes;          // 当前空闲
+  uint32_t minFreeBytes;       // 启动以来最低空闲
+  uint32_t largestFreeBlock;   // 最大可分配块（碎片化程度）
+  uint32_t allocatedBlocks;    // 已分配块数（包括 malloc/String 等所有分配）
+  uint32_t allocs[HEAP_TAG_COUNT];  // 各子系统 new 次数
+  uint32_t frees[HEAP_TAG_COUNT];   // 各子系统 delete 次数
+};
+
+class HeapMonitor {
+public:
+  static void begin();            // 在 setup() 中调用，记录主循环任务
+  static void snapshot(HeapSnapshot& out);
+  static void markSteadyState();  // 记录基准（连接并收到首个数据后调用），之后的分配视为骑行中的分配
+  static void report();           // 输出统计到串口
+
+  static HeapTag setTag(HeapTag tag);  // 返回之前的标记
+  static void recordAlloc();
+  static void recordFree();
+
+private:
+  static void* loopTask;
+  static HeapTag currentTag;
+  static bool marked;
+  static HeapSnapshot mark;
+};
+
+// 作用域内主循环的堆分配记到指定子系统
+class HeapScope {
+public:
+  explicit HeapScope(HeapTag tag) : previous(HeapMonitor::setTag(tag)) {}
+  ~HeapScope() { HeapMonitor::setTag(previous); }
+
+private:
+  HeapTag previous;
+};
+
+#endif // HEAP_MONITOR_H
@@ -0,0 +1,42 @@
+/**
+ * 心率数据解析类实现
+ *
+ * Heart Rate Measurement 数据格式（Bluetooth SIG Heart Rate Service）:
+ *   字节0: 标志位
+ *     bit 0: 心率格式（0 = uint8_t，1 = uint16_t）
+ *     bit 1-2: 皮肤接触状态（bit 2 = 支持检测，bit 1 = 已接触）
+ *     bit 3: 包含能量消耗，bit 4: 包含RR间期（不使用）
+ *   字节1（或1-2）: 心率 (bpm)
+ */
+
+#include "HeartRateParser.h"
+#include "SensorData.h"
+#include <Arduino.h>
+
+#define PARSER_LOG(...) do { if (PACKET_LOG_ENABLED) Serial.printf(__VA_ARGS__); } while (0)
+
+void HeartRateParser::parseData(const uint8_t* data, size_t length, SensorData& sensorData, uint32_t /*arrivalUs*/) {
+  if (data == nullptr || length < 2) {
+    PARSER_LOG("[解析] 心率数据包长度不足: %u 字节\n", (unsigned)length);
+    return;
+  }
+  
+  uint8_t flags = data[0];
+  uint16_t heartRate;
+  if (flags & 0x01) {
+    if (length < 3) {
+      PARSER_LOG("[解析] 心率数据包长度不足: %u 字节\n", (unsigned)length);
+      return;
+    }
+    heartRate = data[1] | (data[2] << 8);
+  } else {
+    heartRate = data[1];
+  }
+  
+  // 支持接触检测且未接触时心率无效
+  if ((flags & 0x06) == 0x04) {
+    heartRate = 0;
+  }
+  sensorData.heartRate = heartRate > 255 ? 255 : (uint8_t)heartRate;
+  PARSER_LOG("[解析] 标志位: 0x%02X, 心率: %u bpm\n", flags, heartRate);
+}
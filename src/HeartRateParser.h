@@ -0,0 +1,22 @@
+/**
+ * 心率数据解析类
+ * 解析 Heart Rate Measurement (0x2A37)，得到心率
+ */
+
+#ifndef HEART_RATE_PARSER_H
+#define HEART_RATE_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// 前向声明
+struct SensorData;
+
+class HeartRateParser {
+public:
+  // arrivalUs 与 CSCParser 一致（由分发器传入），心率数据不需要
+  void parseData(const uint8_t* data, size_t length, SensorData& sensorData, uint32_t arrivalUs = 0);
+};
+
+#endif // HEART_RATE_PARSER_H
@@ -0,0 +1,98 @@
+/**
+ * 延迟统计实现
+ * 记录来自主循环、渲染任务和显示传输任务，统计数据用自旋锁保护（每次记录只更新几个计数）
+ */
+
+#include "LatencyTracker.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <string.h>
+
+static const char* const STAGE_NAMES[LATENCY_STAGE_COUNT] = {
+  "队列", "解析", "等待显示", "绘制+传输", "端到端", "中继转发", "到首个通知"
+};
+
+static portMUX_TYPE histogramLock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t espTimerClock() {
+  return (uint32_t)esp_timer_get_time();
+}
+
+LatencyTracker::ClockFn LatencyTracker::clock = espTimerClock;
+LatencyHistogram LatencyTracker::histograms[LATENCY_STAGE_COUNT];
+
+void LatencyTracker::setClock(ClockFn clock) {
+  LatencyTracker::clock = clock ? clock : espTimerClock;
+}
+
+uint32_t LatencyTracker::now() {
+  return clock();
+}
+
+void LatencyTracker::record(LatencyStage stage, uint32_t startUs, uint32_t endUs) {
+  if (!LATENCY_TRACKER_ENABLED || stage >= LATENCY_STAGE_COUNT || startUs == 0) return;
+  
+  uint32_t us = endUs - startUs;
+  uint8_t bucket = us == 0 ? 0 : 32 - __builtin_clz(us);
+  if (bucket >= LATENCY_BUCKETS) bucket = LATENCY_BUCKETS - 1;
+  
+  portENTER_CRITICAL(&histogramLock);
+  LatencyHistogram& histogram = histograms[stage];
+  histogram.buckets[bucket]++;
+  histogram.count++;
+  histogram.totalUs += us;
+  if (us > histogram.maxUs) histogram.maxUs = us;
+  portEXIT_CRITICAL(&histogramLock);
+}
+
+void LatencyTracker::snapshot(LatencyStage stage, LatencyHistogram& out) {
+  portENTER_CRITICAL(&histogramLock);
+  out = histograms[stage];
+  portEXIT_CRITICAL(&histogramLock);
+}
+
+uint32_t LatencyTracker::percentileUs(const LatencyHistogram& histogram, uint8_t percent) {
+  if (histogram.count == 0) return 0;
+  uint32_t target = ((uint64_t)histogram.count * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+    seen += histogram.buckets[i];
+    if (seen >= target) {
+      if (i == 0) return 0;
+      uint32_t upper = (1u << i) - 1;
+      return upper < histogram.maxUs ? upper : histogram.maxUs;
+    }
+  }
+  return histogram.maxUs;
+}
+
+void LatencyTracker::reset() {
+  portENTER_CRITICAL(&histogramLock);
+  memset(histograms, 0, sizeof(histograms));
+  portEXIT_CRITICAL(&histogramLock);
+}
+
+void LatencyTracker::report() {
+  Serial.println("=== 延迟统计 (us) ===");
+  for (uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+    LatencyHistogram histogram;
+    snapshot((LatencyStage)stage, histogram);
+    if (histogram.count == 0) {
+      Serial.printf("%s: 无数据\n", STAGE_NAMES[stage]);
+      continue;
+    }
+    Serial.printf("%s: %lu 次, 平均 %lu, P50 ≤%lu, P90 ≤%lu, P99 ≤%lu, 最大 %lu\n", STAGE_NAMES[stage],
+                  (unsigned long)histogram.count, (unsigned long)(histogram.totalUs / histogram.count),
+                  (unsigned long)percentileUs(histogram, 50), (unsigned long)percentileUs(histogram, 90),
+                  (unsigned long)percentileUs(histogram, 99), (unsigned long)histogram.maxUs);
+    // 非空的桶：[下界, 上界) 次数
+    Serial.print("  ");
+    for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+      if (histogram.buckets[i] == 0) continue;
+      Serial.printf("[%lu,%lu):%lu ", (unsigned long)(i == 0 ? 0 : 1u << (i - 1)), (unsigned long)(1u << i),
+                    (unsigned long)histogram.buckets[i]);
+    }
+    Serial.println();
+  }
+  Serial.println("=====================");
+}
@@ -0,0 +1,54 @@
+/**
+ * 延迟统计
+ * 每个数据包带着通知到达时间经过 队列 → 解析 → 显示刷新 → 帧传输，
+ * 各阶段和端到端（到达 → 显示该数值的帧发送完成）的耗时按2的幂分桶统计，
+ * 通过串口命令 latency 输出
+ */
+
+#ifndef LATENCY_TRACKER_H
+#define LATENCY_TRACKER_H
+
+#include <stdint.h>
+#include "config.h"
+
+enum LatencyStage : uint8_t {
+  LATENCY_QUEUE = 0,      // 通知到达 → 主循环取出
+  LATENCY_PARSE,          // 取出 → 解析完成
+  LATENCY_DISPLAY_WAIT,   // 解析完成 → 开始绘制包含该数据的帧
+  LATENCY_FRAME,          // 开始绘制 → 帧发送完成
+  LATENCY_END_TO_END,     // 通知到达 → 帧发送完成
+  LATENCY_RELAY,          // 通知到达 → 中继转发给中心设备（见 CSCRelay）
+  LATENCY_FIRST_NOTIFY,   // 重连流程开始（掉线或启动）→ 新连接的第一个通知（见 BLEManager::beginReconnect）
+  LATENCY_STAGE_COUNT
+};
+
+// 分桶：桶0 = 0us，桶i = [2^(i-1), 2^i) us，最后一个桶包含更大的值（约16秒以上）
+#define LATENCY_BUCKETS 26
+
+struct LatencyHistogram {
+  uint32_t buckets[LATENCY_BUCKETS];
+  uint32_t count;
+  uint32_t maxUs;
+  uint64_t totalUs;
+};
+
+class LatencyTracker {
+public:
+  typedef uint32_t (*ClockFn)();
+  
+  // 时间源（默认 esp_timer，主机模拟时替换为虚拟时钟）
+  static void setClock(ClockFn clock);
+  static uint32_t now();
+  
+  static void record(LatencyStage stage, uint32_t startUs, uint32_t endUs);  // startUs 为0表示没有时间标记，不记录
+  static void snapshot(LatencyStage stage, LatencyHistogram& out);
+  static uint32_t percentileUs(const LatencyHistogram& histogram, uint8_t percent);  // 所在桶的上界（不超过最大值）
+  static void reset();
+  static void report();  // 输出统计到串口
+
+private:
+  static ClockFn clock;
+  static LatencyHistogram histograms[LATENCY_STAGE_COUNT];
+};
+
+#endif // LATENCY_TRACKER_H
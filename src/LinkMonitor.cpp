@@ -0,0 +1,204 @@
+/**
+ * 链路质量监控实现
+ *
+ * 丢包推断：BLE通知没有序号，丢失的通知只能从前后两个数据包推断。
+ * 传感器按自己的节拍采样计数器，到达时间受连接间隔调度影响会有抖动，
+ * 所以同时要求两个条件，取两者推断数量的较小值：
+ *   - 到达间隔约为正常通知间隔的 N 倍（N ≥ 2）
+ *   - 轮转数或曲柄转数的增量约为每包平均增量的 N 倍
+ * 计数器不变（静止、滑行）时传感器可能停发通知，这样的间隔不算丢包。
+ *
+ * RSSI 和统计数据由主循环和BLE任务（GAP回调）共同访问，用自旋锁保护
+ */
+
+#include "LinkMonitor.h"
+#include <Arduino.h>
+#include <string.h>
+
+static portMUX_TYPE statsLock = portMUX_INITIALIZER_UNLOCKED;
+
+LinkStats LinkMonitor::stats;
+bool LinkMonitor::havePrevious = false;
+uint32_t LinkMonitor::previousArrivalUs = 0;
+uint32_t LinkMonitor::previousWheel = 0;
+uint16_t LinkMonitor::previousCrank = 0;
+float LinkMonitor::nominalGapUs = 0.0f;
+float LinkMonitor::wheelPerPacket = 0.0f;
+float LinkMonitor::crankPerPacket = 0.0f;
+float LinkMonitor::rssiFast = 0.0f;
+float LinkMonitor::rssiSlow = 0.0f;
+bool LinkMonitor::rssiPending = false;
+uint32_t LinkMonitor::rssiRequestMs = 0;
+
+void LinkMonitor::reset() {
+  portENTER_CRITICAL(&statsLock);
+  memset(&stats, 0, sizeof(stats));
+  rssiFast = 0.0f;
+  rssiSlow = 0.0f;
+  rssiPending = false;
+  rssiRequestMs = 0;
+  portEXIT_CRITICAL(&statsLock);
+  havePrevious = false;
+  nominalGapUs = 0.0f;
+  wheelPerPacket = 0.0f;
+  crankPerPacket = 0.0f;
+}
+
+// 按每包平均增量估算两个数据包之间漏掉的数量（四舍五入后减去收到的这一个）
+uint32_t LinkMonitor::missedFromCounter(uint32_t delta, float perPacket) {
+  if (delta == 0 || perPacket <= 0.0f) return 0;
+  uint32_t packets = (uint32_t)(delta / perPacket + 0.5f);
+  return packets > 1 ? packets - 1 : 0;
+}
+
+void LinkMonitor::onPacket(uint32_t arrivalUs, uint32_t wheelRevolutions, uint16_t crankRevolutions) {
+  if (!LINK_MONITOR_ENABLED) return;
+
+  if (!havePrevious) {
+    havePrevious = true;
+    previousArrivalUs = arrivalUs;
+    previousWheel = wheelRevolutions;
+    previousCrank = crankRevolutions;
+    portENTER_CRITICAL(&statsLock);
+    stats.received++;
+    stats.expected++;
+    portEXIT_CRITICAL(&statsLock);
+    return;
+  }
+
+  uint32_t gapUs = arrivalUs - previousArrivalUs;
+  uint32_t gapMs = gapUs / 1000;
+  // 计数器回退（传感器重启）时不用于推断
+  uint32_t wheelDelta = (int32_t)(wheelRevolutions - previousWheel) > 0 ? wheelRevolutions - previousWheel : 0;
+  uint32_t crankDelta = (int16_t)(crankRevolutions - previousCrank) > 0 ? (uint16_t)(crankRevolutions - previousCrank) : 0;
+  previousArrivalUs = arrivalUs;
+  previousWheel = wheelRevolutions;
+  previousCrank = crankRevolutions;
+
+  uint32_t missed = 0;
+  if (nominalGapUs > 0.0f && (wheelDelta > 0 || crankDelta > 0)) {
+    uint32_t intervals = (uint32_t)(gapUs / nominalGapUs + 0.5f);
+    uint32_t byGap = intervals > 1 ? intervals - 1 : 0;
+    if (byGap > 0) {
+      uint32_t wheelMissed = missedFromCounter(wheelDelta, wheelPerPacket);
+      uint32_t crankMissed = missedFromCounter(crankDelta, crankPerPacket);
+      uint32_t byCounter = wheelMissed > crankMissed ? wheelMissed : crankMissed;
+      missed = byGap < byCounter ? byGap : byCounter;
+      if (missed > LINK_MAX_INFERRED_LOSS) missed = LINK_MAX_INFERRED_LOSS;
+    }
+  }
+
+  if (missed == 0) {
+    // 正常间隔更新基准：更短的间隔总是可信的（丢包只会让间隔变长），快速跟随；
+    // 稍长的间隔缓慢跟随（传感器降低通知频率时）；停顿不参与
+    if (gapUs > 0 && (wheelDelta > 0 || crankDelta > 0)) {
+      if (nominalGapUs <= 0.0f) {
+        nominalGapUs = gapUs;
+      } else if (gapUs < nominalGapUs) {
+        nominalGapUs += (gapUs - nominalGapUs) * 0.5f;
+      } else if (gapUs < nominalGapUs * 1.5f) {
+        nominalGapUs += (gapUs - nominalGapUs) * 0.1f;
+      }
+    }
+    if (wheelDelta > 0) {
+      wheelPerPacket = wheelPerPacket > 0.0f ? wheelPerPacket + (wheelDelta - wheelPerPacket) * 0.2f : wheelDelta;
+    }
+    if (crankDelta > 0) {
+      crankPerPacket = crankPerPacket > 0.0f ? crankPerPacket + (crankDelta - crankPerPacket) * 0.2f : crankDelta;
+    }
+  }
+
+  uint8_t bucket = gapMs == 0 ? 0 : 32 - __builtin_clz(gapMs);
+  if (bucket >= LINK_GAP_BUCKETS) bucket = LINK_GAP_BUCKETS - 1;
+
+  portENTER_CRITICAL(&statsLock);
+  stats.received++;
+  stats.expected += 1 + missed;
+  stats.lost += missed;
+  stats.gapBuckets[bucket]++;
+  if (gapMs > stats.maxGapMs) stats.maxGapMs = gapMs;
+  stats.nominalGapMs = (uint32_t)(nominalGapUs / 1000.0f + 0.5f);
+  portEXIT_CRITICAL(&statsLock);
+}
+
+bool LinkMonitor::rssiDue(uint32_t nowMs) {
+  if (!LINK_MONITOR_ENABLED) return false;
+  bool due = false;
+  portENTER_CRITICAL(&statsLock);
+  // 上一次读取没有回应（连接正在断开等）时超时后允许重新发起
+  if (rssiPending && nowMs - rssiRequestMs > LINK_RSSI_INTERVAL_MS * 2) {
+    rssiPending = false;
+  }
+  if (!rssiPending && (rssiRequestMs == 0 || nowMs - rssiRequestMs >= LINK_RSSI_INTERVAL_MS)) {
+    rssiPending = true;
+    rssiRequestMs = nowMs ? nowMs : 1;
+    due = true;
+  }
+  portEXIT_CRITICAL(&statsLock);
+  return due;
+}
+
+void LinkMonitor::onRssi(int8_t rssi) {
+  portENTER_CRITICAL(&statsLock);
+  rssiPending = false;
+  if (rssi < 0) {
+    if (stats.rssi == 0) {
+      rssiFast = rssi;
+      rssiSlow = rssi;
+    } else {
+      rssiFast += (rssi - rssiFast) * LINK_RSSI_SMOOTHING;
+      rssiSlow += (rssi - rssiSlow) * LINK_RSSI_TREND_SMOOTHING;
+    }
+    stats.rssi = (int8_t)(rssiFast - 0.5f);
+    float trend = rssiFast - rssiSlow;
+    stats.rssiTrend = (int8_t)(trend < 0.0f ? trend - 0.5f : trend + 0.5f);
+  }
+  portEXIT_CRITICAL(&statsLock);
+}
+
+int8_t LinkMonitor::getRssi() {
+  return stats.rssi;
+}
+
+int8_t LinkMonitor::getRssiTrend() {
+  return stats.rssiTrend;
+}
+
+uint16_t LinkMonitor::getLossPermille() {
+  portENTER_CRITICAL(&statsLock);
+  uint32_t lost = stats.lost;
+  uint32_t expected = stats.expected;
+  portEXIT_CRITICAL(&statsLock);
+  return expected > 0 ? (uint16_t)(((uint64_t)lost * 1000 + expected / 2) / expected) : 0;
+}
+
+void LinkMonitor::snapshot(LinkStats& out) {
+  portENTER_CRITICAL(&statsLock);
+  out = stats;
+  portEXIT_CRITICAL(&statsLock);
+}
+
+void LinkMonitor::report() {
+  LinkStats snapshotStats;
+  snapshot(snapshotStats);
+  Serial.println("=== 链路质量 ===");
+  if (snapshotStats.rssi != 0) {
+    Serial.printf("RSSI: %d dBm, 趋势: %+d dB\n", snapshotStats.rssi, snapshotStats.rssiTrend);
+  } else {
+    Serial.println("RSSI: 未获取");
+  }
+  uint16_t permille = getLossPermille();
+  Serial.printf("数据包: 收到 %lu, 推断丢失 %lu (%u.%u%%), 正常间隔 %lu ms, 最大间隔 %lu ms\n",
+                (unsigned long)snapshotStats.received, (unsigned long)snapshotStats.lost,
+                permille / 10, permille % 10,
+                (unsigned long)snapshotStats.nominalGapMs, (unsigned long)snapshotStats.maxGapMs);
+  // 非空的桶：[下界, 上界) ms 次数
+  Serial.print("到达间隔: ");
+  for (uint8_t i = 0; i < LINK_GAP_BUCKETS; i++) {
+    if (snapshotStats.gapBuckets[i] == 0) continue;
+    Serial.printf("[%lu,%lu):%lu ", (unsigned long)(i == 0 ? 0 : 1u << (i - 1)), (unsigned long)(1u << i),
+                  (unsigned long)snapshotStats.gapBuckets[i]);
+  }
+  Serial.println();
+  Serial.println("================");
+}
@@ -0,0 +1,65 @@
+/**
+ * 链路质量监控
+ * 连接期间定期异步读取RSSI并平滑，统计通知的到达间隔（按2的幂分桶），
+ * 并根据轮转数/曲柄转数的跳变推断丢失的通知，结果提供给显示、遥测和串口命令 link
+ */
+
+#ifndef LINK_MONITOR_H
+#define LINK_MONITOR_H
+
+#include <stdint.h>
+#include "config.h"
+
+// 到达间隔分桶：桶0 = 1ms以下，桶i = [2^(i-1), 2^i) ms，最后一个桶包含4秒以上的间隔
+#define LINK_GAP_BUCKETS 14
+
+struct LinkStats {
+  uint32_t received;        // 收到的数据包
+  uint32_t expected;        // 收到的 + 推断丢失的
+  uint32_t lost;            // 推断丢失的数据包
+  uint32_t gapBuckets[LINK_GAP_BUCKETS];
+  uint32_t maxGapMs;
+  uint32_t nominalGapMs;    // 传感器的正常通知间隔（估计值，0表示尚未确定）
+  int8_t rssi;              // 平滑后的RSSI（dBm，0表示尚未获取）
+  int8_t rssiTrend;         // 平滑值 - 长期平均（dB，负值表示信号在变弱）
+};
+
+class LinkMonitor {
+public:
+  static void reset();  // 连接建立时调用
+
+  // 每个数据包解析后调用：到达时间和解析后的累计轮转数/曲柄转数
+  static void onPacket(uint32_t arrivalUs, uint32_t wheelRevolutions, uint16_t crankRevolutions);
+
+  // RSSI采样：rssiDue() 返回 true 时发起一次异步读取，结果在GAP回调中通过 onRssi() 送回
+  static bool rssiDue(uint32_t nowMs);
+  static void onRssi(int8_t rssi);
+
+  static int8_t getRssi();
+  static int8_t getRssiTrend();
+  static uint16_t getLossPermille();  // 丢包率（千分比）
+  static void snapshot(LinkStats& out);
+  static void report();  // 输出统计到串口
+
+private:
+  static LinkStats stats;
+
+  // 丢包推断状态（只在主循环中访问）
+  static bool havePrevious;
+  static uint32_t previousArrivalUs;
+  static uint32_t previousWheel;
+  static uint16_t previousCrank;
+  static float nominalGapUs;
+  static float wheelPerPacket;   // 每个数据包的平均增量（0表示尚未确定）
+  static float crankPerPacket;
+
+  // RSSI（GAP回调在BLE任务中写入）
+  static float rssiFast;
+  static float rssiSlow;
+  static bool rssiPending;
+  static uint32_t rssiRequestMs;
+
+  static uint32_t missedFromCounter(uint32_t delta, float perPacket);
+};
+
+#endif // LINK_MONITOR_H
@@ -0,0 +1,33 @@
+/**
+ * 测量数据分发实现
+ */
+
+#include "MeasurementDispatcher.h"
+#include <string.h>
+
+MeasurementDispatcher::MeasurementDispatcher() {
+  memset(entries, 0, sizeof(entries));
+}
+
+bool MeasurementDispatcher::dispatch(MeasurementKind kind, const uint8_t* data, size_t length,
+                                     SensorData& sensorData, uint32_t arrivalUs) {
+  if (kind >= MEASUREMENT_KIND_COUNT || entries[kind].decode == nullptr) {
+    return false;
+  }
+  entries[kind].packets++;
+  entries[kind].decode(entries[kind].parser, data, length, sensorData, arrivalUs);
+  return true;
+}
+
+uint32_t MeasurementDispatcher::getPackets(MeasurementKind kind) {
+  return kind < MEASUREMENT_KIND_COUNT ? entries[kind].packets : 0;
+}
+
+const char* MeasurementDispatcher::getKindName(MeasurementKind kind) {
+  switch (kind) {
+    case MEASUREMENT_CSC:        return "CSC";
+    case MEASUREMENT_POWER:      return "功率";
+    case MEASUREMENT_HEART_RATE: return "心率";
+    default:                     return "未知";
+  }
+}
@@ -0,0 +1,55 @@
+/**
+ * 测量数据分发
+ * BLEManager 按特征值句柄给每个通知标上测量类型，放入同一个环形缓冲区；
+ * 主循环取出后由分发器按类型直接查表交给对应的解析器，解析结果写入同一份 SensorData。
+ * 新增传感器类型只需增加一个类型、一个解析器和一行订阅，不需要新的缓冲区或轮询路径
+ */
+
+#ifndef MEASUREMENT_DISPATCHER_H
+#define MEASUREMENT_DISPATCHER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 前向声明
+struct SensorData;
+
+// 测量类型（环形缓冲区中每个通知的标记）
+enum MeasurementKind : uint8_t {
+  MEASUREMENT_CSC = 0,         // CSC Measurement (0x2A5B)
+  MEASUREMENT_POWER,           // Cycling Power Measurement (0x2A63)
+  MEASUREMENT_HEART_RATE,      // Heart Rate Measurement (0x2A37)
+  MEASUREMENT_KIND_COUNT
+};
+
+class MeasurementDispatcher {
+public:
+  typedef void (*DecodeFn)(void* parser, const uint8_t* data, size_t length, SensorData& sensorData, uint32_t arrivalUs);
+
+  MeasurementDispatcher();
+
+  // 注册解析器（需要提供 parseData(const uint8_t*, size_t, SensorData&, uint32_t)）
+  template <typename Parser>
+  void attach(MeasurementKind kind, Parser& parser) {
+    if (kind >= MEASUREMENT_KIND_COUNT) return;
+    entries[kind].parser = &parser;
+    entries[kind].decode = [](void* target, const uint8_t* data, size_t length, SensorData& sensorData, uint32_t arrivalUs) {
+      static_cast<Parser*>(target)->parseData(data, length, sensorData, arrivalUs);
+    };
+  }
+
+  // 交给对应的解析器，没有注册解析器时返回 false
+  bool dispatch(MeasurementKind kind, const uint8_t* data, size_t length, SensorData& sensorData, uint32_t arrivalUs);
+  uint32_t getPackets(MeasurementKind kind);
+  static const char* getKindName(MeasurementKind kind);
+
+private:
+  struct Entry {
+    DecodeFn decode;
+    void* parser;
+    uint32_t packets;
+  };
+  Entry entries[MEASUREMENT_KIND_COUNT];
+};
+
+#endif // MEASUREMENT_DISPATCHER_H
@@ -3,12 +3,22 @@
  */
 
 #include "PowerManager.h"
+#include "SensorData.h"
 #include <Arduino.h>
 #include <esp_sleep.h>
+#include <esp_timer.h>
 #include <driver/gpio.h>
 
+#define SESSION_MAGIC 0x424D5331  // "BMS1"
+
+// RTC慢速内存在深度睡眠期间保持供电，唤醒后内容仍然有效
+RTC_DATA_ATTR static RetainedSession retainedSession;
+
 PowerManager::PowerManager() {
   lastActivityTime = 0;
+  warmResume = false;
+  firstDataReported = false;
+  wakeToFirstDataMs = 0;
 }
 
 void PowerManager::begin() {
@@ -57,3 +67,67 @@ unsigned long PowerManager::getInactiveTime() {
 }
 
 
+
+uint32_t PowerManager::sessionChecksum(const RetainedSession& session) {
+  // FNV-1a，覆盖 checksum 之前的所有字段
+  const uint8_t* bytes = (const uint8_t*)&session;
+  size_t length = offsetof(RetainedSession, checksum);
+  uint32_t hash = 2166136261UL;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+void PowerManager::saveSession(const SensorData& data, const char* deviceAddress, uint8_t theme) {
+  memset(&retainedSession, 0, sizeof(retainedSession));
+  retainedSession.magic = SESSION_MAGIC;
+  if (deviceAddress) {
+    strncpy(retainedSession.deviceAddress, deviceAddress, sizeof(retainedSession.deviceAddress) - 1);
+  }
+  retainedSession.rideActive = data.connected && data.connectionStartTime > 0;
+  retainedSession.distance = retainedSession.rideActive ? data.distance : 0.0;
+  retainedSession.totalDistance = data.totalDistance;
+  retainedSession.rideElapsedMs = retainedSession.rideActive ? (millis() - data.connectionStartTime) : 0;
+  retainedSession.theme = theme;
+  retainedSession.checksum = sessionChecksum(retainedSession);
+  Serial.printf("已保存RTC会话: 设备=%s, 骑行中=%s, 路程=%.3f km\n",
+                retainedSession.deviceAddress, retainedSession.rideActive ? "是" : "否", retainedSession.distance);
+}
+
+bool PowerManager::restoreSession(RetainedSession& session) {
+  // 只有从深度睡眠唤醒时RTC内存才有效（复位/上电后内容未定义）
+  esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+  bool valid = cause != ESP_SLEEP_WAKEUP_UNDEFINED &&
+               retainedSession.magic == SESSION_MAGIC &&
+               retainedSession.checksum == sessionChecksum(retainedSession);
+  
+  // 会话只使用一次，避免下次冷启动误用
+  retainedSession.magic = 0;
+  
+  if (!valid) {
+    warmResume = false;
+    return false;
+  }
+  session = retainedSession;
+  warmResume = true;
+  return true;
+}
+
+bool PowerManager::isWarmResume() {
+  return warmResume;
+}
+
+void PowerManager::reportFirstData() {
+  if (firstDataReported) return;
+  firstDataReported = true;
+  // esp_timer 从本次启动（唤醒）开始计时
+  wakeToFirstDataMs = (uint32_t)(esp_timer_get_time() / 1000);
+  Serial.printf("%s到首个数据: %lu ms\n", warmResume ? "唤醒（热恢复）" : "冷启动",
+                (unsigned long)wakeToFirstDataMs);
+}
+
+uint32_t PowerManager::getWakeToFirstDataMs() {
+  return wakeToFirstDataMs;
+}
@@ -9,9 +9,29 @@
 #include <stdint.h>
 #include "config.h"
 
+// 前向声明
+struct SensorData;
+
+// 深度睡眠期间保留在RTC内存中的骑行会话（用于唤醒后热恢复）
+struct RetainedSession {
+  uint32_t magic;
+  char deviceAddress[18];            // 连接目标（"xx:xx:xx:xx:xx:xx"）
+  bool rideActive;                   // 睡眠前是否正在骑行（已连接）
+  float distance;                    // 睡眠前本次骑行的路程 (km)
+  float totalDistance;               // 总路程 (km)
+  unsigned long rideElapsedMs;       // 睡眠前本次骑行已用时长
+  uint8_t theme;                     // 显示主题
+  uint32_t checksum;
+};
+
 class PowerManager {
 private:
   unsigned long lastActivityTime;
+  bool warmResume;              // 本次启动是否从RTC会话热恢复
+  bool firstDataReported;
+  uint32_t wakeToFirstDataMs;   // 启动（唤醒）到收到第一个数据包的时间
+  
+  static uint32_t sessionChecksum(const RetainedSession& session);
   
 public:
   PowerManager();
@@ -21,6 +41,15 @@ public:
   void setCpuFrequency(uint32_t freq);
   void updateActivity();
   unsigned long getInactiveTime();
+  
+  // RTC会话保存/恢复（热恢复只在从深度睡眠唤醒时有效，复位或上电后为冷启动）
+  void saveSession(const SensorData& data, const char* deviceAddress, uint8_t theme);
+  bool restoreSession(RetainedSession& session);
+  bool isWarmResume();
+  
+  // 唤醒到首个数据的时间（首次调用时记录并输出）
+  void reportFirstData();
+  uint32_t getWakeToFirstDataMs();
 };
 
 #endif // POWER_MANAGER_H
@@ -0,0 +1,28 @@
+/**
+ * 功率数据解析类实现
+ *
+ * Cycling Power Measurement 数据格式（Bluetooth SIG Cycling Power Service）:
+ *   字节0-1: 标志位 (uint16_t, little-endian)
+ *   字节2-3: 瞬时功率 (sint16_t, little-endian, 瓦)
+ *   之后按标志位依次为踏板功率平衡、累计扭矩、轮转数据、曲柄数据等可选字段
+ *
+ * 只使用瞬时功率，可选字段不解析（速度和踏频仍由CSC数据提供）
+ */
+
+#include "PowerParser.h"
+#include "SensorData.h"
+#include <Arduino.h>
+
+#define PARSER_LOG(...) do { if (PACKET_LOG_ENABLED) Serial.printf(__VA_ARGS__); } while (0)
+
+void PowerParser::parseData(const uint8_t* data, size_t length, SensorData& sensorData, uint32_t /*arrivalUs*/) {
+  if (data == nullptr || length < 4) {
+    PARSER_LOG("[解析] 功率数据包长度不足: %u 字节\n", (unsigned)length);
+    return;
+  }
+  
+  int16_t power = (int16_t)(data[2] | (data[3] << 8));
+  // 部分功率计倒转曲柄时报告负值，按0处理
+  sensorData.power = power > 0 ? (uint16_t)power : 0;
+  PARSER_LOG("[解析] 标志位: 0x%04X, 功率: %d W\n", data[0] | (data[1] << 8), power);
+}
@@ -0,0 +1,22 @@
+/**
+ * 功率数据解析类
+ * 解析 Cycling Power Measurement (0x2A63)，得到瞬时功率
+ */
+
+#ifndef POWER_PARSER_H
+#define POWER_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// 前向声明
+struct SensorData;
+
+class PowerParser {
+public:
+  // arrivalUs 与 CSCParser 一致（由分发器传入），功率数据不需要
+  void parseData(const uint8_t* data, size_t length, SensorData& sensorData, uint32_t arrivalUs = 0);
+};
+
+#endif // POWER_PARSER_H
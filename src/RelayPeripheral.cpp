@@ -0,0 +1,139 @@
+/**
+ * 中继外设实现
+ *
+ * 服务: CSC (0x1816)
+ *   - CSC Measurement (0x2A5B): 通知
+ *   - CSC Feature (0x2A5C): 读取，固定为支持轮转和曲柄数据
+ *
+ * 通知直接调用 esp_ble_gatts_send_indicate()：BLECharacteristic::notify() 会先复制到特征值缓存
+ * （String，分配堆内存）再发送，这里每个数据包只由协议栈复制一次
+ */
+
+#include "RelayPeripheral.h"
+#include <Arduino.h>
+
+RelayPeripheral* RelayPeripheral::instance = nullptr;
+
+class RelayServerCallbacks : public BLEServerCallbacks {
+  void onConnect(BLEServer* /*server*/, esp_ble_gatts_cb_param_t* param) override {
+    if (RelayPeripheral::instance) {
+      RelayPeripheral::instance->onConnect(param->connect.conn_id);
+    }
+  }
+  void onDisconnect(BLEServer* /*server*/, esp_ble_gatts_cb_param_t* param) override {
+    if (RelayPeripheral::instance) {
+      RelayPeripheral::instance->onDisconnect(param->disconnect.conn_id);
+    }
+  }
+};
+
+static RelayServerCallbacks serverCallbacks;
+
+RelayPeripheral::RelayPeripheral() {
+  server = nullptr;
+  measurement = nullptr;
+  measurementCCCD = nullptr;
+  centralCount = 0;
+  congested = false;
+  lock = portMUX_INITIALIZER_UNLOCKED;
+  instance = this;
+}
+
+bool RelayPeripheral::begin() {
+  esp_ble_gap_set_device_name(CSC_RELAY_DEVICE_NAME);
+  server = BLEDevice::createServer();
+  if (server == nullptr) {
+    Serial.println("[中继] 创建GATT服务器失败");
+    return false;
+  }
+  server->setCallbacks(&serverCallbacks);
+  BLEDevice::setCustomGattsHandler(gattsEventHandler);
+
+  BLEService* service = server->createService(BLEUUID(CSC_SERVICE_UUID));
+  measurement = service->createCharacteristic(BLEUUID(CSC_MEASUREMENT_UUID), BLECharacteristic::PROPERTY_NOTIFY);
+  measurementCCCD = new BLE2902();
+  measurement->addDescriptor(measurementCCCD);
+
+  BLECharacteristic* feature = service->createCharacteristic(BLEUUID(CSC_FEATURE_UUID), BLECharacteristic::PROPERTY_READ);
+  uint16_t featureBits = 0x0003;  // 支持轮转数据和曲柄数据
+  feature->setValue(featureBits);
+  service->start();
+
+  BLEAdvertising* advertising = BLEDevice::getAdvertising();
+  advertising->addServiceUUID(BLEUUID(CSC_SERVICE_UUID));
+  advertising->setScanResponse(true);
+  BLEDevice::startAdvertising();
+  Serial.printf("[中继] 已开始广播CSC服务: %s\n", CSC_RELAY_DEVICE_NAME);
+  return true;
+}
+
+void RelayPeripheral::onConnect(uint16_t connId) {
+  bool full;
+  portENTER_CRITICAL(&lock);
+  if (centralCount < CSC_RELAY_MAX_CENTRALS) {
+    connIds[centralCount++] = connId;
+  }
+  full = centralCount >= CSC_RELAY_MAX_CENTRALS;
+  portEXIT_CRITICAL(&lock);
+  Serial.printf("[中继] 中心设备已连接 (conn_id %u)\n", connId);
+  // 连接后广播会停止，未达到上限时继续广播以接受其他中心设备
+  if (!full) {
+    BLEDevice::startAdvertising();
+  }
+}
+
+void RelayPeripheral::onDisconnect(uint16_t connId) {
+  portENTER_CRITICAL(&lock);
+  for (uint8_t i = 0; i < centralCount; i++) {
+    if (connIds[i] == connId) {
+      connIds[i] = connIds[--centralCount];
+      break;
+    }
+  }
+  if (centralCount == 0) {
+    congested = false;
+  }
+  portEXIT_CRITICAL(&lock);
+  Serial.printf("[中继] 中心设备已断开 (conn_id %u)\n", connId);
+  BLEDevice::startAdvertising();
+}
+
+void RelayPeripheral::gattsEventHandler(esp_gatts_cb_event_t event, esp_gatt_if_t /*gattsIf*/, esp_ble_gatts_cb_param_t* param) {
+  if (event == ESP_GATTS_CONGEST_EVT && instance) {
+    instance->congested = param->congest.congested;
+  }
+}
+
+uint8_t RelayPeripheral::getCentralCount() {
+  return centralCount;
+}
+
+RelaySendResult RelayPeripheral::send(void* context, const uint8_t* data, size_t length) {
+  RelayPeripheral* self = static_cast<RelayPeripheral*>(context);
+  if (self == nullptr || self->measurement == nullptr) {
+    return RELAY_NO_SUBSCRIBER;
+  }
+
+  uint16_t connIds[CSC_RELAY_MAX_CENTRALS];
+  uint8_t count;
+  portENTER_CRITICAL(&self->lock);
+  count = self->centralCount;
+  memcpy(connIds, self->connIds, sizeof(connIds));
+  portEXIT_CRITICAL(&self->lock);
+
+  if (count == 0 || !self->measurementCCCD->getNotifications()) {
+    return RELAY_NO_SUBSCRIBER;
+  }
+  if (self->congested) {
+    return RELAY_CONGESTED;
+  }
+
+  bool failed = false;
+  for (uint8_t i = 0; i < count; i++) {
+    if (esp_ble_gatts_send_indicate(self->server->getGattsIf(), connIds[i], self->measurement->getHandle(),
+                                    (uint16_t)length, (uint8_t*)data, false) != ESP_OK) {
+      failed = true;
+    }
+  }
+  return failed ? RELAY_CONGESTED : RELAY_SENT;
+}
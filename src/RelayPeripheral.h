@@ -0,0 +1,44 @@
+/**
+ * 中继外设
+ * 以BLE外设身份广播CSC服务，供手机等中心设备连接和订阅，是 CSCRelay 在设备上的发送端
+ */
+
+#ifndef RELAY_PERIPHERAL_H
+#define RELAY_PERIPHERAL_H
+
+#include <BLEDevice.h>
+#include <BLEServer.h>
+#include <BLE2902.h>
+#include <esp_gatts_api.h>
+#include "config.h"
+#include "CSCRelay.h"
+
+class RelayPeripheral {
+private:
+  BLEServer* server;
+  BLECharacteristic* measurement;
+  BLE2902* measurementCCCD;
+
+  uint16_t connIds[CSC_RELAY_MAX_CENTRALS];  // 已连接的中心设备
+  uint8_t centralCount;
+  volatile bool congested;                   // 协议栈发送队列已满（GATTS拥塞事件）
+  portMUX_TYPE lock;
+
+  static RelayPeripheral* instance;
+  friend class RelayServerCallbacks;
+
+  void onConnect(uint16_t connId);
+  void onDisconnect(uint16_t connId);
+  static void gattsEventHandler(esp_gatts_cb_event_t event, esp_gatt_if_t gattsIf, esp_ble_gatts_cb_param_t* param);
+
+public:
+  RelayPeripheral();
+
+  bool begin();  // 在 BLEManager::begin() 之后调用（共用同一个BLE协议栈）
+  uint8_t getCentralCount();
+
+  // CSCRelay 的发送函数：直接把栈上编码好的数据包交给协议栈，不经过特征值缓存
+  static RelaySendResult send(void* context, const uint8_t* data, size_t length);
+};
+
+#endif // RELAY_PERIPHERAL_H
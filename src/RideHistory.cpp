@@ -0,0 +1,167 @@
+/**
+ * 骑行历史实现
+ * NVS命名空间 "rides"：键 "last" 为最近一条记录的编号，键 "r<槽位>" 为记录本身。
+ * 一次骑行只写两次（记录 + 编号），骑行中不写闪存
+ */
+
+#include "RideHistory.h"
+#include "SensorData.h"
+#include "StallMonitor.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <string.h>
+#include <time.h>
+
+#define RIDE_HISTORY_NAMESPACE "rides"
+#define RIDE_HISTORY_LAST_KEY "last"
+
+// 数据包间隔超过此值（毫秒）时不计入移动/踩踏时间（信号中断期间不知道是否在骑行）
+#define RIDE_HISTORY_MAX_GAP_MS 5000
+
+static Preferences storage;
+
+// 深度睡眠前写入的骑行编号（热恢复后继续这条记录，冷启动时为0）
+RTC_DATA_ATTR static uint32_t suspendedSequence = 0;
+
+uint32_t RideHistory::lastSequence = 0;
+RideSummary RideHistory::current;
+bool RideHistory::active = false;
+bool RideHistory::resumed = false;
+unsigned long RideHistory::lastUpdateMs = 0;
+uint32_t RideHistory::movingMs = 0;
+uint32_t RideHistory::pedalingMs = 0;
+float RideHistory::crankRevolutions = 0.0;
+
+static void slotKey(uint32_t sequence, char* key, size_t size) {
+  snprintf(key, size, "r%u", (unsigned)(sequence % RIDE_HISTORY_SLOTS));
+}
+
+void RideHistory::begin() {
+  storage.begin(RIDE_HISTORY_NAMESPACE, false);
+  lastSequence = storage.getUInt(RIDE_HISTORY_LAST_KEY, 0);
+}
+
+void RideHistory::startRide() {
+  memset(&current, 0, sizeof(current));
+  current.startTime = (uint32_t)time(nullptr);
+  active = true;
+  resumed = false;
+  lastUpdateMs = 0;
+  movingMs = 0;
+  pedalingMs = 0;
+  crankRevolutions = 0.0;
+}
+
+void RideHistory::resumeRide() {
+  uint32_t sequence = suspendedSequence;
+  suspendedSequence = 0;
+  RideSummary summary;
+  if (sequence == 0 || sequence != lastSequence || !get(0, summary)) {
+    return;  // 睡眠前的骑行太短没有写入，作为新的骑行继续统计
+  }
+  current = summary;
+  movingMs = summary.movingS * 1000;
+  pedalingMs = summary.pedalingS * 1000;
+  crankRevolutions = summary.averageCadence * summary.pedalingS / 60.0;
+  active = true;
+  resumed = true;
+  lastUpdateMs = 0;
+}
+
+void RideHistory::update(const SensorData& data, unsigned long nowMs) {
+  if (!active) {
+    return;
+  }
+  uint32_t elapsedMs = lastUpdateMs == 0 ? 0 : nowMs - lastUpdateMs;
+  lastUpdateMs = nowMs;
+  if (elapsedMs > RIDE_HISTORY_MAX_GAP_MS) {
+    elapsedMs = 0;
+  }
+  if (data.speed > MOTION_THRESHOLD) {
+    movingMs += elapsedMs;
+  }
+  if (data.cadence > 0) {
+    pedalingMs += elapsedMs;
+    crankRevolutions += data.cadence * elapsedMs / 60000.0;
+  }
+  if (data.speed > current.maxSpeed) {
+    current.maxSpeed = data.speed;
+  }
+}
+
+bool RideHistory::finishRide(const SensorData& data) {
+  if (!active) {
+    return false;
+  }
+  active = false;
+  if (!resumed && data.distance < RIDE_HISTORY_MIN_KM) {
+    return false;
+  }
+
+  current.sequence = resumed ? lastSequence : lastSequence + 1;
+  current.durationS = data.rideDuration;
+  current.movingS = movingMs / 1000;
+  current.pedalingS = pedalingMs / 1000;
+  current.distanceKm = data.distance;
+  current.averageSpeed = movingMs > 0 ? data.distance / (movingMs / 3600000.0) : 0.0;
+  current.averageCadence = pedalingMs > 0 ? crankRevolutions / (pedalingMs / 60000.0) : 0.0;
+  if (!write(current)) {
+    Serial.println("骑行记录写入失败");
+    return false;
+  }
+  Serial.printf("骑行记录 #%lu: %.2f km, 时长 %lu s, 移动 %lu s, 平均 %.1f km/h, 最高 %.1f km/h, 踏频 %.0f rpm\n",
+                (unsigned long)current.sequence, current.distanceKm, (unsigned long)current.durationS,
+                (unsigned long)current.movingS, current.averageSpeed, current.maxSpeed, current.averageCadence);
+  return true;
+}
+
+void RideHistory::suspendRide(const SensorData& data) {
+  suspendedSequence = finishRide(data) ? lastSequence : 0;
+}
+
+bool RideHistory::write(const RideSummary& summary) {
+  StallScope scope(STALL_REGION_STORAGE);
+  char key[8];
+  slotKey(summary.sequence, key, sizeof(key));
+  if (storage.putBytes(key, &summary, sizeof(summary)) != sizeof(summary)) {
+    return false;
+  }
+  if (summary.sequence != lastSequence) {
+    storage.putUInt(RIDE_HISTORY_LAST_KEY, summary.sequence);
+    lastSequence = summary.sequence;
+  }
+  return true;
+}
+
+uint16_t RideHistory::getCount() {
+  return lastSequence < RIDE_HISTORY_SLOTS ? (uint16_t)lastSequence : RIDE_HISTORY_SLOTS;
+}
+
+bool RideHistory::get(uint16_t index, RideSummary& out) {
+  if (index >= getCount()) {
+    return false;
+  }
+  uint32_t sequence = lastSequence - index;
+  char key[8];
+  slotKey(sequence, key, sizeof(key));
+  // 槽位中的编号不符（写入被中断）时视为没有这条记录
+  return storage.getBytes(key, &out, sizeof(out)) == sizeof(out) && out.sequence == sequence;
+}
+
+void RideHistory::report() {
+  Serial.println("=== 骑行历史 ===");
+  uint16_t count = getCount();
+  Serial.printf("记录: %u 条（最多 %u 条，最新编号 %lu）\n", count, (unsigned)RIDE_HISTORY_SLOTS,
+                (unsigned long)lastSequence);
+  for (uint16_t i = 0; i < count; i++) {
+    RideSummary ride;
+    if (!get(i, ride)) continue;
+    Serial.printf("#%lu 开始 %lu s: %.2f km, 时长 %lu:%02lu:%02lu, 移动 %lu:%02lu:%02lu, 平均 %.1f km/h, 最高 %.1f km/h, 踏频 %.0f rpm\n",
+                  (unsigned long)ride.sequence, (unsigned long)ride.startTime, ride.distanceKm,
+                  (unsigned long)(ride.durationS / 3600), (unsigned long)(ride.durationS % 3600 / 60),
+                  (unsigned long)(ride.durationS % 60), (unsigned long)(ride.movingS / 3600),
+                  (unsigned long)(ride.movingS % 3600 / 60), (unsigned long)(ride.movingS % 60),
+                  ride.averageSpeed, ride.maxSpeed, ride.averageCadence);
+  }
+  Serial.println("================");
+}
@@ -0,0 +1,54 @@
+/**
+ * 骑行历史
+ * 每次骑行结束时把摘要写成一条定长记录，保存在NVS的 RIDE_HISTORY_SLOTS 个槽位中（环形覆盖最早的记录）。
+ * 记录按编号直接定位槽位（编号 % 槽位数），查看任意一次骑行只需读取一条记录，不需要解析原始日志
+ */
+
+#ifndef RIDE_HISTORY_H
+#define RIDE_HISTORY_H
+
+#include <stdint.h>
+#include "config.h"
+
+// 前向声明
+struct SensorData;
+
+struct RideSummary {
+  uint32_t sequence;        // 骑行编号（从1开始递增，0表示空记录）
+  uint32_t startTime;       // 开始时间（系统时钟，秒；没有校准时间时为上电以来的秒数，深度睡眠期间继续计时）
+  uint32_t durationS;       // 骑行时长（与统计表盘的时长一致）
+  uint32_t movingS;         // 移动时间（速度超过 MOTION_THRESHOLD）
+  uint32_t pedalingS;       // 踩踏时间（踏频大于0）
+  float distanceKm;         // 路程
+  float averageSpeed;       // 平均速度（路程 / 移动时间，km/h）
+  float maxSpeed;           // 最高速度 (km/h)
+  float averageCadence;     // 平均踏频（只计踩踏时间，rpm）
+};
+
+class RideHistory {
+public:
+  static void begin();  // 启动时调用一次：读取最新的骑行编号
+  static void startRide();  // 连接传感器后开始一次骑行
+  static void update(const SensorData& data, unsigned long nowMs);  // 每个数据包解析后调用
+  static bool finishRide(const SensorData& data);  // 骑行结束（断开连接）时写入记录，路程太短时不写入
+  static void suspendRide(const SensorData& data);  // 进入深度睡眠前写入记录，热恢复后继续同一条记录
+  static void resumeRide();  // 热恢复：继续睡眠前的骑行，结束时覆盖同一条记录
+
+  static uint16_t getCount();  // 保存的记录数（最多 RIDE_HISTORY_SLOTS）
+  static bool get(uint16_t index, RideSummary& out);  // index 0 = 最近一次骑行
+  static void report();  // 输出保存的骑行记录到串口
+
+private:
+  static uint32_t lastSequence;  // 最近一条记录的编号（0表示没有记录）
+  static RideSummary current;
+  static bool active;
+  static bool resumed;            // current 是 lastSequence 的记录（热恢复后继续）
+  static unsigned long lastUpdateMs;
+  static uint32_t movingMs;
+  static uint32_t pedalingMs;
+  static float crankRevolutions;  // 踩踏时间内的曲柄转数（踏频按时间积分，用于平均踏频）
+
+  static bool write(const RideSummary& summary);
+};
+
+#endif // RIDE_HISTORY_H
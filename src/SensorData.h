@@ -0,0 +1,44 @@
+/**
+ * 传感器数据结构
+ * 主程序、解析器和显示模块共用同一份定义，避免各文件重复声明导致字段布局不一致
+ */
+
+#ifndef SENSOR_DATA_H
+#define SENSOR_DATA_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "RideHistory.h"
+
+struct SensorData {
+  float speed = 0.0;        // 速度 (km/h)
+  float cadence = 0.0;      // 踏频 (rpm)
+  uint16_t power = 0;       // 瞬时功率 (W，设备提供 Cycling Power 服务时)
+  uint8_t heartRate = 0;    // 心率 (bpm，0表示未获取，设备提供 Heart Rate 服务时)
+  uint32_t wheelRevolutions = 0;
+  uint16_t lastWheelEventTime = 0;
+  uint16_t crankRevolutions = 0;
+  uint16_t lastCrankEventTime = 0;
+  bool connected = false;
+  int8_t batteryLevel = -1;  // 电池电量 (0-100, -1表示未获取)
+  char deviceName[24] = ""; // 设备名称（定长，连接时复制，不分配堆内存）
+  int8_t rssi = 0;          // 信号强度 (dBm)
+  int8_t rssiTrend = 0;     // 信号强度趋势 (dB，负值表示在变弱，见 LinkMonitor)
+  uint16_t linkLossPermille = 0;  // 推断的通知丢失率（千分比）
+  float distance = 0.0;     // 此次连接以来的总路程 (km)
+  float distanceOffset = 0.0; // 深度睡眠前已骑行的路程（热恢复时保留，km）
+  float totalDistance = 0.0; // 总路程（累积所有连接的路程，km）
+  float averageSpeed = 0.0; // 平均速度 (km/h)
+  unsigned long rideDuration = 0;  // 本次骑行时长（秒）
+  uint32_t initialWheelRevolutions = 0;  // 连接时的初始轮转数
+  unsigned long connectionStartTime = 0;  // 连接开始时间（用于计算平均速度和骑行时长）
+  unsigned long lastUpdateTime = 0;
+  uint32_t packetArrivalUs = 0;   // 最近一个数据包的通知到达时间（延迟统计用）
+  uint32_t packetParsedUs = 0;    // 最近一个数据包的解析完成时间
+  // 骑行历史主题显示的记录（翻页时由主循环从 RideHistory 复制）
+  uint8_t historyIndex = 0;       // 1 = 最近一次骑行，0 表示没有记录
+  uint8_t historyCount = 0;       // 保存的记录数
+  RideSummary historyRide = {};
+};
+
+#endif // SENSOR_DATA_H
@@ -0,0 +1,250 @@
+/**
+ * 设置存储实现
+ * 记录整体作为一个NVS blob读写：启动时一次 getBytes，写入时一次 putBytes
+ */
+
+#include "Settings.h"
+#include "StallMonitor.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <esp_timer.h>
+#include <string.h>
+
+#define SETTINGS_MAGIC 0x424D5354  // "BMST"
+#define SETTINGS_NAMESPACE "ble_meter"
+#define SETTINGS_KEY "settings"
+
+static Preferences storage;
+
+SettingsRecord Settings::record;
+bool Settings::dirty = false;
+unsigned long Settings::lastChangeMs = 0;
+uint32_t Settings::loadUs = 0;
+uint32_t Settings::writes = 0;
+
+void Settings::load() {
+  int64_t startUs = esp_timer_get_time();
+  storage.begin(SETTINGS_NAMESPACE, false);
+
+  // 长度不符（旧/新版本布局）时 getBytes 返回0
+  size_t length = storage.getBytes(SETTINGS_KEY, &record, sizeof(record));
+  const char* problem = nullptr;
+  if (length == 0) {
+    problem = "没有设置记录";
+  } else if (length != sizeof(record) || record.magic != SETTINGS_MAGIC ||
+             record.version != SETTINGS_VERSION || record.size != sizeof(record)) {
+    problem = "设置记录版本不符";
+  } else if (record.crc != crc32((const uint8_t*)&record, offsetof(SettingsRecord, crc))) {
+    problem = "设置记录CRC错误";
+  }
+
+  if (problem != nullptr) {
+    setDefaults();
+    if (migrateLegacy()) {
+      Serial.printf("%s，已从旧版本的设置迁移\n", problem);
+    } else {
+      Serial.printf("%s，使用默认设置\n", problem);
+    }
+  }
+  loadUs = (uint32_t)(esp_timer_get_time() - startUs);
+  Serial.printf("设置已加载: 主题 %u, 轮周长 %u mm, 总路程 %.3f km (%lu us)\n", record.theme,
+                record.wheelCircumferenceMm, record.odometerKm, (unsigned long)loadUs);
+}
+
+const SettingsRecord& Settings::get() {
+  return record;
+}
+
+void Settings::setDefaults() {
+  memset(&record, 0, sizeof(record));
+  record.theme = DISPLAY_THEME;
+  record.wheelCircumferenceMm = WHEEL_CIRCUMFERENCE_MM;
+  dirty = false;
+}
+
+// 旧版本：主题在 "display"/theme，总路程在 "distance"/total，上次的设备在 "ble_meter"/last_device
+// 迁移后立即写入记录，写入成功后删除旧的键（之后启动只读取记录）
+bool Settings::migrateLegacy() {
+  Preferences legacy;
+  bool haveTheme = false;
+  bool haveTotal = false;
+  bool haveDevice = storage.isKey("last_device");
+  if (legacy.begin("display", true)) {
+    haveTheme = legacy.isKey("theme");
+    if (haveTheme) {
+      record.theme = legacy.getUChar("theme", DISPLAY_THEME);
+    }
+    legacy.end();
+  }
+  if (legacy.begin("distance", true)) {
+    haveTotal = legacy.isKey("total");
+    if (haveTotal) {
+      record.odometerKm = legacy.getFloat("total", 0.0);
+    }
+    legacy.end();
+  }
+  if (haveDevice) {
+    String address = storage.getString("last_device", "");
+    rememberDevice(address.c_str(), 0, "");
+  }
+  if (!haveTheme && !haveTotal && !haveDevice) {
+    return false;
+  }
+
+  markDirty();
+  flush();
+  if (dirty) {
+    return true;  // 记录写入失败，保留旧的键
+  }
+  if (haveTheme && legacy.begin("display", false)) {
+    legacy.remove("theme");
+    legacy.end();
+  }
+  if (haveTotal && legacy.begin("distance", false)) {
+    legacy.remove("total");
+    legacy.end();
+  }
+  if (haveDevice) {
+    storage.remove("last_device");
+  }
+  return true;
+}
+
+void Settings::markDirty() {
+  dirty = true;
+  lastChangeMs = millis();
+}
+
+void Settings::setTheme(uint8_t theme) {
+  if (record.theme != theme) {
+    record.theme = theme;
+    markDirty();
+  }
+}
+
+void Settings::setWheelCircumference(uint16_t mm) {
+  if (record.wheelCircumferenceMm != mm) {
+    record.wheelCircumferenceMm = mm;
+    markDirty();
+  }
+}
+
+void Settings::checkpointOdometer(float totalKm) {
+  record.odometerKm = totalKm;
+  record.odometerCheckpoints++;
+  markDirty();
+}
+
+void Settings::rememberDevice(const char* address, uint8_t addressType, const char* name) {
+  if (address == nullptr || address[0] == '\0') {
+    return;
+  }
+  // 已知设备移到最前面，表满时丢弃最久未连接的设备
+  uint8_t index = SETTINGS_KNOWN_DEVICES - 1;
+  for (uint8_t i = 0; i < SETTINGS_KNOWN_DEVICES; i++) {
+    if (strcasecmp(record.devices[i].address, address) == 0) {
+      index = i;
+      break;
+    }
+  }
+  KnownDevice device = record.devices[index];
+  bool changed = index != 0 || !record.hasLastDevice || strcasecmp(device.address, address) != 0 ||
+                 device.addressType != addressType;
+  if (strcasecmp(device.address, address) != 0) {
+    memset(&device, 0, sizeof(device));
+  }
+  strncpy(device.address, address, sizeof(device.address) - 1);
+  device.addressType = addressType;
+  if (name != nullptr && name[0] != '\0' && strcmp(device.name, name) != 0) {
+    strncpy(device.name, name, sizeof(device.name) - 1);
+    device.name[sizeof(device.name) - 1] = '\0';
+    changed = true;
+  }
+  if (!changed) {
+    return;
+  }
+  memmove(&record.devices[1], &record.devices[0], index * sizeof(KnownDevice));
+  record.devices[0] = device;
+  record.hasLastDevice = true;
+  markDirty();
+}
+
+const KnownDevice* Settings::getLastDevice() {
+  return record.hasLastDevice && record.devices[0].address[0] != '\0' ? &record.devices[0] : nullptr;
+}
+
+const KnownDevice* Settings::findDevice(const char* address) {
+  if (address == nullptr || address[0] == '\0') {
+    return nullptr;
+  }
+  for (uint8_t i = 0; i < SETTINGS_KNOWN_DEVICES; i++) {
+    if (strcasecmp(record.devices[i].address, address) == 0) {
+      return &record.devices[i];
+    }
+  }
+  return nullptr;
+}
+
+void Settings::forgetLastDevice() {
+  if (record.hasLastDevice) {
+    record.hasLastDevice = false;
+    markDirty();
+  }
+}
+
+void Settings::service(unsigned long nowMs) {
+  if (dirty && nowMs - lastChangeMs >= SETTINGS_WRITE_DELAY_MS) {
+    flush();
+  }
+}
+
+void Settings::flush() {
+  if (!dirty) {
+    return;
+  }
+  StallScope scope(STALL_REGION_STORAGE);
+  record.magic = SETTINGS_MAGIC;
+  record.version = SETTINGS_VERSION;
+  record.size = sizeof(record);
+  record.crc = crc32((const uint8_t*)&record, offsetof(SettingsRecord, crc));
+  if (storage.putBytes(SETTINGS_KEY, &record, sizeof(record)) == sizeof(record)) {
+    dirty = false;
+    writes++;
+  } else {
+    // 写入失败：保留修改，等下一个写入延迟后重试
+    lastChangeMs = millis();
+    Serial.println("设置写入失败");
+  }
+}
+
+void Settings::report() {
+  Serial.println("=== 设置 ===");
+  Serial.printf("版本: %u, 记录大小: %u 字节, 启动读取: %lu us\n", SETTINGS_VERSION, (unsigned)sizeof(record),
+                (unsigned long)loadUs);
+  Serial.printf("主题: %u, 轮周长: %u mm\n", record.theme, record.wheelCircumferenceMm);
+  Serial.printf("总路程: %.3f km（检查点 %lu 次）\n", record.odometerKm, (unsigned long)record.odometerCheckpoints);
+  for (uint8_t i = 0; i < SETTINGS_KNOWN_DEVICES; i++) {
+    const KnownDevice& device = record.devices[i];
+    if (device.address[0] == '\0') continue;
+    Serial.printf("已知设备 %u: %s %s%s\n", i, device.address, device.name,
+                  (i == 0 && record.hasLastDevice) ? "（自动重连）" : "");
+  }
+  Serial.printf("本次启动写入: %lu 次%s\n", (unsigned long)writes, dirty ? "，有修改等待写入" : "");
+  Serial.println("============");
+}
+
+uint32_t Settings::getLoadUs() {
+  return loadUs;
+}
+
+uint32_t Settings::crc32(const uint8_t* data, size_t length) {
+  // CRC-32（IEEE 802.3，反射多项式 0xEDB88320）
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+  }
+  return ~crc;
+}
@@ -0,0 +1,71 @@
+/**
+ * 设置存储
+ * 主题、轮子周长、已知设备和总路程保存在NVS中的一条带版本号和CRC的记录里，
+ * 启动时一次读取到内存；修改只改内存中的副本，一段时间内没有新的修改时再合并写入
+ * （进入深度睡眠前立即写入）。旧版本分散保存的各个键在第一次启动时迁移到记录中
+ */
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// 记录布局版本（字段变化时递增，并在 Settings::load 中迁移旧版本）
+#define SETTINGS_VERSION 1
+
+// 记住的传感器数量（按最近连接排序）
+#define SETTINGS_KNOWN_DEVICES 4
+
+struct KnownDevice {
+  char address[18];      // "xx:xx:xx:xx:xx:xx"，空字符串表示空位
+  uint8_t addressType;   // 扫描时得到的地址类型（直接连接时使用）
+  char name[24];         // 广播名称（直接连接没有扫描时显示）
+};
+
+struct SettingsRecord {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;                     // sizeof(SettingsRecord)
+  uint8_t theme;                     // 显示主题
+  bool hasLastDevice;                // devices[0] 是上次连接的设备（进入匹配模式时清除）
+  uint16_t wheelCircumferenceMm;     // 轮子周长
+  KnownDevice devices[SETTINGS_KNOWN_DEVICES];
+  float odometerKm;                  // 总路程检查点（每次断开连接时更新）
+  uint32_t odometerCheckpoints;      // 检查点次数
+  uint32_t crc;                      // CRC-32，覆盖之前的所有字段
+};
+
+class Settings {
+public:
+  static void load();  // 启动时调用一次
+  static const SettingsRecord& get();
+
+  static void setTheme(uint8_t theme);
+  static void setWheelCircumference(uint16_t mm);
+  static void checkpointOdometer(float totalKm);
+  static void rememberDevice(const char* address, uint8_t addressType, const char* name);
+  static const KnownDevice* getLastDevice();           // 没有时返回 nullptr
+  static const KnownDevice* findDevice(const char* address);
+  static void forgetLastDevice();  // 已知设备保留，只是不再自动重连
+
+  static void service(unsigned long nowMs);  // 主循环中调用：修改后 SETTINGS_WRITE_DELAY_MS 内没有新修改时写入
+  static void flush();                       // 有未写入的修改时立即写入（进入深度睡眠前）
+  static void report();                      // 输出设置和读写统计到串口
+  static uint32_t getLoadUs();               // 启动时读取设置的耗时
+
+private:
+  static SettingsRecord record;
+  static bool dirty;
+  static unsigned long lastChangeMs;
+  static uint32_t loadUs;
+  static uint32_t writes;
+
+  static void setDefaults();
+  static bool migrateLegacy();
+  static void markDirty();
+  static uint32_t crc32(const uint8_t* data, size_t length);
+};
+
+#endif // SETTINGS_H
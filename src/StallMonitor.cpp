@@ -0,0 +1,110 @@
+/**
+ * 主循环卡顿监控实现
+ * 只在主循环任务中调用，不需要加锁
+ */
+
+#include "StallMonitor.h"
+#include <Arduino.h>
+#include <string.h>
+
+static const char* const REGION_NAMES[STALL_REGION_COUNT] = {
+  "主循环", "扫描", "连接", "GATT读取", "显示", "存储", "界面等待"
+};
+
+StallStats StallMonitor::stats;
+StallRegion StallMonitor::currentRegion = STALL_REGION_LOOP;
+uint32_t StallMonitor::iterationStartUs = 0;
+uint32_t StallMonitor::regionStartUs = 0;
+uint32_t StallMonitor::regionUs[STALL_REGION_COUNT];
+
+void StallMonitor::loopStart() {
+  if (!STALL_MONITOR_ENABLED) return;
+
+  uint32_t nowUs = micros();
+  regionUs[currentRegion] += nowUs - regionStartUs;
+  regionStartUs = nowUs;
+  if (iterationStartUs != 0) {
+    closeIteration(nowUs - iterationStartUs);
+  }
+  memset(regionUs, 0, sizeof(regionUs));
+  iterationStartUs = nowUs;
+}
+
+StallRegion StallMonitor::setRegion(StallRegion region) {
+  StallRegion previous = currentRegion;
+  if (STALL_MONITOR_ENABLED) {
+    uint32_t nowUs = micros();
+    regionUs[currentRegion] += nowUs - regionStartUs;
+    regionStartUs = nowUs;
+  }
+  currentRegion = region;
+  return previous;
+}
+
+void StallMonitor::closeIteration(uint32_t iterationUs) {
+  uint32_t ms = iterationUs / 1000;
+  uint8_t bucket = ms == 0 ? 0 : 32 - __builtin_clz(ms);
+  if (bucket >= STALL_BUCKETS) bucket = STALL_BUCKETS - 1;
+  stats.iterations++;
+  stats.buckets[bucket]++;
+  if (ms > stats.maxMs) stats.maxMs = ms;
+
+  if (ms < STALL_THRESHOLD_MS) {
+    return;
+  }
+
+  // 归到这次迭代中耗时最多的区域（包括未标记的主循环代码）
+  StallRegion region = STALL_REGION_LOOP;
+  for (uint8_t i = 1; i < STALL_REGION_COUNT; i++) {
+    if (regionUs[i] > regionUs[region]) {
+      region = (StallRegion)i;
+    }
+  }
+  stats.stalls[region]++;
+  if (ms > stats.stallMaxMs[region]) stats.stallMaxMs[region] = ms;
+  if (ms > stats.worstMs) {
+    stats.worstMs = ms;
+    stats.worstRegion = region;
+    stats.worstAtMs = millis();
+  }
+  if (STALL_LOG_ENABLED) {
+    Serial.printf("[卡顿] 主循环 %lu ms，主要在%s (%lu ms)\n", (unsigned long)ms, REGION_NAMES[region],
+                  (unsigned long)(regionUs[region] / 1000));
+  }
+}
+
+void StallMonitor::snapshot(StallStats& out) {
+  out = stats;
+}
+
+const char* StallMonitor::getRegionName(StallRegion region) {
+  return region < STALL_REGION_COUNT ? REGION_NAMES[region] : "?";
+}
+
+void StallMonitor::reset() {
+  memset(&stats, 0, sizeof(stats));
+}
+
+void StallMonitor::report() {
+  Serial.println("=== 主循环卡顿 ===");
+  Serial.printf("迭代: %lu 次, 最长 %lu ms, 卡顿阈值 %u ms\n", (unsigned long)stats.iterations,
+                (unsigned long)stats.maxMs, (unsigned)STALL_THRESHOLD_MS);
+  // 非空的桶：[下界, 上界) ms 次数
+  Serial.print("迭代耗时 ");
+  for (uint8_t i = 0; i < STALL_BUCKETS; i++) {
+    if (stats.buckets[i] == 0) continue;
+    Serial.printf("[%lu,%lu):%lu ", (unsigned long)(i == 0 ? 0 : 1u << (i - 1)), (unsigned long)(1u << i),
+                  (unsigned long)stats.buckets[i]);
+  }
+  Serial.println();
+  for (uint8_t i = 0; i < STALL_REGION_COUNT; i++) {
+    if (stats.stalls[i] == 0) continue;
+    Serial.printf("%s: 卡顿 %lu 次, 最长 %lu ms\n", REGION_NAMES[i], (unsigned long)stats.stalls[i],
+                  (unsigned long)stats.stallMaxMs[i]);
+  }
+  if (stats.worstMs > 0) {
+    Serial.printf("最长卡顿: %lu ms（%s，启动后 %lu s）\n", (unsigned long)stats.worstMs,
+                  REGION_NAMES[stats.worstRegion], (unsigned long)(stats.worstAtMs / 1000));
+  }
+  Serial.println("==================");
+}
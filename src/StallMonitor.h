@@ -0,0 +1,68 @@
+/**
+ * 主循环卡顿监控
+ * 每次 loop() 开始时结束上一次迭代的计时，迭代耗时按2的幂分桶统计；
+ * 超过 STALL_THRESHOLD_MS 的迭代记为一次卡顿，并归到这次迭代中耗时最多的 StallScope 区域
+ * （扫描、连接、GATT读取、显示、存储、界面等待），通过串口命令 stall 输出
+ */
+
+#ifndef STALL_MONITOR_H
+#define STALL_MONITOR_H
+
+#include <stdint.h>
+#include "config.h"
+
+enum StallRegion : uint8_t {
+  STALL_REGION_LOOP = 0,   // 主循环（未标记的代码）
+  STALL_REGION_SCAN,       // 匹配扫描
+  STALL_REGION_CONNECT,    // 连接、服务发现、订阅
+  STALL_REGION_GATT_READ,  // 同步GATT读取（电量、CSC Feature、轮询测量）
+  STALL_REGION_RENDER,     // 显示刷新
+  STALL_REGION_STORAGE,    // NVS写入
+  STALL_REGION_UI_DELAY,   // 显示提示后的固定等待
+  STALL_REGION_COUNT
+};
+
+// 迭代耗时分桶：桶0 = 1ms以下，桶i = [2^(i-1), 2^i) ms，最后一个桶包含16秒以上
+#define STALL_BUCKETS 16
+
+struct StallStats {
+  uint32_t iterations;
+  uint32_t buckets[STALL_BUCKETS];
+  uint32_t maxMs;
+  uint32_t stalls[STALL_REGION_COUNT];      // 卡顿次数（按主要区域）
+  uint32_t stallMaxMs[STALL_REGION_COUNT];  // 各区域造成的最长卡顿
+  uint32_t worstMs;                         // 最长的一次卡顿
+  StallRegion worstRegion;
+  uint32_t worstAtMs;                       // 发生时间（启动以来）
+};
+
+class StallMonitor {
+public:
+  static void loopStart();  // loop() 开头调用
+  static StallRegion setRegion(StallRegion region);  // 返回之前的区域
+  static void snapshot(StallStats& out);
+  static const char* getRegionName(StallRegion region);
+  static void reset();
+  static void report();  // 输出统计到串口
+
+private:
+  static StallStats stats;
+  static StallRegion currentRegion;
+  static uint32_t iterationStartUs;
+  static uint32_t regionStartUs;
+  static uint32_t regionUs[STALL_REGION_COUNT];  // 本次迭代各区域的耗时（嵌套时记到最内层）
+
+  static void closeIteration(uint32_t iterationUs);
+};
+
+// 作用域内主循环的耗时记到指定区域
+class StallScope {
+public:
+  explicit StallScope(StallRegion region) : previous(StallMonitor::setRegion(region)) {}
+  ~StallScope() { StallMonitor::setRegion(previous); }
+
+private:
+  StallRegion previous;
+};
+
+#endif // STALL_MONITOR_H
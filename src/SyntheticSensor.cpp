@@ -0,0 +1,295 @@
+/**
+ * 合成CSC数据源实现
+ * 定时器回调按速度/踏频曲线推进轮子和曲柄的转数，每个数据包带上最近一次整圈的计数器和事件时间，
+ * 与真实传感器一样：数据包比转动事件快时，连续几个数据包的计数器相同。
+ * 状态只在定时器回调中修改（开始/停止时定时器已停止），已完成的档位用自旋锁交给主循环
+ */
+
+#include "SyntheticSensor.h"
+#include "BLEManager.h"
+#include "LatencyTracker.h"
+#include "Settings.h"
+#include <string.h>
+
+// 速率扫描的各档速率（Hz）
+static const uint16_t SWEEP_RATES[SYNTHETIC_SWEEP_STEPS] = {1, 2, 5, 10, 20, 50, 100, 200, 500};
+
+// 计数器和事件时间的初始值：开始后几秒内就回绕，每次运行都经过回绕处理
+#define SYNTHETIC_WHEEL_START 0xFFFFFFF0UL
+#define SYNTHETIC_CRANK_START 0xFFF0
+#define SYNTHETIC_TIME_START 0xF800  // 1/1024秒，2秒后回绕
+
+esp_timer_handle_t SyntheticSensor::timer = nullptr;
+volatile bool SyntheticSensor::running = false;
+bool SyntheticSensor::sweeping = false;
+uint8_t SyntheticSensor::sweepIndex = 0;
+uint8_t SyntheticSensor::stepsReported = 0;
+int64_t SyntheticSensor::startUs = 0;
+int64_t SyntheticSensor::stepStartUs = 0;
+int64_t SyntheticSensor::lastPacketUs = 0;
+SyntheticRateStats SyntheticSensor::current = {};
+SyntheticRateStats SyntheticSensor::steps[SYNTHETIC_SWEEP_STEPS];
+uint8_t SyntheticSensor::stepCount = 0;
+portMUX_TYPE SyntheticSensor::lock = portMUX_INITIALIZER_UNLOCKED;
+uint32_t SyntheticSensor::packetIndex = 0;
+uint32_t SyntheticSensor::wheelRevolutions = 0;
+uint16_t SyntheticSensor::wheelEventTime = 0;
+float SyntheticSensor::wheelFraction = 0.0;
+uint16_t SyntheticSensor::crankRevolutions = 0;
+uint16_t SyntheticSensor::crankEventTime = 0;
+float SyntheticSensor::crankFraction = 0.0;
+
+bool SyntheticSensor::start(uint16_t rateHz) {
+  if (rateHz == 0 || rateHz > SYNTHETIC_MAX_RATE_HZ) {
+    Serial.printf("合成数据源速率应在 1-%u Hz 之间\n", (unsigned)SYNTHETIC_MAX_RATE_HZ);
+    return false;
+  }
+  if (!begin(rateHz)) {
+    return false;
+  }
+  Serial.printf("合成数据源: %u Hz\n", (unsigned)rateHz);
+  return true;
+}
+
+bool SyntheticSensor::startSweep() {
+  if (!begin(SWEEP_RATES[0])) {
+    return false;
+  }
+  sweeping = true;
+  Serial.printf("合成数据源: 速率扫描 %u-%u Hz，每档 %u 秒\n", (unsigned)SWEEP_RATES[0],
+                (unsigned)SWEEP_RATES[SYNTHETIC_SWEEP_STEPS - 1], (unsigned)(SYNTHETIC_SWEEP_STEP_MS / 1000));
+  return true;
+}
+
+bool SyntheticSensor::begin(uint16_t rateHz) {
+  if (timer == nullptr) {
+    esp_timer_create_args_t args = {};
+    args.callback = onTimer;
+    args.name = "synthetic";
+    if (esp_timer_create(&args, &timer) != ESP_OK) {
+      Serial.println("合成数据源定时器创建失败");
+      return false;
+    }
+  }
+  stop();
+
+  portENTER_CRITICAL(&lock);
+  memset(&current, 0, sizeof(current));
+  current.rateHz = rateHz;
+  stepCount = 0;
+  portEXIT_CRITICAL(&lock);
+  sweeping = false;
+  sweepIndex = 0;
+  stepsReported = 0;
+  packetIndex = 0;
+  wheelRevolutions = SYNTHETIC_WHEEL_START;
+  wheelEventTime = SYNTHETIC_TIME_START;
+  wheelFraction = 0.0;
+  crankRevolutions = SYNTHETIC_CRANK_START;
+  crankEventTime = SYNTHETIC_TIME_START;
+  crankFraction = 0.0;
+  startUs = esp_timer_get_time();
+  stepStartUs = startUs;
+  lastPacketUs = startUs;
+
+  running = true;
+  schedule();
+  return true;
+}
+
+void SyntheticSensor::stop() {
+  if (timer != nullptr) {
+    esp_timer_stop(timer);
+  }
+  running = false;
+}
+
+bool SyntheticSensor::isRunning() {
+  return running;
+}
+
+void SyntheticSensor::schedule() {
+  uint32_t intervalUs = 1000000UL / current.rateHz;
+  uint32_t jitterUs = intervalUs * SYNTHETIC_JITTER_PERCENT / 100;
+  if (jitterUs > 0) {
+    intervalUs = intervalUs - jitterUs + esp_random() % (2 * jitterUs + 1);
+  }
+  if (running) {
+    esp_timer_start_once(timer, intervalUs);
+  }
+}
+
+void SyntheticSensor::onTimer(void* /*arg*/) {
+  if (!running) {
+    return;
+  }
+  int64_t nowUs = esp_timer_get_time();
+
+  // 速率扫描：当前档位结束，记录统计并换到下一档
+  if (sweeping && nowUs - stepStartUs >= SYNTHETIC_SWEEP_STEP_MS * 1000LL) {
+    portENTER_CRITICAL(&lock);
+    steps[stepCount++] = current;
+    portEXIT_CRITICAL(&lock);
+    if (++sweepIndex >= SYNTHETIC_SWEEP_STEPS) {
+      running = false;
+      return;
+    }
+    memset(&current, 0, sizeof(current));
+    current.rateHz = SWEEP_RATES[sweepIndex];
+    stepStartUs = nowUs;
+  }
+
+  advance(nowUs);
+  uint8_t packet[11];
+  size_t length = buildPacket(packet);
+  current.generated++;
+#if SYNTHETIC_LOSS_PERCENT > 0
+  if (esp_random() % 100 < SYNTHETIC_LOSS_PERCENT) {
+    current.lost++;
+  } else
+#endif
+  if (!BLEManager::enqueuePacket(MEASUREMENT_CSC, packet, length, LatencyTracker::now())) {
+    current.dropped++;
+  }
+  schedule();
+}
+
+// 推进到 nowUs：小数转数按速度积分，整圈时计数器增加，事件时间为最后一个整圈的时刻
+void SyntheticSensor::advance(int64_t nowUs) {
+  float speedKmh, cadenceRpm;
+  profileAt((uint32_t)((nowUs - startUs) / 1000), speedKmh, cadenceRpm);
+  float seconds = (nowUs - lastPacketUs) / 1000000.0f;
+  int64_t elapsedUs = nowUs - startUs;
+  lastPacketUs = nowUs;
+
+  float wheelRps = speedKmh / 3.6f / (Settings::get().wheelCircumferenceMm / 1000.0f);
+  if (wheelRps > 0) {
+    wheelFraction += wheelRps * seconds;
+    if (wheelFraction >= 1.0f) {
+      uint32_t turns = (uint32_t)wheelFraction;
+      wheelRevolutions += turns;
+      wheelFraction -= turns;
+      int64_t eventUs = elapsedUs - (int64_t)(wheelFraction / wheelRps * 1000000.0f);
+      wheelEventTime = (uint16_t)(SYNTHETIC_TIME_START + eventUs * 1024 / 1000000);
+    }
+  }
+
+  float crankRps = cadenceRpm / 60.0f;
+  if (crankRps > 0) {
+    crankFraction += crankRps * seconds;
+    if (crankFraction >= 1.0f) {
+      uint16_t turns = (uint16_t)crankFraction;
+      crankRevolutions += turns;
+      crankFraction -= turns;
+      int64_t eventUs = elapsedUs - (int64_t)(crankFraction / crankRps * 1000000.0f);
+      crankEventTime = (uint16_t)(SYNTHETIC_TIME_START + eventUs * 1024 / 1000000);
+    }
+  }
+}
+
+// BT003-2的两种数据包（见 CSCParser.cpp）：
+//   11字节: 0x03, 轮转数(4), 轮转时间(2), 曲柄转数(2), 曲柄时间(2)
+//   5字节:  0x02, 轮转时间(2), 曲柄转数(2)
+size_t SyntheticSensor::buildPacket(uint8_t* out) {
+  bool shortPacket = SYNTHETIC_SHORT_PACKET_EVERY > 0 &&
+                     packetIndex % SYNTHETIC_SHORT_PACKET_EVERY == SYNTHETIC_SHORT_PACKET_EVERY - 1;
+  packetIndex++;
+  if (shortPacket) {
+    out[0] = 0x02;
+    memcpy(out + 1, &wheelEventTime, 2);
+    memcpy(out + 3, &crankRevolutions, 2);
+    return 5;
+  }
+  out[0] = 0x03;
+  memcpy(out + 1, &wheelRevolutions, 4);
+  memcpy(out + 5, &wheelEventTime, 2);
+  memcpy(out + 7, &crankRevolutions, 2);
+  memcpy(out + 9, &crankEventTime, 2);
+  return 11;
+}
+
+void SyntheticSensor::profileAt(uint32_t elapsedMs, float& speedKmh, float& cadenceRpm) {
+  speedKmh = SYNTHETIC_SPEED_KMH;
+  cadenceRpm = SYNTHETIC_CADENCE_RPM;
+  if (SYNTHETIC_PROFILE == 1) {
+    // 间歇：骑30秒、停10秒（停车时轮子和曲柄都不转）
+    if (elapsedMs % 40000 >= 30000) {
+      speedKmh = 0;
+      cadenceRpm = 0;
+    }
+  } else if (SYNTHETIC_PROFILE == 2) {
+    // 往复：速度在0和2倍之间线性变化，接近停车时不踩踏
+    float phase = (elapsedMs % 60000) / 60000.0f;
+    float ramp = phase < 0.5f ? phase * 2 : (1 - phase) * 2;
+    speedKmh = SYNTHETIC_SPEED_KMH * 2 * ramp;
+    cadenceRpm = ramp > 0.1f ? SYNTHETIC_CADENCE_RPM * (0.6f + 0.8f * ramp) : 0;
+  }
+}
+
+void SyntheticSensor::service() {
+  SyntheticRateStats step;
+  while (true) {
+    portENTER_CRITICAL(&lock);
+    bool available = stepsReported < stepCount;
+    if (available) {
+      step = steps[stepsReported++];
+    }
+    portEXIT_CRITICAL(&lock);
+    if (!available) break;
+    Serial.printf("[合成] %u Hz: 生成 %lu，模拟丢失 %lu，溢出丢弃 %lu\n", (unsigned)step.rateHz,
+                  (unsigned long)step.generated, (unsigned long)step.lost, (unsigned long)step.dropped);
+  }
+  if (sweeping && !running) {
+    sweeping = false;
+    Serial.printf("[合成] 速率扫描结束，主循环持续处理的最高速率: %s%u Hz\n", isSustainedRateCapped() ? "不低于 " : "",
+                  (unsigned)getSustainedRate());
+  }
+}
+
+uint8_t SyntheticSensor::getSweepSteps(SyntheticRateStats* out, uint8_t maxSteps) {
+  portENTER_CRITICAL(&lock);
+  uint8_t count = stepCount < maxSteps ? stepCount : maxSteps;
+  memcpy(out, steps, count * sizeof(SyntheticRateStats));
+  portEXIT_CRITICAL(&lock);
+  return count;
+}
+
+uint16_t SyntheticSensor::getSustainedRate() {
+  SyntheticRateStats completed[SYNTHETIC_SWEEP_STEPS];
+  uint8_t count = getSweepSteps(completed, SYNTHETIC_SWEEP_STEPS);
+  uint16_t sustained = 0;
+  for (uint8_t i = 0; i < count && completed[i].dropped == 0; i++) {
+    sustained = completed[i].rateHz;
+  }
+  return sustained;
+}
+
+bool SyntheticSensor::isSustainedRateCapped() {
+  SyntheticRateStats completed[SYNTHETIC_SWEEP_STEPS];
+  uint8_t count = getSweepSteps(completed, SYNTHETIC_SWEEP_STEPS);
+  return count == SYNTHETIC_SWEEP_STEPS && completed[count - 1].dropped == 0;
+}
+
+void SyntheticSensor::report() {
+  Serial.println("=== 合成数据源 ===");
+  Serial.printf("状态: %s, 曲线 %d, %.1f km/h, %.0f rpm, 抖动 ±%d%%, 模拟丢失 %d%%, 5字节数据包 1/%d\n",
+                running ? (sweeping ? "速率扫描中" : "运行中") : "已停止", SYNTHETIC_PROFILE,
+                (float)SYNTHETIC_SPEED_KMH, (float)SYNTHETIC_CADENCE_RPM, SYNTHETIC_JITTER_PERCENT,
+                SYNTHETIC_LOSS_PERCENT, SYNTHETIC_SHORT_PACKET_EVERY);
+  if (running) {
+    Serial.printf("当前 %u Hz: 生成 %lu，模拟丢失 %lu，溢出丢弃 %lu\n", (unsigned)current.rateHz,
+                  (unsigned long)current.generated, (unsigned long)current.lost, (unsigned long)current.dropped);
+  }
+  SyntheticRateStats completed[SYNTHETIC_SWEEP_STEPS];
+  uint8_t count = getSweepSteps(completed, SYNTHETIC_SWEEP_STEPS);
+  for (uint8_t i = 0; i < count; i++) {
+    Serial.printf("%5u Hz: 生成 %lu，模拟丢失 %lu，溢出丢弃 %lu\n", (unsigned)completed[i].rateHz,
+                  (unsigned long)completed[i].generated, (unsigned long)completed[i].lost,
+                  (unsigned long)completed[i].dropped);
+  }
+  if (count > 0) {
+    Serial.printf("持续处理的最高速率: %s%u Hz（缓冲区 %d 个数据包）\n", isSustainedRateCapped() ? "不低于 " : "",
+                  (unsigned)getSustainedRate(), MEASUREMENT_RING_SLOTS);
+  }
+  Serial.println("==================");
+}
@@ -0,0 +1,69 @@
+/**
+ * 合成CSC数据源（压力测试）
+ * 单次定时器（esp_timer任务）按设定速率生成数据包，经 BLEManager::enqueuePacket 写入与通知回调相同的环形缓冲区，
+ * 主循环按真实传感器的流程处理。速率扫描逐档提高速率，统计每一档缓冲区溢出丢弃的数据包，
+ * 得出主循环能持续处理的最高速率（主循环缓冲区中有数据包时不做10 ms延迟，结果由处理耗时决定）
+ */
+
+#ifndef SYNTHETIC_SENSOR_H
+#define SYNTHETIC_SENSOR_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "config.h"
+
+#define SYNTHETIC_SWEEP_STEPS 9  // 1, 2, 5, 10, 20, 50, 100, 200, 500 Hz
+
+struct SyntheticRateStats {
+  uint16_t rateHz;
+  uint32_t generated;  // 生成的数据包（包括模拟丢失的）
+  uint32_t lost;       // 模拟丢失（没有写入缓冲区）
+  uint32_t dropped;    // 缓冲区已满时丢弃的最旧数据包（主循环来不及处理）
+};
+
+class SyntheticSensor {
+public:
+  static bool start(uint16_t rateHz);  // 以固定速率运行，直到 stop()
+  static bool startSweep();            // 速率扫描，最后一档结束后自动停止
+  static void stop();
+  static bool isRunning();
+  static void service();  // 主循环调用：输出扫描中已完成的档位和结果（串口输出不在定时器任务中进行）
+
+  // 速率扫描已完成的档位，返回档数
+  static uint8_t getSweepSteps(SyntheticRateStats* out, uint8_t maxSteps);
+  static uint16_t getSustainedRate();  // 扫描中没有溢出丢弃的最高速率（0 = 没有完成的档位或1 Hz就已溢出）
+  static bool isSustainedRateCapped();  // 最高一档也没有溢出：实际上限高于扫描范围，getSustainedRate 只是下限
+  static void report();
+
+private:
+  static esp_timer_handle_t timer;
+  static volatile bool running;
+  static bool sweeping;
+  static uint8_t sweepIndex;
+  static uint8_t stepsReported;
+  static int64_t startUs;       // 开始时间（速度曲线的时间原点）
+  static int64_t stepStartUs;   // 当前速率（档位）的开始时间
+  static int64_t lastPacketUs;
+  static SyntheticRateStats current;
+  static SyntheticRateStats steps[SYNTHETIC_SWEEP_STEPS];
+  static uint8_t stepCount;
+  static portMUX_TYPE lock;
+
+  // 传感器状态：转数的小数部分在两个数据包之间累计，整圈时更新计数器和事件时间（1/1024秒）
+  static uint32_t packetIndex;
+  static uint32_t wheelRevolutions;
+  static uint16_t wheelEventTime;
+  static float wheelFraction;
+  static uint16_t crankRevolutions;
+  static uint16_t crankEventTime;
+  static float crankFraction;
+
+  static bool begin(uint16_t rateHz);
+  static void onTimer(void* arg);
+  static void schedule();
+  static void advance(int64_t nowUs);
+  static size_t buildPacket(uint8_t* out);
+  static void profileAt(uint32_t elapsedMs, float& speedKmh, float& cadenceRpm);
+};
+
+#endif // SYNTHETIC_SENSOR_H
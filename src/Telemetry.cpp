@@ -0,0 +1,195 @@
+/**
+ * 串口二进制遥测类实现
+ *
+ * 帧结构（COBS编码前）:
+ *   字节0: 记录类型
+ *   字节1-2: 帧序号 (uint16_t, little-endian)
+ *   字节3..N-3: 记录内容（固定布局，little-endian）
+ *   最后2字节: CRC16-CCITT (多项式0x1021，初值0xFFFF，覆盖前面所有字节)
+ *
+ * 编码后的帧前后各有一个 0x00 分隔符，主机端遇到 0x00 即可重新同步，
+ * 即使串口中混有文本日志也不会影响解码（CRC校验失败的数据会被丢弃）
+ */
+
+#include "Telemetry.h"
+#include "SensorData.h"
+#include "LinkMonitor.h"
+#include "Settings.h"
+#include <Arduino.h>
+
+// 小端写入辅助函数
+static inline size_t putU8(uint8_t* buf, size_t offset, uint8_t value) {
+  buf[offset] = value;
+  return offset + 1;
+}
+
+static inline size_t putU16(uint8_t* buf, size_t offset, uint16_t value) {
+  buf[offset] = (uint8_t)(value & 0xFF);
+  buf[offset + 1] = (uint8_t)(value >> 8);
+  return offset + 2;
+}
+
+static inline size_t putU32(uint8_t* buf, size_t offset, uint32_t value) {
+  buf[offset] = (uint8_t)(value & 0xFF);
+  buf[offset + 1] = (uint8_t)((value >> 8) & 0xFF);
+  buf[offset + 2] = (uint8_t)((value >> 16) & 0xFF);
+  buf[offset + 3] = (uint8_t)(value >> 24);
+  return offset + 4;
+}
+
+// 浮点数按定点缩放后写入，负数和溢出截断到0和上限
+static inline uint16_t toFixedU16(float value, float scale) {
+  float scaled = value * scale + 0.5f;
+  if (scaled <= 0.0f) return 0;
+  if (scaled >= 65535.0f) return 65535;
+  return (uint16_t)scaled;
+}
+
+static inline uint32_t toFixedU32(float value, float scale) {
+  float scaled = value * scale + 0.5f;
+  if (scaled <= 0.0f) return 0;
+  if (scaled >= 4294967040.0f) return 0xFFFFFFFFUL;
+  return (uint32_t)scaled;
+}
+
+Telemetry::Telemetry() {
+  sequence = 0;
+  framesSent = 0;
+  framesDropped = 0;
+}
+
+void Telemetry::begin() {
+  // 启动时发送一条HELLO记录，主机端据此确认协议版本和轮周长
+  size_t offset = beginRecord(TELEMETRY_RECORD_HELLO);
+  offset = putU8(payload, offset, TELEMETRY_PROTOCOL_VERSION);
+  offset = putU16(payload, offset, Settings::get().wheelCircumferenceMm);
+  offset = putU32(payload, offset, millis());
+  sendFrame(offset);
+}
+
+size_t Telemetry::beginRecord(uint8_t type) {
+  size_t offset = 0;
+  offset = putU8(payload, offset, type);
+  offset = putU16(payload, offset, sequence++);
+  return offset;
+}
+
+bool Telemetry::sendSensorRecord(const SensorData& data) {
+  size_t offset = beginRecord(TELEMETRY_RECORD_SENSOR);
+  offset = putU32(payload, offset, millis());
+  offset = putU16(payload, offset, toFixedU16(data.speed, 100.0f));        // 0.01 km/h
+  offset = putU16(payload, offset, toFixedU16(data.cadence, 10.0f));       // 0.1 rpm
+  offset = putU32(payload, offset, data.wheelRevolutions);
+  offset = putU16(payload, offset, data.lastWheelEventTime);
+  offset = putU16(payload, offset, data.crankRevolutions);
+  offset = putU16(payload, offset, data.lastCrankEventTime);
+  offset = putU32(payload, offset, toFixedU32(data.distance, 1000.0f));       // 米
+  offset = putU32(payload, offset, toFixedU32(data.totalDistance, 1000.0f));  // 米
+  offset = putU16(payload, offset, toFixedU16(data.averageSpeed, 100.0f));    // 0.01 km/h
+  offset = putU32(payload, offset, (uint32_t)data.rideDuration);
+  offset = putU8(payload, offset, (uint8_t)data.rssi);
+  offset = putU8(payload, offset, (uint8_t)data.batteryLevel);
+  offset = putU8(payload, offset, data.connected ? 0x01 : 0x00);
+  offset = putU16(payload, offset, data.linkLossPermille);  // 协议版本2
+  offset = putU8(payload, offset, (uint8_t)data.rssiTrend);
+  offset = putU16(payload, offset, data.power);             // 协议版本3
+  offset = putU8(payload, offset, data.heartRate);
+  return sendFrame(offset);
+}
+
+bool Telemetry::sendRawPacket(const uint8_t* data, size_t length) {
+  if (data == nullptr || length == 0) {
+    return false;
+  }
+  size_t offset = beginRecord(TELEMETRY_RECORD_RAW_CSC);
+  // 预留时间戳(4) + 长度(1) + CRC(2)
+  if (offset + 5 + length + 2 > TELEMETRY_MAX_PAYLOAD) {
+    length = TELEMETRY_MAX_PAYLOAD - offset - 5 - 2;
+  }
+  offset = putU32(payload, offset, millis());
+  offset = putU8(payload, offset, (uint8_t)length);
+  memcpy(payload + offset, data, length);
+  offset += length;
+  return sendFrame(offset);
+}
+
+bool Telemetry::sendLinkRecord(const LinkStats& stats, uint32_t ringDropped) {
+  size_t offset = beginRecord(TELEMETRY_RECORD_LINK);
+  offset = putU32(payload, offset, millis());
+  offset = putU8(payload, offset, (uint8_t)stats.rssi);
+  offset = putU8(payload, offset, (uint8_t)stats.rssiTrend);
+  offset = putU32(payload, offset, stats.received);
+  offset = putU32(payload, offset, stats.lost);
+  offset = putU32(payload, offset, ringDropped);
+  offset = putU16(payload, offset, stats.nominalGapMs > 65535 ? 65535 : (uint16_t)stats.nominalGapMs);
+  offset = putU16(payload, offset, stats.maxGapMs > 65535 ? 65535 : (uint16_t)stats.maxGapMs);
+  for (uint8_t i = 0; i < LINK_GAP_BUCKETS; i++) {
+    offset = putU16(payload, offset, stats.gapBuckets[i] > 65535 ? 65535 : (uint16_t)stats.gapBuckets[i]);
+  }
+  return sendFrame(offset);
+}
+
+bool Telemetry::sendFrame(size_t payloadLength) {
+  uint16_t crc = crc16(payload, payloadLength);
+  payloadLength = putU16(payload, payloadLength, crc);
+
+  // 帧前后都加分隔符，串口中夹杂的文本日志会被隔离成独立的无效帧，不会吞掉下一帧
+  frame[0] = 0x00;
+  size_t frameLength = 1 + cobsEncode(payload, payloadLength, frame + 1);
+  frame[frameLength++] = 0x00;
+
+  // 串口发送缓冲区不足时直接丢弃，避免阻塞主循环（主机端通过序号检测丢帧）
+  if (Serial.availableForWrite() < (int)frameLength) {
+    framesDropped++;
+    return false;
+  }
+  Serial.write(frame, frameLength);
+  framesSent++;
+  return true;
+}
+
+uint16_t Telemetry::crc16(const uint8_t* data, size_t length) {
+  // CRC-16/CCITT-FALSE
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      if (crc & 0x8000) {
+        crc = (crc << 1) ^ 0x1021;
+      } else {
+        crc <<= 1;
+      }
+    }
+  }
+  return crc;
+}
+
+size_t Telemetry::cobsEncode(const uint8_t* input, size_t length, uint8_t* output) {
+  // 负载不超过254字节，只需要单块编码
+  size_t readIndex = 0;
+  size_t writeIndex = 1;
+  size_t codeIndex = 0;
+  uint8_t code = 1;
+
+  while (readIndex < length) {
+    if (input[readIndex] == 0) {
+      output[codeIndex] = code;
+      code = 1;
+      codeIndex = writeIndex++;
+    } else {
+      output[writeIndex++] = input[readIndex];
+      code++;
+    }
+    readIndex++;
+  }
+  output[codeIndex] = code;
+  return writeIndex;
+}
+
+uint32_t Telemetry::getFramesSent() {
+  return framesSent;
+}
+
+uint32_t Telemetry::getFramesDropped() {
+  return framesDropped;
+}
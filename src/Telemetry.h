@@ -0,0 +1,56 @@
+/**
+ * 串口二进制遥测类
+ * 将传感器数据打包为固定布局的记录，使用 COBS 分帧 + CRC16 校验后写入串口
+ * 帧格式详见: docs/telemetry_protocol.md，主机端解码工具: tools/telemetry_decode.py
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// 前向声明
+struct SensorData;
+struct LinkStats;
+
+// 协议版本（记录布局变化时递增）
+#define TELEMETRY_PROTOCOL_VERSION 3
+
+// 记录类型
+#define TELEMETRY_RECORD_HELLO   0x00  // 启动信息（协议版本、轮周长）
+#define TELEMETRY_RECORD_SENSOR  0x01  // 传感器数据记录（每个数据包一条）
+#define TELEMETRY_RECORD_RAW_CSC 0x02  // 原始CSC通知数据（用于离线回放）
+#define TELEMETRY_RECORD_LINK    0x03  // 链路质量统计（定期发送）
+
+// 单帧最大负载（COBS单块编码上限为254字节）
+#define TELEMETRY_MAX_PAYLOAD 64
+
+class Telemetry {
+private:
+  uint16_t sequence;      // 帧序号（每帧递增，主机端据此检测丢帧）
+  uint32_t framesSent;
+  uint32_t framesDropped; // 串口发送缓冲区不足而丢弃的帧数
+
+  uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+  uint8_t frame[TELEMETRY_MAX_PAYLOAD + 3];  // COBS编码后最多多出1字节，再加帧首尾各一个0x00
+
+  size_t beginRecord(uint8_t type);
+  bool sendFrame(size_t payloadLength);
+
+  static uint16_t crc16(const uint8_t* data, size_t length);
+  static size_t cobsEncode(const uint8_t* input, size_t length, uint8_t* output);
+
+public:
+  Telemetry();
+
+  void begin();
+  bool sendSensorRecord(const SensorData& data);
+  bool sendRawPacket(const uint8_t* data, size_t length);
+  bool sendLinkRecord(const LinkStats& stats, uint32_t ringDropped);
+  uint32_t getFramesSent();
+  uint32_t getFramesDropped();
+};
+
+#endif // TELEMETRY_H
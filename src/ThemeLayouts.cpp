@@ -0,0 +1,122 @@
+/**
+ * 主题布局表
+ * 坐标为 U8g2 文字基线坐标；重绘区域 (bx, by, bw, bh) 需覆盖控件所有可能的像素
+ * 重绘区域不重叠的控件可以单独重绘（例如数字表盘中只有踏频轮子在转动时只发送轮子所在的tile）
+ * 使用 UI_FONT 显示中文时，文字需用 UI_TEXT("...") 标记，子集字体才会包含这些字形
+ */
+
+#include "Widget.h"
+#include "DisplayManager.h"
+
+#ifdef OLED_128x64
+
+// 主题0：数字显示仪表盘（速度和踏频用数字图集绘制，p1 为小数位数）
+static const Widget DIGITAL_WIDGETS[] = {
+  // kind           field          flags               font                      x    y    p1  p2  p3  format    format2  重绘区域
+  {WIDGET_NUMBER,   FIELD_SPEED,   WIDGET_DIGIT_ATLAS, u8g2_font_logisoso32_tn,  0,   32,  1,  0,  0,  "%.1f",  nullptr, 0,  0,  84, 33},
+  {WIDGET_LABEL,    FIELD_NONE,    0,                  UI_FONT,                  85,  12,  0,  0,  0,  "km/h",  nullptr, 85, 0,  43, 14},
+  {WIDGET_NUMBER,   FIELD_CADENCE, WIDGET_DIGIT_ATLAS, u8g2_font_logisoso24_tn,  0,   64,  0,  0,  0,  "%.0f",  nullptr, 0,  40, 56, 24},
+  {WIDGET_LABEL,    FIELD_NONE,    WIDGET_FOLLOW,      UI_FONT,                  2,   64,  0,  0,  0,  "rpm",   nullptr, 14, 50, 76, 14},
+  {WIDGET_WHEEL,    FIELD_CADENCE, 0,                  nullptr,                  108, 44,  18, 0,  0,  nullptr, nullptr, 90, 26, 37, 37},
+  // 丢包率达到1%或信号在变弱时显示在单位和轮子之间的空白处（变弱时附加RSSI趋势）
+  {WIDGET_LINK,     FIELD_NONE,    WIDGET_ALIGN_RIGHT | WIDGET_CONNECTED, u8g2_font_6x10_tf, 127, 25, 10, 0, 0, "L%.0f%%", "L%.0f%%%+d", 85, 16, 43, 10},
+};
+
+// 主题1：模拟仪表盘（表盘内的控件与表盘一起重绘）
+static const Widget ANALOG_WIDGETS[] = {
+  {WIDGET_GAUGE,    FIELD_SPEED,   0,                  u8g2_font_6x10_tf,        64,  55,  62, 52, 60, nullptr, nullptr, 0,  2,  128, 57},
+  {WIDGET_RSSI,     FIELD_NONE,    0,                  u8g2_font_6x10_tf,        2,   10,  0,  0,  0,  "%d",    nullptr, 0,  0,  36, 12},
+  {WIDGET_BATTERY,  FIELD_NONE,    WIDGET_ALIGN_RIGHT, u8g2_font_6x10_tf,        126, 10,  0,  0,  0,  "%d%%",  nullptr, 96, 0,  32, 12},
+  {WIDGET_NUMBER,   FIELD_CADENCE, WIDGET_ALIGN_CENTER, u8g2_font_logisoso16_tn, 64,  57,  0,  0,  0,  "%.0f",  nullptr, 40, 40, 48, 18},
+  {WIDGET_LABEL,    FIELD_NONE,    0,                  u8g2_font_6x10_tf,        52,  69,  0,  0,  0,  "rpm",   nullptr, 52, 60, 20, 4},
+};
+
+// 主题2：数据统计表盘（每行一个重绘区域，行距9像素与 6x10 字体的字形高度一致，各行互不重叠）
+static const Widget STATISTICS_WIDGETS[] = {
+  {WIDGET_NUMBER,   FIELD_SPEED,          0,             u8g2_font_6x10_tf, 2, 10, 0, 0, 0, "Speed: %.1f km/h",     nullptr,              0, 3,  128, 9},
+  {WIDGET_NUMBER,   FIELD_CADENCE,        0,             u8g2_font_6x10_tf, 2, 19, 0, 0, 0, "Cadence: %.0f rpm",    nullptr,              0, 12, 128, 9},
+  {WIDGET_DISTANCE, FIELD_DISTANCE,       0,             u8g2_font_6x10_tf, 2, 28, 0, 0, 0, "Distance: %.0f m",     "Distance: %.2f km",  0, 21, 128, 9},
+  {WIDGET_DISTANCE, FIELD_TOTAL_DISTANCE, 0,             u8g2_font_6x10_tf, 2, 37, 0, 0, 0, "Total: %.0f m",        "Total: %.2f km",     0, 30, 128, 9},
+  {WIDGET_NUMBER,   FIELD_AVERAGE_SPEED,  0,             u8g2_font_6x10_tf, 2, 46, 0, 0, 0, "Avg Speed: %.1f km/h", nullptr,              0, 39, 128, 9},
+  {WIDGET_DURATION, FIELD_RIDE_DURATION,  0,             u8g2_font_6x10_tf, 2, 55, 0, 0, 0, "Duration: %lu:%02lu:%02lu", "Duration: %lu:%02lu", 0, 48, 128, 9},
+  {WIDGET_DEVICE,   FIELD_NONE,           0,             u8g2_font_6x10_tf, 2, 64, 1, 0, 0, "%.7s",                 "Disconnected",       0, 57, 128, 7},
+  {WIDGET_RSSI,     FIELD_NONE,           WIDGET_FOLLOW | WIDGET_CONNECTED, u8g2_font_6x10_tf, 0, 64, 0, 0, 0, " R:%d",   nullptr,  0, 57, 128, 7},
+  {WIDGET_BATTERY,  FIELD_NONE,           WIDGET_FOLLOW | WIDGET_CONNECTED, u8g2_font_6x10_tf, 0, 64, 0, 0, 0, " B:%d%%", nullptr,  0, 57, 128, 7},
+};
+
+// 主题3：骑行历史（与统计表盘相同的行距，每行一个重绘区域）
+static const Widget HISTORY_WIDGETS[] = {
+  {WIDGET_NUMBER,   FIELD_HISTORY_INDEX,         WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 2, 10, 0, 0, 0, "Ride %.0f",            nullptr,              0, 3,  128, 9},
+  {WIDGET_NUMBER,   FIELD_HISTORY_COUNT,         WIDGET_FOLLOW | WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 0, 10, 0, 0, 0, "/%.0f", nullptr,  0, 3,  128, 9},
+  {WIDGET_LABEL,    FIELD_NONE,                  WIDGET_NO_RIDE,  u8g2_font_6x10_tf, 2, 10, 0, 0, 0, "No rides yet",         nullptr,              0, 3,  128, 9},
+  {WIDGET_DISTANCE, FIELD_HISTORY_DISTANCE,      WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 2, 19, 0, 0, 0, "Distance: %.0f m",     "Distance: %.2f km",  0, 12, 128, 9},
+  {WIDGET_DURATION, FIELD_HISTORY_DURATION,      WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 2, 28, 0, 0, 0, "Time: %lu:%02lu:%02lu", "Time: %lu:%02lu",   0, 21, 128, 9},
+  {WIDGET_DURATION, FIELD_HISTORY_MOVING_TIME,   WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 2, 37, 0, 0, 0, "Moving: %lu:%02lu:%02lu", "Moving: %lu:%02lu", 0, 30, 128, 9},
+  {WIDGET_NUMBER,   FIELD_HISTORY_AVERAGE_SPEED, WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 2, 46, 0, 0, 0, "Avg Speed: %.1f km/h", nullptr,              0, 39, 128, 9},
+  {WIDGET_NUMBER,   FIELD_HISTORY_MAX_SPEED,     WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 2, 55, 0, 0, 0, "Max Speed: %.1f km/h", nullptr,              0, 48, 128, 9},
+  {WIDGET_NUMBER,   FIELD_HISTORY_CADENCE,       WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 2, 64, 0, 0, 0, "Cadence: %.0f rpm",    nullptr,              0, 57, 128, 7},
+};
+
+#define ANALOG_WIDGET_COUNT (sizeof(ANALOG_WIDGETS) / sizeof(ANALOG_WIDGETS[0]))
+
+#else
+
+// 128x32 屏幕空间较小，只显示关键信息
+
+// 主题0：速度（数字图集）+ 设备名称/信号/电量（与速度数字重叠，一起重绘）
+static const Widget DIGITAL_WIDGETS[] = {
+  {WIDGET_NUMBER,   FIELD_SPEED,   WIDGET_DIGIT_ATLAS, u8g2_font_logisoso32_tn,  0,   32,  1,  0,  0,  "%.1f",  nullptr,        0,  0,  84,  32},
+  {WIDGET_LABEL,    FIELD_NONE,    0,                  UI_FONT,                  85,  12,  0,  0,  0,  "km/h",  nullptr,        85, 0,  43,  14},
+  {WIDGET_DEVICE,   FIELD_NONE,    0,                  UI_FONT,                  0,   20,  0,  0,  0,  "%.7s",  "Disconnected", 0,  6,  128, 16},
+  {WIDGET_RSSI,     FIELD_NONE,    WIDGET_FOLLOW | WIDGET_CONNECTED,      UI_FONT, 1,   20, 0, 0, 0, "%d",   nullptr, 0, 6, 128, 16},
+  {WIDGET_BATTERY,  FIELD_NONE,    WIDGET_ALIGN_RIGHT | WIDGET_CONNECTED, UI_FONT, 128, 20, 0, 0, 0, "%d%%", nullptr, 0, 6, 128, 16},
+};
+
+// 主题1：模拟仪表盘需要128x64屏幕
+static const Widget ANALOG_WIDGETS[] = {
+  {WIDGET_LABEL,    FIELD_NONE,    0,                  nullptr,                  0,   0,   0,  0,  0,  "",      nullptr,        0,  0,  0,   0},
+};
+
+// 主题2：数据统计（行距8像素，字形下沿与下一行重叠，相邻行一起重绘）
+static const Widget STATISTICS_WIDGETS[] = {
+  {WIDGET_NUMBER,   FIELD_SPEED,          0,             u8g2_font_6x10_tf, 2, 8,  0, 0, 0, "S:%.1f",       nullptr,       0, 1,  128, 9},
+  {WIDGET_NUMBER,   FIELD_CADENCE,        WIDGET_FOLLOW, u8g2_font_6x10_tf, 0, 8,  0, 0, 0, " C:%.0f",      nullptr,       0, 1,  128, 9},
+  {WIDGET_DISTANCE, FIELD_DISTANCE,       0,             u8g2_font_6x10_tf, 2, 16, 0, 0, 0, "D:%.0fm",      "D:%.2fkm",    0, 9,  128, 9},
+  {WIDGET_DISTANCE, FIELD_TOTAL_DISTANCE, WIDGET_FOLLOW, u8g2_font_6x10_tf, 0, 16, 0, 0, 0, " T:%.0fm",     " T:%.1fkm",   0, 9,  128, 9},
+  {WIDGET_NUMBER,   FIELD_AVERAGE_SPEED,  0,             u8g2_font_6x10_tf, 2, 24, 0, 0, 0, "Avg:%.1f",     nullptr,       0, 17, 128, 9},
+  {WIDGET_DURATION, FIELD_RIDE_DURATION,  WIDGET_FOLLOW, u8g2_font_6x10_tf, 0, 24, 1, 0, 0, " T:%lu:%02lu", " T:%lum",     0, 17, 128, 9},
+  {WIDGET_RSSI,     FIELD_NONE,           0,             u8g2_font_6x10_tf, 2, 32, 0, 0, 0, "R:%d",         nullptr,       0, 25, 128, 7},
+  {WIDGET_BATTERY,  FIELD_NONE,           WIDGET_FOLLOW, u8g2_font_6x10_tf, 0, 32, 0, 0, 0, " B:%d%%",      nullptr,       0, 25, 128, 7},
+  {WIDGET_LINK,     FIELD_NONE,           WIDGET_FOLLOW | WIDGET_CONNECTED, u8g2_font_6x10_tf, 0, 32, 0, 0, 0, " L:%.0f%%", " L:%.0f%%%+d", 0, 25, 128, 7},
+};
+
+// 主题3：骑行历史
+static const Widget HISTORY_WIDGETS[] = {
+  {WIDGET_NUMBER,   FIELD_HISTORY_INDEX,         WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 2, 8,  0, 0, 0, "#%.0f",        nullptr,       0, 1,  128, 9},
+  {WIDGET_NUMBER,   FIELD_HISTORY_COUNT,         WIDGET_FOLLOW | WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 0, 8, 0, 0, 0, "/%.0f", nullptr, 0, 1,  128, 9},
+  {WIDGET_DISTANCE, FIELD_HISTORY_DISTANCE,      WIDGET_FOLLOW | WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 0, 8, 0, 0, 0, " D:%.0fm", " D:%.2fkm", 0, 1, 128, 9},
+  {WIDGET_LABEL,    FIELD_NONE,                  WIDGET_NO_RIDE,  u8g2_font_6x10_tf, 2, 8,  0, 0, 0, "No rides yet", nullptr,       0, 1,  128, 9},
+  {WIDGET_DURATION, FIELD_HISTORY_DURATION,      WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 2, 16, 1, 0, 0, "T:%lu:%02lu",  "T:%lum",      0, 9,  128, 9},
+  {WIDGET_DURATION, FIELD_HISTORY_MOVING_TIME,   WIDGET_FOLLOW | WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 0, 16, 1, 0, 0, " M:%lu:%02lu", " M:%lum", 0, 9, 128, 9},
+  {WIDGET_NUMBER,   FIELD_HISTORY_AVERAGE_SPEED, WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 2, 24, 0, 0, 0, "Avg:%.1f",     nullptr,       0, 17, 128, 9},
+  {WIDGET_NUMBER,   FIELD_HISTORY_MAX_SPEED,     WIDGET_FOLLOW | WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 0, 24, 0, 0, 0, " Max:%.1f", nullptr, 0, 17, 128, 9},
+  {WIDGET_NUMBER,   FIELD_HISTORY_CADENCE,       WIDGET_HAS_RIDE, u8g2_font_6x10_tf, 2, 32, 0, 0, 0, "Cad:%.0f",     nullptr,       0, 25, 128, 7},
+};
+
+#define ANALOG_WIDGET_COUNT 0
+
+#endif
+
+static const WidgetLayout THEME_LAYOUTS[] = {
+  {DIGITAL_WIDGETS, sizeof(DIGITAL_WIDGETS) / sizeof(DIGITAL_WIDGETS[0])},
+  {ANALOG_WIDGETS, ANALOG_WIDGET_COUNT},
+  {STATISTICS_WIDGETS, sizeof(STATISTICS_WIDGETS) / sizeof(STATISTICS_WIDGETS[0])},
+  {HISTORY_WIDGETS, sizeof(HISTORY_WIDGETS) / sizeof(HISTORY_WIDGETS[0])},
+};
+
+const WidgetLayout& getThemeLayout(uint8_t theme) {
+  if (theme >= sizeof(THEME_LAYOUTS) / sizeof(THEME_LAYOUTS[0])) {
+    theme = 0;
+  }
+  return THEME_LAYOUTS[theme];
+}
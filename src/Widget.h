@@ -0,0 +1,79 @@
+/**
+ * 界面控件定义
+ * 每个主题是一张常量控件表（存放在Flash中），控件绑定 SensorData 的字段，
+ * 由 WidgetRenderer 按表绘制，只重绘显示内容发生变化的控件
+ */
+
+#ifndef WIDGET_H
+#define WIDGET_H
+
+#include <stdint.h>
+
+// 控件类型
+enum WidgetKind : uint8_t {
+  WIDGET_LABEL,     // 固定文字（单位等），format 为文字内容
+  WIDGET_NUMBER,    // 数值，format 为 printf 格式（float）
+  WIDGET_DISTANCE,  // 路程，小于1km时用 format 显示米，否则用 format2 显示km
+  WIDGET_DURATION,  // 时长（秒），超过1小时用 format，否则用 format2；p1: 0 = 时:分:秒，1 = 时:分
+  WIDGET_RSSI,      // 信号强度（未获取时不显示），format 为 printf 格式（int）
+  WIDGET_BATTERY,   // 电池电量（未获取时不显示），format 为 printf 格式（int）
+  WIDGET_LINK,      // 链路质量：丢包率不低于 p1（千分比）时按 format 显示（丢包率%，float）；
+                    // 信号在变弱时按 format2 显示（丢包率%，RSSI趋势dB），format2 为 nullptr 时不显示趋势
+  WIDGET_DEVICE,    // 已连接时显示设备名称（format），未连接时显示 format2；p1 = 1 时无名称显示 "Connected"
+  WIDGET_GAUGE,     // 半圆指针表盘，(x, y) 为中心，p1/p2 为X/Y方向半径，p3 为满量程
+  WIDGET_WHEEL      // 踏频轮子动画，(x, y) 为中心，p1 为半径
+};
+
+// 绑定的数据字段
+enum WidgetField : uint8_t {
+  FIELD_NONE,
+  FIELD_SPEED,
+  FIELD_CADENCE,
+  FIELD_AVERAGE_SPEED,
+  FIELD_DISTANCE,
+  FIELD_TOTAL_DISTANCE,
+  FIELD_RIDE_DURATION,
+  // 骑行历史主题（SensorData::historyRide）
+  FIELD_HISTORY_INDEX,
+  FIELD_HISTORY_COUNT,
+  FIELD_HISTORY_DISTANCE,
+  FIELD_HISTORY_DURATION,
+  FIELD_HISTORY_MOVING_TIME,
+  FIELD_HISTORY_AVERAGE_SPEED,
+  FIELD_HISTORY_MAX_SPEED,
+  FIELD_HISTORY_CADENCE
+};
+
+// 控件标志
+#define WIDGET_ALIGN_RIGHT   0x01  // x 为文字右边界
+#define WIDGET_ALIGN_CENTER  0x02  // x 为文字中心
+#define WIDGET_FOLLOW        0x04  // 紧跟在上一个控件文字之后，x 为间距（上一个控件没有文字时不加间距）
+#define WIDGET_CONNECTED     0x08  // 只在已连接时显示
+#define WIDGET_HAS_RIDE      0x10  // 只在有骑行记录时显示
+#define WIDGET_NO_RIDE       0x20  // 只在没有骑行记录时显示
+#define WIDGET_DIGIT_ATLAS   0x40  // 数值用数字图集绘制（p1 为小数位数，与 format 一致；没有图集时按 format 和字体绘制）
+
+struct Widget {
+  WidgetKind kind;
+  WidgetField field;
+  uint8_t flags;
+  const uint8_t* font;
+  int16_t x, y;          // 文字基线起点，或图形中心
+  int16_t p1, p2, p3;    // 控件参数（见 WidgetKind）
+  const char* format;
+  const char* format2;
+  uint8_t bx, by, bw, bh;  // 重绘区域：控件重绘时先清除此区域，与之重叠的控件一起重绘
+};
+
+struct WidgetLayout {
+  const Widget* widgets;
+  uint8_t count;
+};
+
+// 单个布局的最大控件数（WidgetRenderer 按此分配每个控件的状态）
+#define WIDGET_MAX_PER_LAYOUT 12
+
+// 主题布局（0=数字表盘，1=模拟表盘，2=数据统计表盘，3=骑行历史），按屏幕尺寸选择
+const WidgetLayout& getThemeLayout(uint8_t theme);
+
+#endif // WIDGET_H
@@ -0,0 +1,370 @@
+/**
+ * 控件渲染类实现
+ * 增量绘制分四步：
+ *   1. 计算每个控件的显示内容，与上一帧比较得到变化的控件
+ *   2. 与变化控件的重绘区域重叠的控件也需要重绘（清除区域时会擦掉它们的像素）
+ *   3. 清除所有需要重绘的区域
+ *   4. 按布局表顺序重绘这些控件，合并它们的区域作为需要发送的tile区域
+ */
+
+#include "WidgetRenderer.h"
+#include <Arduino.h>
+#include <math.h>
+
+// 踏频轮子辐条角度量化（度）：4条辐条每90度重复一次，共15档
+#define WHEEL_ANGLE_STEP 6
+
+WidgetRenderer::WidgetRenderer() {
+  display = nullptr;
+  currentLayout = nullptr;
+  atlasCount = 0;
+  atlasEnabled = true;
+}
+
+void WidgetRenderer::begin(U8G2* display) {
+  this->display = display;
+  currentLayout = nullptr;
+  buildAtlases();
+}
+
+void WidgetRenderer::invalidate() {
+  currentLayout = nullptr;
+}
+
+// 为所有主题中使用数字图集的控件建立图集（借用帧缓冲区，结束时清空）
+void WidgetRenderer::buildAtlases() {
+  atlasCount = 0;
+  for (uint8_t theme = 0; theme < DISPLAY_THEME_COUNT; theme++) {
+    const WidgetLayout& layout = getThemeLayout(theme);
+    for (uint8_t i = 0; i < layout.count; i++) {
+      const Widget& widget = layout.widgets[i];
+      if (!(widget.flags & WIDGET_DIGIT_ATLAS) || findAtlas(widget) || atlasCount >= WIDGET_ATLAS_SLOTS) {
+        continue;
+      }
+      if (atlases[atlasCount].build(display->getU8g2(), widget.font, widget.y)) {
+        atlasCount++;
+      }
+    }
+  }
+}
+
+const DigitAtlas* WidgetRenderer::findAtlas(const Widget& widget) const {
+  if (!(widget.flags & WIDGET_DIGIT_ATLAS)) return nullptr;
+  for (uint8_t i = 0; i < atlasCount; i++) {
+    if (atlases[i].matches(widget.font, widget.y)) {
+      return atlasEnabled ? &atlases[i] : nullptr;
+    }
+  }
+  return nullptr;
+}
+
+uint8_t WidgetRenderer::getAtlasCount() {
+  return atlasCount;
+}
+
+size_t WidgetRenderer::getAtlasBytes() {
+  return atlasCount * sizeof(DigitAtlas);
+}
+
+void WidgetRenderer::setAtlasEnabled(bool enabled) {
+  atlasEnabled = enabled;
+  currentLayout = nullptr;
+}
+
+static float fieldValue(WidgetField field, const SensorData& data) {
+  switch (field) {
+    case FIELD_SPEED:          return data.speed;
+    case FIELD_CADENCE:        return data.cadence;
+    case FIELD_AVERAGE_SPEED:  return data.averageSpeed;
+    case FIELD_DISTANCE:       return data.distance;
+    case FIELD_TOTAL_DISTANCE: return data.totalDistance;
+    case FIELD_RIDE_DURATION:  return (float)data.rideDuration;
+    case FIELD_HISTORY_INDEX:         return data.historyIndex;
+    case FIELD_HISTORY_COUNT:         return data.historyCount;
+    case FIELD_HISTORY_DISTANCE:      return data.historyRide.distanceKm;
+    case FIELD_HISTORY_DURATION:      return (float)data.historyRide.durationS;
+    case FIELD_HISTORY_MOVING_TIME:   return (float)data.historyRide.movingS;
+    case FIELD_HISTORY_AVERAGE_SPEED: return data.historyRide.averageSpeed;
+    case FIELD_HISTORY_MAX_SPEED:     return data.historyRide.maxSpeed;
+    case FIELD_HISTORY_CADENCE:       return data.historyRide.averageCadence;
+    case FIELD_NONE:
+    default:                   return 0.0;
+  }
+}
+
+// 计算控件的显示内容和位置（previous 为布局中上一个控件的内容，用于 WIDGET_FOLLOW）
+void WidgetRenderer::computeContent(const Widget& widget, const SensorData& data, unsigned long time,
+                                    const WidgetContent* previous, WidgetContent& content) {
+  content.text[0] = '\0';
+  content.key = 0;
+  bool visible = !(widget.flags & WIDGET_CONNECTED) || data.connected;
+
+  switch (widget.kind) {
+    case WIDGET_LABEL:
+      snprintf(content.text, sizeof(content.text), "%s", widget.format);
+      break;
+    case WIDGET_NUMBER:
+      if (findAtlas(widget)) {
+        DigitAtlas::formatFixed(fieldValue(widget.field, data), (uint8_t)widget.p1, content.text, sizeof(content.text));
+      } else {
+        snprintf(content.text, sizeof(content.text), widget.format, fieldValue(widget.field, data));
+      }
+      break;
+    case WIDGET_DISTANCE: {
+      float km = fieldValue(widget.field, data);
+      if (km < 1.0) {
+        snprintf(content.text, sizeof(content.text), widget.format, km * 1000.0);
+      } else {
+        snprintf(content.text, sizeof(content.text), widget.format2, km);
+      }
+      break;
+    }
+    case WIDGET_DURATION: {
+      unsigned long duration = (unsigned long)fieldValue(widget.field, data);
+      unsigned long hours = duration / 3600;
+      unsigned long minutes = (duration % 3600) / 60;
+      unsigned long seconds = duration % 60;
+      if (widget.p1 == 1) {
+        if (hours > 0) {
+          snprintf(content.text, sizeof(content.text), widget.format, hours, minutes);
+        } else {
+          snprintf(content.text, sizeof(content.text), widget.format2, minutes);
+        }
+      } else {
+        if (hours > 0) {
+          snprintf(content.text, sizeof(content.text), widget.format, hours, minutes, seconds);
+        } else {
+          snprintf(content.text, sizeof(content.text), widget.format2, minutes, seconds);
+        }
+      }
+      break;
+    }
+    case WIDGET_RSSI:
+      if (visible && data.rssi != 0) {
+        snprintf(content.text, sizeof(content.text), widget.format, data.rssi);
+      }
+      break;
+    case WIDGET_BATTERY:
+      if (visible && data.batteryLevel >= 0) {
+        snprintf(content.text, sizeof(content.text), widget.format, data.batteryLevel);
+      }
+      break;
+    case WIDGET_LINK: {
+      // 信号在变弱时用 format2 附加趋势；丢包率低于 p1 且信号稳定时不显示
+      bool weakening = widget.format2 && data.rssiTrend <= -LINK_RSSI_TREND_WARN_DB;
+      if (visible && (data.linkLossPermille >= widget.p1 || weakening)) {
+        snprintf(content.text, sizeof(content.text), weakening ? widget.format2 : widget.format,
+                 data.linkLossPermille / 10.0, data.rssiTrend);
+      }
+      break;
+    }
+    case WIDGET_DEVICE:
+      if (!data.connected) {
+        snprintf(content.text, sizeof(content.text), "%s", widget.format2);
+      } else if (data.deviceName[0] != '\0') {
+        snprintf(content.text, sizeof(content.text), widget.format, data.deviceName);
+      } else if (widget.p1 == 1) {
+        snprintf(content.text, sizeof(content.text), "Connected");
+      }
+      break;
+    case WIDGET_GAUGE: {
+      // 指针端点（指针之外的表盘内容固定不变）
+      float speed = data.speed;
+      if (speed > widget.p3) speed = widget.p3;
+      if (speed < 0) speed = 0;
+      float rad = (180.0 - (speed / widget.p3) * 180.0) * M_PI / 180.0;
+      int16_t pointerX = widget.x + (int16_t)(cos(rad) * (widget.p1 - 10));
+      int16_t pointerY = widget.y - (int16_t)(sin(rad) * (widget.p2 - 10));
+      content.key = ((int32_t)pointerX << 16) | (uint16_t)pointerY;
+      break;
+    }
+    case WIDGET_WHEEL:
+      if (data.cadence > 0) {
+        // 根据踏频计算旋转角度（速度倍数3，让视觉上更明显）
+        float rotations = (time / 1000.0) * (data.cadence / 60.0) * 3.0;
+        content.key = (int32_t)fmod(rotations * 360.0, 90.0) / WHEEL_ANGLE_STEP;
+      }
+      break;
+  }
+
+  // 骑行历史主题：有/没有记录时显示的控件
+  bool hasRide = data.historyIndex > 0;
+  if (((widget.flags & WIDGET_HAS_RIDE) && !hasRide) || ((widget.flags & WIDGET_NO_RIDE) && hasRide)) {
+    content.text[0] = '\0';
+  }
+
+  content.width = 0;
+  const DigitAtlas* atlas = findAtlas(widget);
+  if (content.text[0] != '\0' && atlas) {
+    content.width = atlas->getWidth(content.text);
+  } else if (content.text[0] != '\0' && widget.font) {
+    display->setFont(widget.font);
+    content.width = display->getUTF8Width(content.text);
+  }
+
+  content.x = widget.x;
+  if ((widget.flags & WIDGET_FOLLOW) && previous) {
+    content.x = previous->x + previous->width + (previous->text[0] != '\0' ? widget.x : 0);
+  } else if (widget.flags & WIDGET_ALIGN_RIGHT) {
+    content.x = widget.x - content.width;
+  } else if (widget.flags & WIDGET_ALIGN_CENTER) {
+    content.x = widget.x - content.width / 2;
+  }
+}
+
+void WidgetRenderer::drawWidget(const Widget& widget, const WidgetContent& content) {
+  if (widget.kind == WIDGET_GAUGE) {
+    drawGauge(widget, content.key);
+  } else if (widget.kind == WIDGET_WHEEL) {
+    drawWheel(widget, content.key);
+  } else if (content.text[0] != '\0') {
+    const DigitAtlas* atlas = findAtlas(widget);
+    if (atlas) {
+      atlas->draw(display->getBufferPtr(), display->getBufferTileWidth(), display->getBufferTileHeight(),
+                  content.x, content.text);
+    } else {
+      display->setFont(widget.font);
+      display->drawUTF8(content.x, widget.y, content.text);
+    }
+  }
+}
+
+// 半圆表盘：左侧0，右侧满量程，每10一个刻度，每20一个刻度值
+void WidgetRenderer::drawGauge(const Widget& widget, int32_t key) {
+  const int16_t centerX = widget.x;
+  const int16_t centerY = widget.y;
+  const int16_t radiusX = widget.p1;
+  const int16_t radiusY = widget.p2;
+
+  // 表盘外圆（半椭圆）
+  for (float angle = 180.0; angle >= 0.0; angle -= 2.0) {
+    float rad = angle * M_PI / 180.0;
+    display->drawPixel(centerX + (int16_t)(cos(rad) * radiusX), centerY - (int16_t)(sin(rad) * radiusY));
+  }
+
+  // 刻度线和刻度值
+  display->setFont(widget.font);
+  for (int16_t speed = 0; speed <= widget.p3; speed += 10) {
+    float rad = (180.0 - ((float)speed / widget.p3) * 180.0) * M_PI / 180.0;
+    int16_t x1 = centerX + (int16_t)(cos(rad) * (radiusX - 6));
+    int16_t y1 = centerY - (int16_t)(sin(rad) * (radiusY - 6));
+    int16_t x2 = centerX + (int16_t)(cos(rad) * radiusX);
+    int16_t y2 = centerY - (int16_t)(sin(rad) * radiusY);
+    display->drawLine(x1, y1, x2, y2);
+
+    if (speed % 20 == 0) {
+      char label[8];  // int16_t 最长 "-32768"
+      snprintf(label, sizeof(label), "%d", speed);
+      display->drawStr(centerX + (int16_t)(cos(rad) * (radiusX - 15)) - 6,
+                       centerY - (int16_t)(sin(rad) * (radiusY - 15)) + 3, label);
+    }
+  }
+
+  // 指针和中心点
+  display->drawLine(centerX, centerY, (int16_t)(key >> 16), (int16_t)(key & 0xFFFF));
+  display->drawDisc(centerX, centerY, 3, U8G2_DRAW_ALL);
+}
+
+// 踏频轮子：外圆 + 4条辐条 + 中心点
+void WidgetRenderer::drawWheel(const Widget& widget, int32_t key) {
+  const int16_t radius = widget.p1;
+  display->drawCircle(widget.x, widget.y, radius, U8G2_DRAW_ALL);
+  for (int i = 0; i < 4; i++) {
+    float angle = (key * WHEEL_ANGLE_STEP + i * 90.0) * M_PI / 180.0;
+    display->drawLine(widget.x, widget.y,
+                      widget.x + (int16_t)(cos(angle) * (radius - 1)),
+                      widget.y + (int16_t)(sin(angle) * (radius - 1)));
+  }
+  display->drawDisc(widget.x, widget.y, 2, U8G2_DRAW_ALL);
+}
+
+TileRegion WidgetRenderer::widgetRegion(const Widget& widget) {
+  TileRegion region = {0, 0, 0};
+  if (widget.bw == 0 || widget.bh == 0) return region;
+  uint8_t rowEnd = (widget.by + widget.bh - 1) / 8;
+  for (uint8_t row = widget.by / 8; row <= rowEnd && row < 8; row++) {
+    region.rowMask |= 1u << row;
+  }
+  region.colStart = widget.bx / 8;
+  region.colEnd = (widget.bx + widget.bw - 1) / 8;
+  return region;
+}
+
+bool WidgetRenderer::overlaps(const Widget& a, const Widget& b) {
+  return a.bx < b.bx + b.bw && b.bx < a.bx + a.bw &&
+         a.by < b.by + b.bh && b.by < a.by + a.bh;
+}
+
+TileRegion WidgetRenderer::draw(const WidgetLayout& layout, const SensorData& data, unsigned long time) {
+  TileRegion region = {0, 0, 0};
+  if (!display) return region;
+
+  uint8_t count = layout.count < WIDGET_MAX_PER_LAYOUT ? layout.count : WIDGET_MAX_PER_LAYOUT;
+  bool fullRedraw = currentLayout != &layout;
+  bool dirty[WIDGET_MAX_PER_LAYOUT];
+
+  // 1. 计算显示内容
+  for (uint8_t i = 0; i < count; i++) {
+    WidgetContent content;
+    computeContent(layout.widgets[i], data, time, i > 0 ? &contents[i - 1] : nullptr, content);
+    dirty[i] = fullRedraw || content.x != contents[i].x || content.key != contents[i].key ||
+               strcmp(content.text, contents[i].text) != 0;
+    contents[i] = content;
+  }
+
+  if (fullRedraw) {
+    display->clearBuffer();
+    for (uint8_t i = 0; i < count; i++) {
+      drawWidget(layout.widgets[i], contents[i]);
+    }
+    currentLayout = &layout;
+    return TileRegion::full();
+  }
+
+  // 2. 重叠闭包：与需要重绘的区域重叠的控件也需要重绘
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (uint8_t i = 0; i < count; i++) {
+      if (!dirty[i]) continue;
+      for (uint8_t j = 0; j < count; j++) {
+        if (!dirty[j] && overlaps(layout.widgets[i], layout.widgets[j])) {
+          dirty[j] = true;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  // 3. 清除需要重绘的区域
+  display->setDrawColor(0);
+  for (uint8_t i = 0; i < count; i++) {
+    if (dirty[i]) {
+      const Widget& widget = layout.widgets[i];
+      display->drawBox(widget.bx, widget.by, widget.bw, widget.bh);
+    }
+  }
+  display->setDrawColor(1);
+
+  // 4. 按布局顺序重绘
+  for (uint8_t i = 0; i < count; i++) {
+    if (dirty[i]) {
+      drawWidget(layout.widgets[i], contents[i]);
+      region.add(widgetRegion(layout.widgets[i]));
+    }
+  }
+  return region;
+}
+
+void WidgetRenderer::drawAll(const WidgetLayout& layout, const SensorData& data, unsigned long time) {
+  if (!display) return;
+
+  uint8_t count = layout.count < WIDGET_MAX_PER_LAYOUT ? layout.count : WIDGET_MAX_PER_LAYOUT;
+  WidgetContent previous;
+  for (uint8_t i = 0; i < count; i++) {
+    WidgetContent content;
+    computeContent(layout.widgets[i], data, time, i > 0 ? &previous : nullptr, content);
+    drawWidget(layout.widgets[i], content);
+    previous = content;
+  }
+}
@@ -0,0 +1,63 @@
+/**
+ * 控件渲染类
+ * 按主题布局表绘制控件，记录每个控件上一次显示的内容，
+ * 完整帧缓冲区模式下只清除并重绘内容变化的控件，返回需要发送的tile区域
+ */
+
+#ifndef WIDGET_RENDERER_H
+#define WIDGET_RENDERER_H
+
+#include <U8g2lib.h>
+#include "Widget.h"
+#include "SensorData.h"
+#include "DisplayTransport.h"
+#include "DigitAtlas.h"
+
+// 数字图集数量（所有主题中带 WIDGET_DIGIT_ATLAS 的控件，每种 字体+基线 一个）
+#define WIDGET_ATLAS_SLOTS 2
+
+class WidgetRenderer {
+private:
+  // 控件的显示内容（文字、位置，图形控件的量化状态）
+  struct WidgetContent {
+    char text[28];
+    int16_t x;
+    int16_t width;
+    int32_t key;  // 表盘：指针端点；轮子：辐条角度档位
+  };
+
+  U8G2* display;
+  const WidgetLayout* currentLayout;  // 帧缓冲区中当前绘制的布局（nullptr 表示需要整屏重绘）
+  WidgetContent contents[WIDGET_MAX_PER_LAYOUT];
+  DigitAtlas atlases[WIDGET_ATLAS_SLOTS];
+  uint8_t atlasCount;
+  bool atlasEnabled;
+
+  void buildAtlases();
+  const DigitAtlas* findAtlas(const Widget& widget) const;
+
+  void computeContent(const Widget& widget, const SensorData& data, unsigned long time,
+                      const WidgetContent* previous, WidgetContent& content);
+  void drawWidget(const Widget& widget, const WidgetContent& content);
+  void drawGauge(const Widget& widget, int32_t key);
+  void drawWheel(const Widget& widget, int32_t key);
+  TileRegion widgetRegion(const Widget& widget);
+  static bool overlaps(const Widget& a, const Widget& b);
+
+public:
+  WidgetRenderer();
+
+  void begin(U8G2* display);
+  // 增量绘制到完整帧缓冲区，返回变化的tile区域（内容没有变化时返回空区域）
+  TileRegion draw(const WidgetLayout& layout, const SensorData& data, unsigned long time);
+  // 完整绘制（分页模式下每页调用一次，不修改控件状态）
+  void drawAll(const WidgetLayout& layout, const SensorData& data, unsigned long time);
+  // 帧缓冲区被其他内容覆盖后调用，下一次 draw() 整屏重绘
+  void invalidate();
+  // 数字图集（begin() 时建立，分页模式下没有）；关闭后按字体绘制（基准测试对比用）
+  uint8_t getAtlasCount();
+  size_t getAtlasBytes();
+  void setAtlasEnabled(bool enabled);
+};
+
+#endif // WIDGET_RENDERER_H
@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""
+界面字体子集生成工具
+
+u8g2_font_unifont_t_chinese3 包含数千个汉字，而界面实际只显示十几个状态文字。
+本工具扫描源码中显示到屏幕上的字符串，只把用到的字形生成为 U8g2 子集字体，
+显著减小固件体积（同时缩短启动和OTA时间）。
+
+显示字符串的识别规则:
+  - showStatus / showError / showSplash / drawUTF8 / drawStr 调用参数中的所有字符串字面量
+    （包括条件表达式的两个分支，例如 showStatus(x ? "连接中..." : "等待连接")）
+  - 用 UI_TEXT("...") 标记的字符串（用于先存入数组/变量再显示的文字，例如主题名称）
+  - 可打印ASCII字符（0x20-0x7E）始终包含，设备名称、数字等运行时文字依赖它们
+
+生成（需要 U8g2 的 bdfconv 工具和 unifont BDF 字体，均在 U8g2 源码仓库 tools/font 目录下）:
+  python3 tools/gen_ui_font.py --bdfconv <u8g2>/tools/font/bdfconv/bdfconv \\
+                               --bdf <u8g2>/tools/font/bdf/unifont.bdf
+  生成 src/fonts/ui_font.c（字体数据）、src/fonts/ui_font.h（声明）和 src/fonts/ui_font.map（字形清单），
+  然后在 config.h 中设置 USE_UI_FONT_SUBSET 为 true。
+
+检查（编译前运行，无需 bdfconv；host/ 下的 make test 也会运行）:
+  python3 tools/gen_ui_font.py --check
+  若有显示字符串用到了子集中不存在的字形，输出缺失的字符及其位置并以非0状态退出。
+  PlatformIO 用户可在 platformio.ini 中加入: extra_scripts = pre:tools/gen_ui_font.py
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+try:
+    REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+except NameError:
+    REPO_ROOT = os.getcwd()  # PlatformIO extra_scripts 中没有 __file__，工作目录即项目根目录
+FONT_DIR = os.path.join(REPO_ROOT, "src", "fonts")
+FONT_NAME = "u8g2_font_ble_meter_ui"
+MAP_FILE = os.path.join(FONT_DIR, "ui_font.map")
+
+SOURCE_FILES = ["ble_meter.ino"]
+SOURCE_DIRS = ["src"]
+
+ASCII_RANGE = range(0x20, 0x7F)
+
+# 显示调用的参数列表（其中的每个字符串字面量），或 UI_TEXT("...")
+DISPLAY_CALL_RE = re.compile(r'\b(?:showStatus|showError|showSplash|drawUTF8|drawStr)\s*\(([^;]*?)\)\s*;')
+UI_TEXT_RE = re.compile(r'\bUI_TEXT\s*\(\s*("(?:[^"\\]|\\.)*")\s*\)')
+STRING_RE = re.compile(r'"((?:[^"\\]|\\.)*)"')
+
+
+def source_paths():
+    for name in SOURCE_FILES:
+        path = os.path.join(REPO_ROOT, name)
+        if os.path.exists(path):
+            yield path
+    for directory in SOURCE_DIRS:
+        for root, _, files in os.walk(os.path.join(REPO_ROOT, directory)):
+            for name in sorted(files):
+                if name.endswith((".h", ".cpp", ".ino")) and root != FONT_DIR:
+                    yield os.path.join(root, name)
+
+
+def scan_display_strings():
+    """返回 {字符: [(文件, 行号, 字符串), ...]}，只统计非ASCII字符"""
+    usage = {}
+    for path in source_paths():
+        with open(path, encoding="utf-8") as handle:
+            text = handle.read()
+        literals = []
+        for match in DISPLAY_CALL_RE.finditer(text):
+            for string in STRING_RE.finditer(match.group(1)):
+                literals.append((match.start(1) + string.start(), string.group(1)))
+        for match in UI_TEXT_RE.finditer(text):
+            literals.append((match.start(), match.group(1)[1:-1]))
+        for position, literal in literals:
+            line = text.count("\n", 0, position) + 1
+            for char in literal:
+                if ord(char) > 0x7E:
+                    usage.setdefault(char, []).append((os.path.relpath(path, REPO_ROOT), line, literal))
+    return usage
+
+
+def bdf_codepoints(bdf_path):
+    codepoints = set()
+    with open(bdf_path, encoding="latin-1") as handle:
+        for line in handle:
+            if line.startswith("ENCODING "):
+                codepoints.add(int(line.split()[1]))
+    return codepoints
+
+
+def read_map():
+    if not os.path.exists(MAP_FILE):
+        return None
+    with open(MAP_FILE, encoding="utf-8") as handle:
+        return {int(line.split()[0], 16) for line in handle if line.strip() and not line.startswith("#")}
+
+
+def generate(args):
+    usage = scan_display_strings()
+    needed = set(ASCII_RANGE) | {ord(char) for char in usage}
+
+    available = bdf_codepoints(args.bdf)
+    missing = sorted(needed - available)
+    if missing:
+        for codepoint in missing:
+            char = chr(codepoint)
+            for path, line, literal in usage.get(char, []):
+                sys.stderr.write("%s:%d: 字体 %s 中没有字形 '%s' (U+%04X)，字符串: \"%s\"\n"
+                                 % (path, line, os.path.basename(args.bdf), char, codepoint, literal))
+        return 1
+
+    os.makedirs(FONT_DIR, exist_ok=True)
+    glyph_map = ",".join(str(codepoint) for codepoint in sorted(needed))
+    font_c = os.path.join(FONT_DIR, "ui_font.c")
+    subprocess.check_call([args.bdfconv, "-f", "1", "-m", glyph_map, "-n", FONT_NAME, "-o", font_c, args.bdf])
+
+    # bdfconv 输出的文件依赖 u8g2.h 中的 U8G2_FONT_SECTION 宏
+    with open(font_c, encoding="utf-8") as handle:
+        font_source = handle.read()
+    if "#include" not in font_source:
+        with open(font_c, "w", encoding="utf-8") as handle:
+            handle.write("/* 由 tools/gen_ui_font.py 生成，请勿手动修改 */\n#include <U8g2lib.h>\n\n" + font_source)
+
+    with open(os.path.join(FONT_DIR, "ui_font.h"), "w", encoding="utf-8") as handle:
+        handle.write("/**\n * 界面子集字体（由 tools/gen_ui_font.py 生成，请勿手动修改）\n")
+        handle.write(" * 包含 %d 个字形: 可打印ASCII + 界面用到的 %d 个非ASCII字符\n */\n\n" % (len(needed), len(usage)))
+        handle.write("#ifndef UI_FONT_H\n#define UI_FONT_H\n\n#include <U8g2lib.h>\n\n")
+        handle.write("#define UI_FONT_SUBSET_GENERATED 1\n\n")
+        handle.write("extern \"C\" const uint8_t %s[];\n\n#endif // UI_FONT_H\n" % FONT_NAME)
+
+    with open(MAP_FILE, "w", encoding="utf-8") as handle:
+        handle.write("# 子集字体包含的字形（由 tools/gen_ui_font.py 生成，--check 据此检查）\n")
+        for codepoint in sorted(needed):
+            handle.write("%04X %s\n" % (codepoint, chr(codepoint) if codepoint > 0x20 else "SPACE"))
+
+    size = os.path.getsize(font_c)
+    print("已生成 %s: %d 个字形（源文件 %d 字节）" % (os.path.relpath(font_c, REPO_ROOT), len(needed), size))
+    return 0
+
+
+def subset_enabled():
+    with open(os.path.join(REPO_ROOT, "config.h"), encoding="utf-8") as handle:
+        match = re.search(r'^\s*#define\s+USE_UI_FONT_SUBSET\s+(\w+)', handle.read(), re.MULTILINE)
+    return match is not None and match.group(1) in ("true", "1")
+
+
+def check():
+    if not subset_enabled():
+        print("config.h 中未启用 USE_UI_FONT_SUBSET，使用完整字体，跳过检查")
+        return 0
+    glyphs = read_map()
+    if glyphs is None:
+        sys.stderr.write("已启用 USE_UI_FONT_SUBSET，但子集字体尚未生成（%s 不存在），请先运行 tools/gen_ui_font.py\n"
+                         % os.path.relpath(MAP_FILE, REPO_ROOT))
+        return 1
+
+    errors = 0
+    for char, places in sorted(scan_display_strings().items()):
+        if ord(char) not in glyphs:
+            for path, line, literal in places:
+                sys.stderr.write("%s:%d: 子集字体缺少字形 '%s' (U+%04X)，字符串: \"%s\"\n"
+                                 % (path, line, char, ord(char), literal))
+                errors += 1
+    if errors:
+        sys.stderr.write("子集字体缺少 %d 处字形，请重新运行 tools/gen_ui_font.py 生成字体\n" % errors)
+        return 1
+    print("子集字体检查通过（%d 个字形）" % len(glyphs))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="生成/检查界面子集字体")
+    parser.add_argument("--check", action="store_true", help="只检查显示字符串是否都在已生成的子集中")
+    parser.add_argument("--list", action="store_true", help="列出显示字符串用到的非ASCII字符")
+    parser.add_argument("--bdfconv", help="U8g2 bdfconv 工具路径")
+    parser.add_argument("--bdf", help="源BDF字体路径（unifont.bdf）")
+    args = parser.parse_args()
+
+    if args.list:
+        for char, places in sorted(scan_display_strings().items()):
+            print("U+%04X %s  (%d 处)" % (ord(char), char, len(places)))
+        return 0
+    if args.check:
+        return check()
+    if not args.bdfconv or not args.bdf:
+        parser.error("生成字体需要 --bdfconv 和 --bdf 参数（只检查请使用 --check）")
+    return generate(args)
+
+
+# PlatformIO extra_scripts 方式运行时只做检查，检查失败则中止编译
+if __name__ == "SCons.Script":
+    if check() != 0:
+        Exit(1)  # noqa: F821 (PlatformIO/SCons 提供)
+elif __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""
+BLE Meter 二进制遥测解码工具
+
+从串口或录制文件读取 COBS 分帧的遥测数据，校验 CRC 后输出 CSV。
+帧格式详见 docs/telemetry_protocol.md（固件端: src/Telemetry.cpp）。
+
+用法:
+  # 直接读取串口（需要 pyserial: pip install pyserial）
+  python3 tools/telemetry_decode.py --port /dev/ttyACM0 --baud 115200 > ride.csv
+
+  # 解码录制的原始串口数据
+  python3 tools/telemetry_decode.py --input capture.bin > ride.csv
+
+  # 同时输出原始CSC数据包（用于回放）
+  python3 tools/telemetry_decode.py --input capture.bin --raw raw_packets.csv > ride.csv
+
+  # 同时输出链路质量统计（RSSI、丢包、到达间隔分布）
+  python3 tools/telemetry_decode.py --input capture.bin --link link.csv > ride.csv
+"""
+
+import argparse
+import struct
+import sys
+
+PROTOCOL_VERSION = 3
+
+RECORD_HELLO = 0x00
+RECORD_SENSOR = 0x01
+RECORD_RAW_CSC = 0x02
+RECORD_LINK = 0x03
+
+HELLO_FORMAT = "<BHI"  # 协议版本、轮周长(mm)、运行时间(ms)
+RAW_CSC_HEADER = "<IB"  # 时间戳、数据包长度
+
+# 传感器记录布局（帧头之后，little-endian）；旧版本的记录较短，缺少的字段输出为空
+SENSOR_FORMATS = [
+    "<IHHIHHHIIHIbbB",      # 版本1
+    "<IHHIHHHIIHIbbBHb",    # 版本2：链路质量
+    "<IHHIHHHIIHIbbBHbHB",  # 版本3：功率、心率
+]
+SENSOR_FIELDS = [
+    "timestamp_ms",
+    "speed_kmh",
+    "cadence_rpm",
+    "wheel_revolutions",
+    "wheel_event_time",
+    "crank_revolutions",
+    "crank_event_time",
+    "distance_km",
+    "total_distance_km",
+    "average_speed_kmh",
+    "ride_duration_s",
+    "rssi_dbm",
+    "battery_pct",
+    "connected",
+    "link_loss_pct",
+    "rssi_trend_db",
+    "power_w",
+    "heart_rate_bpm",
+]
+
+# 链路记录布局：时间戳、RSSI、趋势、收到/推断丢失/缓冲区溢出的数据包数、正常/最大间隔，之后是到达间隔分桶
+LINK_GAP_BUCKETS = 14
+LINK_FORMAT = "<IbbIIIHH" + "H" * LINK_GAP_BUCKETS
+LINK_FIELDS = [
+    "timestamp_ms",
+    "rssi_dbm",
+    "rssi_trend_db",
+    "received",
+    "lost",
+    "ring_dropped",
+    "nominal_gap_ms",
+    "max_gap_ms",
+] + ["gap_lt_%dms" % (1 << i) for i in range(LINK_GAP_BUCKETS - 1)] + ["gap_ge_%dms" % (1 << (LINK_GAP_BUCKETS - 2))]
+
+
+def crc16_ccitt(data):
+    """CRC-16/CCITT-FALSE，与固件端 Telemetry::crc16 一致"""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            if crc & 0x8000:
+                crc = ((crc << 1) ^ 0x1021) & 0xFFFF
+            else:
+                crc = (crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    """COBS解码，格式错误时返回None"""
+    output = bytearray()
+    index = 0
+    while index < len(frame):
+        code = frame[index]
+        if code == 0 or index + code > len(frame):
+            return None
+        output += frame[index + 1:index + code]
+        index += code
+        if code < 0xFF and index < len(frame):
+            output.append(0)
+    return bytes(output)
+
+
+class Decoder:
+    def __init__(self, sensor_out, raw_out=None, link_out=None):
+        self.sensor_out = sensor_out
+        self.raw_out = raw_out
+        self.link_out = link_out
+        self.buffer = bytearray()
+        self.last_sequence = None
+        self.frames = 0
+        self.invalid_frames = 0
+        self.lost_frames = 0
+        self.malformed_records = 0
+        self.sensor_out.write(",".join(["sequence"] + SENSOR_FIELDS) + "\n")
+        if self.raw_out:
+            self.raw_out.write("sequence,timestamp_ms,length,data\n")
+        if self.link_out:
+            self.link_out.write(",".join(["sequence"] + LINK_FIELDS) + "\n")
+
+    def feed(self, chunk):
+        self.buffer += chunk
+        while True:
+            end = self.buffer.find(b"\x00")
+            if end < 0:
+                # 防止长时间无分隔符（纯文本日志）导致缓冲区无限增长
+                if len(self.buffer) > 4096:
+                    del self.buffer[:-256]
+                return
+            frame = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if frame:
+                self.handle_frame(frame)
+
+    def handle_frame(self, frame):
+        payload = cobs_decode(frame)
+        if payload is None or len(payload) < 5:
+            self.invalid_frames += 1
+            return
+        body, crc = payload[:-2], struct.unpack("<H", payload[-2:])[0]
+        if crc16_ccitt(body) != crc:
+            self.invalid_frames += 1
+            return
+
+        record_type, sequence = struct.unpack("<BH", body[:3])
+        record = body[3:]
+        self.frames += 1
+        if self.last_sequence is not None:
+            gap = (sequence - self.last_sequence - 1) & 0xFFFF
+            if gap < 0x8000:
+                self.lost_frames += gap
+        self.last_sequence = sequence
+
+        if record_type == RECORD_HELLO:
+            if len(record) < struct.calcsize(HELLO_FORMAT):
+                self.malformed_records += 1
+                return
+            version, wheel_mm, uptime = struct.unpack(HELLO_FORMAT, record[:struct.calcsize(HELLO_FORMAT)])
+            if version != PROTOCOL_VERSION:
+                sys.stderr.write("警告: 固件协议版本 %d，解码器版本 %d\n" % (version, PROTOCOL_VERSION))
+            sys.stderr.write("HELLO: 协议版本=%d, 轮周长=%dmm, 运行时间=%dms\n" % (version, wheel_mm, uptime))
+            self.last_sequence = sequence
+        elif record_type == RECORD_SENSOR:
+            if len(record) < struct.calcsize(SENSOR_FORMATS[0]):
+                self.malformed_records += 1
+                return
+            fmt = SENSOR_FORMATS[0]
+            for candidate in SENSOR_FORMATS:
+                if len(record) >= struct.calcsize(candidate):
+                    fmt = candidate
+            values = list(struct.unpack(fmt, record[:struct.calcsize(fmt)]))
+            values += [""] * (len(SENSOR_FIELDS) - len(values))
+            if values[14] != "":
+                values[14] /= 10.0    # 丢包率（千分比 → %）
+            values[1] /= 100.0    # speed
+            values[2] /= 10.0     # cadence
+            values[7] /= 1000.0   # distance
+            values[8] /= 1000.0   # total distance
+            values[9] /= 100.0    # average speed
+            values[13] = values[13] & 0x01
+            self.sensor_out.write(",".join(str(v) for v in [sequence] + values) + "\n")
+        elif record_type == RECORD_RAW_CSC:
+            header = struct.calcsize(RAW_CSC_HEADER)
+            if len(record) < header or len(record) < header + record[header - 1]:
+                self.malformed_records += 1
+                return
+            if self.raw_out:
+                timestamp, length = struct.unpack(RAW_CSC_HEADER, record[:header])
+                data = record[header:header + length]
+                self.raw_out.write("%d,%d,%d,%s\n" % (sequence, timestamp, length, data.hex(" ")))
+        elif record_type == RECORD_LINK:
+            if len(record) < struct.calcsize(LINK_FORMAT):
+                self.malformed_records += 1
+                return
+            if self.link_out:
+                values = struct.unpack(LINK_FORMAT, record[:struct.calcsize(LINK_FORMAT)])
+                self.link_out.write(",".join(str(v) for v in (sequence,) + values) + "\n")
+
+    def summary(self):
+        sys.stderr.write("帧数: %d, 无效帧(CRC错误或文本日志): %d, 丢失帧: %d, 长度不足的记录: %d\n" %
+                         (self.frames, self.invalid_frames, self.lost_frames, self.malformed_records))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="BLE Meter 二进制遥测解码工具")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="串口设备，例如 /dev/ttyACM0 或 COM3")
+    source.add_argument("--input", help="录制的原始串口数据文件（'-' 表示标准输入）")
+    parser.add_argument("--baud", type=int, default=115200, help="串口波特率（与 config.h 中 SERIAL_BAUD 一致）")
+    parser.add_argument("--raw", help="原始CSC数据包输出文件（CSV）")
+    parser.add_argument("--link", help="链路质量统计输出文件（CSV）")
+    args = parser.parse_args()
+
+    raw_out = open(args.raw, "w") if args.raw else None
+    link_out = open(args.link, "w") if args.link else None
+    decoder = Decoder(sys.stdout, raw_out, link_out)
+    try:
+        if args.port:
+            import serial  # pyserial
+            with serial.Serial(args.port, args.baud, timeout=0.5) as port:
+                while True:
+                    decoder.feed(port.read(4096))
+        else:
+            stream = sys.stdin.buffer if args.input == "-" else open(args.input, "rb")
+            with stream:
+                while True:
+                    chunk = stream.read(65536)
+                    if not chunk:
+                        break
+                    decoder.feed(chunk)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        decoder.summary()
+        if raw_out:
+            raw_out.close()
+        if link_out:
+            link_out.close()
+
+
+if __name__ == "__main__":
+    main()